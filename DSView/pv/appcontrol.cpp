@@ -33,6 +33,8 @@
 #include "log.h"
 #include "utility/path.h"
 #include "utility/encoding.h"
+#include "data/memorybudget.h"
+#include "taskscheduler.h"
 
 AppControl::AppControl()
 {
@@ -69,6 +71,12 @@ bool AppControl::Init()
 
     pv::encoding::init();
 
+    pv::data::MemoryBudget &mem = pv::data::MemoryBudget::Instance();
+    mem.set_budget((uint64_t)AppConfig::Instance()._appOptions.memoryBudget * 1024 * 1024);
+    dsv_info("Physical memory:%lluMB, memory budget:%lluMB",
+        (unsigned long long)(mem.get_physical_memory() / (1024 * 1024)),
+        (unsigned long long)(mem.get_budget() / (1024 * 1024)));
+
     srd_log_set_context(dsv_log_context());
 
 #if defined(_WIN32) && defined(DEBUG_INFO)
@@ -123,6 +131,8 @@ void AppControl::UnInit()
     srd_exit();
 
     _session->uninit();
+
+    pv::TaskScheduler::Instance().shutdown();
 }
 
 const char *AppControl::GetLastError()
@@ -94,8 +94,11 @@ void _loadApp(AppOptions &o, QSettings &st){
     getFiled("quickScroll", st, o.quickScroll, true);
     getFiled("warnofMultiTrig", st, o.warnofMultiTrig, true);
     getFiled("originalData", st, o.originalData, false);
+    getFiled("saveDecodeResults", st, o.saveDecodeResults, false);
     getFiled("ableSaveLog", st, o.ableSaveLog, false);
     getFiled("logLevel", st, o.logLevel, 3);
+    getFiled("memoryBudget", st, o.memoryBudget, 0);
+    getFiled("streamData", st, o.streamData, false);
 
     QString fmt;
     getFiled("protocalFormats", st, fmt, "");
@@ -111,8 +114,11 @@ void _saveApp(AppOptions &o, QSettings &st){
     setFiled("quickScroll", st, o.quickScroll);
     setFiled("warnofMultiTrig", st, o.warnofMultiTrig);
     setFiled("originalData", st, o.originalData);
+    setFiled("saveDecodeResults", st, o.saveDecodeResults);
     setFiled("ableSaveLog", st, o.ableSaveLog);
     setFiled("logLevel", st, o.logLevel);
+    setFiled("memoryBudget", st, o.memoryBudget);
+    setFiled("streamData", st, o.streamData);
 
     QString fmt =  FormatArrayToString(o.m_protocolFormats);
     setFiled("protocalFormats", st, fmt);
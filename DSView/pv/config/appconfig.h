@@ -57,8 +57,11 @@ struct AppOptions
     bool  quickScroll;
     bool  warnofMultiTrig;
     bool  originalData;
+    bool  saveDecodeResults;
     bool  ableSaveLog;
     int   logLevel;
+    int   memoryBudget; // MB, 0 is automatic
+    bool  streamData;
 
     std::vector<StringPair> m_protocolFormats;
 };
@@ -27,6 +27,7 @@
 #include <algorithm>
  
 #include "analogsnapshot.h"
+#include "memorybudget.h"
 #include "../dsvdef.h"
 
 using namespace std;
@@ -44,6 +45,9 @@ AnalogSnapshot::AnalogSnapshot() :
     Snapshot(sizeof(uint16_t), 1, 1)
 {
 	memset(_envelope_levels, 0, sizeof(_envelope_levels));
+    memset(_moments, 0, sizeof(_moments));
+    _envelope_bytes = 0;
+    _mem_pool = MemoryBudget::PoolAnalog;
     _unit_pitch = 0;
 }
 
@@ -54,13 +58,21 @@ AnalogSnapshot::~AnalogSnapshot()
 
 void AnalogSnapshot::free_envelop()
 {
-    for (unsigned int i = 0; i < _channel_num; i++) {
-        for(auto &e : _envelope_levels[i]) {
+    // the channel number may have been changed, release all levels
+    for (auto &levels : _envelope_levels) {
+        for(auto &e : levels) {
             if (e.samples)
                 free(e.samples);
         }
     }
     memset(_envelope_levels, 0, sizeof(_envelope_levels));
+    for (auto &m : _moments) {
+        if (m)
+            free(m);
+    }
+    memset(_moments, 0, sizeof(_moments));
+    mem_free(_envelope_bytes);
+    _envelope_bytes = 0;
 }
 
 void AnalogSnapshot::init()
@@ -84,6 +96,7 @@ void AnalogSnapshot::init_all()
             _envelope_levels[i][level].data_length = 0;
         }
     }
+    _generation++;
 }
 
 void AnalogSnapshot::clear()
@@ -95,6 +108,20 @@ void AnalogSnapshot::clear()
     _have_data = false;
 }
 
+uint64_t AnalogSnapshot::get_memory_size(uint64_t total_sample_count,
+                                         unsigned int channel_num, int unit_bytes)
+{
+    uint64_t size = total_sample_count * channel_num * unit_bytes + sizeof(uint64_t);
+    uint64_t envelop_count = total_sample_count / EnvelopeScaleFactor;
+
+    for (unsigned int level = 0; level < ScaleStepCount && envelop_count != 0; level++) {
+        size += envelop_count * sizeof(EnvelopeSample) * channel_num;
+        envelop_count = envelop_count / EnvelopeScaleFactor;
+    }
+    size += (total_sample_count / BlockStatsSamples) * sizeof(Moments) * channel_num;
+    return size;
+}
+
 void AnalogSnapshot::first_payload(const sr_datafeed_analog &analog, uint64_t total_sample_count, GSList *channels)
 {
     _total_sample_count = total_sample_count;
@@ -120,6 +147,8 @@ void AnalogSnapshot::first_payload(const sr_datafeed_analog &analog, uint64_t to
         free_data();
         _data = malloc(size);
         if (_data) {
+            _capacity = size;
+            mem_alloc(size);
             free_envelop();
             for (unsigned int i = 0; i < _channel_num; i++) {
                 uint64_t envelop_count = _total_sample_count / EnvelopeScaleFactor;
@@ -134,13 +163,26 @@ void AnalogSnapshot::first_payload(const sr_datafeed_analog &analog, uint64_t to
                         isOk = false;
                         break;
                     }
+                    _envelope_bytes += envelop_count * sizeof(EnvelopeSample);
+                    mem_alloc(envelop_count * sizeof(EnvelopeSample));
                     envelop_count = envelop_count / EnvelopeScaleFactor;
                 }
                 if (!isOk)
                     break;
+
+                const uint64_t block_count = _total_sample_count / BlockStatsSamples;
+                if (block_count != 0) {
+                    _moments[i] = (Moments*)malloc(block_count * sizeof(Moments));
+                    if (!_moments[i]) {
+                        isOk = false;
+                        break;
+                    }
+                    _envelope_bytes += block_count * sizeof(Moments);
+                    mem_alloc(block_count * sizeof(Moments));
+                }
             }
         } else {
-            isOk = true;
+            isOk = false;
         }
     }
 
@@ -176,6 +218,7 @@ void AnalogSnapshot::append_payload(
         append_payload_to_envelope_levels();
 
     _have_data = true;
+    _generation++;
 }
 
 void AnalogSnapshot::append_data(void *data, uint64_t samples, uint16_t pitch)
@@ -297,15 +340,32 @@ void AnalogSnapshot::append_payload_to_envelope_levels()
             EnvelopeSample sub_sample;
             sub_sample.min = *src_ptr;
             sub_sample.max = *src_ptr;
+            uint32_t sum = *src_ptr;
+            uint32_t square_sum = *src_ptr * *src_ptr;
             src_ptr += _channel_num * _unit_bytes;
             while(src_ptr != end_src_ptr) {
                 sub_sample.min = min(sub_sample.min, *src_ptr);
                 sub_sample.max = max(sub_sample.max, *src_ptr);
+                sum += *src_ptr;
+                square_sum += *src_ptr * *src_ptr;
                 src_ptr += _channel_num * _unit_bytes;
                 if (src_ptr >= (uint8_t*)_data + src_size)
                     src_ptr -= src_size;
             }
 
+            // the moments of a block are summed up from its first sample on
+            const uint64_t index = dest_ptr - e0.samples;
+            const uint64_t block = index >> (BlockStatsPower - EnvelopeScalePower);
+            if (_moments[i] != NULL && block < _total_sample_count / BlockStatsSamples) {
+                Moments &m = _moments[i][block];
+                if ((index & ((BlockStatsSamples >> EnvelopeScalePower) - 1)) == 0) {
+                    m.sum = 0;
+                    m.square_sum = 0;
+                }
+                m.sum += sum;
+                m.square_sum += square_sum;
+            }
+
             *dest_ptr++ = sub_sample;
             if (dest_ptr >= e0.samples + e0.count)
                 dest_ptr = e0.samples;
@@ -372,6 +432,26 @@ int AnalogSnapshot::get_ch_order(int sig_index)
         return order;
 }
 
+bool AnalogSnapshot::get_block_stats(int order, uint64_t block, BlockStats &s)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (order < 0 || order >= (int)_channel_num || _moments[order] == NULL)
+        return false;
+    if (ring_start() != 0 || (block + 1) * BlockStatsSamples > _sample_count)
+        return false;
+
+    const Envelope &e = _envelope_levels[order][BlockStatsPower / EnvelopeScalePower - 1];
+    if (e.samples == NULL || block >= e.count)
+        return false;
+
+    s.min = e.samples[block].min;
+    s.max = e.samples[block].max;
+    s.sum = _moments[order][block].sum;
+    s.square_sum = _moments[order][block].square_sum;
+    return true;
+}
+
 int AnalogSnapshot::get_scale_factor()
 {
     return EnvelopeScaleFactor;
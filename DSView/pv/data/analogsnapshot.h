@@ -55,6 +55,18 @@ public:
 		EnvelopeSample *samples;
 	};
 
+    // of the raw samples of one block
+    struct BlockStats
+    {
+        uint8_t min;
+        uint8_t max;
+        uint64_t sum;
+        uint64_t square_sum;
+    };
+
+    static const int BlockStatsPower = 12;  // the samples of a level 2 envelope sample
+    static const uint64_t BlockStatsSamples = 1ULL << BlockStatsPower;
+
 private:
 	struct Envelope
 	{
@@ -67,6 +79,12 @@ private:
         uint8_t *min;
 	};
 
+    struct Moments
+    {
+        uint32_t sum;
+        uint32_t square_sum;
+    };
+
 private:
 	static const unsigned int ScaleStepCount = 10;
 	static const int EnvelopeScalePower;
@@ -92,6 +110,10 @@ public:
     void first_payload(const sr_datafeed_analog &analog,
                        uint64_t total_sample_count, GSList *channels);
 
+    // bytes of the samples and the envelopes of a capture
+    static uint64_t get_memory_size(uint64_t total_sample_count,
+                                    unsigned int channel_num, int unit_bytes);
+
 	void append_payload(const sr_datafeed_analog &analog);
 
     const uint8_t *get_samples(int64_t start_sample);
@@ -101,6 +123,10 @@ public:
 
     int get_ch_order(int sig_index);
 
+    // false for a block which is not complete, or once the capture
+    // has wrapped around and the blocks no longer start at sample 0
+    bool get_block_stats(int order, uint64_t block, BlockStats &s);
+
     int get_scale_factor();
 
     bool has_data(int index);
@@ -117,6 +143,8 @@ private:
 
 private:
     struct Envelope _envelope_levels[DS_MAX_ANALOG_PROBES_NUM][ScaleStepCount];
+    Moments *_moments[DS_MAX_ANALOG_PROBES_NUM];
+    uint64_t _envelope_bytes;
 	friend class AnalogSnapshotTest::Basic;
 };
 
@@ -0,0 +1,407 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2013 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "capturediff.h"
+
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <glib.h>
+
+#include "../ZipMaker.h"
+#include "../utility/path.h"
+#include "../log.h"
+#include "../ui/langresource.h"
+
+using namespace std;
+
+namespace pv {
+namespace data {
+
+CaptureDiff::CaptureDiff()
+{
+    _ref_loaded = false;
+    _ref_trig_pos = 0;
+    _ref_samplerate = 0;
+    _offset = 0;
+    _tolerance = 0;
+    _max_ranges = MaxRangesDefault;
+    _compared = 0;
+    _ref.init();
+}
+
+CaptureDiff::~CaptureDiff()
+{
+}
+
+void CaptureDiff::clear_reference()
+{
+    _ref.clear();
+    _ref_loaded = false;
+    _ref_file = "";
+    _ref_trig_pos = 0;
+    _ref_samplerate = 0;
+    _result.clear();
+}
+
+bool CaptureDiff::load_reference(QString file, QString &error)
+{
+    clear_reference();
+
+    auto f_name = path::ConvertPath(file);
+    ZipReader rd(f_name.c_str());
+    if (!rd.HaveArchive()) {
+        error = L_S(STR_PAGE_MSG, S_ID(IDS_MSG_COMPARE_OPEN_ERROR), "Failed to open the reference file.");
+        return false;
+    }
+
+    auto *header = rd.GetInnterFileData("header");
+    if (header == NULL) {
+        error = L_S(STR_PAGE_MSG, S_ID(IDS_MSG_COMPARE_FORMAT_ERROR), "The reference file is not a logic capture.");
+        return false;
+    }
+
+    GKeyFile *kf = g_key_file_new();
+    gboolean ok = g_key_file_load_from_data(kf, header->data(), header->size(), G_KEY_FILE_NONE, NULL);
+    rd.ReleaseInnerFileData(header);
+
+    int version = 0;
+    int mode = -1;
+    uint64_t total_samples = 0;
+    uint64_t total_blocks = 0;
+    std::vector<uint16_t> probes;
+
+    if (ok) {
+        char *val = g_key_file_get_string(kf, "version", "version", NULL);
+        if (val != NULL) {
+            version = strtoul(val, NULL, 10);
+            g_free(val);
+        }
+
+        gchar **keys = g_key_file_get_keys(kf, "header", NULL, NULL);
+        for (int j = 0; keys && keys[j]; j++) {
+            val = g_key_file_get_string(kf, "header", keys[j], NULL);
+            if (val == NULL)
+                continue;
+
+            if (!strcmp(keys[j], "device mode"))
+                mode = strtoul(val, NULL, 10);
+            else if (!strcmp(keys[j], "samplerate"))
+                sr_parse_sizestring(val, &_ref_samplerate);
+            else if (!strcmp(keys[j], "total samples"))
+                total_samples = strtoull(val, NULL, 10);
+            else if (!strcmp(keys[j], "total blocks"))
+                total_blocks = strtoull(val, NULL, 10);
+            else if (!strcmp(keys[j], "trigger pos"))
+                _ref_trig_pos = strtoull(val, NULL, 10);
+            else if (!strncmp(keys[j], "probe", 5))
+                probes.push_back(strtoul(keys[j] + 5, NULL, 10));
+
+            g_free(val);
+        }
+        g_strfreev(keys);
+    }
+    g_key_file_free(kf);
+
+    // only the split layout of version 2 files can be fed block by block
+    if (!ok || version != 2 || mode != LOGIC || probes.empty() || total_samples == 0) {
+        error = L_S(STR_PAGE_MSG, S_ID(IDS_MSG_COMPARE_FORMAT_ERROR), "The reference file is not a logic capture.");
+        return false;
+    }
+
+    std::sort(probes.begin(), probes.end());
+
+    std::vector<sr_channel> channels(probes.size());
+    GSList *ch_list = NULL;
+    for (unsigned int i = 0; i < probes.size(); i++) {
+        memset(&channels[i], 0, sizeof(sr_channel));
+        channels[i].index = probes[i];
+        channels[i].type = SR_CHANNEL_LOGIC;
+        channels[i].enabled = TRUE;
+        ch_list = g_slist_append(ch_list, &channels[i]);
+    }
+
+    char chunk_name[20] = {0};
+    bool first = true;
+    bool ret = true;
+
+    for (unsigned int i = 0; ret && i < probes.size(); i++) {
+        for (uint64_t b = 0; b < total_blocks; b++) {
+            snprintf(chunk_name, 15, "L-%d/%d", probes[i], (int)b);
+            auto *block = rd.GetInnterFileData(chunk_name);
+            if (block == NULL) {
+                dsv_err("Reference file block \"%s\" is missing.", chunk_name);
+                ret = false;
+                break;
+            }
+
+            sr_datafeed_logic logic;
+            memset(&logic, 0, sizeof(logic));
+            logic.format = LA_SPLIT_DATA;
+            logic.index = probes[i];
+            logic.order = i;
+            logic.unitsize = 1;
+            logic.length = block->size();
+            logic.data = block->data();
+
+            if (first) {
+                _ref.first_payload(logic, total_samples, ch_list);
+                first = false;
+            }
+            else {
+                _ref.append_payload(logic);
+            }
+            rd.ReleaseInnerFileData(block);
+
+            if (_ref.memory_failed()) {
+                ret = false;
+                break;
+            }
+        }
+    }
+    g_slist_free(ch_list);
+
+    if (!ret) {
+        _ref.clear();
+        error = _ref.memory_failed() ?
+                L_S(STR_PAGE_MSG, S_ID(IDS_MSG_COMPARE_MEMORY_ERROR), "Memory is not enough for the reference capture.") :
+                L_S(STR_PAGE_MSG, S_ID(IDS_MSG_COMPARE_FORMAT_ERROR), "The reference file is not a logic capture.");
+        return false;
+    }
+
+    _ref.capture_ended();
+    _ref_loaded = true;
+    _ref_file = file;
+
+    dsv_info("Loaded reference capture \"%s\", %llu samples, %d channels.",
+             file.toUtf8().data(), (unsigned long long)_ref.get_sample_count(), (int)probes.size());
+
+    return true;
+}
+
+int CaptureDiff::compare(LogicSnapshot *cur, std::atomic<bool> *canceled)
+{
+    if (!_ref_loaded) {
+        _result.clear();
+        _compared = 0;
+        return 0;
+    }
+    return compare(cur, &_ref, canceled);
+}
+
+int CaptureDiff::compare(LogicSnapshot *cur, LogicSnapshot *ref, std::atomic<bool> *canceled)
+{
+    assert(cur);
+    assert(ref);
+
+    _result.clear();
+    _compared = 0;
+
+    const int64_t cur_samples = cur->get_sample_count();
+    const int64_t ref_samples = ref->get_sample_count();
+    const int64_t start = max((int64_t)0, -_offset);
+    const int64_t end = min(cur_samples, ref_samples - _offset);
+    if (start >= end)
+        return 0;
+    _compared = end - start;
+
+    int total = 0;
+    for (auto sig_index : cur->_ch_index) {
+        if (canceled && *canceled)
+            break;
+        // virtual channels are computed, the reference has none of them
+        if (LogicSnapshot::is_virtual_index(sig_index) || !ref->has_data(sig_index))
+            continue;
+
+        ChannelDiff diff;
+        diff.sig_index = sig_index;
+        diff.truncated = false;
+        compare_channel(cur, ref, sig_index, diff, canceled);
+        total += diff.ranges.size();
+        _result.push_back(diff);
+    }
+
+    return total;
+}
+
+void CaptureDiff::init_cursor(PlaneCursor &pc, LogicSnapshot *snapshot, int order, uint64_t samples)
+{
+    assert(order != -1);
+
+    pc.nodes = &snapshot->_ch_data[order];
+    pc.word_count = (samples + LogicSnapshot::Scale - 1) >> LogicSnapshot::ScalePower;
+    pc.leaf = ~0ULL;
+    pc.lbp = NULL;
+    pc.fill = 0;
+}
+
+bool CaptureDiff::leaf_is_constant(PlaneCursor &pc, uint64_t leaf, bool &value)
+{
+    const LogicSnapshot::RootNode &rn = (*pc.nodes)[leaf >> LogicSnapshot::RootScalePower];
+    const uint64_t mask = 1ULL << (leaf & (LogicSnapshot::RootScale - 1));
+
+    // finalized leaves without toggles have been trimmed
+    if ((rn.tog & mask) || rn.lbp[leaf & (LogicSnapshot::RootScale - 1)] != NULL)
+        return false;
+
+    value = (rn.value & mask) != 0;
+    return true;
+}
+
+bool CaptureDiff::root_is_constant(const LogicSnapshot::RootNode &rn)
+{
+    if (rn.tog != 0)
+        return false;
+
+    for (unsigned int i = 0; i < LogicSnapshot::RootScale; i++) {
+        if (rn.lbp[i] != NULL)
+            return false;
+    }
+    return true;
+}
+
+bool CaptureDiff::span_is_constant(PlaneCursor &pc, uint64_t start, uint64_t samples, bool &value)
+{
+    const uint64_t first = start >> LogicSnapshot::LeafBlockPower;
+    const uint64_t last = (start + samples - 1) >> LogicSnapshot::LeafBlockPower;
+    bool leaf_value;
+
+    for (uint64_t leaf = first; leaf <= last; leaf++) {
+        if (!leaf_is_constant(pc, leaf, leaf_value))
+            return false;
+        if (leaf != first && leaf_value != value)
+            return false;
+        value = leaf_value;
+    }
+    return true;
+}
+
+bool CaptureDiff::push_range(ChannelDiff &diff, uint64_t start, uint64_t end)
+{
+    if (end - start <= _tolerance)
+        return true;
+
+    if ((int)diff.ranges.size() >= _max_ranges) {
+        diff.truncated = true;
+        return false;
+    }
+
+    DiffRange range;
+    range.start = start;
+    range.end = end;
+    diff.ranges.push_back(range);
+    return true;
+}
+
+void CaptureDiff::compare_channel(LogicSnapshot *cur, LogicSnapshot *ref, int sig_index, ChannelDiff &diff,
+                                  std::atomic<bool> *canceled)
+{
+    const uint64_t cur_samples = cur->get_sample_count();
+    const uint64_t ref_samples = ref->get_sample_count();
+    const uint64_t start = max((int64_t)0, -_offset);
+    const uint64_t end = min((int64_t)cur_samples, (int64_t)ref_samples - _offset);
+    const uint64_t leaf_samples = LogicSnapshot::LeafBlockSamples;
+    const uint64_t root_samples = LogicSnapshot::RootNodeSamples;
+    const bool root_aligned = (_offset % (int64_t)root_samples) == 0;
+
+    PlaneCursor cur_pc;
+    PlaneCursor ref_pc;
+    init_cursor(cur_pc, cur, cur->get_ch_order(sig_index), cur_samples);
+    init_cursor(ref_pc, ref, ref->get_ch_order(sig_index), ref_samples);
+
+    bool in_run = false;
+    uint64_t run_start = 0;
+    bool cur_value;
+    bool ref_value;
+    uint64_t pos = start & ~(LogicSnapshot::Scale - 1);
+
+    while (pos < end) {
+        if ((pos & LogicSnapshot::LeafMask) == 0) {
+            if (canceled && *canceled)
+                return;
+
+            // the first word may start before the compared range, and
+            // before the start of the reference for a negative offset
+            const bool inside = pos >= start && (int64_t)pos + _offset >= 0;
+            uint64_t skip = 0;
+
+            // whole root nodes without any toggle on both sides
+            if (inside && root_aligned && (pos % root_samples) == 0 && pos + root_samples <= end) {
+                const LogicSnapshot::RootNode &cur_rn = (*cur_pc.nodes)[pos / root_samples];
+                const LogicSnapshot::RootNode &ref_rn = (*ref_pc.nodes)[(pos + _offset) / root_samples];
+                if (cur_rn.value == ref_rn.value &&
+                    root_is_constant(cur_rn) && root_is_constant(ref_rn))
+                    skip = root_samples;
+            }
+
+            // constant leaf against constant samples with the same level
+            if (skip == 0 && inside && pos + leaf_samples <= end &&
+                leaf_is_constant(cur_pc, pos >> LogicSnapshot::LeafBlockPower, cur_value) &&
+                span_is_constant(ref_pc, pos + _offset, leaf_samples, ref_value) &&
+                cur_value == ref_value)
+                skip = leaf_samples;
+
+            if (skip != 0) {
+                if (in_run) {
+                    in_run = false;
+                    if (!push_range(diff, run_start, pos))
+                        return;
+                }
+                pos += skip;
+                continue;
+            }
+        }
+
+        uint64_t bits = get_word(cur_pc, pos >> LogicSnapshot::ScalePower) ^
+                        get_bits(ref_pc, (int64_t)pos + _offset);
+        if (pos < start)
+            bits &= ~0ULL << (start - pos);
+        if (end - pos < LogicSnapshot::Scale)
+            bits &= ~(~0ULL << (end - pos));
+
+        // walk the runs of differing samples in this word
+        uint64_t i = 0;
+        while (i < LogicSnapshot::Scale) {
+            const uint64_t rest = (in_run ? ~bits : bits) >> i;
+            if (rest == 0)
+                break;
+            i += LogicSnapshot::bsf_folded(rest);
+            if (in_run) {
+                in_run = false;
+                if (!push_range(diff, run_start, pos + i))
+                    return;
+            }
+            else {
+                in_run = true;
+                run_start = pos + i;
+            }
+        }
+
+        pos += LogicSnapshot::Scale;
+    }
+
+    if (in_run)
+        push_range(diff, run_start, end);
+}
+
+} // namespace data
+} // namespace pv
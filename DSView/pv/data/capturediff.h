@@ -0,0 +1,185 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2013 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef DSVIEW_PV_DATA_CAPTUREDIFF_H
+#define DSVIEW_PV_DATA_CAPTUREDIFF_H
+
+#include <stdint.h>
+#include <vector>
+#include <atomic>
+#include <QString>
+
+#include "logicsnapshot.h"
+
+namespace pv {
+namespace data {
+
+//Compare two logic captures channel by channel, the reference capture
+//is normally loaded from a .dsl file.
+class CaptureDiff
+{
+public:
+    static const int MaxRangesDefault = 100;
+
+    struct DiffRange
+    {
+        uint64_t start; // first differing sample, in current capture
+        uint64_t end;   // one past the last differing sample
+    };
+
+    struct ChannelDiff
+    {
+        int sig_index;
+        bool truncated;
+        std::vector<DiffRange> ranges;
+    };
+
+private:
+    //Cached access to the data words of one channel
+    struct PlaneCursor
+    {
+        const std::vector<LogicSnapshot::RootNode> *nodes;
+        uint64_t word_count;
+        uint64_t leaf;
+        const uint64_t *lbp;
+        uint64_t fill;
+    };
+
+public:
+    CaptureDiff();
+    ~CaptureDiff();
+
+    bool load_reference(QString file, QString &error);
+    void clear_reference();
+
+    inline bool have_reference(){
+        return _ref_loaded;
+    }
+
+    inline QString reference_file(){
+        return _ref_file;
+    }
+
+    inline uint64_t reference_trig_pos(){
+        return _ref_trig_pos;
+    }
+
+    inline uint64_t reference_samplerate(){
+        return _ref_samplerate;
+    }
+
+    inline LogicSnapshot* reference(){
+        return &_ref;
+    }
+
+    // sample n of the current capture is compared with sample n + offset of the reference
+    inline void set_offset(int64_t offset){
+        _offset = offset;
+    }
+
+    inline int64_t get_offset(){
+        return _offset;
+    }
+
+    // differences not longer than tolerance samples are ignored
+    inline void set_tolerance(uint64_t tolerance){
+        _tolerance = tolerance;
+    }
+
+    inline void set_max_ranges(int max_ranges){
+        _max_ranges = max_ranges;
+    }
+
+    // returns the total number of divergence ranges found
+    int compare(LogicSnapshot *cur, std::atomic<bool> *canceled = NULL);
+    int compare(LogicSnapshot *cur, LogicSnapshot *ref, std::atomic<bool> *canceled = NULL);
+
+    inline void clear_result(){
+        _result.clear();
+        _compared = 0;
+    }
+
+    inline const std::vector<ChannelDiff>& get_result(){
+        return _result;
+    }
+
+    inline uint64_t compared_samples(){
+        return _compared;
+    }
+
+private:
+    void compare_channel(LogicSnapshot *cur, LogicSnapshot *ref, int sig_index, ChannelDiff &diff,
+                         std::atomic<bool> *canceled);
+    void init_cursor(PlaneCursor &pc, LogicSnapshot *snapshot, int order, uint64_t samples);
+    bool root_is_constant(const LogicSnapshot::RootNode &rn);
+    bool leaf_is_constant(PlaneCursor &pc, uint64_t leaf, bool &value);
+    bool span_is_constant(PlaneCursor &pc, uint64_t start, uint64_t samples, bool &value);
+    bool push_range(ChannelDiff &diff, uint64_t start, uint64_t end);
+
+    inline uint64_t get_word(PlaneCursor &pc, uint64_t index)
+    {
+        if (index >= pc.word_count)
+            return 0;
+
+        const uint64_t leaf = index >> (LogicSnapshot::LeafBlockPower - LogicSnapshot::ScalePower);
+        if (leaf != pc.leaf) {
+            const LogicSnapshot::RootNode &rn = (*pc.nodes)[leaf >> LogicSnapshot::RootScalePower];
+            const uint64_t pos = leaf & (LogicSnapshot::RootScale - 1);
+            pc.leaf = leaf;
+            pc.lbp = (const uint64_t *)rn.lbp[pos];
+            pc.fill = (rn.value & (1ULL << pos)) ? ~0ULL : 0ULL;
+        }
+        if (pc.lbp == NULL)
+            return pc.fill;
+        return pc.lbp[index & (LogicSnapshot::LeafBlockSamples / LogicSnapshot::Scale - 1)];
+    }
+
+    // 64 samples starting at any position, bit 0 is the first sample,
+    // samples before the start of the capture read as 0
+    inline uint64_t get_bits(PlaneCursor &pc, int64_t pos)
+    {
+        const int64_t index = pos >> LogicSnapshot::ScalePower;
+        const uint64_t shift = pos & (LogicSnapshot::Scale - 1);
+        const uint64_t lo = (index < 0) ? 0 : get_word(pc, index);
+        if (shift == 0)
+            return lo;
+        const uint64_t hi = (index + 1 < 0) ? 0 : get_word(pc, index + 1);
+        return (lo >> shift) | (hi << (LogicSnapshot::Scale - shift));
+    }
+
+private:
+    LogicSnapshot _ref;
+    bool _ref_loaded;
+    QString _ref_file;
+    uint64_t _ref_trig_pos;
+    uint64_t _ref_samplerate;
+
+    int64_t _offset;
+    uint64_t _tolerance;
+    int _max_ranges;
+    uint64_t _compared;
+    std::vector<ChannelDiff> _result;
+};
+
+} // namespace data
+} // namespace pv
+
+#endif // DSVIEW_PV_DATA_CAPTUREDIFF_H
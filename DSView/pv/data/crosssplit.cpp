@@ -0,0 +1,66 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "crosssplit.h"
+#include <stddef.h>
+
+namespace pv {
+namespace data {
+
+void CrossSplit::split(uint64_t *const *dest, const uint64_t *src,
+                       uint64_t words, unsigned int channel_num)
+{
+    uint64_t tile_words = TileSize / channel_num;
+    if (tile_words == 0)
+        tile_words = 1;
+
+    for (uint64_t start = 0; start < words; start += tile_words) {
+        const uint64_t count = (words - start < tile_words) ? words - start : tile_words;
+        const uint64_t *tile = src + start * channel_num;
+
+        for (unsigned int order = 0; order < channel_num; order++) {
+            uint64_t *dp = dest[order] + start;
+            const uint64_t *sp = tile + order;
+            for (uint64_t i = 0; i < count; i++) {
+                dp[i] = *sp;
+                sp += channel_num;
+            }
+        }
+    }
+}
+
+CrossSplit::Kernel CrossSplit::get_kernel(unsigned int channel_num)
+{
+    // the other layouts measured no faster than the generic split
+    switch (channel_num) {
+    case 6:     return split<6>;
+    case 8:     return split<8>;
+    case 10:    return split<10>;
+    case 12:    return split<12>;
+    case 14:    return split<14>;
+    case 16:    return split<16>;
+    case 32:    return split<32>;
+    default:    return NULL;
+    }
+}
+
+} // namespace data
+} // namespace pv
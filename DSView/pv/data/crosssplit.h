@@ -0,0 +1,82 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef DSVIEW_PV_DATA_CROSSSPLIT_H
+#define DSVIEW_PV_DATA_CROSSSPLIT_H
+
+#include <stdint.h>
+
+namespace pv {
+namespace data {
+
+//Sorts the cross data, where the channels take turns word by word, into
+//one word array per channel. The source is walked in tiles which stay in
+//the L1 cache while each channel takes its words out. The even layouts
+//from 6 to 16 channels and 32 channels get a kernel with a constant
+//stride, picked once per capture, see crosssplit_bench.cpp for the speed
+//of each layout.
+class CrossSplit
+{
+public:
+    // words of cross data sorted at once, 16KB
+    static const uint64_t TileSize = 2048;
+
+    typedef void (*Kernel)(uint64_t *const *dest, const uint64_t *src, uint64_t words);
+
+    // NULL if the channel count has no kernel, split() takes it then
+    static Kernel get_kernel(unsigned int channel_num);
+
+    static void split(uint64_t *const *dest, const uint64_t *src,
+                      uint64_t words, unsigned int channel_num);
+
+    template<unsigned int Stride>
+    static void split(uint64_t *const *dest, const uint64_t *src, uint64_t words)
+    {
+        const uint64_t tile_words = TileSize / Stride;
+
+        for (uint64_t start = 0; start < words; start += tile_words) {
+            const uint64_t count = (words - start < tile_words) ? words - start : tile_words;
+            const uint64_t *tile = src + start * Stride;
+
+            for (unsigned int order = 0; order < Stride; order++) {
+                uint64_t *dp = dest[order] + start;
+                const uint64_t *sp = tile + order;
+                uint64_t i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    dp[i] = sp[0];
+                    dp[i + 1] = sp[Stride];
+                    dp[i + 2] = sp[2 * Stride];
+                    dp[i + 3] = sp[3 * Stride];
+                    sp += 4 * Stride;
+                }
+                for (; i < count; i++) {
+                    dp[i] = *sp;
+                    sp += Stride;
+                }
+            }
+        }
+    }
+};
+
+} // namespace data
+} // namespace pv
+
+#endif // DSVIEW_PV_DATA_CROSSSPLIT_H
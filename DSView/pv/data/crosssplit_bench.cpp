@@ -0,0 +1,137 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/*
+*	Speed of the cross data sorting for each channel layout, the word by
+*	word loop of the old append_cross_payload() against the tiled generic
+*	kernel and the constant stride kernel of the layout.
+*
+*	crosssplit_bench [payload KB] [rounds]
+*/
+
+#include "crosssplit.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <chrono>
+
+using namespace pv::data;
+
+static void split_words(uint64_t *const *dest, const uint64_t *src,
+                        uint64_t words, unsigned int channel_num)
+{
+    for (unsigned int order = 0; order < channel_num; order++) {
+        const uint64_t *sp = src + order;
+        uint64_t *dp = dest[order];
+        for (uint64_t i = 0; i < words; i++) {
+            *dp++ = *sp;
+            sp += channel_num;
+        }
+    }
+}
+
+// the fastest of the rounds, after one round to warm up the caches
+template<typename Func>
+static double run_mbps(Func func, uint64_t bytes, int rounds)
+{
+    double best = 0;
+
+    func();
+    for (int i = 0; i < rounds; i++) {
+        const auto start = std::chrono::steady_clock::now();
+        func();
+        const std::chrono::duration<double> sec = std::chrono::steady_clock::now() - start;
+        if (best == 0 || sec.count() < best)
+            best = sec.count();
+    }
+    return bytes / best / (1024 * 1024);
+}
+
+int main(int argc, char **argv)
+{
+    const uint64_t payload_kb = (argc > 1) ? strtoull(argv[1], NULL, 10) : 4096;
+    const int rounds = (argc > 2) ? atoi(argv[2]) : 20;
+    const unsigned int layouts[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12,
+                                    13, 14, 15, 16, 24, 32};
+
+    if (payload_kb == 0 || rounds <= 0) {
+        fprintf(stderr, "usage: %s [payload KB] [rounds]\n", argv[0]);
+        return 1;
+    }
+
+    printf("payload %llu KB, best of %d rounds, MB/s\n", (unsigned long long)payload_kb, rounds);
+    printf("%4s %10s %10s %10s %8s %8s\n", "ch", "old", "generic", "kernel", "vs old", "vs gen");
+
+    for (unsigned int channel_num : layouts) {
+        const uint64_t words = payload_kb * 1024 / 8 / channel_num;
+        const uint64_t bytes = words * channel_num * 8;
+        std::vector<uint64_t> src(words * channel_num);
+        std::vector<std::vector<uint64_t>> ref(channel_num, std::vector<uint64_t>(words));
+        std::vector<std::vector<uint64_t>> out(channel_num, std::vector<uint64_t>(words));
+        std::vector<uint64_t *> ref_ptr(channel_num);
+        std::vector<uint64_t *> out_ptr(channel_num);
+
+        srand(channel_num);
+        for (auto &w : src)
+            w = ((uint64_t)rand() << 32) ^ (uint64_t)rand();
+        for (unsigned int i = 0; i < channel_num; i++) {
+            ref_ptr[i] = ref[i].data();
+            out_ptr[i] = out[i].data();
+        }
+
+        const double old_mbps = run_mbps([&]{
+            split_words(ref_ptr.data(), src.data(), words, channel_num);
+        }, bytes, rounds);
+
+        const double generic_mbps = run_mbps([&]{
+            CrossSplit::split(out_ptr.data(), src.data(), words, channel_num);
+        }, bytes, rounds);
+        if (out != ref) {
+            fprintf(stderr, "%u channels: the generic kernel is wrong\n", channel_num);
+            return 1;
+        }
+
+        CrossSplit::Kernel kernel = CrossSplit::get_kernel(channel_num);
+        double kernel_mbps = 0;
+        if (kernel) {
+            for (auto &o : out)
+                memset(o.data(), 0, words * 8);
+            kernel_mbps = run_mbps([&]{
+                kernel(out_ptr.data(), src.data(), words);
+            }, bytes, rounds);
+            if (out != ref) {
+                fprintf(stderr, "%u channels: the layout kernel is wrong\n", channel_num);
+                return 1;
+            }
+        }
+
+        const double best = kernel ? kernel_mbps : generic_mbps;
+        printf("%4u %10.0f %10.0f ", channel_num, old_mbps, generic_mbps);
+        if (kernel)
+            printf("%10.0f", kernel_mbps);
+        else
+            printf("%10s", "-");
+        printf(" %7.1fx %7.1fx\n", best / old_mbps, best / generic_mbps);
+    }
+
+    return 0;
+}
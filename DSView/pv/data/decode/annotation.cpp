@@ -95,6 +95,19 @@ Annotation::Annotation(const srd_proto_data *const pdata, DecoderStatus *status)
 	}
 }
 
+Annotation::Annotation(uint64_t start_sample, uint64_t end_sample, int format,
+                       int type, int resIndex, DecoderStatus *status)
+{
+	assert(status);
+
+	_start_sample = start_sample;
+	_end_sample   = end_sample;
+	_format     = format;
+	_type       = type;
+	_resIndex   = resIndex;
+	_status     = status;
+}
+
 Annotation::Annotation()
 {
     _start_sample = 0;
@@ -42,6 +42,9 @@ class Annotation
 {
 public:
 	Annotation(const srd_proto_data *const pdata, DecoderStatus *status);
+	// restore a saved annotation, resIndex is in the status resource table
+	Annotation(uint64_t start_sample, uint64_t end_sample, int format,
+	           int type, int resIndex, DecoderStatus *status);
     Annotation();
 	~Annotation();
 
@@ -66,6 +69,10 @@ public:
 		return _type;
 	}  
 
+	inline int res_index() const{
+		return _resIndex;
+	}
+
 	bool is_numberic();
 
 	const std::vector<QString>& annotations() const;
@@ -24,6 +24,7 @@
 #include <stdlib.h> 
 #include "../../log.h"
 #include "../../dsvdef.h"
+#include "../memorybudget.h"
  
 const char g_bin_cvt_table[] = "0000000100100011010001010110011110001001101010111100110111101111";
  
@@ -98,7 +99,7 @@ long long bin2long_string(const char *bin, int len)
 //-----------------------------------
 
 AnnotationResTable::AnnotationResTable(){
-
+    m_bytes = 0;
   }
 
 AnnotationResTable::~AnnotationResTable(){
@@ -118,6 +119,11 @@ int AnnotationResTable::MakeIndex(const std::string &key, AnnotationSourceItem*
     item->cur_display_format = -1;
     item->is_numeric = false;
     newItem = item;
+
+    // the key in the map and the source lines, which hold the same text
+    uint64_t bytes = sizeof(AnnotationSourceItem) + key.size() * 3 + 64;
+    m_bytes += bytes;
+    pv::data::MemoryBudget::Instance().alloc(pv::data::MemoryBudget::PoolResource, bytes);
    
     int dex = m_indexs.size();
     m_indexs[key] = dex;
@@ -335,5 +341,7 @@ void AnnotationResTable::reset()
 	}
 	m_resourceTable.clear();
 	m_indexs.clear();
+	pv::data::MemoryBudget::Instance().release(pv::data::MemoryBudget::PoolResource, m_bytes);
+	m_bytes = 0;
 }
  
@@ -21,6 +21,7 @@
 
 #pragma once
 
+#include <stdint.h>
 #include <map>
 #include <string>
 #include <vector>
@@ -62,6 +63,7 @@ class AnnotationResTable
     private:
         std::map<std::string, int>          m_indexs;
         std::vector<AnnotationSourceItem*>  m_resourceTable;
+        uint64_t                            m_bytes;
         char g_bin_format_tmp_buffer[DECODER_MAX_DATA_BLOCK_LEN * 4 + 2];
         char g_oct_format_tmp_buffer[DECODER_MAX_DATA_BLOCK_LEN * 3 + 2];
         char g_number_tmp_64[30];
@@ -55,6 +55,10 @@ public:
 		return _row;
 	}
 
+	inline int order() const{
+		return _order;
+	}
+
     QString title() const;
 
     bool operator<(const Row &other)const;
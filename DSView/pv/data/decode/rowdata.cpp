@@ -24,6 +24,7 @@
 #include <assert.h>
 
 #include "rowdata.h"
+#include "../memorybudget.h"
 
 using std::max;
 using std::min;
@@ -33,6 +34,9 @@ namespace pv {
 namespace data {
 namespace decode {
 
+// an annotation object and its pointer in the row
+static const uint64_t AnnotationBytes = sizeof(Annotation) + sizeof(Annotation*);
+
 std::mutex RowData::_global_visitor_mutex;
 
 RowData::RowData() :
@@ -55,6 +59,8 @@ void RowData::clear()
     for (Annotation *p : _annotations){
         delete p;
     }
+    MemoryBudget::Instance().release(MemoryBudget::PoolAnnotation,
+                                     _annotations.size() * AnnotationBytes);
     _annotations.clear();
     _item_count = 0;
 }
@@ -117,6 +123,7 @@ bool RowData::push_annotation(Annotation *a)
 
     try {
       _annotations.push_back(a);
+      MemoryBudget::Instance().alloc(MemoryBudget::PoolAnnotation, AnnotationBytes);
       _item_count = _annotations.size();
       _max_annotation = max(_max_annotation, a->end_sample() - a->start_sample());
 
@@ -0,0 +1,116 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2013 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "decodecache.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+
+#include "../config/appconfig.h"
+#include "../log.h"
+
+namespace pv {
+namespace data {
+
+DecodeCache::DecodeCache()
+{
+    _dir = GetUserDataDir() + "/decode_cache";
+}
+
+DecodeCache& DecodeCache::Instance()
+{
+    static DecodeCache cache;
+    return cache;
+}
+
+QString DecodeCache::get_file_name(const QString &key)
+{
+    return _dir + "/" + key + ".ddr";
+}
+
+bool DecodeCache::load(const QString &key, QByteArray &data)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    QFile file(get_file_name(key));
+    if (!file.open(QIODevice::ReadWrite))
+        return false;
+
+    data = file.readAll();
+
+    // the modification time is the last use
+#if QT_VERSION >= 0x050A00
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+#endif
+    file.close();
+
+    return !data.isEmpty();
+}
+
+void DecodeCache::store(const QString &key, const QByteArray &data)
+{
+    if (data.isEmpty() || data.size() > MaxEntrySize)
+        return;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    QDir dir;
+    if (!dir.mkpath(_dir)) {
+        dsv_err("Failed to create the decode cache directory: %s", _dir.toUtf8().data());
+        return;
+    }
+
+    // write a temporary file first, a broken entry is never read
+    const QString name = get_file_name(key);
+    QFile file(name + ".tmp");
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    const bool bDone = (file.write(data) == data.size());
+    file.close();
+
+    QFile::remove(name);
+    if (!bDone || !QFile::rename(name + ".tmp", name)) {
+        QFile::remove(name + ".tmp");
+        return;
+    }
+
+    evict();
+}
+
+void DecodeCache::evict()
+{
+    QDir dir(_dir);
+    QFileInfoList files = dir.entryInfoList(QStringList() << "*.ddr", QDir::Files, QDir::Time);
+    qint64 total = 0;
+
+    // newest first
+    for (auto &info : files) {
+        total += info.size();
+        if (total > MaxCacheSize)
+            QFile::remove(info.absoluteFilePath());
+    }
+}
+
+} // namespace data
+} // namespace pv
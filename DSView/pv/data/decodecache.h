@@ -0,0 +1,61 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2013 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef DSVIEW_PV_DATA_DECODECACHE_H
+#define DSVIEW_PV_DATA_DECODECACHE_H
+
+#include <stdint.h>
+#include <mutex>
+#include <QString>
+#include <QByteArray>
+
+namespace pv {
+namespace data {
+
+//Decode results stored in the user data directory, one file per key.
+//The least recently used files are removed when the cache is too big.
+class DecodeCache
+{
+private:
+    static const qint64 MaxCacheSize = 512LL * 1024 * 1024;
+    static const qint64 MaxEntrySize = MaxCacheSize / 4;
+
+    DecodeCache();
+
+public:
+    static DecodeCache& Instance();
+
+    bool load(const QString &key, QByteArray &data);
+    void store(const QString &key, const QByteArray &data);
+
+private:
+    QString get_file_name(const QString &key);
+    void evict();
+
+private:
+    QString     _dir;
+    std::mutex  _mutex;
+};
+
+} // namespace data
+} // namespace pv
+
+#endif // DSVIEW_PV_DATA_DECODECACHE_H
@@ -24,6 +24,10 @@
 #include <stdexcept>
 #include <algorithm>
 #include <assert.h>
+#include <chrono>
+#include <string.h>
+#include <QDataStream>
+#include <QCryptographicHash>
 
 #include "decoderstack.h"
 #include "logic.h"
@@ -31,6 +35,8 @@
 #include "decode/decoder.h"
 #include "decode/annotation.h"
 #include "decode/rowdata.h"
+#include "decodecache.h"
+#include "memorybudget.h"
 #include "../sigsession.h"
 #include "../view/logicsignal.h"
 #include "../dsvdef.h"
@@ -49,6 +55,7 @@ const double DecoderStack::DecodeMargin = 1.0;
 const double DecoderStack::DecodeThreshold = 0.2;
 const int64_t DecoderStack::DecodeChunkLength = 4 * 1024; 
 const unsigned int DecoderStack::DecodeNotifyPeriod = 1024;
+const int64_t DecoderStack::DecodeNotifyInterval = 16;
  
 DecoderStack::DecoderStack(pv::SigSession *session,
 	const srd_decoder *const dec, DecoderStatus *decoder_status) :
@@ -66,6 +73,8 @@ DecoderStack::DecoderStack(pv::SigSession *session,
     _mark_index = -1;
     _decoder_status = decoder_status;
     _stask_stauts = NULL;  
+    _put_record = NULL;
+    _decode_complete = false;
     
     _stack.push_back(new decode::Decoder(dec));
  
@@ -94,6 +103,8 @@ DecoderStack::~DecoderStack()
     _rows_gshow.clear();
     _rows_lshow.clear();
     _class_rows.clear();
+
+    free_put_record();
 }
  
 void DecoderStack::add_sub_decoder(decode::Decoder *decoder)
@@ -375,6 +386,7 @@ void DecoderStack::init()
     _samples_decoded = 0;
     _error_message = QString();
     _no_memory = false;
+    _decode_complete = false;
 
     for (auto i = _rows.begin();
         i != _rows.end(); i++) { 
@@ -465,8 +477,28 @@ void DecoderStack::do_decode_work()
 	_samplerate = data->samplerate();
     if (_samplerate == 0.0)
         return;
+
+    // results saved with the session file, or cached by an earlier
+    // decoding of the same data with the same decoders
+    const QString key = get_result_key();
+    QByteArray results;
+    results.swap(_saved_results); // used once
+
+    if ((!results.isEmpty() && load_results(results, key))
+        || (DecodeCache::Instance().load(key, results) && load_results(results, key))) {
+        if (!_session->is_closed())
+            decode_done();
+        return;
+    }
      
     execute_decode_stack();   
+
+    // the samples of an unfinished capture can still change
+    if (_decode_complete && _snapshot->last_ended()) {
+        results.clear();
+        if (write_results(results, key))
+            DecodeCache::Instance().store(key, results);
+    }
 }
 
 uint64_t DecoderStack::get_max_sample_count()
@@ -480,13 +512,14 @@ uint64_t DecoderStack::get_max_sample_count()
 	return max_sample_count;
 }
 
-void DecoderStack::decode_data(const uint64_t decode_start, const uint64_t decode_end, srd_session *const session)
+bool DecoderStack::decode_data(const uint64_t decode_start, const uint64_t decode_end, srd_session *const session)
 {
     decode_task_status *status = _stask_stauts;
 
     //uint8_t *chunk = NULL;
     uint64_t last_cnt = 0;
     uint64_t notify_cnt = (decode_end - decode_start + 1)/100;
+    auto last_notify = std::chrono::steady_clock::now();
     srd_decoder_inst *logic_di = NULL;
 
     // find the first level decoder instant
@@ -512,6 +545,24 @@ void DecoderStack::decode_data(const uint64_t decode_start, const uint64_t decod
     if( i >= decode_end){
         dsv_info("%s", "decode data index have been end");
     }
+
+    // resolve the decoder channels once, not for every chunk
+    std::vector<LogicSnapshot::ChannelHandle> chans;
+    for (int j =0 ; j < logic_di->dec_num_channels; j++) {
+        int sig_index = logic_di->dec_channelmap[j];
+        LogicSnapshot::ChannelHandle ch;
+        ch.order = -1;
+
+        if (sig_index != -1) {
+            ch = _snapshot->get_channel(sig_index);
+            if (!ch.valid()) {
+                _error_message = L_S(STR_PAGE_MSG, S_ID(IDS_MSG_DECODERSTACK_DECODE_DATA_ERROR),
+                                 "At least one of selected channels are not enabled.");
+                return false;
+            }
+        }
+        chans.push_back(ch);
+    }
   
     while(i < decode_end && !_no_memory && !status->_bStop)
     {
@@ -519,21 +570,13 @@ void DecoderStack::decode_data(const uint64_t decode_start, const uint64_t decod
         std::vector<uint8_t> chunk_const;
         uint64_t chunk_end = decode_end;
 
-        for (int j =0 ; j < logic_di->dec_num_channels; j++) {
-            int sig_index = logic_di->dec_channelmap[j];
-
-            if (sig_index == -1) {
+        for (auto &ch : chans) {
+            if (!ch.valid()) {
                 chunk.push_back(NULL);
                 chunk_const.push_back(0);
             } else {
-                if (_snapshot->has_data(sig_index)) {
-                    chunk.push_back(_snapshot->get_samples(i, chunk_end, sig_index));
-                    chunk_const.push_back(_snapshot->get_sample(i, sig_index));
-                } else {
-                    _error_message = L_S(STR_PAGE_MSG, S_ID(IDS_MSG_DECODERSTACK_DECODE_DATA_ERROR),
-                                     "At least one of selected channels are not enabled.");
-                    return;
-                }
+                chunk.push_back(_snapshot->get_samples(i, chunk_end, ch));
+                chunk_const.push_back(_snapshot->get_sample(i, ch));
             }
         }
 
@@ -568,16 +611,24 @@ void DecoderStack::decode_data(const uint64_t decode_start, const uint64_t decod
             _samples_decoded = i - decode_start + 1;
         }
 
+        // progress is refreshed at most once per display frame,
+        // decode_done() delivers the final state
         if ((i - last_cnt) > notify_cnt) {
-            last_cnt = i;
-            new_decode_data();
+            auto now = std::chrono::steady_clock::now();
+            if (std::chrono::duration_cast<std::chrono::milliseconds>(now - last_notify).count()
+                    >= DecodeNotifyInterval) {
+                last_cnt = i;
+                last_notify = now;
+                new_decode_data();
+            }
         }
         entry_cnt++;
     } 
 
     // the task is normal ends,so all samples was processed;
     if (!bError && bEndTime){
-       srd_session_end(session, &error);
+        if (srd_session_end(session, &error) != SRD_OK)
+            bError = true;
 
         if (error)
             _error_message = QString::fromLocal8Bit(error);
@@ -590,14 +641,18 @@ void DecoderStack::decode_data(const uint64_t decode_start, const uint64_t decod
   
     if (!_session->is_closed())
         decode_done();
+
+    return !bError;
 }
 
 void DecoderStack::execute_decode_stack()
 {  
 	srd_session *session = NULL;
 	srd_decoder_inst *prev_di = NULL;
+	srd_decoder_inst *bottom_di = NULL;
     uint64_t decode_start = 0;
     uint64_t decode_end = 0;
+    decode_task_status *status = _stask_stauts;
 
 	assert(_snapshot);
 
@@ -628,6 +683,8 @@ void DecoderStack::execute_decode_stack()
 
 		if (prev_di)
 			srd_inst_stack (session, prev_di, di);
+		else
+			bottom_di = di;
 
 		prev_di = di;
         decode_start = dec->decode_start();
@@ -644,13 +701,55 @@ void DecoderStack::execute_decode_stack()
 		            DecoderStack::annotation_callback,
                     _stask_stauts);
 
+    // When only the upper decoders changed, the output of the bottom
+    // decoder is replayed to them instead of decoding the samples again.
+    const std::string key = get_record_key(decode_start, decode_end);
+    const bool replay = _stack.size() > 1 && _put_record && key == _put_record_key;
+    bool record = false;
+
+    if (!replay) {
+        free_put_record();
+        // the samples of an unfinished capture can still change,
+        // and the record is not kept when the memory is short
+        if (_stack.size() > 1 && _snapshot->last_ended()
+            && MemoryBudget::Instance().admit(PutRecordLimit, 0))
+            record = (srd_inst_record_start(bottom_di, PutRecordLimit) == SRD_OK);
+    }
+
     char *error = NULL;
-    if (srd_session_start(session, &error) == SRD_OK)
-       //need a lot time
-        decode_data(decode_start, decode_end, session);
-    else
+    bool bDone = false;
+    if (srd_session_start(session, &error) == SRD_OK) {
+        if (replay) {
+            dsv_info("%s", "replay the output of the bottom decoder");
+            bDone = replay_data(decode_start, decode_end, session, bottom_di);
+        }
+        else {
+            //need a lot time
+            bDone = decode_data(decode_start, decode_end, session);
+        }
+    }
+    else if (error)
         _error_message = QString::fromLocal8Bit(error);
 
+    // a failed decoder does not always leave an error message
+    _decode_complete = bDone && !status->_bStop && !_no_memory;
+    if (_no_memory)
+        MemoryBudget::Instance().log_usage("Decoding stopped, out of memory");
+
+    if (record) {
+        GByteArray *put_record = srd_inst_record_take(bottom_di);
+
+        // keep only the output of a complete decoding
+        if (put_record && _decode_complete) {
+            _put_record = put_record;
+            _put_record_key = key;
+            MemoryBudget::Instance().alloc(MemoryBudget::PoolReplay, _put_record->len);
+        }
+        else if (put_record) {
+            g_byte_array_free(put_record, TRUE);
+        }
+    }
+
 	// Destroy the session
     if (error) {
         g_free(error);
@@ -659,6 +758,318 @@ void DecoderStack::execute_decode_stack()
 	srd_session_destroy(session); 
 }
 
+bool DecoderStack::replay_data(const uint64_t decode_start, const uint64_t decode_end,
+                               srd_session *const session, srd_decoder_inst *const di)
+{
+    decode_task_status *status = _stask_stauts;
+    uint64_t offset = 0;
+    char *error = NULL;
+    bool bError = false;
+    auto last_notify = std::chrono::steady_clock::now();
+
+    while (offset < _put_record->len && !_no_memory && !status->_bStop)
+    {
+        if (srd_inst_replay(di, _put_record, &offset, ReplayChunkCount, &error) != SRD_OK) {
+            if (error)
+                _error_message = QString::fromLocal8Bit(error);
+            bError = true;
+            break;
+        }
+
+        //use mutex
+        {
+            std::lock_guard<std::mutex> lock(_output_mutex);
+            _samples_decoded = (decode_end - decode_start + 1) * offset / _put_record->len;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration_cast<std::chrono::milliseconds>(now - last_notify).count()
+                >= DecodeNotifyInterval) {
+            last_notify = now;
+            new_decode_data();
+        }
+    }
+
+    if (offset == _put_record->len && !status->_bStop) {
+        if (srd_session_end(session, &error) != SRD_OK)
+            bError = true;
+
+        if (error)
+            _error_message = QString::fromLocal8Bit(error);
+    }
+
+    if (error)
+        g_free(error);
+
+    if (!_session->is_closed())
+        decode_done();
+
+    return !bError;
+}
+
+// the channels of a decoder in the order of its definition, the map
+// is ordered by the channel addresses which change between runs
+static std::vector<std::pair<const srd_channel*, int> > key_channels(Decoder *dec)
+{
+    std::vector<std::pair<const srd_channel*, int> > channels(dec->channels().begin(),
+                                                              dec->channels().end());
+    std::sort(channels.begin(), channels.end(),
+        [](const std::pair<const srd_channel*, int> &a, const std::pair<const srd_channel*, int> &b) {
+            return a.first->order < b.first->order;
+        });
+    return channels;
+}
+
+std::string DecoderStack::get_record_key(const uint64_t decode_start, const uint64_t decode_end)
+{
+    Decoder *const dec = _stack.front();
+    std::string key = dec->decoder()->id;
+
+    for (auto &kv : dec->options()) {
+        gchar *value = g_variant_print(kv.second, TRUE);
+        key += ";" + kv.first + "=" + value;
+        g_free(value);
+    }
+    // the content of the channels, a new capture or a virtual channel
+    // with a new expression on the same index gives another key
+    for (auto &kv : key_channels(dec)) {
+        LogicSnapshot::ChannelHandle ch = _snapshot->get_channel(kv.second);
+        key += ";" + std::string(kv.first->id) + ":" + std::to_string(kv.second);
+        key += "#" + std::to_string(_snapshot->get_data_digest(ch));
+    }
+
+    key += ";" + std::to_string(decode_start) + "-" + std::to_string(decode_end);
+    key += ";" + std::to_string((uint64_t)_samplerate);
+    key += ";" + std::to_string(_sample_count);
+
+    return key;
+}
+
+void DecoderStack::free_put_record()
+{
+    if (_put_record) {
+        MemoryBudget::Instance().release(MemoryBudget::PoolReplay, _put_record->len);
+        g_byte_array_free(_put_record, TRUE);
+        _put_record = NULL;
+    }
+    _put_record_key.clear();
+}
+
+void DecoderStack::get_decode_region(uint64_t &decode_start, uint64_t &decode_end)
+{
+    const uint64_t sample_count = _snapshot->get_sample_count();
+
+    // as execute_decode_stack(), the last decoder sets the region
+    decode_start = 0;
+    decode_end = 0;
+    for (auto dec : _stack) {
+        decode_start = dec->decode_start();
+        decode_end = min(dec->decode_end(), sample_count - 1);
+    }
+}
+
+QString DecoderStack::get_result_key()
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    uint64_t decode_start;
+    uint64_t decode_end;
+
+    // the decoders are installed with the application
+    hash.addData(QByteArray(DS_VERSION_STRING));
+
+    for (auto dec : _stack) {
+        const srd_decoder *const d = dec->decoder();
+        hash.addData(QByteArray(d->id));
+
+        // options which are not set have the default value
+        for (GSList *l = d->options; l; l = l->next) {
+            const srd_decoder_option *const opt = (srd_decoder_option*)l->data;
+            auto iter = dec->options().find(opt->id);
+            GVariant *const value = (iter != dec->options().end()) ? (*iter).second : opt->def;
+            gchar *str = g_variant_print(value, FALSE);
+            hash.addData(QByteArray(opt->id));
+            hash.addData(QByteArray(str));
+            g_free(str);
+        }
+
+        for (auto &kv : key_channels(dec)) {
+            LogicSnapshot::ChannelHandle ch = _snapshot->get_channel(kv.second);
+            hash.addData(QByteArray(kv.first->id));
+            hash.addData(QByteArray::number(kv.second));
+            hash.addData(QByteArray::number((qulonglong)_snapshot->get_data_digest(ch)));
+        }
+    }
+
+    get_decode_region(decode_start, decode_end);
+    hash.addData(QByteArray::number((qulonglong)decode_start));
+    hash.addData(QByteArray::number((qulonglong)decode_end));
+    hash.addData(QByteArray::number((qulonglong)_samplerate));
+    hash.addData(QByteArray::number((qulonglong)_snapshot->get_sample_count()));
+
+    return QString(hash.result().toHex());
+}
+
+bool DecoderStack::save_results(QByteArray &data)
+{
+    if (!_decode_complete || _decode_state == Running || !_snapshot)
+        return false;
+
+    return write_results(data, get_result_key());
+}
+
+bool DecoderStack::write_results(QByteArray &data, const QString &key)
+{
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << ResultsMagic << ResultsVersion << key;
+
+    // the strings are stored once, annotations refer to them by index
+    AnnotationResTable &table = _decoder_status->m_resTable;
+    const qint32 item_count = table.GetCount();
+    out << item_count;
+    for (qint32 i = 0; i < item_count; i++) {
+        AnnotationSourceItem *item = table.GetItem(i);
+        out << item->is_numeric << QByteArray(item->str_number_hex);
+        out << (quint32)item->src_lines.size();
+        for (auto &line : item->src_lines)
+            out << line;
+    }
+
+    out << (quint32)_rows.size();
+    for (auto &kv : _rows) {
+        RowData *const row_data = kv.second;
+        const quint64 count = row_data->get_annotation_size();
+        Annotation ann;
+
+        out << QByteArray(kv.first.decoder()->id) << (qint32)kv.first.order() << count;
+        for (quint64 i = 0; i < count; i++) {
+            row_data->get_annotation(ann, i);
+            out << (quint64)ann.start_sample() << (quint64)ann.end_sample()
+                << (qint16)ann.format() << (qint16)ann.type() << (qint32)ann.res_index();
+        }
+    }
+
+    return out.status() == QDataStream::Ok;
+}
+
+void DecoderStack::set_saved_results(const QByteArray &data)
+{
+    _saved_results = data;
+}
+
+bool DecoderStack::load_results(const QByteArray &data, const QString &key)
+{
+    QDataStream in(data);
+    in.setVersion(QDataStream::Qt_5_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    QString data_key;
+
+    in >> magic >> version >> data_key;
+    if (magic != ResultsMagic || version != ResultsVersion || data_key != key) {
+        dsv_info("%s", "The decode results do not match, decode again.");
+        return false;
+    }
+
+    AnnotationResTable &table = _decoder_status->m_resTable;
+    bool bError = false;
+    qint32 item_count = 0;
+
+    in >> item_count;
+    for (qint32 i = 0; i < item_count && in.status() == QDataStream::Ok; i++) {
+        bool numeric = false;
+        QByteArray hex;
+        quint32 line_count = 0;
+        std::vector<QString> lines;
+        std::string res_key;
+
+        in >> numeric >> hex >> line_count;
+        for (quint32 j = 0; j < line_count && in.status() == QDataStream::Ok; j++) {
+            QString line;
+            in >> line;
+            res_key.append(line.toUtf8().data());
+            lines.push_back(line);
+        }
+        res_key.append(hex.data());
+
+        // same key as Annotation uses, so the indexes are the same
+        AnnotationSourceItem *item = NULL;
+        if (table.MakeIndex(res_key, item) != i || item == NULL
+            || hex.size() >= DECODER_MAX_DATA_BLOCK_LEN) {
+            bError = true;
+            break;
+        }
+
+        item->src_lines = lines;
+        if (numeric) {
+            strcpy(item->str_number_hex, hex.data());
+            item->is_numeric = true;
+            _decoder_status->m_bNumeric = true;
+        }
+    }
+
+    quint32 row_count = 0;
+    in >> row_count;
+    for (quint32 r = 0; r < row_count && !bError && in.status() == QDataStream::Ok; r++) {
+        QByteArray id;
+        qint32 order = 0;
+        quint64 count = 0;
+
+        in >> id >> order >> count;
+
+        RowData *row_data = NULL;
+        for (auto &kv : _rows) {
+            if (id == kv.first.decoder()->id && order == kv.first.order()) {
+                row_data = kv.second;
+                break;
+            }
+        }
+        if (row_data == NULL) {
+            bError = true;
+            break;
+        }
+
+        for (quint64 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+            quint64 start, end;
+            qint16 format, type;
+            qint32 res_index;
+
+            in >> start >> end >> format >> type >> res_index;
+            if (res_index < 0 || res_index >= item_count) {
+                bError = true;
+                break;
+            }
+
+            Annotation *a = new Annotation(start, end, format, type, res_index, _decoder_status);
+            if (!row_data->push_annotation(a)) {
+                _no_memory = true;
+                bError = true;
+                break;
+            }
+        }
+    }
+
+    if (bError || in.status() != QDataStream::Ok) {
+        dsv_err("%s", "Failed to load the decode results.");
+        init();
+        _decoder_status->clear();
+        return false;
+    }
+
+    uint64_t decode_start;
+    uint64_t decode_end;
+    get_decode_region(decode_start, decode_end);
+
+    _sample_count = _snapshot->get_sample_count();
+    {
+        std::lock_guard<std::mutex> lock(_output_mutex);
+        _samples_decoded = decode_end - decode_start + 1;
+    }
+    _decode_complete = true;
+
+    return true;
+}
+
 uint64_t DecoderStack::sample_count()
 {
     if (_snapshot)
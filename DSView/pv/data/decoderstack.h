@@ -28,7 +28,10 @@
 #include <boost/optional.hpp>
 #include <QObject>
 #include <QString>
+#include <QByteArray>
 #include <mutex> 
+#include <atomic>
+#include <string>
 
 #include "decode/row.h" 
 #include "../data/signaldata.h"
@@ -76,7 +79,12 @@ private:
 	static const double DecodeThreshold;
 	static const int64_t DecodeChunkLength;
 	static const unsigned int DecodeNotifyPeriod;
+	static const int64_t DecodeNotifyInterval;
     static const uint64_t MaxChunkSize = 1024 * 16;
+    static const uint64_t PutRecordLimit = 64 * 1024 * 1024;
+    static const uint64_t ReplayChunkCount = 1024;
+    static const quint32 ResultsMagic = 0x44534452; // "DSDR"
+    static const quint32 ResultsVersion = 1;
 
 public:
     enum decode_state {
@@ -162,8 +170,25 @@ public:
         return _decoder_status;
     }
 
+    // Decode results to be stored in a session file, only complete
+    // results can be saved.
+    bool save_results(QByteArray &data);
+
+    // Results loaded from a session file, they are used instead of
+    // decoding when the decoders and the data still match.
+    void set_saved_results(const QByteArray &data);
+
 private:
-    void decode_data(const uint64_t decode_start, const uint64_t decode_end, srd_session *const session);
+    // return false when the decoders failed
+    bool decode_data(const uint64_t decode_start, const uint64_t decode_end, srd_session *const session);
+    bool replay_data(const uint64_t decode_start, const uint64_t decode_end,
+                     srd_session *const session, srd_decoder_inst *const di);
+    std::string get_record_key(const uint64_t decode_start, const uint64_t decode_end);
+    void free_put_record();
+    void get_decode_region(uint64_t &decode_start, uint64_t &decode_end);
+    QString get_result_key();
+    bool write_results(QByteArray &data, const QString &key);
+    bool load_results(const QByteArray &data, const QString &key);
 	void execute_decode_stack();
 	static void annotation_callback(srd_proto_data *pdata, void *self);
     void do_decode_work();
@@ -195,6 +220,14 @@ private:
     decode_task_status  *_stask_stauts;    
     mutable std::mutex _output_mutex; 
 
+    // output of the bottom decoder, to re-run the upper decoders
+    GByteArray      *_put_record;
+    std::string     _put_record_key;
+
+    // written by the decode task, read by save_results()
+    std::atomic<bool> _decode_complete;
+    QByteArray      _saved_results;
+
 	friend class DecoderStackTest::TwoDecoderStack;
 };
 
@@ -0,0 +1,104 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "dsoframestats.h"
+
+#include <string.h>
+
+namespace pv {
+namespace data {
+
+bool DsoFrameStats::calc(const uint8_t *data, uint64_t count, int stride, Result &result)
+{
+    uint64_t histogram[MaxCode + 1];
+
+    memset(&result, 0, sizeof(result));
+    if (data == NULL || count < 2)
+        return false;
+
+    memset(histogram, 0, sizeof(histogram));
+    const uint8_t *p = data;
+    for (uint64_t i = 0; i < count; i++) {
+        histogram[*p]++;
+        p += stride;
+    }
+
+    result.min = 0;
+    while (histogram[result.min] == 0)
+        result.min++;
+    result.max = MaxCode;
+    while (histogram[result.max] == 0)
+        result.max--;
+
+    // a square wave has two peaks, a sine has none worth the name and
+    // falls back to the extremes
+    const int mid = (result.min + result.max) / 2;
+    result.lower = peak(histogram, result.min, mid);
+    result.upper = peak(histogram, mid + 1, result.max);
+    if (result.upper - result.lower < (result.max - result.min) / 2) {
+        result.lower = result.min;
+        result.upper = result.max;
+    }
+
+    // rising crossings of the middle level with a hysteresis of 1/8 of
+    // the swing, noise on a slow edge is not counted
+    const int level = (result.upper + result.lower + 1) / 2;
+    const int hyst = (result.upper - result.lower) / 8 + 1;
+    if (result.upper - result.lower < 4)
+        return true;
+
+    // codes grow when the voltage falls, a rising edge goes high to low
+    bool high = data[0] < level;
+    uint64_t first = 0;
+    uint64_t last = 0;
+    p = data;
+    for (uint64_t i = 0; i < count; i++) {
+        const int v = *p;
+        p += stride;
+        if (!high && v <= level - hyst) {
+            high = true;
+            if (result.rising == 0)
+                first = i;
+            last = i;
+            result.rising++;
+        } else if (high && v >= level + hyst) {
+            high = false;
+        }
+    }
+
+    if (result.rising >= 2)
+        result.period = (double)(last - first) / (result.rising - 1);
+
+    return true;
+}
+
+int DsoFrameStats::peak(const uint64_t *histogram, int from, int to)
+{
+    int index = from;
+    for (int i = from + 1; i <= to; i++) {
+        if (histogram[i] > histogram[index])
+            index = i;
+    }
+    return index;
+}
+
+} // namespace data
+} // namespace pv
@@ -0,0 +1,58 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef DSVIEW_PV_DATA_DSOFRAMESTATS_H
+#define DSVIEW_PV_DATA_DSOFRAMESTATS_H
+
+#include <stdint.h>
+
+namespace pv {
+namespace data {
+
+//Levels and period of one oscilloscope frame, the input of the one-shot
+//autoset. Values are raw ADC codes.
+class DsoFrameStats
+{
+public:
+    struct Result
+    {
+        int min;
+        int max;
+        int lower;          // most common code of the lower half
+        int upper;          // most common code of the upper half
+        uint64_t rising;    // crossings of the middle level
+        double period;      // samples, 0 if less than two rising crossings
+    };
+
+    static const int MaxCode = 255;
+
+public:
+    // samples of one channel, interleaved with stride bytes
+    static bool calc(const uint8_t *data, uint64_t count, int stride, Result &result);
+
+private:
+    static int peak(const uint64_t *histogram, int from, int to);
+};
+
+} // namespace data
+} // namespace pv
+
+#endif // DSVIEW_PV_DATA_DSOFRAMESTATS_H
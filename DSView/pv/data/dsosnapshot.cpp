@@ -26,6 +26,7 @@
 #include <algorithm>
  
 #include "dsosnapshot.h"
+#include "memorybudget.h"
 #include "../dsvdef.h"
 
 using namespace std;
@@ -48,6 +49,8 @@ DsoSnapshot::DsoSnapshot() :
     _instant(false)
 {
 	memset(_envelope_levels, 0, sizeof(_envelope_levels));
+    _envelope_bytes = 0;
+    _mem_pool = MemoryBudget::PoolDso;
 }
 
 DsoSnapshot::~DsoSnapshot()
@@ -57,13 +60,16 @@ DsoSnapshot::~DsoSnapshot()
 
 void DsoSnapshot::free_envelop()
 {
-    for (unsigned int i = 0; i < _channel_num; i++) {
-        for(auto &e : _envelope_levels[i]) {
+    // the channel number may have been changed, release all levels
+    for (auto &levels : _envelope_levels) {
+        for(auto &e : levels) {
             if (e.samples)
                 free(e.samples);
         }
     }
     memset(_envelope_levels, 0, sizeof(_envelope_levels));
+    mem_free(_envelope_bytes);
+    _envelope_bytes = 0;
 }
 
 void DsoSnapshot::init()
@@ -87,6 +93,7 @@ void DsoSnapshot::init_all()
             _envelope_levels[i][level].data_length = 0;
         }
     }
+    _generation++;
 }
 
 void DsoSnapshot::clear()
@@ -98,6 +105,20 @@ void DsoSnapshot::clear()
     _have_data  = false;
 }
 
+uint64_t DsoSnapshot::get_memory_size(uint64_t total_sample_count, unsigned int channel_num)
+{
+    uint64_t size = total_sample_count * channel_num + sizeof(uint64_t);
+    uint64_t envelop_count = total_sample_count / EnvelopeScaleFactor;
+
+    for (unsigned int level = 0; level < ScaleStepCount; level++) {
+        envelop_count = ((envelop_count + EnvelopeDataUnit - 1) /
+                EnvelopeDataUnit) * EnvelopeDataUnit;
+        size += envelop_count * sizeof(EnvelopeSample) * channel_num;
+        envelop_count = envelop_count / EnvelopeScaleFactor;
+    }
+    return size;
+}
+
 void DsoSnapshot::first_payload(const sr_datafeed_dso &dso, uint64_t total_sample_count,
                                 std::map<int, bool> ch_enable, bool instant)
 {
@@ -124,6 +145,8 @@ void DsoSnapshot::first_payload(const sr_datafeed_dso &dso, uint64_t total_sampl
         free_data();
         _data = malloc(size);
         if (_data) {
+            _capacity = size;
+            mem_alloc(size);
             free_envelop();
             for (unsigned int i = 0; i < _channel_num; i++) {
                 uint64_t envelop_count = _total_sample_count / EnvelopeScaleFactor;
@@ -135,13 +158,15 @@ void DsoSnapshot::first_payload(const sr_datafeed_dso &dso, uint64_t total_sampl
                         isOk = false;
                         break;
                     }
+                    _envelope_bytes += envelop_count * sizeof(EnvelopeSample);
+                    mem_alloc(envelop_count * sizeof(EnvelopeSample));
                     envelop_count = envelop_count / EnvelopeScaleFactor;
                 }
                 if (!isOk)
                     break;
             }
         } else {
-            isOk = true;
+            isOk = false;
         }
     }
 
@@ -169,6 +194,7 @@ void DsoSnapshot::append_payload(const sr_datafeed_dso &dso)
             append_payload_to_envelope_levels(dso.samplerate_tog);
 
         _have_data = true;
+        _generation++;
     }
 }
 
@@ -192,6 +218,7 @@ void DsoSnapshot::enable_envelope(bool enable)
     if (!_envelope_done && enable)
         append_payload_to_envelope_levels(true);
     _envelope_en = enable;
+    _generation++;
 }
 
 const uint8_t *DsoSnapshot::get_samples(
@@ -89,6 +89,9 @@ public:
     void first_payload(const sr_datafeed_dso &dso, uint64_t total_sample_count,
                        std::map<int, bool> ch_enable, bool instant);
 
+    // bytes of the samples and the envelopes of a capture
+    static uint64_t get_memory_size(uint64_t total_sample_count, unsigned int channel_num);
+
     void append_payload(const sr_datafeed_dso &dso);
 
     const uint8_t* get_samples(int64_t start_sample,
@@ -104,6 +107,10 @@ public:
 
     bool has_data(int index);
     int get_block_num();
+
+    inline bool is_instant(){
+        return _instant;
+    }
     uint64_t get_block_size(int block_index);
 
 private:
@@ -114,6 +121,7 @@ private:
 
 private:
     struct Envelope _envelope_levels[2*DS_MAX_DSO_PROBES_NUM][ScaleStepCount];
+    uint64_t _envelope_bytes;
     bool _envelope_en;
     bool _envelope_done;
     bool _instant;
@@ -0,0 +1,307 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "edgetrend.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../taskscheduler.h"
+
+namespace pv {
+namespace data {
+
+EdgeTrend::EdgeTrend()
+{
+    clear();
+}
+
+void EdgeTrend::clear()
+{
+    std::vector<uint64_t>().swap(_rising);
+    std::vector<uint32_t>().swap(_high);
+    for (int m = 0; m < MetricCount; m++) {
+        std::vector<std::vector<MinMax> >().swap(_mipmap[m]);
+        _summary[m].min = 0;
+        _summary[m].max = 0;
+        _summary[m].mean = 0;
+        _summary[m].stddev = 0;
+    }
+    _samplerate = 0;
+    _tie_offset = 0;
+    _tie_period = 0;
+    _truncated = false;
+}
+
+bool EdgeTrend::extract(LogicSnapshot *snapshot, int channel, double samplerate,
+                        std::atomic<bool> *canceled)
+{
+    clear();
+
+    if (snapshot == NULL || samplerate <= 0)
+        return false;
+
+    LogicSnapshot::ChannelHandle ch = snapshot->get_channel(channel);
+    if (!ch.valid())
+        return false;
+
+    _samplerate = samplerate;
+
+    // one task per leaf block, the edges are joined in order afterwards
+    const uint64_t samples = snapshot->get_sample_count();
+    const uint64_t leaf = LogicSnapshot::get_block_samples();
+    const uint64_t leaves = (samples + leaf - 1) / leaf;
+
+    std::vector<std::vector<uint64_t> > rising(leaves);
+    std::vector<std::vector<uint64_t> > falling(leaves);
+    std::vector<TaskPtr> tasks;
+
+    for (uint64_t i = 0; i < leaves; i++) {
+        const uint64_t start = i * leaf;
+        const uint64_t end = std::min(samples, start + leaf);
+        tasks.push_back(TaskScheduler::Instance().submit(TaskScheduler::TaskQuery,
+            [this, snapshot, ch, start, end, &rising, &falling, i, canceled](Task &){
+                leaf_edges(snapshot, ch, start, end, rising[i], falling[i], canceled);
+            }));
+    }
+    for (auto &task : tasks)
+        task->wait();
+
+    if (canceled != NULL && *canceled)
+        return true;
+
+    uint64_t total = 0;
+    for (auto &r : rising)
+        total += r.size();
+    _rising.reserve(std::min(total, MaxCycles + 1));
+
+    // the levels alternate, a falling edge before the first rising one
+    // belongs to no cycle
+    uint64_t fall_index = 0;
+    uint64_t fall_leaf = 0;
+    uint64_t last_fall = 0;
+    bool have_fall = false;
+
+    for (uint64_t i = 0; i < leaves && !_truncated; i++) {
+        for (uint64_t pos : rising[i]) {
+            if (_rising.size() == MaxCycles + 1) {
+                _truncated = true;
+                break;
+            }
+            if (!_rising.empty())
+                _high.push_back(have_fall && last_fall > _rising.back() ?
+                    (uint32_t)std::min(last_fall - _rising.back(), (uint64_t)UINT32_MAX) : 0);
+            _rising.push_back(pos);
+
+            // the falling edge of the new cycle, if it is captured
+            have_fall = false;
+            while (fall_leaf < leaves) {
+                if (fall_index >= falling[fall_leaf].size()) {
+                    std::vector<uint64_t>().swap(falling[fall_leaf]);
+                    fall_leaf++;
+                    fall_index = 0;
+                    continue;
+                }
+                last_fall = falling[fall_leaf][fall_index];
+                if (last_fall > pos) {
+                    have_fall = true;
+                    break;
+                }
+                fall_index++;
+            }
+        }
+        std::vector<uint64_t>().swap(rising[i]);
+    }
+
+    if (get_cycle_count() == 0)
+        return true;
+
+    fit_clock();
+    build_mipmap();
+    return true;
+}
+
+void EdgeTrend::leaf_edges(LogicSnapshot *snapshot, LogicSnapshot::ChannelHandle ch,
+                           uint64_t start, uint64_t end, std::vector<uint64_t> &rising,
+                           std::vector<uint64_t> &falling, std::atomic<bool> *canceled)
+{
+    static const uint64_t EdgeBatch = 4096;
+
+    std::vector<LogicSnapshot::EdgePair> edges(EdgeBatch);
+    uint64_t index = start;
+
+    while (index < end) {
+        if (canceled != NULL && *canceled)
+            break;
+
+        const uint64_t num = snapshot->get_edges(index, end, ch, edges.data(), EdgeBatch);
+        if (num == 0)
+            break;
+
+        for (uint64_t i = 0; i < num; i++) {
+            if (edges[i].second)
+                rising.push_back(edges[i].first);
+            else
+                falling.push_back(edges[i].first);
+        }
+    }
+}
+
+void EdgeTrend::fit_clock()
+{
+    // least squares line through (k, rising[k] - rising[0])
+    const uint64_t n = _rising.size();
+    const double mean_k = (n - 1) / 2.0;
+
+    double mean_pos = 0;
+    for (uint64_t k = 0; k < n; k++)
+        mean_pos += (double)(_rising[k] - _rising[0]);
+    mean_pos /= n;
+
+    double sum = 0;
+    for (uint64_t k = 0; k < n; k++)
+        sum += (k - mean_k) * ((double)(_rising[k] - _rising[0]) - mean_pos);
+
+    const double sum_kk = (double)n * ((double)n * n - 1) / 12.0;
+    _tie_period = sum / sum_kk;
+    _tie_offset = mean_pos - _tie_period * mean_k;
+}
+
+double EdgeTrend::get_value(Metric metric, uint64_t cycle)
+{
+    const double period = (double)(_rising[cycle + 1] - _rising[cycle]);
+
+    switch (metric)
+    {
+    case TREND_PERIOD:
+        return period / _samplerate;
+    case TREND_FREQUENCY:
+        return _samplerate / period;
+    case TREND_DUTY:
+        return _high[cycle] * 100.0 / period;
+    case TREND_TIE:
+        return ((double)(_rising[cycle] - _rising[0]) -
+                (_tie_offset + _tie_period * cycle)) / _samplerate;
+    default:
+        break;
+    }
+
+    return 0;
+}
+
+void EdgeTrend::build_mipmap()
+{
+    const uint64_t count = get_cycle_count();
+
+    for (int m = 0; m < MetricCount; m++) {
+        const Metric metric = (Metric)m;
+        std::vector<std::vector<MinMax> > &mipmap = _mipmap[m];
+
+        // level 0 and the summary from the cycles
+        mipmap.push_back(std::vector<MinMax>((count + Scale - 1) / Scale));
+        double sum = 0;
+        double sum_sq = 0;
+        double min = get_value(metric, 0);
+        double max = min;
+
+        for (uint64_t i = 0; i < count; i += Scale) {
+            const uint64_t end = std::min(count, i + Scale);
+            double bmin = get_value(metric, i);
+            double bmax = bmin;
+            for (uint64_t k = i; k < end; k++) {
+                const double v = get_value(metric, k);
+                bmin = std::min(bmin, v);
+                bmax = std::max(bmax, v);
+                sum += v;
+                sum_sq += v * v;
+            }
+            mipmap[0][i / Scale].min = (float)bmin;
+            mipmap[0][i / Scale].max = (float)bmax;
+            min = std::min(min, bmin);
+            max = std::max(max, bmax);
+        }
+
+        // the upper levels until one entry is left
+        while (mipmap.back().size() > 1) {
+            const std::vector<MinMax> &low = mipmap.back();
+            std::vector<MinMax> high((low.size() + Scale - 1) / Scale);
+            for (uint64_t i = 0; i < low.size(); i++) {
+                MinMax &e = high[i / Scale];
+                if (i % Scale == 0) {
+                    e = low[i];
+                } else {
+                    e.min = std::min(e.min, low[i].min);
+                    e.max = std::max(e.max, low[i].max);
+                }
+            }
+            mipmap.push_back(std::move(high));
+        }
+
+        Summary &s = _summary[m];
+        s.min = min;
+        s.max = max;
+        s.mean = sum / count;
+        s.stddev = std::sqrt(std::max(0.0, sum_sq / count - s.mean * s.mean));
+    }
+}
+
+void EdgeTrend::get_range(Metric metric, uint64_t first, uint64_t last,
+                          double &min, double &max)
+{
+    const std::vector<std::vector<MinMax> > &mipmap = _mipmap[metric];
+    const uint64_t end = std::min(last + 1, get_cycle_count());
+
+    min = max = get_value(metric, first);
+
+    // single cycles up to the next aligned block, then the largest
+    // aligned blocks which fit in the range
+    uint64_t i = first;
+    while (i < end) {
+        uint64_t span = 1;
+        unsigned int level = 0;
+        while (level < mipmap.size() && i % (span * Scale) == 0 &&
+               i + span * Scale <= end) {
+            span *= Scale;
+            level++;
+        }
+
+        if (level == 0) {
+            const double v = get_value(metric, i);
+            min = std::min(min, v);
+            max = std::max(max, v);
+        } else {
+            const MinMax &e = mipmap[level - 1][i / span];
+            min = std::min(min, (double)e.min);
+            max = std::max(max, (double)e.max);
+        }
+        i += span;
+    }
+}
+
+int64_t EdgeTrend::find_cycle(uint64_t sample)
+{
+    if (get_cycle_count() == 0)
+        return -1;
+    return std::upper_bound(_rising.begin(), _rising.end(), sample) - _rising.begin() - 1;
+}
+
+} // namespace data
+} // namespace pv
@@ -0,0 +1,137 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef DSVIEW_PV_DATA_EDGETREND_H
+#define DSVIEW_PV_DATA_EDGETREND_H
+
+#include <stdint.h>
+#include <vector>
+#include <atomic>
+
+#include "logicsnapshot.h"
+
+namespace pv {
+namespace data {
+
+//The timing of each cycle of a logic channel, a cycle runs from one
+//rising edge to the next. The values of a metric are computed on the
+//fly from the edges, a min/max mipmap of each metric serves the zoomed
+//out views. The TIE is the distance of each rising edge to a clock of
+//fixed period fitted to all of them.
+class EdgeTrend
+{
+public:
+    enum Metric
+    {
+        TREND_PERIOD = 0,   // seconds
+        TREND_FREQUENCY,    // Hz
+        TREND_DUTY,         // percent of the period at high level
+        TREND_TIE,          // seconds
+        MetricCount
+    };
+
+    struct Summary
+    {
+        double min;
+        double max;
+        double mean;
+        double stddev;
+    };
+
+    static const uint64_t MaxCycles = 1ULL << 25;
+
+private:
+    static const uint64_t ScalePower = 6;
+    static const uint64_t Scale = 1 << ScalePower;
+
+    struct MinMax
+    {
+        float min;
+        float max;
+    };
+
+public:
+    EdgeTrend();
+
+    void clear();
+
+    // the leaf blocks of the snapshot are scanned in parallel, returns
+    // false if the channel has no data, stops early when canceled is set
+    // by another thread
+    bool extract(LogicSnapshot *snapshot, int channel, double samplerate,
+                 std::atomic<bool> *canceled = NULL);
+
+    inline uint64_t get_cycle_count(){
+        return _rising.size() > 1 ? _rising.size() - 1 : 0;
+    }
+
+    // the rising edge which starts the cycle
+    inline uint64_t get_position(uint64_t cycle){
+        return _rising[cycle];
+    }
+
+    inline double get_samplerate(){
+        return _samplerate;
+    }
+
+    // MaxCycles reached, the trend ends before the capture
+    inline bool truncated(){
+        return _truncated;
+    }
+
+    inline const Summary& get_summary(Metric metric){
+        return _summary[metric];
+    }
+
+    double get_value(Metric metric, uint64_t cycle);
+
+    // min and max of the cycles [first, last]
+    void get_range(Metric metric, uint64_t first, uint64_t last,
+                   double &min, double &max);
+
+    // the cycle which holds the sample, -1 before the first rising edge,
+    // get_cycle_count() after the last one
+    int64_t find_cycle(uint64_t sample);
+
+private:
+    void leaf_edges(LogicSnapshot *snapshot, LogicSnapshot::ChannelHandle ch,
+                    uint64_t start, uint64_t end, std::vector<uint64_t> &rising,
+                    std::vector<uint64_t> &falling, std::atomic<bool> *canceled);
+
+    void fit_clock();
+    void build_mipmap();
+
+private:
+    std::vector<uint64_t> _rising;
+    std::vector<uint32_t> _high;    // samples at high level in each cycle
+    // _mipmap[metric][level], level 0 holds Scale cycles per entry
+    std::vector<std::vector<MinMax> > _mipmap[MetricCount];
+    Summary _summary[MetricCount];
+    double _samplerate;
+    double _tie_offset;             // the fitted clock, in samples from _rising[0]
+    double _tie_period;
+    bool _truncated;
+};
+
+} // namespace data
+} // namespace pv
+
+#endif // DSVIEW_PV_DATA_EDGETREND_H
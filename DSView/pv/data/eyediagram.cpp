@@ -0,0 +1,332 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "eyediagram.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../taskscheduler.h"
+
+namespace pv {
+namespace data {
+
+EyeDiagram::EyeDiagram()
+{
+    _period = 0;
+    clear();
+}
+
+void EyeDiagram::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _density.assign(Rows * Columns, 0);
+    _max = 0;
+    _version = 0;
+    _blocks = 0;
+    _ui = 0;
+}
+
+void EyeDiagram::set_period(double period)
+{
+    _period = period;
+}
+
+uint64_t EyeDiagram::get_version()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _version;
+}
+
+uint64_t EyeDiagram::get_blocks()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _blocks;
+}
+
+double EyeDiagram::get_ui()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _ui;
+}
+
+void EyeDiagram::get_density(std::vector<uint32_t> &density, uint32_t &max)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    density = _density;
+    max = _max;
+}
+
+bool EyeDiagram::fit_clock(const uint8_t *data, uint64_t count, int stride,
+                           double &period, double &offset)
+{
+    uint8_t min = 0xff;
+    uint8_t max = 0;
+    for (uint64_t i = 0; i < count; i++) {
+        min = std::min(min, data[i * stride]);
+        max = std::max(max, data[i * stride]);
+    }
+    if (max - min < MinSwing)
+        return false;
+
+    // a crossing of the mid level counts once the signal has left it by
+    // the hysteresis, the noise around the level gives no extra crossings
+    const double mid = (min + max) / 2.0;
+    const double hyst = (max - min) / 8.0;
+    std::vector<double> cross;
+    double last = -1;
+    int state = 0;
+
+    for (uint64_t i = 1; i < count; i++) {
+        const double v0 = data[(i - 1) * stride];
+        const double v1 = data[i * stride];
+        if ((v0 <= mid) != (v1 <= mid))
+            last = i - 1 + (mid - v0) / (v1 - v0);
+
+        if (v1 > mid + hyst && state <= 0) {
+            if (state < 0 && last >= 0)
+                cross.push_back(last);
+            state = 1;
+        } else if (v1 < mid - hyst && state >= 0) {
+            if (state > 0 && last >= 0)
+                cross.push_back(last);
+            state = -1;
+        }
+    }
+    if (cross.size() < MinCrossings)
+        return false;
+
+    std::vector<double> intervals(cross.size() - 1);
+    for (uint64_t k = 1; k < cross.size(); k++)
+        intervals[k - 1] = cross[k] - cross[k - 1];
+
+    // the shortest intervals are single unit intervals, a low percentile
+    // of them leaves out the glitches
+    double ui = _period;
+    if (ui <= 0) {
+        std::vector<double> sorted(intervals);
+        const uint64_t rank = sorted.size() / 10;
+        std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+        ui = sorted[rank];
+    }
+    if (ui < 1)
+        return false;
+
+    // number the crossings in unit intervals and fit the clock to them,
+    // the second pass numbers them again with the fitted period
+    const uint64_t n = cross.size();
+    std::vector<double> index(n);
+
+    for (int pass = 0; pass < 2; pass++) {
+        index[0] = 0;
+        for (uint64_t k = 1; k < n; k++)
+            index[k] = index[k - 1] + std::max(1.0, std::round(intervals[k - 1] / ui));
+
+        if (_period > 0) {
+            double sum = 0;
+            for (uint64_t k = 0; k < n; k++)
+                sum += cross[k] - ui * index[k];
+            offset = sum / n;
+            break;
+        }
+
+        double mean_i = 0;
+        double mean_t = 0;
+        for (uint64_t k = 0; k < n; k++) {
+            mean_i += index[k];
+            mean_t += cross[k];
+        }
+        mean_i /= n;
+        mean_t /= n;
+
+        double sum_ii = 0;
+        double sum_it = 0;
+        for (uint64_t k = 0; k < n; k++) {
+            sum_ii += (index[k] - mean_i) * (index[k] - mean_i);
+            sum_it += (index[k] - mean_i) * (cross[k] - mean_t);
+        }
+        ui = sum_it / sum_ii;
+        offset = mean_t - ui * mean_i;
+
+        if (ui < 1)
+            return false;
+    }
+
+    period = ui;
+    return true;
+}
+
+void EyeDiagram::fold_range(const uint8_t *data, uint64_t start, uint64_t end,
+                            int stride, double period, double offset, uint32_t *grid)
+{
+    // the segments between the samples are drawn into the grid, a column
+    // gets the value where the segment crosses it and is filled up to
+    // the value of the column before, so steep edges stay connected
+    const double columns_per_sample = ColumnsPerUI / period;
+    int last_row = -1;
+
+    if (start > 0)
+        start--;
+
+    for (uint64_t i = start + 1; i < end; i++) {
+        const double v0 = data[(i - 1) * stride];
+        const double v1 = data[i * stride];
+        const double x0 = ((double)(i - 1) - offset) * columns_per_sample;
+        const double x1 = x0 + columns_per_sample;
+
+        for (int64_t c = (int64_t)std::floor(x0) + 1; c <= (int64_t)std::floor(x1); c++) {
+            const int row = (int)std::lround(v0 + (v1 - v0) * (c - x0) / columns_per_sample);
+            const int q = (int)(((c % ColumnsPerUI) + ColumnsPerUI) % ColumnsPerUI);
+            const int col = (q + ColumnsPerUI / 2) % ColumnsPerUI;
+
+            int from = row;
+            int to = row;
+            if (last_row >= 0 && last_row != row) {
+                from = (last_row < row) ? last_row + 1 : row;
+                to = (last_row < row) ? row : last_row - 1;
+            }
+            for (int r = from; r <= to; r++) {
+                grid[r * Columns + col]++;
+                grid[r * Columns + col + ColumnsPerUI]++;
+            }
+            last_row = row;
+        }
+    }
+}
+
+bool EyeDiagram::fold(const uint8_t *data, uint64_t count, int stride,
+                      std::atomic<bool> *canceled)
+{
+    double period = 0;
+    double offset = 0;
+
+    if (data == NULL || count < 2 || !fit_clock(data, count, stride, period, offset))
+        return false;
+
+    // each task folds its range into a grid of its own, the grids are
+    // added to the density afterwards
+    const uint64_t block = std::max(FoldBlock, (count + MaxFoldTasks - 1) / MaxFoldTasks);
+    const uint64_t num = (count + block - 1) / block;
+    std::vector<std::vector<uint32_t> > grids(num);
+    std::vector<TaskPtr> tasks;
+
+    for (uint64_t i = 0; i < num; i++) {
+        const uint64_t start = i * block;
+        const uint64_t end = std::min(count, start + block);
+        tasks.push_back(TaskScheduler::Instance().submit(TaskScheduler::TaskRender,
+            [&grids, i, data, start, end, stride, period, offset, canceled](Task &){
+                if (canceled != NULL && *canceled)
+                    return;
+                grids[i].assign(Rows * Columns, 0);
+                fold_range(data, start, end, stride, period, offset, grids[i].data());
+            }));
+    }
+    for (auto &task : tasks)
+        task->wait();
+
+    if (canceled != NULL && *canceled)
+        return false;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for (auto &grid : grids) {
+        for (int k = 0; k < Rows * Columns; k++) {
+            const uint64_t sum = (uint64_t)_density[k] + grid[k];
+            _density[k] = (uint32_t)std::min(sum, (uint64_t)UINT32_MAX);
+            _max = std::max(_max, _density[k]);
+        }
+    }
+    _ui = period;
+    _blocks++;
+    _version++;
+    return true;
+}
+
+EyeDiagram::Eye EyeDiagram::measure()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    Eye eye;
+    eye.open = false;
+    eye.height = 0;
+    eye.level = 0;
+    eye.width = 0;
+
+    // the rows of the columns in the middle of the eye, a row with less
+    // than a hundredth of the busiest one counts as empty
+    const int center = ColumnsPerUI;
+    std::vector<uint64_t> rows(Rows, 0);
+    uint64_t rows_max = 0;
+    for (int r = 0; r < Rows; r++) {
+        for (int c = center - 2; c < center + 2; c++)
+            rows[r] += _density[r * Columns + c];
+        rows_max = std::max(rows_max, rows[r]);
+    }
+    if (rows_max == 0)
+        return eye;
+
+    // the highest run of empty rows between hits above and below
+    int best_start = -1;
+    int best_len = 0;
+    int run_start = -1;
+    for (int r = 0; r < Rows; r++) {
+        if (rows[r] * 100 <= rows_max) {
+            if (run_start < 0)
+                run_start = r;
+        } else {
+            if (run_start > 0 && r - run_start > best_len) {
+                best_start = run_start;
+                best_len = r - run_start;
+            }
+            run_start = -1;
+        }
+    }
+    if (best_start < 0)
+        return eye;
+
+    eye.height = best_len;
+    eye.level = best_start + best_len / 2;
+
+    // the columns on the middle level, the width is the run of empty
+    // columns around the center
+    std::vector<uint64_t> cols(Columns, 0);
+    uint64_t cols_max = 0;
+    for (int c = 0; c < Columns; c++) {
+        for (int r = std::max(eye.level - 1, 0); r <= std::min(eye.level + 1, Rows - 1); r++)
+            cols[c] += _density[r * Columns + c];
+        cols_max = std::max(cols_max, cols[c]);
+    }
+
+    int left = center;
+    int right = center;
+    while (left > 0 && cols[left - 1] * 100 <= cols_max)
+        left--;
+    while (right < Columns - 1 && cols[right + 1] * 100 <= cols_max)
+        right++;
+
+    eye.open = true;
+    eye.width = (right - left + 1) / (double)ColumnsPerUI;
+    return eye;
+}
+
+} // namespace data
+} // namespace pv
@@ -0,0 +1,104 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef DSVIEW_PV_DATA_EYEDIAGRAM_H
+#define DSVIEW_PV_DATA_EYEDIAGRAM_H
+
+#include <stdint.h>
+#include <vector>
+#include <atomic>
+#include <mutex>
+
+namespace pv {
+namespace data {
+
+//The hits of 8 bit samples folded onto two unit intervals of a clock.
+//The clock of each folded block is fitted to the crossings of its mid
+//level, the period is given or recovered from the shortest intervals
+//between the crossings. The density only grows until it is cleared, so
+//new frames or new samples of a stream are folded on top of the old ones.
+class EyeDiagram
+{
+public:
+    static const int Columns = 256;     // -0.5 UI to 1.5 UI, crossings at 1/4 and 3/4
+    static const int Rows = 256;        // one per sample value
+    static const int ColumnsPerUI = Columns / 2;
+
+    struct Eye
+    {
+        bool open;
+        int height;     // sample values
+        int level;      // the sample value in the middle of the opening
+        double width;   // unit intervals
+    };
+
+private:
+    static const uint64_t MinCrossings = 8;
+    static const int MinSwing = 16;
+    static const uint64_t FoldBlock = 1 << 18;
+    static const uint64_t MaxFoldTasks = 16;
+
+public:
+    EyeDiagram();
+
+    void clear();
+
+    // in samples, 0 recovers the period of each block
+    void set_period(double period);
+
+    // folds data[0], data[stride], ... data[(count - 1) * stride], returns
+    // false when no clock is found in the block
+    bool fold(const uint8_t *data, uint64_t count, int stride,
+              std::atomic<bool> *canceled = NULL);
+
+    // changes with every folded block
+    uint64_t get_version();
+
+    uint64_t get_blocks();
+
+    // the clock period of the last folded block, in samples
+    double get_ui();
+
+    void get_density(std::vector<uint32_t> &density, uint32_t &max);
+
+    Eye measure();
+
+private:
+    bool fit_clock(const uint8_t *data, uint64_t count, int stride,
+                   double &period, double &offset);
+
+    static void fold_range(const uint8_t *data, uint64_t start, uint64_t end,
+                           int stride, double period, double offset, uint32_t *grid);
+
+private:
+    std::mutex _mutex;
+    std::vector<uint32_t> _density;     // Rows * Columns, row major
+    uint32_t _max;
+    uint64_t _version;
+    uint64_t _blocks;
+    double _period;
+    double _ui;
+};
+
+} // namespace data
+} // namespace pv
+
+#endif // DSVIEW_PV_DATA_EYEDIAGRAM_H
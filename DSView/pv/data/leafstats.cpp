@@ -0,0 +1,96 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+#include "leafstats.h"
+#include <string.h>
+
+namespace pv {
+namespace data {
+
+LeafStats LeafStats::from_words(const uint64_t *words, uint64_t count)
+{
+    LeafStats stats;
+    uint64_t last = 0;
+
+    memset(&stats, 0, sizeof(stats));
+    stats.min_high = UINT32_MAX;
+    stats.min_low = UINT32_MAX;
+    stats.first = count > 0 && (words[0] & 1) != 0;
+
+    for (uint64_t i = 0; i < count; i++) {
+        const uint64_t sample = words[i];
+        uint64_t tog = sample ^ ((sample << 1) | last);
+        // the change against the previous block is not part of the summary
+        if (i == 0)
+            tog &= ~1ULL;
+        stats.hash = next_hash(stats.hash, sample);
+        stats.high += popcnt64(sample);
+
+        while (tog != 0) {
+            const uint32_t bit = bsf64(tog);
+            const uint32_t pos = i * 64 + bit;
+            const uint32_t width = pos - stats.last_edge;
+            if ((sample >> bit) & 1) {
+                if (stats.edges != 0) {
+                    stats.min_low = (width < stats.min_low) ? width : stats.min_low;
+                    stats.max_low = (width > stats.max_low) ? width : stats.max_low;
+                }
+                if (stats.rising == 0)
+                    stats.first_rising = pos;
+                stats.last_rising = pos;
+                stats.rising++;
+            } else if (stats.edges != 0) {
+                stats.min_high = (width < stats.min_high) ? width : stats.min_high;
+                stats.max_high = (width > stats.max_high) ? width : stats.max_high;
+            }
+            if (stats.edges == 0)
+                stats.first_edge = pos;
+            stats.last_edge = pos;
+            stats.edges++;
+            tog &= tog - 1;
+        }
+        last = sample >> 63;
+    }
+    stats.last = last != 0;
+
+    return stats;
+}
+
+LeafStats LeafStats::from_level(bool level, uint64_t count)
+{
+    LeafStats stats;
+    const uint64_t word = level ? ~0ULL : 0ULL;
+
+    memset(&stats, 0, sizeof(stats));
+    stats.min_high = UINT32_MAX;
+    stats.min_low = UINT32_MAX;
+    stats.first = level;
+    stats.last = level;
+    stats.high = level ? count * 64 : 0;
+    for (uint64_t i = 0; i < count; i++)
+        stats.hash = next_hash(stats.hash, word);
+
+    return stats;
+}
+
+} // namespace data
+} // namespace pv
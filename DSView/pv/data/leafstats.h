@@ -0,0 +1,79 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef DSVIEW_PV_DATA_LEAFSTATS_H
+#define DSVIEW_PV_DATA_LEAFSTATS_H
+
+#include <stdint.h>
+
+namespace pv {
+namespace data {
+
+//Summary of one leaf block of a logic channel, positions are offsets in
+//the block, edges are counted after the first sample. It walks every
+//edge, so the snapshot makes it on the first query instead of while the
+//data comes in, see leafstats_bench.cpp for the cost.
+struct LeafStats
+{
+    uint32_t edges;
+    uint32_t rising;
+    uint32_t high;          // samples at high level
+    uint32_t first_edge;
+    uint32_t last_edge;
+    uint32_t first_rising;
+    uint32_t last_rising;
+    uint32_t min_high;      // complete pulses in the block, UINT32_MAX if none
+    uint32_t max_high;
+    uint32_t min_low;
+    uint32_t max_low;
+    bool first;             // first and last sample of the block
+    bool last;
+    uint64_t hash;          // hash of the block content
+
+    static LeafStats from_words(const uint64_t *words, uint64_t count);
+
+    // a block at one level, its words are not kept
+    static LeafStats from_level(bool level, uint64_t count);
+
+private:
+    static inline int popcnt64(uint64_t bb)
+    {
+        bb = bb - ((bb >> 1) & 0x5555555555555555ULL);
+        bb = (bb & 0x3333333333333333ULL) + ((bb >> 2) & 0x3333333333333333ULL);
+        bb = (bb + (bb >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return (bb * 0x0101010101010101ULL) >> 56;
+    }
+
+    static inline int bsf64(uint64_t bb)
+    {
+        return popcnt64((bb & (0 - bb)) - 1);
+    }
+
+    static inline uint64_t next_hash(uint64_t hash, uint64_t word)
+    {
+        return ((hash ^ word) * 0x9E3779B97F4A7C15ULL) ^ (hash >> 29);
+    }
+};
+
+} // namespace data
+} // namespace pv
+
+#endif // DSVIEW_PV_DATA_LEAFSTATS_H
@@ -0,0 +1,240 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+/*
+*	Cost of a leaf block on the collect thread, the level 1 mipmap which
+*	calc_mipmap() builds for every block, against the level 1 mipmap with
+*	the leaf summary in the same pass as it was before the summary was
+*	made on the first query. The last column is that query alone.
+*
+*	leafstats_bench [leaves] [rounds]
+*/
+
+#include "leafstats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <chrono>
+
+using namespace pv::data;
+
+// samples of a leaf block / 64
+static const uint64_t LeafWords = 1 << 18;
+
+static inline uint64_t popcnt64(uint64_t bb)
+{
+    bb = bb - ((bb >> 1) & 0x5555555555555555ULL);
+    bb = (bb & 0x3333333333333333ULL) + ((bb >> 2) & 0x3333333333333333ULL);
+    bb = (bb + (bb >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (bb * 0x0101010101010101ULL) >> 56;
+}
+
+static inline uint64_t bsf_folded(uint64_t bb)
+{
+    static const int lsb_64_table[64] = {
+        63, 30,  3, 32, 59, 14, 11, 33,
+        60, 24, 50,  9, 55, 19, 21, 34,
+        61, 29,  2, 53, 51, 23, 41, 18,
+        56, 28,  1, 43, 46, 27,  0, 35,
+        62, 31, 58,  4,  5, 49, 54,  6,
+        15, 52, 12, 40,  7, 42, 45, 16,
+        25, 57, 48, 13, 10, 39,  8, 44,
+        20, 47, 38, 22, 17, 37, 36, 26
+    };
+    unsigned int folded;
+    bb ^= bb - 1;
+    folded = (int) bb ^ (bb >> 32);
+    return lsb_64_table[folded * 0x78291ACF >> 26];
+}
+
+// the level 1 loop of calc_mipmap()
+static void mipmap(const uint64_t *src, uint64_t *dest, uint64_t &last_sample)
+{
+    uint64_t *dest_ptr = dest - 1;
+    for (uint64_t i = 0; i < LeafWords; i++) {
+        const unsigned int offset = i % 64;
+        if (offset == 0)
+            dest_ptr++;
+        *dest_ptr += ((last_sample ^ *src) != 0 ? 1ULL : 0ULL) << offset;
+        last_sample = *src & (1ULL << 63) ? ~0ULL : 0ULL;
+        src++;
+    }
+}
+
+// the same loop with the summary, as calc_mipmap() had it
+static void mipmap_stats(const uint64_t *src, uint64_t *dest, uint64_t &last_sample, LeafStats &stats)
+{
+    uint64_t *dest_ptr = dest - 1;
+
+    memset(&stats, 0, sizeof(stats));
+    stats.min_high = UINT32_MAX;
+    stats.min_low = UINT32_MAX;
+    stats.first = (*src & 1) != 0;
+    for (uint64_t i = 0; i < LeafWords; i++) {
+        const unsigned int offset = i % 64;
+        if (offset == 0)
+            dest_ptr++;
+        *dest_ptr += ((last_sample ^ *src) != 0 ? 1ULL : 0ULL) << offset;
+
+        const uint64_t sample = *src;
+        uint64_t tog = sample ^ ((sample << 1) | (last_sample & 1));
+        stats.hash = ((stats.hash ^ sample) * 0x9E3779B97F4A7C15ULL) ^ (stats.hash >> 29);
+        if (i == 0)
+            tog &= ~1ULL;
+        stats.high += popcnt64(sample);
+        while (tog != 0) {
+            const uint32_t pos = i * 64 + bsf_folded(tog);
+            const bool value = (sample >> (pos & 63)) & 1;
+            if (stats.edges == 0) {
+                stats.first_edge = pos;
+            } else if (value) {
+                stats.min_low = (pos - stats.last_edge < stats.min_low) ? pos - stats.last_edge : stats.min_low;
+                stats.max_low = (pos - stats.last_edge > stats.max_low) ? pos - stats.last_edge : stats.max_low;
+            } else {
+                stats.min_high = (pos - stats.last_edge < stats.min_high) ? pos - stats.last_edge : stats.min_high;
+                stats.max_high = (pos - stats.last_edge > stats.max_high) ? pos - stats.last_edge : stats.max_high;
+            }
+            if (value) {
+                if (stats.rising == 0)
+                    stats.first_rising = pos;
+                stats.last_rising = pos;
+                stats.rising++;
+            }
+            stats.last_edge = pos;
+            stats.edges++;
+            tog &= tog - 1;
+        }
+
+        last_sample = *src & (1ULL << 63) ? ~0ULL : 0ULL;
+        src++;
+    }
+    stats.last = last_sample != 0;
+}
+
+static bool same_stats(const LeafStats &a, const LeafStats &b)
+{
+    return a.edges == b.edges && a.rising == b.rising && a.high == b.high &&
+           a.first_edge == b.first_edge && a.last_edge == b.last_edge &&
+           a.first_rising == b.first_rising && a.last_rising == b.last_rising &&
+           a.min_high == b.min_high && a.max_high == b.max_high &&
+           a.min_low == b.min_low && a.max_low == b.max_low &&
+           a.first == b.first && a.last == b.last && a.hash == b.hash;
+}
+
+// a clock of the period, or random samples for 0
+static void make_signal(std::vector<uint64_t> &words, uint64_t period)
+{
+    srand(period + 1);
+    for (uint64_t i = 0; i < words.size(); i++) {
+        if (period == 0) {
+            words[i] = ((uint64_t)rand() << 32) ^ (uint64_t)rand();
+            continue;
+        }
+        uint64_t w = 0;
+        for (uint64_t b = 0; b < 64; b++)
+            w |= (uint64_t)((i * 64 + b) % period < period / 2) << b;
+        words[i] = w;
+    }
+}
+
+// the fastest of the rounds, after one round to warm up the caches
+template<typename Func>
+static double run_mbps(Func func, uint64_t bytes, int rounds)
+{
+    double best = 0;
+
+    func();
+    for (int i = 0; i < rounds; i++) {
+        const auto start = std::chrono::steady_clock::now();
+        func();
+        const std::chrono::duration<double> sec = std::chrono::steady_clock::now() - start;
+        if (best == 0 || sec.count() < best)
+            best = sec.count();
+    }
+    return bytes / best / (1024 * 1024);
+}
+
+int main(int argc, char **argv)
+{
+    const uint64_t leaves = (argc > 1) ? strtoull(argv[1], NULL, 10) : 4;
+    const int rounds = (argc > 2) ? atoi(argv[2]) : 10;
+    const uint64_t periods[] = {1000000, 1000, 100, 8, 2, 0};
+
+    if (leaves == 0 || rounds <= 0) {
+        fprintf(stderr, "usage: %s [leaves] [rounds]\n", argv[0]);
+        return 1;
+    }
+
+    const uint64_t words = leaves * LeafWords;
+    const uint64_t bytes = words * 8;
+    std::vector<uint64_t> src(words);
+    std::vector<uint64_t> dest(words / 64);
+    std::vector<LeafStats> stats(leaves);
+
+    printf("%llu leaves of %llu samples, best of %d rounds, MB/s\n",
+           (unsigned long long)leaves, (unsigned long long)LeafWords * 64, rounds);
+    printf("%8s %8s %10s %10s %8s %10s\n", "period", "edges/w", "mipmap", "+stats", "gain", "query");
+
+    for (uint64_t period : periods) {
+        make_signal(src, period);
+
+        const double stats_mbps = run_mbps([&]{
+            uint64_t last = 0;
+            memset(dest.data(), 0, dest.size() * 8);
+            for (uint64_t l = 0; l < leaves; l++)
+                mipmap_stats(&src[l * LeafWords], &dest[l * LeafWords / 64], last, stats[l]);
+        }, bytes, rounds);
+
+        const double mipmap_mbps = run_mbps([&]{
+            uint64_t last = 0;
+            memset(dest.data(), 0, dest.size() * 8);
+            for (uint64_t l = 0; l < leaves; l++)
+                mipmap(&src[l * LeafWords], &dest[l * LeafWords / 64], last);
+        }, bytes, rounds);
+
+        LeafStats query;
+        const double query_mbps = run_mbps([&]{
+            for (uint64_t l = 0; l < leaves; l++)
+                query = LeafStats::from_words(&src[l * LeafWords], LeafWords);
+        }, bytes, rounds);
+
+        uint64_t edges = 0;
+        for (uint64_t l = 0; l < leaves; l++) {
+            if (!same_stats(stats[l], LeafStats::from_words(&src[l * LeafWords], LeafWords))) {
+                fprintf(stderr, "period %llu: the summary of leaf %llu is wrong\n",
+                        (unsigned long long)period, (unsigned long long)l);
+                return 1;
+            }
+            edges += stats[l].edges;
+        }
+
+        if (period == 0)
+            printf("%8s", "random");
+        else
+            printf("%8llu", (unsigned long long)period);
+        printf(" %8.1f %10.0f %10.0f %7.1fx %10.0f\n", (double)edges / words,
+               mipmap_mbps, stats_mbps, mipmap_mbps / stats_mbps, query_mbps);
+    }
+
+    return 0;
+}
@@ -24,8 +24,11 @@
 #include <string.h>
 #include <stdlib.h>
 #include <math.h>
+#include <algorithm>
  
 #include "logicsnapshot.h"
+#include "memorybudget.h"
+#include "scriptengine.h"
 #include "../dsvdef.h"
 #include "../log.h"
 
@@ -51,10 +54,21 @@ LogicSnapshot::LogicSnapshot() :
     Snapshot(1, 0, 0),
     _block_num(0)
 {
+    _block_listener = NULL;
+    _cross_kernel = NULL;
+    _virtual_leaf = 0;
+    _mem_pool = MemoryBudget::PoolLogic;
+    _ch_data.reserve(CHANNEL_MAX_COUNT);
+    _ch_order.reserve(CHANNEL_MAX_COUNT);
 }
 
 LogicSnapshot::~LogicSnapshot()
 {
+    free_data();
+
+    for (auto vch : _virtual)
+        delete vch;
+    _virtual.clear();
 }
 
 void LogicSnapshot::free_data()
@@ -63,13 +77,18 @@ void LogicSnapshot::free_data()
     for(auto& iter:_ch_data) {
         for(auto& iter_rn:iter) {
             for (unsigned int k = 0; k < Scale; k++)
-                if (iter_rn.lbp[k] != NULL)
-                    free(iter_rn.lbp[k]);
+                if (iter_rn.lbp[k] != NULL) {
+                    // a script may still hold a view of the leaf
+                    if (!ScriptEngine::retire_buffer(iter_rn.lbp[k]))
+                        free(iter_rn.lbp[k]);
+                    mem_free(LeafBlockSpace);
+                }
         }
         std::vector<struct RootNode> void_vector;
         iter.swap(void_vector);
     }
     _ch_data.clear();
+    _ch_order.clear();
     _sample_count = 0;
 }
 
@@ -92,6 +111,8 @@ void LogicSnapshot::init_all()
     _memory_failed = false;
     _last_ended = true;
     _times = 0;
+    _virtual_leaf = 0;
+    _generation++;
 }
 
 void LogicSnapshot::clear()
@@ -111,9 +132,9 @@ void LogicSnapshot::capture_ended()
     if (block_offset != 0) {
         uint64_t index0 = block_index / RootScale;
         uint64_t index1 = block_index % RootScale;
-        int order = 0;
 
-        for(auto& iter:_ch_data) { 
+        for (unsigned int order = 0; order < _channel_num; order++) {
+            auto &iter = _ch_data[order];
 
             if (iter[index0].lbp[index1] == NULL){
                 iter[index0].lbp[index1] = malloc(LeafBlockSpace);
@@ -122,6 +143,7 @@ void LogicSnapshot::capture_ended()
                     _memory_failed = true;
                     return;
                 }
+                mem_alloc(LeafBlockSpace);
                 memset(iter[index0].lbp[index1], 0, LeafBlockSpace);
             }
 
@@ -133,6 +155,7 @@ void LogicSnapshot::capture_ended()
 
             // calc mipmap of current block
             calc_mipmap(order, index0, index1, block_offset * Scale);
+            block_finished(order, index0, index1, block_offset * Scale);
 
             // calc root of current block
             if (*((uint64_t *)iter[index0].lbp[index1]) != 0)
@@ -142,15 +165,21 @@ void LogicSnapshot::capture_ended()
             } else {
                // trim leaf to free space
                free(iter[index0].lbp[index1]);
+               mem_free(LeafBlockSpace);
                iter[index0].lbp[index1] = NULL;
             }
-
-            order++;
         }
     }
+    update_virtual();
     _sample_count = _ring_sample_count;
 }
 
+uint64_t LogicSnapshot::get_memory_size(uint64_t total_sample_count, unsigned int channel_num)
+{
+    const uint64_t leaf_count = (total_sample_count + LeafBlockSamples - 1) / LeafBlockSamples;
+    return leaf_count * channel_num * LeafBlockSpace;
+}
+
 void LogicSnapshot::first_payload(const sr_datafeed_logic &logic, uint64_t total_sample_count, GSList *channels)
 {
     bool channel_changed = false;
@@ -166,6 +195,9 @@ void LogicSnapshot::first_payload(const sr_datafeed_logic &logic, uint64_t total
         }
     }
 
+    if (_ch_data.size() != channel_num + _virtual.size())
+        channel_changed = true;
+
     if (total_sample_count != _total_sample_count ||
         channel_num != _channel_num ||
         channel_changed) {
@@ -176,29 +208,25 @@ void LogicSnapshot::first_payload(const sr_datafeed_logic &logic, uint64_t total
 
         _total_sample_count = total_sample_count;
         _channel_num = channel_num;
-        uint64_t rootnode_size = (_total_sample_count + RootNodeSamples - 1) / RootNodeSamples;
 
         for (const GSList *l = channels; l; l = l->next) {
             sr_channel *const probe = (sr_channel*)l->data;
-            if (probe->type == SR_CHANNEL_LOGIC && probe->enabled) {
-                std::vector<struct RootNode> root_vector;
-                for (uint64_t j = 0; j < rootnode_size; j++) {
-                    struct RootNode rn;
-                    rn.tog = 0;
-                    rn.value = 0;
-                    memset(rn.lbp, 0, sizeof(rn.lbp));
-                    root_vector.push_back(rn);
-                }
-                _ch_data.push_back(root_vector);
-                _ch_index.push_back(probe->index);
-            }
+            if (probe->type == SR_CHANNEL_LOGIC && probe->enabled)
+                append_channel_data(probe->index);
         }
+        // the free slots of removed virtual channels are dropped
+        _virtual.erase(std::remove(_virtual.begin(), _virtual.end(), (VirtualChannel*)NULL),
+                       _virtual.end());
+        for (auto vch : _virtual)
+            append_channel_data(vch->get_index());
+        build_ch_order();
 
     } else {
         for(auto& iter:_ch_data) {
             for(auto& iter_rn:iter) {
                 iter_rn.tog = 0;
                 iter_rn.value = 0;
+                iter_rn.stats_done = 0;
             }
         }
     }
@@ -209,12 +237,21 @@ void LogicSnapshot::first_payload(const sr_datafeed_logic &logic, uint64_t total
     _sample_cnt.clear();
     _block_cnt.clear();
     _ring_sample_cnt.clear();
+    _leaf_done.clear();
 
     for (unsigned int i = 0; i < _channel_num; i++) {
-        _last_sample.push_back(0);
         _sample_cnt.push_back(0);
         _block_cnt.push_back(0);
         _ring_sample_cnt.push_back(0);
+        _leaf_done.push_back(0);
+    }
+    _last_sample.assign(_ch_data.size(), 0);
+    _cross_kernel = CrossSplit::get_kernel(_channel_num);
+
+    _virtual_leaf = 0;
+    for (auto vch : _virtual) {
+        if (vch != NULL)
+            vch->reset();
     }
 
     append_payload(logic);
@@ -230,7 +267,10 @@ void LogicSnapshot::append_payload(const sr_datafeed_logic &logic)
     else if (logic.format == LA_SPLIT_DATA)
         append_split_payload(logic);
 
+    update_virtual();
+
     _have_data = true;
+    _generation++;
 }
 
 void LogicSnapshot::append_cross_payload(const sr_datafeed_logic &logic)
@@ -257,7 +297,8 @@ void LogicSnapshot::append_cross_payload(const sr_datafeed_logic &logic)
     while (_sample_count > _block_num * LeafBlockSamples) {
         uint8_t index0 = _block_num / RootScale;
         uint8_t index1 = _block_num % RootScale;
-        for(auto& iter:_ch_data) {
+        for (unsigned int order = 0; order < _channel_num; order++) {
+            auto &iter = _ch_data[order];
 
             if (iter[index0].lbp[index1] == NULL){
                 iter[index0].lbp[index1] = malloc(LeafBlockSpace);
@@ -265,7 +306,8 @@ void LogicSnapshot::append_cross_payload(const sr_datafeed_logic &logic)
                 if (iter[index0].lbp[index1] == NULL) {
                     _memory_failed = true;
                     return;
-                }                
+                }
+                mem_alloc(LeafBlockSpace);
             }
            
             uint64_t *mipmap_ptr = (uint64_t *)iter[index0].lbp[index1] +
@@ -318,59 +360,66 @@ void LogicSnapshot::append_cross_payload(const sr_datafeed_logic &logic)
         uint64_t pre_index0 = _ring_sample_count / RootNodeSamples;
         uint64_t pre_index1 = (_ring_sample_count >> LeafBlockPower) % RootScale;
         uint64_t pre_offset = (_ring_sample_count % LeafBlockSamples) / Scale;
-        uint64_t *src_ptr = NULL;
-        uint64_t *dest_ptr;
-        int order = 0;
         const uint64_t align_size = len / ScaleSize / _channel_num;
         _ring_sample_count += align_size * Scale;
 
 //        uint64_t mipmap_index = pre_offset / Scale;
 //        uint64_t mipmap_offset = pre_offset % Scale;
 //        uint64_t *l1_mipmap;
-        for(auto& iter:_ch_data) {
-            uint64_t index0 = pre_index0;
-            uint64_t index1 = pre_index1;
-            src_ptr = (uint64_t *)_src_ptr + order;
-            _dest_ptr = iter[index0].lbp[index1];
-            dest_ptr = (uint64_t *)_dest_ptr + pre_offset;
-//            l1_mipmap = (uint64_t *)_dest_ptr + (LeafBlockSamples / Scale) + mipmap_index;
-            while (src_ptr < (uint64_t *)_src_ptr + (align_size * _channel_num)) {
-                const uint64_t tmp_u64 = *src_ptr;
-                *dest_ptr++ = tmp_u64;
-//                *l1_mipmap += ((_last_sample[i] ^ tmp_u64) != 0 ? 1ULL : 0ULL) << mipmap_offset;
-//                mipmap_offset = (mipmap_offset + 1) % Scale;
-//                l1_mipmap += (mipmap_offset == 0);
-//                _last_sample[i] = tmp_u64 & (1ULL << (Scale - 1)) ? ~0ULL : 0ULL;
-                src_ptr += _channel_num;
-                //mipmap
-                if (dest_ptr == (uint64_t *)_dest_ptr + (LeafBlockSamples / Scale)) {
-                    // calc mipmap of current block
-                    calc_mipmap(order, index0, index1, LeafBlockSamples);
-
-                    // calc root of current block
-                    if (*((uint64_t *)iter[index0].lbp[index1]) != 0)
-                        iter[index0].value +=  1ULL<< index1;
-                    if (*((uint64_t *)iter[index0].lbp[index1] + LeafBlockSpace / sizeof(uint64_t) - 1) != 0) {
-                        iter[index0].tog += 1ULL << index1;
-                    } else {
-                        // trim leaf to free space
-                        free(iter[index0].lbp[index1]);
-                        iter[index0].lbp[index1] = NULL;                       
-                    }
+        const uint64_t leaf_words = LeafBlockSamples / Scale;
+        uint64_t index0 = pre_index0;
+        uint64_t index1 = pre_index1;
+        uint64_t offset = pre_offset;
+        uint64_t words = align_size;
+        const uint64_t *src_ptr = (const uint64_t *)_src_ptr;
+        std::vector<uint64_t *> dest(_channel_num);
+
+        // up to the end of the leaf blocks at once
+        while (words != 0) {
+            const uint64_t count = min(words, leaf_words - offset);
+            for (unsigned int order = 0; order < _channel_num; order++)
+                dest[order] = (uint64_t *)_ch_data[order][index0].lbp[index1] + offset;
+            if (_cross_kernel)
+                _cross_kernel(dest.data(), src_ptr, count);
+            else
+                CrossSplit::split(dest.data(), src_ptr, count, _channel_num);
+            src_ptr += count * _channel_num;
+            offset += count;
+            words -= count;
 
-                    index1++;
-                    if (index1 == RootScale) {
-                        index0++;
-                        index1 = 0;
-                    }
-                    _dest_ptr = iter[index0].lbp[index1];
-                    dest_ptr = (uint64_t *)_dest_ptr;
+            if (offset != leaf_words)
+                break;
+
+            //mipmap
+            for (unsigned int order = 0; order < _channel_num; order++) {
+                auto &iter = _ch_data[order];
+
+                // calc mipmap of current block
+                calc_mipmap(order, index0, index1, LeafBlockSamples);
+                block_finished(order, index0, index1, LeafBlockSamples);
+
+                // calc root of current block
+                if (*((uint64_t *)iter[index0].lbp[index1]) != 0)
+                    iter[index0].value +=  1ULL<< index1;
+                if (*((uint64_t *)iter[index0].lbp[index1] + LeafBlockSpace / sizeof(uint64_t) - 1) != 0) {
+                    iter[index0].tog += 1ULL << index1;
+                } else {
+                    // trim leaf to free space
+                    free(iter[index0].lbp[index1]);
+                    mem_free(LeafBlockSpace);
+                    iter[index0].lbp[index1] = NULL;                       
                 }
             }
-            order++;
+
+            index1++;
+            if (index1 == RootScale) {
+                index0++;
+                index1 = 0;
+            }
+            offset = 0;
         }
         len -= align_size * _channel_num * ScaleSize;
-        _src_ptr = src_ptr - _channel_num + 1;
+        _src_ptr = (uint64_t *)_src_ptr + align_size * _channel_num;
     }
 
     // fraction data append
@@ -428,7 +477,8 @@ void LogicSnapshot::append_split_payload(const sr_datafeed_logic &logic)
             {
                 _memory_failed = true;
                 return;
-            } 
+            }
+            mem_alloc(LeafBlockSpace);
         }
 
         memset(_ch_data[order][index0].lbp[index1], 0, LeafBlockSpace);
@@ -449,6 +499,7 @@ void LogicSnapshot::append_split_payload(const sr_datafeed_logic &logic)
 
             // calc mipmap of current block
             calc_mipmap(order, index0, index1, LeafBlockSamples);
+            block_finished(order, index0, index1, LeafBlockSamples);
 
             // calc root of current block
             if (*((uint64_t *)_ch_data[order][index0].lbp[index1]) != 0)
@@ -459,7 +510,8 @@ void LogicSnapshot::append_split_payload(const sr_datafeed_logic &logic)
             } else {
                 // trim leaf to free space
                 free(_ch_data[order][index0].lbp[index1]);
-                _ch_data[order][index0].lbp[index1] = NULL; 
+                mem_free(LeafBlockSpace);
+                _ch_data[order][index0].lbp[index1] = NULL;
             }
         } else {
             memcpy((uint8_t*)_dest_ptr, (uint8_t *)logic.data, samples/8);
@@ -472,6 +524,179 @@ void LogicSnapshot::append_split_payload(const sr_datafeed_logic &logic)
     _ring_sample_count = *min_element(_ring_sample_cnt.begin(), _ring_sample_cnt.end());
 }
 
+void LogicSnapshot::block_finished(unsigned int order, uint64_t index0, uint64_t index1, uint64_t samples)
+{
+    _leaf_done[order]++;
+
+    if (_block_listener == NULL)
+        return;
+
+    // before the leaf of a constant block is trimmed
+    _block_listener->OnLogicBlock(_ch_index[order],
+                                  (index0 * RootScale + index1) * LeafBlockSamples,
+                                  samples,
+                                  _ch_data[order][index0].lbp[index1]);
+}
+
+void LogicSnapshot::update_virtual()
+{
+    if (_leaf_done.empty())
+        return;
+
+    // a leaf is computed when the leaves of all captured channels are done
+    const uint64_t leaf_count = *min_element(_leaf_done.begin(), _leaf_done.end());
+
+    while (_virtual_leaf < leaf_count && !_memory_failed) {
+        if (_virtual_leaf * LeafBlockSamples + Scale > _ring_sample_count)
+            break;
+        for (unsigned int i = 0; i < _virtual.size(); i++)
+            compute_virtual_leaf(i, _virtual_leaf);
+        _virtual_leaf++;
+    }
+}
+
+void LogicSnapshot::compute_virtual_leaf(unsigned int i, uint64_t leaf)
+{
+    if (_virtual[i] == NULL)
+        return;
+
+    const unsigned int order = _channel_num + i;
+    const uint64_t index0 = leaf / RootScale;
+    const uint64_t index1 = leaf % RootScale;
+    const uint64_t samples = min(LeafBlockSamples,
+                                 (_ring_sample_count - leaf * LeafBlockSamples) / Scale * Scale);
+    struct RootNode &rn = _ch_data[order][index0];
+
+    if (rn.lbp[index1] == NULL) {
+        rn.lbp[index1] = malloc(LeafBlockSpace);
+        if (rn.lbp[index1] == NULL) {
+            _memory_failed = true;
+            return;
+        }
+        mem_alloc(LeafBlockSpace);
+    }
+    memset(rn.lbp[index1], 0, LeafBlockSpace);
+
+    uint64_t *dest_ptr = (uint64_t *)rn.lbp[index1];
+    VirtualChannel *vch = _virtual[i];
+    for (uint64_t w = 0; w < samples / Scale; w++)
+        *dest_ptr++ = vch->next_word(this);
+
+    calc_mipmap(order, index0, index1, samples);
+
+    // calc root of current block
+    if (*((uint64_t *)rn.lbp[index1]) != 0)
+        rn.value += 1ULL << index1;
+    if (*((uint64_t *)rn.lbp[index1] + LeafBlockSpace / sizeof(uint64_t) - 1) != 0) {
+        rn.tog += 1ULL << index1;
+    } else {
+        // trim leaf to free space
+        free(rn.lbp[index1]);
+        mem_free(LeafBlockSpace);
+        rn.lbp[index1] = NULL;
+    }
+}
+
+uint64_t LogicSnapshot::GetSourceWord(int sig_index, uint64_t word_index)
+{
+    const int order = get_ch_order(sig_index);
+    if (order < 0 || order >= (int)_channel_num)
+        return 0;
+
+    const uint64_t leaf = word_index / (LeafBlockSamples / Scale);
+    const uint64_t root_pos = leaf % RootScale;
+    const struct RootNode &rn = _ch_data[order][leaf / RootScale];
+
+    if (rn.lbp[root_pos] == NULL)
+        return (rn.value >> root_pos) & 1 ? ~0ULL : 0ULL;
+    return *((const uint64_t *)rn.lbp[root_pos] + word_index % (LeafBlockSamples / Scale));
+}
+
+void LogicSnapshot::add_virtual_channel(VirtualChannel *vch)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    assert(vch);
+    vch->reset();
+
+    // the free slot of a removed channel is taken first
+    unsigned int i = 0;
+    while (i < _virtual.size() && _virtual[i] != NULL)
+        i++;
+    const bool free_slot = i < _virtual.size();
+    if (free_slot)
+        _virtual[i] = vch;
+    else
+        _virtual.push_back(vch);
+
+    // the next capture makes the layout
+    if (_ch_data.empty())
+        return;
+
+    const unsigned int order = _channel_num + i;
+    if (free_slot) {
+        if (_ch_data.size() != _channel_num + _virtual.size())
+            return;
+        _ch_index[order] = vch->get_index();
+        _last_sample[order] = 0;
+    } else {
+        if (_ch_data.size() + 1 != _channel_num + _virtual.size())
+            return;
+        append_channel_data(vch->get_index());
+        _last_sample.push_back(0);
+    }
+    build_ch_order();
+
+    for (uint64_t leaf = 0; leaf < _virtual_leaf && !_memory_failed; leaf++)
+        compute_virtual_leaf(i, leaf);
+}
+
+void LogicSnapshot::remove_virtual_channel(int sig_index)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for (unsigned int i = 0; i < _virtual.size(); i++) {
+        if (_virtual[i] == NULL || _virtual[i]->get_index() != sig_index)
+            continue;
+
+        // the slot is left free, the other channels keep their orders
+        const unsigned int order = _channel_num + i;
+        if (_ch_data.size() == _channel_num + _virtual.size()) {
+            for (auto &rn : _ch_data[order]) {
+                for (unsigned int k = 0; k < Scale; k++) {
+                    if (rn.lbp[k] != NULL) {
+                        if (!ScriptEngine::retire_buffer(rn.lbp[k]))
+                            free(rn.lbp[k]);
+                        mem_free(LeafBlockSpace);
+                        rn.lbp[k] = NULL;
+                    }
+                }
+                rn.tog = 0;
+                rn.value = 0;
+                rn.stats_done = 0;
+            }
+        }
+
+        delete _virtual[i];
+        _virtual[i] = NULL;
+        if (_ch_data.size() == _channel_num + _virtual.size())
+            build_ch_order();
+        return;
+    }
+}
+
+std::vector<VirtualChannel*> LogicSnapshot::get_virtual_channels()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::vector<VirtualChannel*> channels;
+    for (auto vch : _virtual) {
+        if (vch != NULL)
+            channels.push_back(vch);
+    }
+    return channels;
+}
+
 void LogicSnapshot::calc_mipmap(unsigned int order, uint8_t index0, uint8_t index1, uint64_t samples)
 {
     uint8_t offset;
@@ -492,6 +717,12 @@ void LogicSnapshot::calc_mipmap(unsigned int order, uint8_t index0, uint8_t inde
         src_ptr++;
     }
 
+    // the summary of the old content is made again on the next query
+    {
+        std::lock_guard<std::mutex> lock(_stats_mutex);
+        _ch_data[order][index0].stats_done &= ~(1ULL << index1);
+    }
+
     // level 2/3
     src_ptr = (uint64_t *)_ch_data[order][index0].lbp[index1] + (LeafBlockSamples / Scale);
     dest_ptr = src_ptr + (LeafBlockSamples / Scale / Scale) - 1;
@@ -513,7 +744,13 @@ const uint8_t *LogicSnapshot::get_samples(uint64_t start_sample, uint64_t &end_s
     assert(end_sample <= sample_count);
     assert(start_sample <= end_sample);
 
-    int order = get_ch_order(sig_index);
+    return get_samples(start_sample, end_sample, get_channel(sig_index));
+}
+
+const uint8_t *LogicSnapshot::get_samples(uint64_t start_sample, uint64_t &end_sample,
+                                     ChannelHandle ch)
+{
+    const int order = ch.order;
     uint64_t root_index = start_sample >> (LeafBlockPower + RootScalePower);
     uint8_t root_pos = (start_sample & RootMask) >> LeafBlockPower;
     uint64_t block_offset = (start_sample & LeafMask) / 8;
@@ -531,26 +768,12 @@ const uint8_t *LogicSnapshot::get_samples(uint64_t start_sample, uint64_t &end_s
 
 bool LogicSnapshot::get_sample(uint64_t index, int sig_index)
 {
-    int order = get_ch_order(sig_index);
-    assert(order != -1);
-    assert(_ch_data[order].size() != 0);
+    ChannelHandle ch = get_channel(sig_index);
+    assert(ch.valid());
+    assert(_ch_data[ch.order].size() != 0);
     //assert(index < get_sample_count());
 
-    if (index < get_sample_count()) {
-        uint64_t index_mask = 1ULL << (index & LevelMask[0]);
-        uint64_t root_index = index >> (LeafBlockPower + RootScalePower);
-        uint8_t root_pos = (index & RootMask) >> LeafBlockPower;
-        uint64_t root_pos_mask = 1ULL << root_pos;
-
-        if ((_ch_data[order][root_index].tog & root_pos_mask) == 0) {
-            return (_ch_data[order][root_index].value & root_pos_mask) != 0;
-        } else {
-            uint64_t *lbp = (uint64_t *)_ch_data[order][root_index].lbp[root_pos];
-            return *(lbp + ((index & LeafMask) >> ScalePower)) & index_mask;
-        }
-    } else {
-        return false;
-    }
+    return get_sample(index, ch);
 }
 
 bool LogicSnapshot::get_display_edges(std::vector<std::pair<bool, bool> > &edges,
@@ -574,12 +797,16 @@ bool LogicSnapshot::get_display_edges(std::vector<std::pair<bool, bool> > &edges
     bool last_sample;
     bool start_sample;
 
+    ChannelHandle ch = get_channel(sig_index);
+    if (!ch.valid())
+        return false;
+
     // Get the initial state
-    start_sample = last_sample = get_sample(index++, sig_index);
+    start_sample = last_sample = get_sample(index++, ch);
     togs.push_back(pair<uint16_t, bool>(0, last_sample));
     while(edges.size() < width) {
         // search next edge
-        bool has_edge = get_nxt_edge(index, last_sample, end, 0, sig_index);
+        bool has_edge = get_nxt_edge(index, last_sample, end, 0, ch);
 
         // calc the edge position
         int64_t gap = (index / min_length) - pixels_offset;
@@ -588,9 +815,9 @@ bool LogicSnapshot::get_display_edges(std::vector<std::pair<bool, bool> > &edges
             edges.push_back(pair<bool, bool>(false, last_sample));
 
         if (index > end)
-            last_sample = get_sample(end, sig_index);
+            last_sample = get_sample(end, ch);
         else
-            last_sample = get_sample(index - 1, sig_index);
+            last_sample = get_sample(index - 1, ch);
 
         if (has_edge) {
             edges.push_back(pair<bool, bool>(true, last_sample));
@@ -603,7 +830,7 @@ bool LogicSnapshot::get_display_edges(std::vector<std::pair<bool, bool> > &edges
     }
 
     if (togs.size() < max_togs) {
-        last_sample = get_sample(end, sig_index);
+        last_sample = get_sample(end, ch);
         togs.push_back(pair<uint16_t, bool>(edges.size() - 1, last_sample));
     }
 
@@ -613,11 +840,18 @@ bool LogicSnapshot::get_display_edges(std::vector<std::pair<bool, bool> > &edges
 bool LogicSnapshot::get_nxt_edge(
     uint64_t &index, bool last_sample, uint64_t end,
     double min_length, int sig_index)
+{
+    return get_nxt_edge(index, last_sample, end, min_length, get_channel(sig_index));
+}
+
+bool LogicSnapshot::get_nxt_edge(
+    uint64_t &index, bool last_sample, uint64_t end,
+    double min_length, ChannelHandle ch)
 {
     if (index > end)
         return false;
 
-    int order = get_ch_order(sig_index);
+    const int order = ch.order;
     if (order == -1)
         return false;
 
@@ -659,10 +893,16 @@ bool LogicSnapshot::get_nxt_edge(
 
 bool LogicSnapshot::get_pre_edge(uint64_t &index, bool last_sample,
     double min_length, int sig_index)
+{
+    return get_pre_edge(index, last_sample, min_length, get_channel(sig_index));
+}
+
+bool LogicSnapshot::get_pre_edge(uint64_t &index, bool last_sample,
+    double min_length, ChannelHandle ch)
 {
     assert(index < get_sample_count());
 
-    int order = get_ch_order(sig_index);
+    const int order = ch.order;
     if (order == -1)
         return false;
 
@@ -684,7 +924,7 @@ bool LogicSnapshot::get_pre_edge(uint64_t &index, bool last_sample,
                                    (first_edge_pos << LeafBlockPower)) | LeafMask;
                 index = min(blk_end, index);
                 if (min_level < ScaleLevel) {
-                    edge_hit = block_pre_edge(lbp, index, last_sample, min_level, sig_index);
+                    edge_hit = block_pre_edge(lbp, index, last_sample, min_level, ch);
                 } else {
                     edge_hit = true;
                 }
@@ -785,7 +1025,7 @@ bool LogicSnapshot::block_nxt_edge(uint64_t *lbp, uint64_t &index, uint64_t bloc
 }
 
 bool LogicSnapshot::block_pre_edge(uint64_t *lbp, uint64_t &index, bool last_sample,
-                                   unsigned int min_level, int sig_index)
+                                   unsigned int min_level, ChannelHandle ch)
 {
     assert(min_level == 0);
 
@@ -813,7 +1053,7 @@ bool LogicSnapshot::block_pre_edge(uint64_t *lbp, uint64_t &index, bool last_sam
                 index--;
 
             // using get_sample() to avoid out of block case
-            bool sample = get_sample(index, sig_index);
+            bool sample = get_sample(index, ch);
             if (sample ^ last_sample) {
                 index++;
                 return true;
@@ -892,6 +1132,193 @@ bool LogicSnapshot::block_pre_edge(uint64_t *lbp, uint64_t &index, bool last_sam
     return (index >= block_start) && (index != 0);
 }
 
+uint64_t LogicSnapshot::get_edges(uint64_t &index, uint64_t end, int sig_index,
+                                  EdgePair *edges, uint64_t max_edges)
+{
+    return get_edges(index, end, get_channel(sig_index), edges, max_edges);
+}
+
+uint64_t LogicSnapshot::get_edges(uint64_t &index, uint64_t end, ChannelHandle ch,
+                                  EdgePair *edges, uint64_t max_edges)
+{
+    uint64_t count = 0;
+
+    end = min(end, get_sample_count());
+    if (!ch.valid() || max_edges == 0)
+        return 0;
+
+    // sample 0 has no previous sample
+    if (index == 0)
+        index = 1;
+
+    while (index < end && count < max_edges) {
+        const uint64_t root_index = index >> (LeafBlockPower + RootScalePower);
+        const uint64_t root_pos = (index & RootMask) >> LeafBlockPower;
+        const uint64_t cur_tog = _ch_data[ch.order][root_index].tog & (~0ULL << root_pos);
+
+        if (cur_tog == 0) {
+            // no edge left in this root node
+            index = (root_index + 1) << (LeafBlockPower + RootScalePower);
+            continue;
+        }
+
+        const uint64_t pos = bsf_folded(cur_tog);
+        const uint64_t block_start = (root_index << (LeafBlockPower + RootScalePower)) +
+                                     (pos << LeafBlockPower);
+        if (block_start >= end)
+            break;
+
+        // constant blocks equal the last sample before them, so the
+        // blocks skipped above carry no edge
+        index = max(index, block_start);
+        const uint64_t block_end = min(block_start + LeafBlockSamples, end);
+        const bool last_sample = (block_start == 0) ? false : get_sample(block_start - 1, ch);
+        const uint64_t *lbp = (const uint64_t *)_ch_data[ch.order][root_index].lbp[pos];
+
+        count += block_edges(lbp, block_start, index, block_end, last_sample,
+                             edges + count, max_edges - count);
+    }
+
+    index = min(index, end);
+    return count;
+}
+
+bool LogicSnapshot::get_leaf_stats(ChannelHandle ch, uint64_t leaf, LeafStats &stats)
+{
+    if (!ch.valid() || ((leaf + 1) << LeafBlockPower) > get_sample_count())
+        return false;
+
+    struct RootNode &rn = _ch_data[ch.order][leaf >> RootScalePower];
+    const uint64_t pos = leaf & (RootScale - 1);
+
+    // a freed block is at one level, one summary serves all of them
+    if (rn.lbp[pos] == NULL) {
+        static const LeafStats level_stats[2] = {
+            LeafStats::from_level(false, LeafBlockSamples / Scale),
+            LeafStats::from_level(true, LeafBlockSamples / Scale)
+        };
+        stats = level_stats[(rn.value >> pos) & 1];
+        return true;
+    }
+
+    // made on the first query, calc_mipmap() keeps the collect thread
+    // to the constant work per word
+    {
+        std::lock_guard<std::mutex> lock(_stats_mutex);
+        if (rn.stats_done & (1ULL << pos)) {
+            stats = rn.stats[pos];
+            return true;
+        }
+    }
+    stats = LeafStats::from_words((const uint64_t *)rn.lbp[pos], LeafBlockSamples / Scale);
+
+    std::lock_guard<std::mutex> lock(_stats_mutex);
+    rn.stats[pos] = stats;
+    rn.stats_done |= 1ULL << pos;
+    return true;
+}
+
+uint64_t LogicSnapshot::get_data_digest(ChannelHandle ch)
+{
+    const uint64_t sample_count = get_sample_count();
+    const uint64_t leaf_count = sample_count >> LeafBlockPower;
+    uint64_t digest = 14695981039346656037ULL;   // FNV-1a
+    auto add = [&digest](uint64_t value) {
+        for (int i = 0; i < 8; i++) {
+            digest ^= (value >> (i * 8)) & 0xff;
+            digest *= 1099511628211ULL;
+        }
+    };
+
+    add(sample_count);
+    if (!ch.valid() || sample_count == 0)
+        return digest;
+
+    LeafStats stats;
+    for (uint64_t leaf = 0; leaf < leaf_count; leaf++) {
+        get_leaf_stats(ch, leaf, stats);
+        add(stats.edges);
+        add(stats.rising);
+        add(stats.high);
+        add(stats.first_edge);
+        add(stats.last_edge);
+        add(stats.first);
+        add(stats.hash);
+    }
+
+    uint64_t index = leaf_count << LeafBlockPower;
+    if (index < sample_count) {
+        EdgePair edges[1024];
+        uint64_t cnt;
+
+        add(get_sample(index, ch));
+        do {
+            cnt = get_edges(index, sample_count, ch, edges, 1024);
+            for (uint64_t i = 0; i < cnt; i++)
+                add(edges[i].first);
+        } while (cnt == 1024);
+    }
+
+    return digest;
+}
+
+uint64_t LogicSnapshot::block_edges(const uint64_t *lbp, uint64_t block_start, uint64_t &index,
+                                    uint64_t end, bool last_sample, EdgePair *edges, uint64_t max_edges)
+{
+    uint64_t count = 0;
+    uint64_t word = (index - block_start) >> ScalePower;
+    const uint64_t last_word = (end - 1 - block_start) >> ScalePower;
+
+    while (word <= last_word) {
+        // level 1 marks the words that differ from the sample before them
+        uint64_t mark = *(lbp + LevelOffset[1] + (word >> ScalePower)) & (~0ULL << (word & LevelMask[0]));
+        if (mark == 0) {
+            // level 2 marks the level 1 words which are not zero
+            uint64_t group = (word >> ScalePower) + 1;
+            if (group & LevelMask[0]) {
+                const uint64_t mark2 = *(lbp + LevelOffset[2] + (group >> ScalePower)) &
+                                       (~0ULL << (group & LevelMask[0]));
+                if (mark2 != 0)
+                    group = (group & ~LevelMask[0]) + bsf_folded(mark2);
+                else
+                    group = ((group >> ScalePower) + 1) << ScalePower;
+            }
+            word = group << ScalePower;
+            continue;
+        }
+
+        word = (word & ~LevelMask[0]) + bsf_folded(mark);
+        if (word > last_word)
+            break;
+
+        const uint64_t sample = *(lbp + word);
+        const uint64_t pre = (word == 0) ? (last_sample ? 1ULL : 0ULL) : (*(lbp + word - 1) >> (Scale - 1));
+        uint64_t tog = sample ^ ((sample << 1) | pre);
+
+        // trim the edges outside [index, end)
+        const uint64_t word_start = block_start + (word << ScalePower);
+        if (index > word_start)
+            tog &= ~0ULL << (index - word_start);
+        if (end - word_start < Scale)
+            tog &= ~(~0ULL << (end - word_start));
+
+        while (tog != 0) {
+            const uint64_t bit = bsf_folded(tog);
+            if (count == max_edges) {
+                index = word_start + bit;
+                return count;
+            }
+            edges[count++] = EdgePair(word_start + bit, (sample >> bit) & 1);
+            tog &= tog - 1;
+        }
+        word++;
+        index = max(index, block_start + (word << ScalePower));
+    }
+
+    index = end;
+    return count;
+}
+
 bool LogicSnapshot::pattern_search(int64_t start, int64_t end, int64_t &index,
                     std::map<uint16_t, QString> pattern, bool isNext)
 {
@@ -901,7 +1328,7 @@ bool LogicSnapshot::pattern_search(int64_t start, int64_t end, int64_t &index,
   
     char flagList[CHANNEL_MAX_COUNT];
     char lstValues[CHANNEL_MAX_COUNT];
-    int  chanIndexs[CHANNEL_MAX_COUNT];
+    ChannelHandle chans[CHANNEL_MAX_COUNT];
     int  count = 0;  
     bool bEdgeFlag = false;
 
@@ -914,7 +1341,7 @@ bool LogicSnapshot::pattern_search(int64_t start, int64_t end, int64_t &index,
 
          if (flag != 'X' && has_data(channel)){
              flagList[count]  = flag;
-             chanIndexs[count] = channel;
+             chans[count] = get_channel(channel);
              count++;
 
              if (flag == 'R' || flag == 'F' || flag == 'C'){
@@ -934,7 +1361,7 @@ bool LogicSnapshot::pattern_search(int64_t start, int64_t end, int64_t &index,
     //get first edge values
     if (bEdgeFlag){
         for (int i=0; i < count; i++){
-            lstValues[i] =  (char)get_sample(index, chanIndexs[i]);
+            lstValues[i] =  (char)get_sample(index, chans[i]);
         }
         index += step;
     }
@@ -945,7 +1372,7 @@ bool LogicSnapshot::pattern_search(int64_t start, int64_t end, int64_t &index,
 
         for (int i = 0; i < count; i++)
         {
-            val = (char)get_sample(index, chanIndexs[i]);
+            val = (char)get_sample(index, chans[i]);
 
             if (flagList[i] == '0')
             {
@@ -1039,19 +1466,37 @@ uint8_t *LogicSnapshot::get_block_buf(int block_index, int sig_index, bool &samp
     return lbp;
 }
 
-int LogicSnapshot::get_ch_order(int sig_index)
+void LogicSnapshot::append_channel_data(int sig_index)
 {
-    uint16_t order = 0;
-    for (auto& iter:_ch_index) {
-        if (iter == sig_index)
-            break;
-        order++;
+    uint64_t rootnode_size = (_total_sample_count + RootNodeSamples - 1) / RootNodeSamples;
+    std::vector<struct RootNode> root_vector;
+    for (uint64_t j = 0; j < rootnode_size; j++) {
+        struct RootNode rn;
+        rn.tog = 0;
+        rn.value = 0;
+        memset(rn.lbp, 0, sizeof(rn.lbp));
+        memset(rn.stats, 0, sizeof(rn.stats));
+        rn.stats_done = 0;
+        root_vector.push_back(rn);
     }
+    _ch_data.push_back(root_vector);
+    _ch_index.push_back(sig_index);
+}
 
-    if (order >= _ch_index.size())
-        return -1;
-    else
-        return order;
+void LogicSnapshot::build_ch_order()
+{
+    int max_index = -1;
+    for (auto index : _ch_index)
+        max_index = max(max_index, (int)index);
+
+    _ch_order.assign(max_index + 1, -1);
+    for (unsigned int i = 0; i < _ch_index.size(); i++) {
+        // the free slot of a removed virtual channel
+        if (i >= _channel_num && i - _channel_num < _virtual.size() &&
+            _virtual[i - _channel_num] == NULL)
+            continue;
+        _ch_order[_ch_index[i]] = i;
+    }
 }
 
 } // namespace data
@@ -26,8 +26,12 @@
 
 #include <libsigrok.h> 
 #include "snapshot.h"
+#include "virtualchannel.h"
+#include "leafstats.h"
+#include "crosssplit.h"
 #include <QString>
 #include <utility>
+#include <algorithm>
 #include <vector>
 #include <map>
 
@@ -44,7 +48,16 @@ class LongPulses;
 namespace pv {
 namespace data {
 
-class LogicSnapshot : public Snapshot
+//Called from the collect thread when a block of a channel is complete,
+//data is valid only during the call
+class ILogicBlockListener
+{
+public:
+    virtual void OnLogicBlock(int probe_index, uint64_t start_sample,
+                              uint64_t sample_count, const void *data)=0;
+};
+
+class LogicSnapshot : public Snapshot, public IWordSource
 {
 private:
     static const uint64_t ScaleLevel = 4;
@@ -65,17 +78,35 @@ private:
     static const uint64_t LevelMask[ScaleLevel];
     static const uint64_t LevelOffset[ScaleLevel];
 
+public:
+    // virtual channels take the probe indexes from here
+    static const int VirtualIndexBase = 100;
+
 private:
     struct RootNode
     {
         uint64_t tog;
         uint64_t value;
         void *lbp[Scale];
+        struct LeafStats stats[Scale];
+        uint64_t stats_done;    // leaves with a summary in stats
     };
 
 public:
     typedef std::pair<uint64_t, bool> EdgePair;
 
+    //A channel resolved by get_channel(), it stays valid until the channel
+    //layout changes (first_payload() with other channels, clear()), a
+    //removed virtual channel keeps the orders of the others
+    struct ChannelHandle
+    {
+        int order;
+
+        inline bool valid() const{
+            return order >= 0;
+        }
+    };
+
 private:
     void init_all();
 
@@ -92,12 +123,61 @@ public:
 
     void first_payload(const sr_datafeed_logic &logic, uint64_t total_sample_count, GSList *channels);
 
+    // bytes needed by a capture, before the constant blocks are trimmed
+    static uint64_t get_memory_size(uint64_t total_sample_count, unsigned int channel_num);
+
+    inline static uint64_t get_block_samples(){
+        return LeafBlockSamples;
+    }
+
+    inline void set_block_listener(ILogicBlockListener *listener){
+        _block_listener = listener;
+    }
+
+    inline static bool is_virtual_index(int sig_index){
+        return sig_index >= VirtualIndexBase;
+    }
+
+    // Takes the channel, its blocks are computed when the blocks of the
+    // sources are complete, at once for the data already captured
+    void add_virtual_channel(VirtualChannel *vch);
+    void remove_virtual_channel(int sig_index);
+
+    // without the free slots of removed channels
+    std::vector<VirtualChannel*> get_virtual_channels();
+
 	void append_payload(const sr_datafeed_logic &logic);
 
     const uint8_t * get_samples(uint64_t start_sample, uint64_t& end_sample, int sig_index);
 
     bool get_sample(uint64_t index, int sig_index);
 
+    inline ChannelHandle get_channel(int sig_index){
+        ChannelHandle ch;
+        ch.order = get_ch_order(sig_index);
+        return ch;
+    }
+
+    const uint8_t * get_samples(uint64_t start_sample, uint64_t& end_sample, ChannelHandle ch);
+
+    // no lookup and no check, ch must be valid
+    inline bool get_sample(uint64_t index, ChannelHandle ch)
+    {
+        if (index >= sample_count())
+            return false;
+
+        const uint64_t root_index = index >> (LeafBlockPower + RootScalePower);
+        const uint8_t root_pos = (index & RootMask) >> LeafBlockPower;
+        const uint64_t root_pos_mask = 1ULL << root_pos;
+        const struct RootNode &rn = _ch_data[ch.order][root_index];
+
+        if ((rn.tog & root_pos_mask) == 0)
+            return (rn.value & root_pos_mask) != 0;
+
+        const uint64_t *lbp = (const uint64_t *)rn.lbp[root_pos];
+        return (*(lbp + ((index & LeafMask) >> ScalePower)) >> (index & LevelMask[0])) & 1;
+    }
+
     void capture_ended();
 
     bool get_display_edges(std::vector<std::pair<bool, bool>> &edges,
@@ -109,9 +189,32 @@ public:
     bool get_nxt_edge(uint64_t &index, bool last_sample, uint64_t end,
                       double min_length, int sig_index);
 
+    bool get_nxt_edge(uint64_t &index, bool last_sample, uint64_t end,
+                      double min_length, ChannelHandle ch);
+
     bool get_pre_edge(uint64_t &index, bool last_sample,
                       double min_length, int sig_index);
 
+    bool get_pre_edge(uint64_t &index, bool last_sample,
+                      double min_length, ChannelHandle ch);
+
+    // Fill edges with the transitions in [index, end), an edge at sample n
+    // means sample n differs from sample n - 1, the bool is the new level.
+    // Returns the number of edges stored, at most max_edges, and moves index
+    // so that the next call continues after the last stored edge.
+    uint64_t get_edges(uint64_t &index, uint64_t end, ChannelHandle ch,
+                       EdgePair *edges, uint64_t max_edges);
+
+    uint64_t get_edges(uint64_t &index, uint64_t end, int sig_index,
+                       EdgePair *edges, uint64_t max_edges);
+
+    // only leaves which are completely captured have a summary
+    bool get_leaf_stats(ChannelHandle ch, uint64_t leaf, LeafStats &stats);
+
+    // fingerprint of the channel data, from the leaf summaries (with the
+    // content hash of each leaf) and the edges of the last unfinished leaf
+    uint64_t get_data_digest(ChannelHandle ch);
+
     bool has_data(int sig_index);
     int get_block_num();
     uint64_t get_block_size(int block_index);
@@ -121,8 +224,22 @@ public:
                         std::map<uint16_t, QString> pattern, bool isNext);
 
 private:
-    int get_ch_order(int sig_index);
+    inline int get_ch_order(int sig_index){
+        if (sig_index < 0 || sig_index >= (int)_ch_order.size())
+            return -1;
+        return _ch_order[sig_index];
+    }
+
+    void build_ch_order();
+    void append_channel_data(int sig_index);
     void calc_mipmap(unsigned int order, uint8_t index0, uint8_t index1, uint64_t samples);
+    void block_finished(unsigned int order, uint64_t index0, uint64_t index1, uint64_t samples);
+
+    void update_virtual();
+    void compute_virtual_leaf(unsigned int i, uint64_t leaf);
+
+    //IWordSource
+    uint64_t GetSourceWord(int sig_index, uint64_t word_index);
 
     void append_cross_payload(const sr_datafeed_logic &logic);
     void append_split_payload(const sr_datafeed_logic &logic);
@@ -131,9 +248,12 @@ private:
                         unsigned int min_level);
 
     bool block_pre_edge(uint64_t *lbp, uint64_t &index, bool last_sample,
-                        unsigned int min_level, int sig_index);
+                        unsigned int min_level, ChannelHandle ch);
+
+    uint64_t block_edges(const uint64_t *lbp, uint64_t block_start, uint64_t &index,
+                         uint64_t end, bool last_sample, EdgePair *edges, uint64_t max_edges);
 
-    inline uint64_t bsf_folded (uint64_t bb)
+    static inline uint64_t bsf_folded (uint64_t bb)
     {
         static const int lsb_64_table[64] = {
             63, 30,  3, 32, 59, 14, 11, 33,
@@ -151,7 +271,15 @@ private:
         return lsb_64_table[folded * 0x78291ACF >> 26];
     }
 
-    inline int bsr32(uint32_t bb)
+    static inline uint64_t popcnt64(uint64_t bb)
+    {
+        bb = bb - ((bb >> 1) & 0x5555555555555555ULL);
+        bb = (bb & 0x3333333333333333ULL) + ((bb >> 2) & 0x3333333333333333ULL);
+        bb = (bb + (bb >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return (bb * 0x0101010101010101ULL) >> 56;
+    }
+
+    static inline int bsr32(uint32_t bb)
     {
         static const char msb_256_table[256] = {
             0, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3,
@@ -178,7 +306,7 @@ private:
        return (result + msb_256_table[bb]);
     }
 
-    inline uint64_t bsr64(uint64_t bb)
+    static inline uint64_t bsr64(uint64_t bb)
     {
         const uint32_t hb = bb >> 32;
         return hb ? 32 + bsr32((uint32_t)hb) : bsr32((uint32_t)bb);
@@ -186,16 +314,26 @@ private:
 
 private:
     std::vector<std::vector<struct RootNode>> _ch_data;
+    std::vector<int> _ch_order; // probe index -> order in _ch_data, -1 if none
     uint64_t _block_num;
     uint8_t _byte_fraction;
     uint16_t _ch_fraction;
     void *_src_ptr;
     void *_dest_ptr;
+    ILogicBlockListener *_block_listener;
+    CrossSplit::Kernel _cross_kernel;
+    std::mutex _stats_mutex;    // stats and stats_done of the root nodes
 
     std::vector<uint64_t> _sample_cnt;
     std::vector<uint64_t> _block_cnt;
     std::vector<uint64_t> _ring_sample_cnt;
     std::vector<uint64_t> _last_sample;
+    std::vector<uint64_t> _leaf_done;  // complete leaves of each captured channel
+
+    // virtual channels follow the captured channels in _ch_data, a
+    // removed one leaves a NULL slot until the layout is made again
+    std::vector<VirtualChannel*> _virtual;
+    uint64_t _virtual_leaf;
 
     int _times;
  
@@ -204,6 +342,9 @@ private:
 	friend class LogicSnapshotTest::LargeData;
 	friend class LogicSnapshotTest::Pulses;
 	friend class LogicSnapshotTest::LongPulses;
+
+    friend class CaptureDiff;
+    friend class RangeStats;
 };
 
 } // namespace data
@@ -0,0 +1,403 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "mathfilter.h"
+
+#include <assert.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+#define PI 3.14159265358979323846
+
+using namespace std;
+
+namespace pv {
+namespace data {
+
+MathFilter::MathFilter() :
+    _samplerate(0),
+    _fft_size(0),
+    _fft_buf(NULL),
+    _fft_spec(NULL),
+    _kernel_spec(NULL),
+    _fft_fwd(NULL),
+    _fft_inv(NULL),
+    _ring_pos(0),
+    _sum(0)
+{
+    Params params;
+    params.type = FILTER_AVERAGE;
+    params.window = WINDOW_HAMMING;
+    params.length = 8;
+    params.cutoff = 0;
+    set_params(params);
+}
+
+MathFilter::~MathFilter()
+{
+    free_fft();
+}
+
+void MathFilter::free_fft()
+{
+    if (_fft_fwd)
+        fftw_destroy_plan(_fft_fwd);
+    if (_fft_inv)
+        fftw_destroy_plan(_fft_inv);
+    if (_fft_buf)
+        fftw_free(_fft_buf);
+    if (_fft_spec)
+        fftw_free(_fft_spec);
+    if (_kernel_spec)
+        fftw_free(_kernel_spec);
+
+    _fft_fwd = NULL;
+    _fft_inv = NULL;
+    _fft_buf = NULL;
+    _fft_spec = NULL;
+    _kernel_spec = NULL;
+    _fft_size = 0;
+}
+
+void MathFilter::set_params(const Params &params)
+{
+    _params = params;
+    _samplerate = 0;
+    _taps.clear();
+    _history.clear();
+    _block.clear();
+    _sections.clear();
+    _ring.clear();
+    _sorted.clear();
+    free_fft();
+
+    switch (_params.type) {
+    case FILTER_FIR:
+        // odd, so the delay is a whole number of samples
+        _params.length = max(3, min(_params.length, (int)MaxTaps)) | 1;
+        _taps.resize(_params.length);
+        _history.resize(_params.length - 1);
+        if (_params.length > OverlapSaveTaps) {
+            // the plans are made here, not with each new samplerate
+            _fft_size = 1;
+            while (_fft_size < 4 * _params.length)
+                _fft_size <<= 1;
+            const int bins = _fft_size / 2 + 1;
+            _fft_buf = fftw_alloc_real(_fft_size);
+            _fft_spec = fftw_alloc_complex(bins);
+            _kernel_spec = fftw_alloc_complex(bins);
+            _fft_fwd = fftw_plan_dft_r2c_1d(_fft_size, _fft_buf, _fft_spec, FFTW_ESTIMATE);
+            _fft_inv = fftw_plan_dft_c2r_1d(_fft_size, _fft_spec, _fft_buf, FFTW_ESTIMATE);
+        } else {
+            _block.resize(_history.size() + BlockSize);
+        }
+        break;
+    case FILTER_IIR:
+        _params.length = max(1, min(_params.length, (int)MaxOrder));
+        break;
+    default:
+        _params.length = max(2, min(_params.length, (int)MaxWindow));
+        _ring.resize(_params.length);
+        _sorted.resize(_params.length);
+        break;
+    }
+
+    reset(0);
+}
+
+const MathFilter::Params& MathFilter::get_params()
+{
+    return _params;
+}
+
+double MathFilter::get_samplerate()
+{
+    return _samplerate;
+}
+
+bool MathFilter::design(double samplerate)
+{
+    if (samplerate <= 0)
+        return false;
+
+    if (_params.type == FILTER_FIR || _params.type == FILTER_IIR) {
+        if (_params.cutoff <= 0 || _params.cutoff >= samplerate / 2)
+            return false;
+        if (_params.type == FILTER_FIR)
+            design_fir(_params.cutoff / samplerate);
+        else
+            design_iir(_params.cutoff / samplerate);
+    }
+
+    _samplerate = samplerate;
+    return true;
+}
+
+void MathFilter::design_fir(double fc)
+{
+    const int taps = _params.length;
+    const double center = (taps - 1) / 2.0;
+    std::vector<double> h(taps);
+    double sum = 0;
+
+    for (int k = 0; k < taps; k++) {
+        const double x = k - center;
+        double v = (x == 0) ? 2 * fc : sin(2 * PI * fc * x) / (PI * x);
+
+        const double phase = 2 * PI * k / (taps - 1);
+        switch (_params.window) {
+        case WINDOW_HANN:
+            v *= 0.5 - 0.5 * cos(phase);
+            break;
+        case WINDOW_HAMMING:
+            v *= 0.54 - 0.46 * cos(phase);
+            break;
+        case WINDOW_BLACKMAN:
+            v *= 0.42 - 0.5 * cos(phase) + 0.08 * cos(2 * phase);
+            break;
+        default:
+            break;
+        }
+        h[k] = v;
+        sum += v;
+    }
+
+    // unity gain for a constant input
+    for (int k = 0; k < taps; k++)
+        _taps[taps - 1 - k] = (float)(h[k] / sum);
+
+    if (_fft_fwd) {
+        memset(_fft_buf, 0, _fft_size * sizeof(double));
+        for (int k = 0; k < taps; k++)
+            _fft_buf[k] = h[k] / sum / _fft_size;
+        fftw_execute(_fft_fwd);
+        memcpy(_kernel_spec, _fft_spec, (_fft_size / 2 + 1) * sizeof(fftw_complex));
+    }
+}
+
+void MathFilter::add_biquad(double fc, double q)
+{
+    const double w0 = 2 * PI * fc;
+    const double alpha = sin(w0) / (2 * q);
+    const double a0 = 1 + alpha;
+
+    Biquad s;
+    s.b0 = (1 - cos(w0)) / 2 / a0;
+    s.b1 = (1 - cos(w0)) / a0;
+    s.b2 = s.b0;
+    s.a1 = -2 * cos(w0) / a0;
+    s.a2 = (1 - alpha) / a0;
+    s.z1 = 0;
+    s.z2 = 0;
+    _sections.push_back(s);
+}
+
+void MathFilter::add_first_order(double fc)
+{
+    const double k = tan(PI * fc);
+
+    Biquad s;
+    s.b0 = k / (1 + k);
+    s.b1 = s.b0;
+    s.b2 = 0;
+    s.a1 = (k - 1) / (k + 1);
+    s.a2 = 0;
+    s.z1 = 0;
+    s.z2 = 0;
+    _sections.push_back(s);
+}
+
+void MathFilter::design_iir(double fc)
+{
+    const int order = _params.length;
+    _sections.clear();
+
+    // the analog poles in pairs, each pair becomes one biquad
+    for (int k = 0; k < order / 2; k++) {
+        const double angle = PI * (2 * k + order + 1) / (2 * order);
+        add_biquad(fc, -1 / (2 * cos(angle)));
+    }
+    if (order & 1)
+        add_first_order(fc);
+}
+
+void MathFilter::reset(float value)
+{
+    fill(_history.begin(), _history.end(), value);
+
+    for (auto &s : _sections) {
+        s.z2 = (s.b2 - s.a2) * value;
+        s.z1 = (s.b1 - s.a1) * value + s.z2;
+    }
+
+    fill(_ring.begin(), _ring.end(), value);
+    fill(_sorted.begin(), _sorted.end(), value);
+    _ring_pos = 0;
+    _sum = (double)value * _ring.size();
+}
+
+void MathFilter::process(const float *in, float *out, uint64_t count)
+{
+    assert(in != out);
+
+    switch (_params.type) {
+    case FILTER_FIR:
+        if (_fft_fwd)
+            process_fir_fft(in, out, count);
+        else
+            process_fir(in, out, count);
+        break;
+    case FILTER_IIR:
+        process_iir(in, out, count);
+        break;
+    case FILTER_AVERAGE:
+        process_average(in, out, count);
+        break;
+    case FILTER_MEDIAN:
+        process_median(in, out, count);
+        break;
+    }
+}
+
+void MathFilter::process_fir(const float *in, float *out, uint64_t count)
+{
+    const int taps = (int)_taps.size();
+    const int keep = taps - 1;
+
+    for (uint64_t pos = 0; pos < count; pos += BlockSize) {
+        const int n = (int)min((uint64_t)BlockSize, count - pos);
+        float *const block = _block.data();
+        float *const dest = out + pos;
+
+        memcpy(block, _history.data(), keep * sizeof(float));
+        memcpy(block + keep, in + pos, n * sizeof(float));
+
+        // one tap over the whole block, the outputs do not depend on
+        // each other
+        memset(dest, 0, n * sizeof(float));
+        for (int j = 0; j < taps; j++) {
+            const float t = _taps[j];
+            const float *const src = block + j;
+            for (int i = 0; i < n; i++)
+                dest[i] += t * src[i];
+        }
+
+        memcpy(_history.data(), block + n, keep * sizeof(float));
+    }
+}
+
+void MathFilter::process_fir_fft(const float *in, float *out, uint64_t count)
+{
+    const int keep = (int)_history.size();
+    const int step = _fft_size - keep;
+    const int bins = _fft_size / 2 + 1;
+
+    for (uint64_t pos = 0; pos < count; pos += step) {
+        const int n = (int)min((uint64_t)step, count - pos);
+
+        for (int i = 0; i < keep; i++)
+            _fft_buf[i] = _history[i];
+        for (int i = 0; i < n; i++)
+            _fft_buf[keep + i] = in[pos + i];
+        for (int i = keep + n; i < _fft_size; i++)
+            _fft_buf[i] = 0;
+
+        fftw_execute(_fft_fwd);
+        for (int i = 0; i < bins; i++) {
+            const double re = _fft_spec[i][0] * _kernel_spec[i][0] - _fft_spec[i][1] * _kernel_spec[i][1];
+            const double im = _fft_spec[i][0] * _kernel_spec[i][1] + _fft_spec[i][1] * _kernel_spec[i][0];
+            _fft_spec[i][0] = re;
+            _fft_spec[i][1] = im;
+        }
+        fftw_execute(_fft_inv);
+
+        // the first outputs wrapped around, the kernel is scaled by the size
+        for (int i = 0; i < n; i++)
+            out[pos + i] = (float)_fft_buf[keep + i];
+
+        if (n >= keep) {
+            memcpy(_history.data(), in + pos + n - keep, keep * sizeof(float));
+        } else {
+            memmove(_history.data(), _history.data() + n, (keep - n) * sizeof(float));
+            memcpy(_history.data() + keep - n, in + pos, n * sizeof(float));
+        }
+    }
+}
+
+void MathFilter::process_iir(const float *in, float *out, uint64_t count)
+{
+    if (_sections.empty()) {
+        memcpy(out, in, count * sizeof(float));
+        return;
+    }
+
+    // section by section, each one runs over the whole chunk
+    const float *src = in;
+    for (auto &s : _sections) {
+        double z1 = s.z1;
+        double z2 = s.z2;
+        for (uint64_t i = 0; i < count; i++) {
+            const double x = src[i];
+            const double y = s.b0 * x + z1;
+            z1 = s.b1 * x - s.a1 * y + z2;
+            z2 = s.b2 * x - s.a2 * y;
+            out[i] = (float)y;
+        }
+        s.z1 = z1;
+        s.z2 = z2;
+        src = out;
+    }
+}
+
+void MathFilter::process_average(const float *in, float *out, uint64_t count)
+{
+    const unsigned int n = (unsigned int)_ring.size();
+
+    for (uint64_t i = 0; i < count; i++) {
+        _sum += (double)in[i] - _ring[_ring_pos];
+        _ring[_ring_pos] = in[i];
+        if (++_ring_pos == n)
+            _ring_pos = 0;
+        out[i] = (float)(_sum / n);
+    }
+}
+
+void MathFilter::process_median(const float *in, float *out, uint64_t count)
+{
+    const unsigned int n = (unsigned int)_ring.size();
+
+    for (uint64_t i = 0; i < count; i++) {
+        // the window is kept sorted, the oldest sample leaves it
+        auto old = lower_bound(_sorted.begin(), _sorted.end(), _ring[_ring_pos]);
+        _sorted.erase(old);
+        _sorted.insert(upper_bound(_sorted.begin(), _sorted.end(), in[i]), in[i]);
+
+        _ring[_ring_pos] = in[i];
+        if (++_ring_pos == n)
+            _ring_pos = 0;
+
+        out[i] = (n & 1) ? _sorted[n / 2] : (_sorted[n / 2 - 1] + _sorted[n / 2]) / 2;
+    }
+}
+
+} // namespace data
+} // namespace pv
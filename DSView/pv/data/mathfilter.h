@@ -0,0 +1,139 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef DSVIEW_PV_DATA_MATHFILTER_H
+#define DSVIEW_PV_DATA_MATHFILTER_H
+
+#include <stdint.h>
+#include <vector>
+
+#include <fftw3.h>
+
+namespace pv {
+namespace data {
+
+//A low pass filter which keeps its state between the calls of process(),
+//so a stream of samples can be filtered chunk by chunk. The samples are
+//floats, the IIR sections and the moving sum keep double state.
+//The FIR filter convolves blocks of samples with the taps in the inner
+//loop so the compiler can vectorize it, long kernels are applied in the
+//frequency domain by overlap-save instead.
+class MathFilter
+{
+public:
+    enum FilterType {
+        FILTER_FIR,         // windowed sinc
+        FILTER_IIR,         // Butterworth, cascaded biquads
+        FILTER_AVERAGE,     // moving average
+        FILTER_MEDIAN,      // moving median
+    };
+
+    enum WindowType {
+        WINDOW_RECTANGLE,
+        WINDOW_HANN,
+        WINDOW_HAMMING,
+        WINDOW_BLACKMAN,
+    };
+
+    struct Params
+    {
+        int type;
+        int window;         // FIR only
+        int length;         // FIR taps, IIR order, moving filter samples
+        double cutoff;      // Hz, FIR and IIR only
+    };
+
+    static const int MaxTaps = 1023;
+    static const int MaxOrder = 16;
+    static const int MaxWindow = 1023;
+    static const int OverlapSaveTaps = 64;  // longer kernels use the FFT
+    static const int BlockSize = 1024;
+
+private:
+    struct Biquad
+    {
+        double b0, b1, b2;
+        double a1, a2;
+        double z1, z2;
+    };
+
+public:
+    MathFilter();
+    ~MathFilter();
+
+    // the length is limited to the range of the type
+    void set_params(const Params &params);
+    const Params& get_params();
+
+    // returns false when the cutoff is not below half the samplerate
+    bool design(double samplerate);
+    double get_samplerate();
+
+    // starts again as after a constant input of value
+    void reset(float value);
+
+    void process(const float *in, float *out, uint64_t count);
+
+private:
+    void design_fir(double fc);
+    void design_iir(double fc);
+    void add_biquad(double fc, double q);
+    void add_first_order(double fc);
+
+    void process_fir(const float *in, float *out, uint64_t count);
+    void process_fir_fft(const float *in, float *out, uint64_t count);
+    void process_iir(const float *in, float *out, uint64_t count);
+    void process_average(const float *in, float *out, uint64_t count);
+    void process_median(const float *in, float *out, uint64_t count);
+
+    void free_fft();
+
+private:
+    Params _params;
+    double _samplerate;
+
+    // fir, the taps in reverse order and the last taps-1 inputs
+    std::vector<float> _taps;
+    std::vector<float> _history;
+    std::vector<float> _block;
+
+    // overlap-save
+    int _fft_size;
+    double *_fft_buf;
+    fftw_complex *_fft_spec;
+    fftw_complex *_kernel_spec;
+    fftw_plan _fft_fwd;
+    fftw_plan _fft_inv;
+
+    // iir
+    std::vector<Biquad> _sections;
+
+    // moving average and median, the window as a ring
+    std::vector<float> _ring;
+    std::vector<float> _sorted;
+    unsigned int _ring_pos;
+    double _sum;
+};
+
+} // namespace data
+} // namespace pv
+
+#endif // DSVIEW_PV_DATA_MATHFILTER_H
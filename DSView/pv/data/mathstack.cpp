@@ -86,9 +86,18 @@ MathStack::MathStack(pv::SigSession *session,
     _total_sample_num(0),
     _math_state(Init),
     _envelope_en(false),
-    _envelope_done(false)
+    _envelope_done(false),
+    _filter_ok(false),
+    _filter_pos(0),
+    _filter_scale(0),
+    _filter_delta(0)
 {
     memset(_envelope_level, 0, sizeof(_envelope_level));
+
+    if (is_filter()) {
+        MathFilter::Params params = _filter.get_params();
+        set_filter(params);
+    }
 }
 
 MathStack::~MathStack()
@@ -117,6 +126,7 @@ void MathStack::init()
 
     _sample_num = 0;
     _envelope_done = false;
+    _filter_pos = 0;
 }
 
 MathStack::MathType MathStack::get_type()
@@ -124,6 +134,40 @@ MathStack::MathType MathStack::get_type()
     return _type;
 }
 
+bool MathStack::is_filter()
+{
+    return _type == MATH_FIR || _type == MATH_IIR ||
+           _type == MATH_AVERAGE || _type == MATH_MEDIAN;
+}
+
+void MathStack::set_filter(const MathFilter::Params &params)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    MathFilter::Params p = params;
+    switch(_type) {
+    case MATH_FIR:
+        p.type = MathFilter::FILTER_FIR;
+        break;
+    case MATH_IIR:
+        p.type = MathFilter::FILTER_IIR;
+        break;
+    case MATH_MEDIAN:
+        p.type = MathFilter::FILTER_MEDIAN;
+        break;
+    default:
+        p.type = MathFilter::FILTER_AVERAGE;
+        break;
+    }
+    _filter.set_params(p);
+    _filter_pos = 0;
+}
+
+MathFilter::Params MathStack::get_filter()
+{
+    return _filter.get_params();
+}
+
 uint64_t MathStack::get_sample_num()
 {
     return _sample_num;
@@ -164,6 +208,10 @@ uint64_t MathStack::default_vDialValue()
     switch(_type) {
     case MATH_ADD:
     case MATH_SUB:
+    case MATH_FIR:
+    case MATH_IIR:
+    case MATH_AVERAGE:
+    case MATH_MEDIAN:
         value = max(dial1_value, dial2_value);
         break;
     case MATH_MUL:
@@ -198,6 +246,10 @@ view::dslDial * MathStack::get_vDial()
     switch(_type) {
     case MATH_ADD:
     case MATH_SUB:
+    case MATH_FIR:
+    case MATH_IIR:
+    case MATH_AVERAGE:
+    case MATH_MEDIAN:
         for (int i = 0; i < vDialValueCount; i++) {
             if (vDialValue[i] < min(dial1_min, dial2_min))
                 continue;
@@ -246,6 +298,10 @@ QString MathStack::get_unit(int level)
     switch(_type) {
     case MATH_ADD:
     case MATH_SUB:
+    case MATH_FIR:
+    case MATH_IIR:
+    case MATH_AVERAGE:
+    case MATH_MEDIAN:
         unit = vDialAddUnit[level];
         break;
     case MATH_MUL:
@@ -265,6 +321,10 @@ double MathStack::get_math_scale()
     switch(_type) {
     case MATH_ADD:
     case MATH_SUB:
+    case MATH_FIR:
+    case MATH_IIR:
+    case MATH_AVERAGE:
+    case MATH_MEDIAN:
         scale = 1.0 / DS_CONF_DSO_VDIVS;
         break;
     case MATH_MUL:
@@ -350,6 +410,14 @@ void MathStack::calc_math()
     _sample_num = snapshot->get_sample_count();
     assert(_sample_num <= _total_sample_num);
 
+    if (is_filter()) {
+        calc_filter(snapshot, scale1, delta1, index1);
+        if (_envelope_en)
+            append_to_envelope_level(true);
+        _math_state = Stopped;
+        return;
+    }
+
     double value1, value2;
     for (uint64_t sample = 0; sample < _sample_num; sample++) {
         value1 = value[sample * num_channels + index1];
@@ -367,6 +435,8 @@ void MathStack::calc_math()
         case MATH_DIV:
             _math[sample] = (delta1 - scale1 * value1) / (delta2 - scale2 * value2);
             break;
+        default:
+            break;
         }
     }
 
@@ -377,6 +447,51 @@ void MathStack::calc_math()
     _math_state = Stopped;
 }
 
+void MathStack::calc_filter(DsoSnapshot *snapshot, double scale, double delta, int index)
+{
+    const int num_channels = snapshot->get_channel_num();
+    const uint8_t *value = snapshot->get_samples(0, 0, 0) + index;
+    const double samplerate = _session->cur_snap_samplerate();
+
+    // the samples appended to an instant capture continue the stream,
+    // a new frame or new settings start it again
+    uint64_t start = _filter_pos;
+    if (!snapshot->is_instant() || start > _sample_num ||
+        scale != _filter_scale || delta != _filter_delta ||
+        samplerate != _filter.get_samplerate())
+        start = 0;
+
+    if (start == 0) {
+        if (samplerate != _filter.get_samplerate())
+            _filter_ok = _filter.design(samplerate);
+        _filter.reset(delta - scale * value[0]);
+    }
+
+    // a cutoff above the Nyquist frequency passes the samples unfiltered
+    const uint64_t chunk = 64 * MathFilter::BlockSize;
+    _filter_in.resize(chunk);
+    _filter_out.resize(chunk);
+    for (uint64_t pos = start; pos < _sample_num; pos += chunk) {
+        const uint64_t n = min(chunk, _sample_num - pos);
+        const uint8_t *src = value + pos * num_channels;
+        for (uint64_t i = 0; i < n; i++)
+            _filter_in[i] = (float)(delta - scale * src[i * num_channels]);
+
+        if (_filter_ok)
+            _filter.process(_filter_in.data(), _filter_out.data(), n);
+        else
+            memcpy(_filter_out.data(), _filter_in.data(), n * sizeof(float));
+
+        double *dest = _math.data() + pos;
+        for (uint64_t i = 0; i < n; i++)
+            dest[i] = _filter_out[i];
+    }
+
+    _filter_pos = _sample_num;
+    _filter_scale = scale;
+    _filter_delta = delta;
+}
+
 void MathStack::reallocate_envelope(Envelope &e)
 {
     const uint64_t new_data_length = ((e.length + EnvelopeDataUnit - 1) /
@@ -23,6 +23,7 @@
 #define DSVIEW_PV_DATA_MATHSTACK_H
 
 #include "signaldata.h"
+#include "mathfilter.h"
 
 #include <list>
 
@@ -62,6 +63,11 @@ public:
         MATH_SUB,
         MATH_MUL,
         MATH_DIV,
+        // filters of the first source
+        MATH_FIR,
+        MATH_IIR,
+        MATH_AVERAGE,
+        MATH_MEDIAN,
     };
 
     struct EnvelopeSample
@@ -112,8 +118,12 @@ public:
     void realloc(uint64_t num);
 
     MathType get_type();
+    bool is_filter();
     uint64_t get_sample_num();
 
+    void set_filter(const MathFilter::Params &params);
+    MathFilter::Params get_filter();
+
     void enable_envelope(bool enable);
 
     uint64_t default_vDialValue();
@@ -131,6 +141,9 @@ public:
 
 signals:
 
+private:
+    void calc_filter(DsoSnapshot *snapshot, double scale, double delta, int index);
+
 private:
     pv::SigSession  *_session;
     view::DsoSignal *_dsoSig1;
@@ -146,6 +159,15 @@ private:
 
     bool _envelope_en;
     bool _envelope_done;
+
+    // the samples of the snapshot filtered so far, and how
+    MathFilter _filter;
+    bool _filter_ok;
+    uint64_t _filter_pos;
+    double _filter_scale;
+    double _filter_delta;
+    std::vector<float> _filter_in;
+    std::vector<float> _filter_out;
 };
 
 } // namespace data
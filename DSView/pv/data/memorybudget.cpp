@@ -0,0 +1,205 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2013 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "memorybudget.h"
+
+#include <assert.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <sys/types.h>
+#include <sys/sysctl.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "../log.h"
+
+namespace pv {
+namespace data {
+
+namespace {
+    const uint64_t MB = 1024 * 1024;
+
+    void update_peak(std::atomic<uint64_t> &peak, uint64_t value)
+    {
+        uint64_t cur = peak.load();
+        while (value > cur && !peak.compare_exchange_weak(cur, value))
+            ;
+    }
+}
+
+MemoryBudget::MemoryBudget()
+{
+    for (int i = 0; i < PoolCount; i++) {
+        _used[i] = 0;
+        _peak[i] = 0;
+    }
+    _total = 0;
+    _total_peak = 0;
+    _budget = 0;
+}
+
+MemoryBudget& MemoryBudget::Instance()
+{
+    static MemoryBudget ins;
+    return ins;
+}
+
+void MemoryBudget::alloc(int pool, uint64_t bytes)
+{
+    assert(pool >= 0 && pool < PoolCount);
+
+    if (bytes == 0)
+        return;
+    update_peak(_peak[pool], _used[pool].fetch_add(bytes) + bytes);
+    update_peak(_total_peak, _total.fetch_add(bytes) + bytes);
+}
+
+void MemoryBudget::release(int pool, uint64_t bytes)
+{
+    assert(pool >= 0 && pool < PoolCount);
+
+    if (bytes == 0)
+        return;
+    assert(_used[pool] >= bytes);
+    _used[pool].fetch_sub(bytes);
+    _total.fetch_sub(bytes);
+}
+
+uint64_t MemoryBudget::used(int pool)
+{
+    assert(pool >= 0 && pool < PoolCount);
+    return _used[pool];
+}
+
+uint64_t MemoryBudget::peak(int pool)
+{
+    assert(pool >= 0 && pool < PoolCount);
+    return _peak[pool];
+}
+
+uint64_t MemoryBudget::total_used()
+{
+    return _total;
+}
+
+uint64_t MemoryBudget::total_peak()
+{
+    return _total_peak;
+}
+
+void MemoryBudget::reset_peak()
+{
+    for (int i = 0; i < PoolCount; i++)
+        _peak[i] = _used[i].load();
+    _total_peak = _total.load();
+}
+
+void MemoryBudget::set_budget(uint64_t bytes)
+{
+    _budget = bytes;
+}
+
+uint64_t MemoryBudget::get_budget()
+{
+    if (_budget != 0)
+        return _budget;
+
+    // leave a quarter of the machine to the system and the other programs
+    return get_physical_memory() / 4 * 3;
+}
+
+uint64_t MemoryBudget::get_physical_memory()
+{
+#ifdef _WIN32
+    MEMORYSTATUSEX status;
+    status.dwLength = sizeof(status);
+    if (GlobalMemoryStatusEx(&status))
+        return status.ullTotalPhys;
+    return 0;
+#elif defined(__APPLE__)
+    uint64_t size = 0;
+    size_t len = sizeof(size);
+    if (sysctlbyname("hw.memsize", &size, &len, NULL, 0) == 0)
+        return size;
+    return 0;
+#else
+    long pages = sysconf(_SC_PHYS_PAGES);
+    long page_size = sysconf(_SC_PAGESIZE);
+    if (pages > 0 && page_size > 0)
+        return (uint64_t)pages * (uint64_t)page_size;
+    return 0;
+#endif
+}
+
+bool MemoryBudget::admit(uint64_t need, uint64_t reusable)
+{
+    const uint64_t budget = get_budget();
+    if (budget == 0)
+        return true;
+
+    uint64_t total = _total;
+    total -= (reusable < total) ? reusable : total;
+
+    return need <= budget && total <= budget - need;
+}
+
+const char* MemoryBudget::pool_name(int pool)
+{
+    switch (pool) {
+    case PoolLogic:
+        return "logic";
+    case PoolDso:
+        return "dso";
+    case PoolAnalog:
+        return "analog";
+    case PoolAnnotation:
+        return "annotation";
+    case PoolResource:
+        return "annotation text";
+    case PoolReplay:
+        return "decoder record";
+    case PoolSpectrum:
+        return "fft";
+    }
+    return "unknown";
+}
+
+void MemoryBudget::log_usage(const char *title)
+{
+    dsv_info("%s: used %lluMB, peak %lluMB, budget %lluMB", title,
+        (unsigned long long)(_total / MB),
+        (unsigned long long)(_total_peak / MB),
+        (unsigned long long)(get_budget() / MB));
+
+    for (int i = 0; i < PoolCount; i++) {
+        if (_peak[i] == 0)
+            continue;
+        dsv_info("    %s: used %lluKB, peak %lluKB", pool_name(i),
+            (unsigned long long)(_used[i] / 1024),
+            (unsigned long long)(_peak[i] / 1024));
+    }
+}
+
+} // namespace data
+} // namespace pv
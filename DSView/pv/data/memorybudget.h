@@ -0,0 +1,88 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2013 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef DSVIEW_PV_DATA_MEMORYBUDGET_H
+#define DSVIEW_PV_DATA_MEMORYBUDGET_H
+
+#include <stdint.h>
+#include <atomic>
+
+namespace pv {
+namespace data {
+
+//Bytes held by the capture buffers and the decoder results, counted at
+//the places where they are allocated and released. It is safe to call
+//from any thread.
+class MemoryBudget
+{
+public:
+    enum Pool
+    {
+        PoolLogic = 0,  // logic leaves and their mipmaps
+        PoolDso,        // dso samples and envelopes
+        PoolAnalog,     // analog samples and envelopes
+        PoolAnnotation, // annotation objects
+        PoolResource,   // annotation strings, shared by the annotations
+        PoolReplay,     // recorded output of the bottom decoders
+        PoolSpectrum,   // fft buffers
+        PoolCount
+    };
+
+private:
+    MemoryBudget();
+
+public:
+    static MemoryBudget& Instance();
+
+    void alloc(int pool, uint64_t bytes);
+    void release(int pool, uint64_t bytes);
+
+    uint64_t used(int pool);
+    uint64_t peak(int pool);
+    uint64_t total_used();
+    uint64_t total_peak();
+    void reset_peak();
+
+    // the configured budget in bytes, 0 for automatic
+    void set_budget(uint64_t bytes);
+    // the budget in effect, 0 if there is no limit
+    uint64_t get_budget();
+    static uint64_t get_physical_memory();
+
+    // true if another need bytes fit in the budget, reusable is the
+    // part of the used memory which will be given back for them
+    bool admit(uint64_t need, uint64_t reusable);
+
+    static const char* pool_name(int pool);
+    void log_usage(const char *title);
+
+private:
+    std::atomic<uint64_t> _used[PoolCount];
+    std::atomic<uint64_t> _peak[PoolCount];
+    std::atomic<uint64_t> _total;
+    std::atomic<uint64_t> _total_peak;
+    std::atomic<uint64_t> _budget;
+};
+
+} // namespace data
+} // namespace pv
+
+#endif // DSVIEW_PV_DATA_MEMORYBUDGET_H
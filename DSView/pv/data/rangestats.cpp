@@ -0,0 +1,310 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2013 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "rangestats.h"
+#include "analogsnapshot.h"
+
+#include <assert.h>
+#include <math.h>
+#include <limits.h>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+namespace pv {
+namespace data {
+
+bool RangeStats::calc_logic(LogicSnapshot *snapshot, int sig_index, uint64_t start, uint64_t end,
+                            LogicResult &result, const std::atomic<bool> &cancel)
+{
+    assert(snapshot);
+
+    const uint64_t sample_count = snapshot->get_sample_count();
+    LogicSnapshot::ChannelHandle ch = snapshot->get_channel(sig_index);
+    if (!ch.valid() || sample_count == 0 || start > end)
+        return false;
+    end = min(end + 1, sample_count);
+    if (start >= end)
+        return false;
+
+    Summary total;
+    bool have_total = false;
+    uint64_t index = start;
+
+    while (index < end) {
+        if (cancel)
+            return false;
+
+        const uint64_t leaf = index >> LogicSnapshot::LeafBlockPower;
+        const uint64_t leaf_start = leaf << LogicSnapshot::LeafBlockPower;
+        const uint64_t leaf_end = leaf_start + LogicSnapshot::LeafBlockSamples;
+        Summary s;
+
+        if (index == leaf_start && leaf_end <= end) {
+            if (!leaf_summary(snapshot, ch, leaf, s, cancel))
+                return false;
+        } else {
+            if (!summarize(snapshot, ch, index, min(leaf_end, end), s, cancel))
+                return false;
+        }
+
+        if (have_total)
+            merge(total, s);
+        else
+            total = s;
+        have_total = true;
+        index = s.end;
+    }
+
+    result.samples = total.end - total.start;
+    result.high = total.high;
+    result.rising = total.rising;
+    result.falling = total.falling;
+    result.first_rising = total.first_rising;
+    result.last_rising = total.last_rising;
+    result.min_high = (total.min_high == UINT64_MAX) ? 0 : total.min_high;
+    result.max_high = total.max_high;
+    result.min_low = (total.min_low == UINT64_MAX) ? 0 : total.min_low;
+    result.max_low = total.max_low;
+
+    return true;
+}
+
+bool RangeStats::calc_analog(AnalogSnapshot *snapshot, int sig_index, int hw_offset,
+                             uint64_t start, uint64_t end, AnalogResult &result,
+                             const std::atomic<bool> &cancel)
+{
+    assert(snapshot);
+
+    const uint64_t sample_count = snapshot->get_sample_count();
+    const int order = snapshot->get_ch_order(sig_index);
+    if (order == -1 || sample_count == 0 || start > end)
+        return false;
+    end = min(end, sample_count - 1);
+    if (start > end)
+        return false;
+
+    const uint64_t ring_start = snapshot->get_ring_start();
+    const uint64_t stride = snapshot->get_unit_bytes() * snapshot->get_channel_num();
+    const uint8_t *base = snapshot->get_samples(0) + order * snapshot->get_unit_bytes();
+
+    const uint64_t block_samples = AnalogSnapshot::BlockStatsSamples;
+    const uint64_t last = end + 1;
+
+    int min_value = INT_MAX;
+    int max_value = INT_MIN;
+    double sum = 0;
+    double square_sum = 0;
+    uint64_t i = start;
+
+    while (i < last) {
+        if (cancel)
+            return false;
+
+        // whole blocks from the envelope and the block moments
+        const uint64_t block = i / block_samples;
+        AnalogSnapshot::BlockStats bs;
+        if (ring_start == 0 && (i % block_samples) == 0 && i + block_samples <= last &&
+            snapshot->get_block_stats(order, block, bs)) {
+            min_value = min(min_value, hw_offset - bs.max);
+            max_value = max(max_value, hw_offset - bs.min);
+            sum += (double)hw_offset * block_samples - bs.sum;
+            square_sum += (double)hw_offset * hw_offset * block_samples -
+                          2.0 * hw_offset * bs.sum + bs.square_sum;
+            i += block_samples;
+            continue;
+        }
+
+        // the raw samples at the ends of the range
+        const uint64_t next = min(last, (block + 1) * block_samples);
+        for (; i < next; i++) {
+            const uint64_t ring_index = (ring_start + i) % sample_count;
+            const int value = hw_offset - *(base + ring_index * stride);
+            min_value = min(min_value, value);
+            max_value = max(max_value, value);
+            sum += value;
+            square_sum += (double)value * value;
+        }
+    }
+
+    const double samples = end - start + 1;
+    result.min = min_value;
+    result.max = max_value;
+    result.mean = sum / samples;
+    result.rms = sqrt(square_sum / samples);
+
+    return true;
+}
+
+bool RangeStats::leaf_summary(LogicSnapshot *snapshot, LogicSnapshot::ChannelHandle ch,
+                              uint64_t leaf, Summary &s, const std::atomic<bool> &cancel)
+{
+    const uint64_t leaf_start = leaf << LogicSnapshot::LeafBlockPower;
+    const uint64_t leaf_end = leaf_start + LogicSnapshot::LeafBlockSamples;
+    LeafStats stats;
+
+    // summary kept by the snapshot for a complete block
+    if (!snapshot->get_leaf_stats(ch, leaf, stats))
+        return summarize(snapshot, ch, leaf_start, leaf_end, s, cancel);
+
+    s.start = leaf_start;
+    s.end = leaf_end;
+    s.first = stats.first;
+    s.last = stats.last;
+    s.high = stats.high;
+    s.rising = stats.rising;
+    s.falling = stats.edges - stats.rising;
+    s.first_edge = leaf_start + stats.first_edge;
+    s.last_edge = leaf_start + stats.last_edge;
+    s.first_rising = leaf_start + stats.first_rising;
+    s.last_rising = leaf_start + stats.last_rising;
+    s.min_high = (stats.min_high == UINT32_MAX) ? UINT64_MAX : stats.min_high;
+    s.max_high = stats.max_high;
+    s.min_low = (stats.min_low == UINT32_MAX) ? UINT64_MAX : stats.min_low;
+    s.max_low = stats.max_low;
+
+    return true;
+}
+
+bool RangeStats::summarize(LogicSnapshot *snapshot, LogicSnapshot::ChannelHandle ch,
+                           uint64_t start, uint64_t end, Summary &s, const std::atomic<bool> &cancel)
+{
+    std::vector<LogicSnapshot::EdgePair> edges(EdgeBatchSize);
+    uint64_t index = start + 1;
+    uint64_t pos = start;
+    uint64_t cnt;
+    bool level;
+
+    s.start = start;
+    s.end = end;
+    s.first = snapshot->get_sample(start, ch);
+    s.high = 0;
+    s.rising = 0;
+    s.falling = 0;
+    s.first_edge = 0;
+    s.last_edge = 0;
+    s.first_rising = 0;
+    s.last_rising = 0;
+    s.min_high = UINT64_MAX;
+    s.max_high = 0;
+    s.min_low = UINT64_MAX;
+    s.max_low = 0;
+
+    level = s.first;
+    do {
+        if (cancel)
+            return false;
+
+        cnt = snapshot->get_edges(index, end, ch, edges.data(), EdgeBatchSize);
+        for (uint64_t i = 0; i < cnt; i++) {
+            const uint64_t edge = edges[i].first;
+
+            if (level)
+                s.high += edge - pos;
+            if (s.rising + s.falling != 0)
+                add_pulse(s, s.last_edge, edge, level);
+            else
+                s.first_edge = edge;
+
+            if (edges[i].second) {
+                if (s.rising == 0)
+                    s.first_rising = edge;
+                s.last_rising = edge;
+                s.rising++;
+            } else {
+                s.falling++;
+            }
+
+            s.last_edge = edge;
+            level = edges[i].second;
+            pos = edge;
+        }
+    } while (cnt == EdgeBatchSize);
+
+    if (level)
+        s.high += end - pos;
+    s.last = level;
+
+    return true;
+}
+
+void RangeStats::add_pulse(Summary &s, uint64_t from, uint64_t to, bool level)
+{
+    const uint64_t width = to - from;
+
+    if (level) {
+        s.min_high = min(s.min_high, width);
+        s.max_high = max(s.max_high, width);
+    } else {
+        s.min_low = min(s.min_low, width);
+        s.max_low = max(s.max_low, width);
+    }
+}
+
+void RangeStats::merge(Summary &a, const Summary &b)
+{
+    assert(a.end == b.start);
+
+    const bool a_edges = (a.rising + a.falling) != 0;
+    const bool b_edges = (b.rising + b.falling) != 0;
+    const bool junction = (a.last != b.first);
+    const uint64_t j = b.start;
+
+    // pulses which are only complete in the merged range
+    if (a_edges) {
+        if (junction)
+            add_pulse(a, a.last_edge, j, a.last);
+        else if (b_edges)
+            add_pulse(a, a.last_edge, b.first_edge, a.last);
+    }
+    if (junction && b_edges)
+        add_pulse(a, j, b.first_edge, b.first);
+
+    a.min_high = min(a.min_high, b.min_high);
+    a.max_high = max(a.max_high, b.max_high);
+    a.min_low = min(a.min_low, b.min_low);
+    a.max_low = max(a.max_low, b.max_low);
+
+    if (!a_edges)
+        a.first_edge = junction ? j : b.first_edge;
+    if (b_edges)
+        a.last_edge = b.last_edge;
+    else if (junction)
+        a.last_edge = j;
+
+    const bool j_rising = junction && b.first;
+    if (a.rising == 0)
+        a.first_rising = j_rising ? j : b.first_rising;
+    if (b.rising != 0)
+        a.last_rising = b.last_rising;
+    else if (j_rising)
+        a.last_rising = j;
+
+    a.rising += b.rising + (j_rising ? 1 : 0);
+    a.falling += b.falling + ((junction && !b.first) ? 1 : 0);
+    a.high += b.high;
+    a.end = b.end;
+    a.last = b.last;
+}
+
+} // namespace data
+} // namespace pv
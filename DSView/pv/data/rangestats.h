@@ -0,0 +1,107 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2013 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef DSVIEW_PV_DATA_RANGESTATS_H
+#define DSVIEW_PV_DATA_RANGESTATS_H
+
+#include <stdint.h>
+#include <atomic>
+
+#include "logicsnapshot.h"
+
+namespace pv {
+namespace data {
+
+class AnalogSnapshot;
+
+//Statistics of the samples between two cursors, it is safe to call
+//from a worker thread, one calculation at a time.
+class RangeStats
+{
+public:
+    struct LogicResult
+    {
+        uint64_t samples;
+        uint64_t high;          // samples at high level
+        uint64_t rising;
+        uint64_t falling;
+        uint64_t first_rising;
+        uint64_t last_rising;
+        uint64_t min_high;      // complete pulses only, 0 if none
+        uint64_t max_high;
+        uint64_t min_low;
+        uint64_t max_low;
+    };
+
+    struct AnalogResult
+    {
+        // values are hw_offset - raw sample, as used by AnalogSignal
+        double min;
+        double max;
+        double mean;
+        double rms;
+    };
+
+private:
+    //Statistics of samples [start, end), edges are counted in (start, end)
+    struct Summary
+    {
+        uint64_t start;
+        uint64_t end;
+        bool first;
+        bool last;
+        uint64_t high;
+        uint64_t rising;
+        uint64_t falling;
+        uint64_t first_edge;
+        uint64_t last_edge;
+        uint64_t first_rising;
+        uint64_t last_rising;
+        uint64_t min_high;
+        uint64_t max_high;
+        uint64_t min_low;
+        uint64_t max_low;
+    };
+
+    static const uint64_t EdgeBatchSize = 4096;
+
+public:
+    // samples [start, end], returns false when cancelled
+    bool calc_logic(LogicSnapshot *snapshot, int sig_index, uint64_t start, uint64_t end,
+                    LogicResult &result, const std::atomic<bool> &cancel);
+
+    bool calc_analog(AnalogSnapshot *snapshot, int sig_index, int hw_offset,
+                     uint64_t start, uint64_t end, AnalogResult &result,
+                     const std::atomic<bool> &cancel);
+
+private:
+    bool summarize(LogicSnapshot *snapshot, LogicSnapshot::ChannelHandle ch,
+                   uint64_t start, uint64_t end, Summary &s, const std::atomic<bool> &cancel);
+    bool leaf_summary(LogicSnapshot *snapshot, LogicSnapshot::ChannelHandle ch,
+                      uint64_t leaf, Summary &s, const std::atomic<bool> &cancel);
+    static void add_pulse(Summary &s, uint64_t from, uint64_t to, bool level);
+    static void merge(Summary &a, const Summary &b);
+};
+
+} // namespace data
+} // namespace pv
+
+#endif // DSVIEW_PV_DATA_RANGESTATS_H
@@ -0,0 +1,751 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+// Python.h must come before the standard headers
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "scriptengine.h"
+
+#include <assert.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <libsigrok.h>
+
+#include "logicsnapshot.h"
+#include "statesnapshot.h"
+#include "dsosnapshot.h"
+#include "analogsnapshot.h"
+#include "../sigsession.h"
+#include "../view/signal.h"
+#include "../log.h"
+
+/*
+    The dsview module:
+
+    samplerate()                samplerate of the capture
+    sample_count()              samples of the current mode
+    channels()                  [(index, name, 'logic'|'dso'|'analog')] of the enabled channels
+    logic(index)                [(start, block)] of a logic channel, block is a
+                                uint64 array, bit n of word k is sample start+k*64+n,
+                                or a bool if the whole block has one level
+    edges(index, start, end)    (positions, levels) of the transitions in [start, end),
+                                uint64 and uint8 arrays
+    dso(index)                  uint8 array of a dso channel
+    analog(index)               (array, first) of an analog channel, first is the
+                                position of the oldest sample in the array
+    add_marker(index)           add a cursor to the view
+    measure(name, value, unit)  report a result
+*/
+
+namespace pv {
+namespace data {
+
+namespace {
+    const Py_ssize_t EdgeBatch = 65536;
+
+    SigSession  *g_session = NULL;
+    IScriptHost *g_host = NULL;
+    PyObject    *g_buffer_type = NULL;
+    PyObject    *g_module = NULL;
+    // views made by older runs can't be exported again
+    uint64_t    g_generation = 1;
+    std::atomic<int64_t> g_exports(0);
+    std::atomic<bool> g_running(false);
+    std::atomic<bool> g_cancel(false);
+    // snapshot buffers released while python may still use them
+    std::mutex  g_retired_mutex;
+    std::vector<void*> g_retired;
+
+    const char *BootCode =
+        "import sys, dsview\n"
+        "class _DsvWriter:\n"
+        "    def write(self, s):\n"
+        "        dsview._write(s)\n"
+        "    def flush(self):\n"
+        "        pass\n"
+        "_dsv_writer = _DsvWriter()\n";
+}
+
+//A read only one dimension array, borrowed from a snapshot or owned
+struct ScriptBuffer
+{
+    PyObject_HEAD
+    const void  *buf;
+    Py_ssize_t  shape;
+    Py_ssize_t  stride;
+    Py_ssize_t  itemsize;
+    const char  *format;
+    uint64_t    generation; // 0 for owned memory
+    std::vector<uint8_t> *owned;
+};
+
+static int buffer_getbuffer(PyObject *self, Py_buffer *view, int flags)
+{
+    static uint64_t empty = 0;
+    ScriptBuffer *b = (ScriptBuffer*)self;
+
+    view->obj = NULL;
+
+    if (b->generation != 0 && b->generation != g_generation){
+        PyErr_SetString(PyExc_BufferError, "the capture data of an old script run");
+        return -1;
+    }
+    if (flags & PyBUF_WRITABLE){
+        PyErr_SetString(PyExc_BufferError, "the capture data is read only");
+        return -1;
+    }
+    if (b->stride != b->itemsize && (flags & PyBUF_STRIDES) != PyBUF_STRIDES){
+        PyErr_SetString(PyExc_BufferError, "the array is not contiguous");
+        return -1;
+    }
+
+    view->buf = (void*)(b->buf ? b->buf : &empty);
+    view->obj = self;
+    Py_INCREF(self);
+    view->len = b->shape * b->itemsize;
+    view->readonly = 1;
+    view->itemsize = b->itemsize;
+    view->format = (flags & PyBUF_FORMAT) ? (char*)b->format : NULL;
+    view->ndim = 1;
+    view->shape = (flags & PyBUF_ND) ? &b->shape : NULL;
+    view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? &b->stride : NULL;
+    view->suboffsets = NULL;
+    view->internal = NULL;
+
+    g_exports++;
+    return 0;
+}
+
+static void free_retired()
+{
+    std::lock_guard<std::mutex> lock(g_retired_mutex);
+
+    for (void *buf : g_retired)
+        free(buf);
+    g_retired.clear();
+}
+
+static void buffer_releasebuffer(PyObject *self, Py_buffer *view)
+{
+    (void)self;
+    (void)view;
+    if (--g_exports == 0 && !g_running)
+        free_retired();
+}
+
+// stops the script at the next line once cancel() was called
+static int trace_cancel(PyObject *obj, PyFrameObject *frame, int what, PyObject *arg)
+{
+    (void)obj;
+    (void)frame;
+    (void)what;
+    (void)arg;
+
+    if (g_cancel){
+        PyErr_SetString(PyExc_KeyboardInterrupt, "the script was canceled");
+        return -1;
+    }
+    return 0;
+}
+
+static void buffer_dealloc(PyObject *self)
+{
+    ScriptBuffer *b = (ScriptBuffer*)self;
+    PyTypeObject *tp = Py_TYPE(self);
+
+    delete b->owned;
+    tp->tp_free(self);
+#if PY_VERSION_HEX >= 0x03080000
+    Py_DECREF(tp);
+#endif
+}
+
+static Py_ssize_t buffer_length(PyObject *self)
+{
+    return ((ScriptBuffer*)self)->shape;
+}
+
+static ScriptBuffer* new_buffer(const void *buf, Py_ssize_t shape, Py_ssize_t stride,
+                                Py_ssize_t itemsize, const char *format)
+{
+    ScriptBuffer *b = PyObject_New(ScriptBuffer, (PyTypeObject*)g_buffer_type);
+    if (b == NULL)
+        return NULL;
+
+    b->buf = buf;
+    b->shape = shape;
+    b->stride = stride;
+    b->itemsize = itemsize;
+    b->format = format;
+    b->generation = g_generation;
+    b->owned = NULL;
+    return b;
+}
+
+static ScriptBuffer* new_owned_buffer(std::vector<uint8_t> *data, Py_ssize_t itemsize,
+                                      const char *format)
+{
+    ScriptBuffer *b = new_buffer(data->data(), data->size() / itemsize,
+                                 itemsize, itemsize, format);
+    if (b == NULL){
+        delete data;
+        return NULL;
+    }
+    b->generation = 0;
+    b->owned = data;
+    return b;
+}
+
+static Snapshot* get_snapshot(int type)
+{
+    Snapshot *snapshot = g_session->get_snapshot(type);
+    if (snapshot == NULL || snapshot->empty()){
+        PyErr_SetString(PyExc_RuntimeError, "no capture data");
+        return NULL;
+    }
+    return snapshot;
+}
+
+static PyObject* dsv_samplerate(PyObject *self, PyObject *args)
+{
+    (void)self;
+    (void)args;
+    return PyLong_FromUnsignedLongLong(g_session->cur_snap_samplerate());
+}
+
+static PyObject* dsv_sample_count(PyObject *self, PyObject *args)
+{
+    (void)self;
+    (void)args;
+
+    int type = SR_CHANNEL_LOGIC;
+    int mode = g_session->get_device()->get_work_mode();
+    if (mode == DSO)
+        type = SR_CHANNEL_DSO;
+    else if (mode == ANALOG)
+        type = SR_CHANNEL_ANALOG;
+
+    Snapshot *snapshot = g_session->get_snapshot(type);
+    return PyLong_FromUnsignedLongLong(snapshot ? snapshot->get_sample_count() : 0);
+}
+
+static PyObject* dsv_channels(PyObject *self, PyObject *args)
+{
+    (void)self;
+    (void)args;
+
+    PyObject *list = PyList_New(0);
+    if (list == NULL)
+        return NULL;
+
+    for (auto s : g_session->get_signals())
+    {
+        const char *type = NULL;
+        if (s->get_type() == SR_CHANNEL_LOGIC)
+            type = "logic";
+        else if (s->get_type() == SR_CHANNEL_DSO)
+            type = "dso";
+        else if (s->get_type() == SR_CHANNEL_ANALOG)
+            type = "analog";
+        if (type == NULL || !s->enabled())
+            continue;
+
+        QByteArray name = s->get_name().toUtf8();
+        PyObject *item = Py_BuildValue("(iss)", s->get_index(), name.data(), type);
+        if (item == NULL || PyList_Append(list, item) != 0){
+            Py_XDECREF(item);
+            Py_DECREF(list);
+            return NULL;
+        }
+        Py_DECREF(item);
+    }
+    return list;
+}
+
+static PyObject* dsv_logic(PyObject *self, PyObject *args)
+{
+    (void)self;
+    int index;
+
+    if (!PyArg_ParseTuple(args, "i", &index))
+        return NULL;
+
+    LogicSnapshot *snapshot = (LogicSnapshot*)get_snapshot(SR_CHANNEL_LOGIC);
+    if (snapshot == NULL)
+        return NULL;
+    if (!snapshot->has_data(index)){
+        PyErr_Format(PyExc_ValueError, "no logic channel %d", index);
+        return NULL;
+    }
+
+    PyObject *list = PyList_New(0);
+    if (list == NULL)
+        return NULL;
+
+    const int block_num = snapshot->get_block_num();
+    const uint64_t block_samples = LogicSnapshot::get_block_samples();
+
+    for (int i = 0; i < block_num; i++)
+    {
+        bool sample;
+        const uint8_t *lbp = snapshot->get_block_buf(i, index, sample);
+        PyObject *block;
+
+        if (lbp == NULL){
+            block = PyBool_FromLong(sample);
+        }
+        else{
+            // the leaf is a whole block, the bytes of the last word are there
+            Py_ssize_t words = (snapshot->get_block_size(i) + 7) / 8;
+            block = (PyObject*)new_buffer(lbp, words, 8, 8, "Q");
+        }
+
+        PyObject *item = block ? Py_BuildValue("(KN)", (unsigned long long)(i * block_samples), block) : NULL;
+        if (item == NULL || PyList_Append(list, item) != 0){
+            Py_XDECREF(item);
+            Py_DECREF(list);
+            return NULL;
+        }
+        Py_DECREF(item);
+    }
+    return list;
+}
+
+static PyObject* dsv_edges(PyObject *self, PyObject *args)
+{
+    (void)self;
+    int index;
+    long long start = 0;
+    long long end = -1;
+
+    if (!PyArg_ParseTuple(args, "i|LL", &index, &start, &end))
+        return NULL;
+
+    LogicSnapshot *snapshot = (LogicSnapshot*)get_snapshot(SR_CHANNEL_LOGIC);
+    if (snapshot == NULL)
+        return NULL;
+
+    LogicSnapshot::ChannelHandle ch = snapshot->get_channel(index);
+    if (!ch.valid()){
+        PyErr_Format(PyExc_ValueError, "no logic channel %d", index);
+        return NULL;
+    }
+
+    const uint64_t count = snapshot->get_sample_count();
+    uint64_t pos = (start > 0) ? start : 0;
+    uint64_t stop = (end < 0 || (uint64_t)end > count) ? count : end;
+
+    std::vector<uint8_t> *positions = new std::vector<uint8_t>();
+    std::vector<uint8_t> *levels = new std::vector<uint8_t>();
+    std::vector<LogicSnapshot::EdgePair> edges(EdgeBatch);
+
+    Py_BEGIN_ALLOW_THREADS
+    while (pos < stop)
+    {
+        uint64_t num = snapshot->get_edges(pos, stop, ch, edges.data(), EdgeBatch);
+        if (num == 0)
+            break;
+
+        size_t offset = positions->size();
+        positions->resize(offset + num * sizeof(uint64_t));
+        uint64_t *p = (uint64_t*)(positions->data() + offset);
+        for (uint64_t i = 0; i < num; i++){
+            p[i] = edges[i].first;
+            levels->push_back(edges[i].second);
+        }
+    }
+    Py_END_ALLOW_THREADS
+
+    PyObject *pos_buf = (PyObject*)new_owned_buffer(positions, 8, "Q");
+    PyObject *level_buf = (PyObject*)new_owned_buffer(levels, 1, "B");
+    if (pos_buf == NULL || level_buf == NULL){
+        Py_XDECREF(pos_buf);
+        Py_XDECREF(level_buf);
+        return NULL;
+    }
+    return Py_BuildValue("(NN)", pos_buf, level_buf);
+}
+
+static PyObject* dsv_states(PyObject *self, PyObject *args)
+{
+    (void)self;
+    int clock;
+    PyObject *data_list;
+    int edge = StateSnapshot::EDGE_RISING;
+    long long start = 0;
+    long long end = -1;
+
+    if (!PyArg_ParseTuple(args, "iO|iLL", &clock, &data_list, &edge, &start, &end))
+        return NULL;
+
+    if (edge < StateSnapshot::EDGE_RISING || edge > StateSnapshot::EDGE_BOTH){
+        PyErr_SetString(PyExc_ValueError, "edge is 0 (rising), 1 (falling) or 2 (both)");
+        return NULL;
+    }
+
+    PyObject *seq = PySequence_Fast(data_list, "data channels must be a sequence");
+    if (seq == NULL)
+        return NULL;
+
+    std::vector<int> data;
+    for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(seq); i++)
+        data.push_back((int)PyLong_AsLong(PySequence_Fast_GET_ITEM(seq, i)));
+    Py_DECREF(seq);
+    if (PyErr_Occurred())
+        return NULL;
+
+    if (data.empty() || data.size() > (size_t)StateSnapshot::MaxDataChannels){
+        PyErr_Format(PyExc_ValueError, "1 to %d data channels", StateSnapshot::MaxDataChannels);
+        return NULL;
+    }
+
+    LogicSnapshot *snapshot = (LogicSnapshot*)get_snapshot(SR_CHANNEL_LOGIC);
+    if (snapshot == NULL)
+        return NULL;
+
+    const uint64_t count = snapshot->get_sample_count();
+    const uint64_t from = (start > 0) ? start : 0;
+    const uint64_t stop = (end < 0 || (uint64_t)end > count) ? count : end;
+
+    StateSnapshot states;
+    bool ret;
+
+    Py_BEGIN_ALLOW_THREADS
+    ret = states.extract(snapshot, clock, (StateSnapshot::ClockEdge)edge, data, from, stop);
+    Py_END_ALLOW_THREADS
+
+    if (!ret){
+        PyErr_SetString(PyExc_ValueError, "no such logic channel");
+        return NULL;
+    }
+
+    const size_t bytes = states.get_state_count() * sizeof(uint64_t);
+    std::vector<uint8_t> *positions = new std::vector<uint8_t>(bytes);
+    std::vector<uint8_t> *values = new std::vector<uint8_t>(bytes);
+    if (bytes > 0){
+        memcpy(positions->data(), states.get_positions(), bytes);
+        memcpy(values->data(), states.get_values(), bytes);
+    }
+
+    PyObject *pos_buf = (PyObject*)new_owned_buffer(positions, 8, "Q");
+    PyObject *value_buf = (PyObject*)new_owned_buffer(values, 8, "Q");
+    if (pos_buf == NULL || value_buf == NULL){
+        Py_XDECREF(pos_buf);
+        Py_XDECREF(value_buf);
+        return NULL;
+    }
+    return Py_BuildValue("(NN)", pos_buf, value_buf);
+}
+
+static PyObject* dsv_dso(PyObject *self, PyObject *args)
+{
+    (void)self;
+    int index;
+
+    if (!PyArg_ParseTuple(args, "i", &index))
+        return NULL;
+
+    DsoSnapshot *snapshot = (DsoSnapshot*)get_snapshot(SR_CHANNEL_DSO);
+    if (snapshot == NULL)
+        return NULL;
+    if (!snapshot->has_data(index)){
+        PyErr_Format(PyExc_ValueError, "no dso channel %d", index);
+        return NULL;
+    }
+
+    const uint64_t count = snapshot->get_sample_count();
+    const uint8_t *data = snapshot->get_samples(0, 0, index);
+    return (PyObject*)new_buffer(data, count, snapshot->get_channel_num(), 1, "B");
+}
+
+static PyObject* dsv_analog(PyObject *self, PyObject *args)
+{
+    (void)self;
+    int index;
+
+    if (!PyArg_ParseTuple(args, "i", &index))
+        return NULL;
+
+    AnalogSnapshot *snapshot = (AnalogSnapshot*)get_snapshot(SR_CHANNEL_ANALOG);
+    if (snapshot == NULL)
+        return NULL;
+
+    int order = snapshot->get_ch_order(index);
+    if (order < 0 || !snapshot->has_data(index)){
+        PyErr_Format(PyExc_ValueError, "no analog channel %d", index);
+        return NULL;
+    }
+
+    // the buffer is a ring in loop mode
+    const uint64_t count = std::min(snapshot->get_sample_count(),
+                                    snapshot->get_total_sample_count());
+    const uint64_t first = snapshot->get_ring_start();
+    const int unit_bytes = snapshot->get_unit_bytes();
+    const uint8_t *data = snapshot->get_samples(0) + order * unit_bytes;
+
+    PyObject *buf = (PyObject*)new_buffer(data, count,
+                                          unit_bytes * snapshot->get_channel_num(),
+                                          unit_bytes, (unit_bytes == 1) ? "B" : "H");
+    if (buf == NULL)
+        return NULL;
+    return Py_BuildValue("(NK)", buf, (unsigned long long)first);
+}
+
+static PyObject* dsv_add_marker(PyObject *self, PyObject *args)
+{
+    (void)self;
+    unsigned long long index;
+
+    if (!PyArg_ParseTuple(args, "K", &index))
+        return NULL;
+
+    g_host->ScriptAddMarker(index);
+    Py_RETURN_NONE;
+}
+
+static PyObject* dsv_measure(PyObject *self, PyObject *args)
+{
+    (void)self;
+    const char *name;
+    double value;
+    const char *unit = "";
+
+    if (!PyArg_ParseTuple(args, "sd|s", &name, &value, &unit))
+        return NULL;
+
+    g_host->ScriptMeasure(QString::fromUtf8(name), value, QString::fromUtf8(unit));
+    Py_RETURN_NONE;
+}
+
+static PyObject* dsv_write(PyObject *self, PyObject *args)
+{
+    (void)self;
+    const char *text;
+
+    if (!PyArg_ParseTuple(args, "s", &text))
+        return NULL;
+
+    g_host->ScriptPrint(QString::fromUtf8(text));
+    Py_RETURN_NONE;
+}
+
+static PyType_Slot buffer_slots[] = {
+    {Py_tp_dealloc, (void*)buffer_dealloc},
+    {Py_sq_length, (void*)buffer_length},
+    {Py_bf_getbuffer, (void*)buffer_getbuffer},
+    {Py_bf_releasebuffer, (void*)buffer_releasebuffer},
+    {0, NULL}
+};
+
+static PyType_Spec buffer_spec = {
+    "dsview.Buffer", sizeof(ScriptBuffer), 0, Py_TPFLAGS_DEFAULT, buffer_slots
+};
+
+static PyMethodDef module_methods[] = {
+    {"samplerate", dsv_samplerate, METH_NOARGS, "samplerate of the capture"},
+    {"sample_count", dsv_sample_count, METH_NOARGS, "samples of the current mode"},
+    {"channels", dsv_channels, METH_NOARGS, "enabled channels"},
+    {"logic", dsv_logic, METH_VARARGS, "blocks of a logic channel"},
+    {"edges", dsv_edges, METH_VARARGS, "transitions of a logic channel"},
+    {"states", dsv_states, METH_VARARGS, "bus values at the edges of a clock channel"},
+    {"dso", dsv_dso, METH_VARARGS, "samples of a dso channel"},
+    {"analog", dsv_analog, METH_VARARGS, "samples of an analog channel"},
+    {"add_marker", dsv_add_marker, METH_VARARGS, "add a cursor"},
+    {"measure", dsv_measure, METH_VARARGS, "report a result"},
+    {"_write", dsv_write, METH_VARARGS, NULL},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyModuleDef module_def = {
+    PyModuleDef_HEAD_INIT, "dsview", NULL, -1, module_methods,
+    NULL, NULL, NULL, NULL
+};
+
+//-------------ScriptEngine
+
+ScriptEngine::ScriptEngine(SigSession *session)
+{
+    _session = session;
+}
+
+ScriptEngine::~ScriptEngine()
+{
+}
+
+int64_t ScriptEngine::get_export_count()
+{
+    return g_exports;
+}
+
+bool ScriptEngine::retire_buffer(void *buf)
+{
+    if (buf == NULL || (!g_running && g_exports == 0))
+        return false;
+
+    std::lock_guard<std::mutex> lock(g_retired_mutex);
+    g_retired.push_back(buf);
+    return true;
+}
+
+void ScriptEngine::cancel()
+{
+    g_cancel = true;
+}
+
+bool ScriptEngine::init_module()
+{
+    if (g_module != NULL)
+        return true;
+
+    g_buffer_type = PyType_FromSpec(&buffer_spec);
+    if (g_buffer_type == NULL)
+        return false;
+
+    PyObject *module = PyModule_Create(&module_def);
+    if (module == NULL)
+        return false;
+
+    Py_INCREF(g_buffer_type);
+    if (PyModule_AddObject(module, "Buffer", g_buffer_type) != 0
+        || PyDict_SetItemString(PyImport_GetModuleDict(), "dsview", module) != 0){
+        Py_DECREF(g_buffer_type);
+        Py_DECREF(module);
+        return false;
+    }
+
+    g_module = module;
+    return true;
+}
+
+bool ScriptEngine::run(const QString &code, IScriptHost *host, QString &error)
+{
+    assert(host);
+
+    if (!Py_IsInitialized()){
+        error = "The python interpreter is not ready.";
+        return false;
+    }
+
+    PyGILState_STATE gstate = PyGILState_Ensure();
+
+    g_session = _session;
+    g_host = host;
+    g_cancel = false;
+    g_running = true;
+
+    bool ret = false;
+    PyObject *globals = NULL;
+    PyObject *old_stdout = NULL;
+    PyObject *old_stderr = NULL;
+    PyObject *writer = NULL;
+    PyObject *result = NULL;
+    PyObject *name = NULL;
+    QByteArray source = code.toUtf8();
+
+    if (!init_module())
+        goto end;
+
+    globals = PyDict_New();
+    name = PyUnicode_FromString("__main__");
+    if (globals == NULL || name == NULL
+        || PyDict_SetItemString(globals, "__builtins__", PyEval_GetBuiltins()) != 0
+        || PyDict_SetItemString(globals, "__name__", name) != 0)
+        goto end;
+
+    result = PyRun_String(BootCode, Py_file_input, globals, globals);
+    if (result == NULL)
+        goto end;
+    Py_DECREF(result);
+
+    // the output goes to the host
+    writer = PyDict_GetItemString(globals, "_dsv_writer");
+    old_stdout = PySys_GetObject("stdout");
+    old_stderr = PySys_GetObject("stderr");
+    Py_XINCREF(old_stdout);
+    Py_XINCREF(old_stderr);
+    PySys_SetObject("stdout", writer);
+    PySys_SetObject("stderr", writer);
+
+    PyEval_SetTrace(trace_cancel, NULL);
+    result = PyRun_String(source.data(), Py_file_input, globals, globals);
+    PyEval_SetTrace(NULL, NULL);
+    if (result != NULL){
+        Py_DECREF(result);
+        ret = true;
+    }
+    else if (PyErr_ExceptionMatches(PyExc_SystemExit)){
+        PyErr_Clear();
+        ret = true;
+    }
+    else{
+        PyObject *type, *value, *traceback;
+        PyErr_Fetch(&type, &value, &traceback);
+        PyErr_NormalizeException(&type, &value, &traceback);
+
+        PyObject *str = value ? PyObject_Str(value) : NULL;
+        if (str != NULL){
+            error = QString::fromUtf8(PyUnicode_AsUTF8(str));
+            Py_DECREF(str);
+        }
+        // write the traceback to the host, without keeping it in sys.last_traceback
+        PyErr_Restore(type, value, traceback);
+        PyErr_PrintEx(0);
+    }
+
+    PySys_SetObject("stdout", old_stdout);
+    PySys_SetObject("stderr", old_stderr);
+    Py_XDECREF(old_stdout);
+    Py_XDECREF(old_stderr);
+
+end:
+    if (PyErr_Occurred()){
+        dsv_err("%s", "ERROR: failed to set up the script.");
+        PyErr_Clear();
+        if (error == "")
+            error = "Failed to set up the script.";
+    }
+
+    Py_XDECREF(name);
+    Py_XDECREF(globals);
+    PyGC_Collect();
+
+    // the data may change after the run
+    g_generation++;
+    if (g_exports > 0)
+        dsv_info("Views of the capture data are still held by the script: %lld", (long long)g_exports.load());
+
+    g_session = NULL;
+    g_host = NULL;
+    g_running = false;
+    if (g_exports == 0)
+        free_retired();
+
+    PyGILState_Release(gstate);
+
+    return ret;
+}
+
+} // namespace data
+} // namespace pv
@@ -0,0 +1,79 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef DSVIEW_PV_DATA_SCRIPTENGINE_H
+#define DSVIEW_PV_DATA_SCRIPTENGINE_H
+
+#include <stdint.h>
+#include <QString>
+
+namespace pv {
+
+class SigSession;
+
+namespace data {
+
+//Receives the output and the results of a script
+class IScriptHost
+{
+public:
+    virtual void ScriptPrint(const QString &text)=0;
+    virtual void ScriptAddMarker(uint64_t index)=0;
+    virtual void ScriptMeasure(const QString &name, double value, const QString &unit)=0;
+};
+
+//Run python scripts on the capture data with the embedded interpreter
+//of the decoders. The dsview module gives the snapshots to the scripts
+//through the buffer protocol, numpy.asarray() uses them without a copy.
+//The snapshots give their buffers to retire_buffer() instead of freeing
+//them while a script runs or python still holds views of them, and no new
+//capture is started until those views are released.
+class ScriptEngine
+{
+public:
+    ScriptEngine(SigSession *session);
+    ~ScriptEngine();
+
+    // returns false and sets error if the script raised an exception,
+    // runs on a worker thread, the host is called from that thread
+    bool run(const QString &code, IScriptHost *host, QString &error);
+
+    // stops the running script at its next line, from any thread
+    void cancel();
+
+    // views of the capture data still held by python objects
+    static int64_t get_export_count();
+
+    // keeps a snapshot buffer alive while python may use it, it is freed
+    // with the last view, returns false if the caller must free it
+    static bool retire_buffer(void *buf);
+
+private:
+    bool init_module();
+
+private:
+    SigSession  *_session;
+};
+
+} // namespace data
+} // namespace pv
+
+#endif // DSVIEW_PV_DATA_SCRIPTENGINE_H
@@ -22,6 +22,8 @@
 
 
 #include "snapshot.h"
+#include "memorybudget.h"
+#include "scriptengine.h"
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
@@ -38,23 +40,30 @@ Snapshot::Snapshot(int unit_size, uint64_t total_sample_count, unsigned int chan
     _ring_sample_count(0),
     _unit_size(unit_size),
     _memory_failed(false),
-    _last_ended(true)
+    _last_ended(true),
+    _generation(0)
 {
     assert(_unit_size > 0);
     _unit_bytes = 1;
     _unit_pitch = 0;
     _have_data = false;
+    _mem_pool = MemoryBudget::PoolLogic;
+    _mem_bytes = 0;
 }
 
 Snapshot::~Snapshot()
 {
     free_data();
+    mem_free(_mem_bytes);
 }
 
 void Snapshot::free_data()
 {
     if (_data) {
-        free(_data);
+        // a script may still hold a view of it
+        if (!ScriptEngine::retire_buffer(_data))
+            free(_data);
+        mem_free(_capacity);
         _data = NULL;
         _capacity = 0;
         _sample_count = 0;
@@ -106,6 +115,19 @@ uint64_t Snapshot::ring_end()
         return _ring_sample_count - 1;
 }
 
+void Snapshot::mem_alloc(uint64_t bytes)
+{
+    _mem_bytes += bytes;
+    MemoryBudget::Instance().alloc(_mem_pool, bytes);
+}
+
+void Snapshot::mem_free(uint64_t bytes)
+{
+    assert(bytes <= _mem_bytes);
+    _mem_bytes -= bytes;
+    MemoryBudget::Instance().release(_mem_pool, bytes);
+}
+
 void Snapshot::capture_ended()
 {
     set_last_ended(true);
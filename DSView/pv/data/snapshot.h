@@ -25,6 +25,7 @@
 
 #include <mutex>
 #include <vector>
+#include <atomic>
 
 namespace pv {
 namespace data {
@@ -40,6 +41,10 @@ public:
     virtual void init() = 0;
 
 	uint64_t get_sample_count();
+
+    inline uint64_t get_total_sample_count(){
+        return _total_sample_count;
+    }
     uint64_t get_ring_start();
     uint64_t get_ring_end();
 
@@ -77,6 +82,12 @@ public:
         return _have_data;
     }
 
+    // changes whenever the samples change, the views compare it with
+    // the one they painted
+    inline uint64_t get_generation(){
+        return _generation;
+    }
+
     virtual void capture_ended();
     virtual bool has_data(int index) = 0;
     virtual int get_block_num() = 0;
@@ -86,6 +97,10 @@ public:
 protected:
     virtual void free_data();
 
+    // count the bytes of the buffers held by this snapshot
+    void mem_alloc(uint64_t bytes);
+    void mem_free(uint64_t bytes);
+
     inline uint64_t sample_count(){
         return _sample_count;
     }
@@ -110,7 +125,10 @@ protected:
     uint16_t _unit_pitch;
     bool _memory_failed;
     bool _last_ended;
+    std::atomic<uint64_t> _generation;
     bool _have_data;
+    int _mem_pool;
+    uint64_t _mem_bytes;
 };
 
 } // namespace data
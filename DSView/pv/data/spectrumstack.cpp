@@ -23,6 +23,7 @@
  
 #include "dso.h"
 #include "dsosnapshot.h"
+#include "memorybudget.h"
 #include "../sigsession.h"
 #include "../view/dsosignal.h"
 #include <math.h>
@@ -57,7 +58,8 @@ SpectrumStack::SpectrumStack(pv::SigSession *session, int index) :
     _dc_ignore(true),
     _sample_interval(1),
     _spectrum_state(Init),
-    _fft_plan(NULL)
+    _fft_plan(NULL),
+    _mem_bytes(0)
 {
 }
 
@@ -68,6 +70,7 @@ SpectrumStack::~SpectrumStack()
     _power_spectrum.clear();
     if (_fft_plan)
         fftw_destroy_plan(_fft_plan);
+    MemoryBudget::Instance().release(MemoryBudget::PoolSpectrum, _mem_bytes);
 }
 
 void SpectrumStack::clear()
@@ -94,6 +97,12 @@ void SpectrumStack::set_sample_num(uint64_t num)
     _xn.resize(_sample_num);
     _xk.resize(_sample_num);
     _power_spectrum.resize(_sample_num/2+1);
+
+    // the buffers only grow, count the new capacity
+    const uint64_t bytes = (_xn.capacity() + _xk.capacity() +
+                            _power_spectrum.capacity()) * sizeof(double);
+    MemoryBudget::Instance().alloc(MemoryBudget::PoolSpectrum, bytes - _mem_bytes);
+    _mem_bytes = bytes;
     _fft_plan = fftw_plan_r2r_1d(_sample_num, _xn.data(), _xk.data(),
                                  FFTW_R2HC, FFTW_ESTIMATE);
 }
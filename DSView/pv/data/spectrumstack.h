@@ -109,6 +109,7 @@ private:
     std::vector<double> _xn;
     std::vector<double> _xk;
     std::vector<double> _power_spectrum;
+    uint64_t _mem_bytes;
 };
 
 } // namespace data
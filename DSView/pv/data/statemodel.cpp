@@ -0,0 +1,122 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "statemodel.h"
+#include "statesnapshot.h"
+#include "../view/ruler.h"
+
+#include <algorithm>
+#include <limits.h>
+
+namespace pv {
+namespace data {
+
+StateModel::StateModel(QObject *parent)
+    : QAbstractTableModel(parent),
+      _states(NULL),
+      _samplerate(0),
+      _format(FORMAT_HEX)
+{
+}
+
+void StateModel::setStateSnapshot(StateSnapshot *states, uint64_t samplerate)
+{
+    beginResetModel();
+    _states = states;
+    _samplerate = samplerate;
+    endResetModel();
+}
+
+void StateModel::setFormat(ValueFormat format)
+{
+    beginResetModel();
+    _format = format;
+    endResetModel();
+}
+
+void StateModel::setHeaders(const QStringList &headers)
+{
+    _headers = headers;
+    headerDataChanged(Qt::Horizontal, 0, COL_COUNT - 1);
+}
+
+int StateModel::rowCount(const QModelIndex & /* parent */) const
+{
+    if (_states == NULL)
+        return 0;
+    // MaxStates keeps the table within the range of a view row
+    return (int)std::min(_states->get_state_count(), (uint64_t)INT_MAX);
+}
+
+int StateModel::columnCount(const QModelIndex & /* parent */) const
+{
+    return COL_COUNT;
+}
+
+QVariant StateModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || _states == NULL)
+        return QVariant();
+
+    if (role == Qt::TextAlignmentRole) {
+        return int(Qt::AlignLeft | Qt::AlignVCenter);
+    } else if (role == Qt::DisplayRole) {
+        const uint64_t pos = _states->get_position(index.row());
+
+        switch (index.column())
+        {
+        case COL_SAMPLE:
+            return QString::number(pos);
+        case COL_TIME:
+            return view::Ruler::format_real_time(pos, _samplerate);
+        case COL_VALUE:
+        {
+            const uint64_t value = _states->get_value(index.row());
+            const int bits = std::max((int)_states->get_data_channels().size(), 1);
+            if (_format == FORMAT_HEX)
+                return QString("%1").arg(value, (bits + 3) / 4, 16, QChar('0')).toUpper();
+            else if (_format == FORMAT_BIN)
+                return QString("%1").arg(value, bits, 2, QChar('0'));
+            else
+                return QString::number(value);
+        }
+        }
+    }
+    return QVariant();
+}
+
+QVariant StateModel::headerData(int section,
+                                Qt::Orientation  orientation,
+                                int role) const
+{
+    if (role != Qt::DisplayRole)
+        return QVariant();
+
+    if (orientation == Qt::Vertical)
+        return section;
+
+    if (section < _headers.size())
+        return _headers.at(section);
+    return QVariant();
+}
+
+} // namespace data
+} // namespace pv
@@ -0,0 +1,73 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef DSVIEW_PV_DATA_STATEMODEL_H
+#define DSVIEW_PV_DATA_STATEMODEL_H
+
+#include <QAbstractTableModel>
+
+namespace pv {
+namespace data {
+
+class StateSnapshot;
+
+//Lists the states of a StateSnapshot, the rows are read on demand
+class StateModel : public QAbstractTableModel
+{
+public:
+    enum ValueFormat
+    {
+        FORMAT_HEX = 0,
+        FORMAT_DEC,
+        FORMAT_BIN,
+    };
+
+    enum Column
+    {
+        COL_SAMPLE = 0,
+        COL_TIME,
+        COL_VALUE,
+        COL_COUNT,
+    };
+
+public:
+    StateModel(QObject *parent = 0);
+
+    int rowCount(const QModelIndex & /*parent*/) const;
+    int columnCount(const QModelIndex & /*parent*/) const;
+    QVariant data(const QModelIndex &index, int role) const;
+    QVariant headerData(int section, Qt::Orientation orientation,int role) const;
+
+    void setStateSnapshot(StateSnapshot *states, uint64_t samplerate);
+    void setFormat(ValueFormat format);
+    void setHeaders(const QStringList &headers);
+
+private:
+    StateSnapshot  *_states;
+    uint64_t        _samplerate;
+    ValueFormat     _format;
+    QStringList     _headers;
+};
+
+} // namespace data
+} // namespace pv
+
+#endif // DSVIEW_PV_DATA_STATEMODEL_H
@@ -0,0 +1,121 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "statesnapshot.h"
+
+#include <algorithm>
+
+namespace pv {
+namespace data {
+
+StateSnapshot::StateSnapshot()
+{
+    _truncated = false;
+}
+
+void StateSnapshot::clear()
+{
+    std::vector<uint64_t>().swap(_positions);
+    std::vector<uint64_t>().swap(_values);
+    _data.clear();
+    _truncated = false;
+}
+
+bool StateSnapshot::extract(LogicSnapshot *snapshot, int clock, ClockEdge edge,
+                            const std::vector<int> &data, uint64_t start, uint64_t end,
+                            std::atomic<bool> *canceled)
+{
+    static const uint64_t EdgeBatch = 4096;
+
+    clear();
+
+    if (snapshot == NULL || data.size() > (size_t)MaxDataChannels)
+        return false;
+
+    LogicSnapshot::ChannelHandle clk = snapshot->get_channel(clock);
+    if (!clk.valid())
+        return false;
+
+    std::vector<LogicSnapshot::ChannelHandle> chans;
+    for (int index : data) {
+        LogicSnapshot::ChannelHandle ch = snapshot->get_channel(index);
+        if (!ch.valid())
+            return false;
+        chans.push_back(ch);
+    }
+    _data = data;
+
+    // the clock edges come in batches from the mipmap, the data bits of
+    // each batch are read channel by channel
+    std::vector<LogicSnapshot::EdgePair> edges(EdgeBatch);
+    uint64_t index = start;
+    end = std::min(end, snapshot->get_sample_count());
+
+    while (index < end) {
+        if (canceled != NULL && *canceled)
+            break;
+
+        const uint64_t num = snapshot->get_edges(index, end, clk, edges.data(), EdgeBatch);
+        if (num == 0)
+            break;
+
+        const uint64_t first = _positions.size();
+        for (uint64_t i = 0; i < num; i++) {
+            if (edge == EDGE_BOTH || edges[i].second == (edge == EDGE_RISING))
+                _positions.push_back(edges[i].first);
+        }
+
+        if (_positions.size() > MaxStates) {
+            _positions.resize(MaxStates);
+            _truncated = true;
+        }
+        gather(snapshot, chans, first);
+
+        if (_truncated)
+            break;
+    }
+
+    return true;
+}
+
+void StateSnapshot::gather(LogicSnapshot *snapshot,
+                           const std::vector<LogicSnapshot::ChannelHandle> &chans, uint64_t first)
+{
+    const uint64_t count = _positions.size();
+    _values.resize(count, 0);
+
+    const uint64_t *pos = _positions.data();
+    uint64_t *value = _values.data();
+
+    for (unsigned int bit = 0; bit < chans.size(); bit++) {
+        const LogicSnapshot::ChannelHandle ch = chans[bit];
+        for (uint64_t i = first; i < count; i++)
+            value[i] |= (uint64_t)snapshot->get_sample(pos[i], ch) << bit;
+    }
+}
+
+uint64_t StateSnapshot::find_state(uint64_t sample)
+{
+    return std::lower_bound(_positions.begin(), _positions.end(), sample) - _positions.begin();
+}
+
+} // namespace data
+} // namespace pv
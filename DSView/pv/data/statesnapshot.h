@@ -0,0 +1,107 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef DSVIEW_PV_DATA_STATESNAPSHOT_H
+#define DSVIEW_PV_DATA_STATESNAPSHOT_H
+
+#include <stdint.h>
+#include <vector>
+#include <atomic>
+
+#include "logicsnapshot.h"
+
+namespace pv {
+namespace data {
+
+//The value of a parallel bus at each active edge of its clock, taken
+//from a logic capture. Data channel i is bit i of the value, the data
+//is read at the edge sample, the first one with the new clock level.
+class StateSnapshot
+{
+public:
+    enum ClockEdge
+    {
+        EDGE_RISING = 0,
+        EDGE_FALLING,
+        EDGE_BOTH,
+    };
+
+    static const int MaxDataChannels = 64;
+    static const uint64_t MaxStates = 1ULL << 25;
+
+public:
+    StateSnapshot();
+
+    void clear();
+
+    // returns false if a channel has no data, stops early when canceled
+    // is set by another thread
+    bool extract(LogicSnapshot *snapshot, int clock, ClockEdge edge,
+                 const std::vector<int> &data, uint64_t start, uint64_t end,
+                 std::atomic<bool> *canceled = NULL);
+
+    inline uint64_t get_state_count(){
+        return _positions.size();
+    }
+
+    inline uint64_t get_position(uint64_t state){
+        return _positions[state];
+    }
+
+    inline uint64_t get_value(uint64_t state){
+        return _values[state];
+    }
+
+    inline const uint64_t* get_positions(){
+        return _positions.data();
+    }
+
+    inline const uint64_t* get_values(){
+        return _values.data();
+    }
+
+    // MaxStates reached, the table ends before the range
+    inline bool truncated(){
+        return _truncated;
+    }
+
+    inline const std::vector<int>& get_data_channels(){
+        return _data;
+    }
+
+    // the first state at or after the sample
+    uint64_t find_state(uint64_t sample);
+
+private:
+    void gather(LogicSnapshot *snapshot,
+                const std::vector<LogicSnapshot::ChannelHandle> &chans, uint64_t first);
+
+private:
+    std::vector<uint64_t> _positions;
+    std::vector<uint64_t> _values;
+    std::vector<int> _data;
+    bool _truncated;
+};
+
+} // namespace data
+} // namespace pv
+
+#endif // DSVIEW_PV_DATA_STATESNAPSHOT_H
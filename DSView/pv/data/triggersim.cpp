@@ -0,0 +1,328 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "triggersim.h"
+
+#include <assert.h>
+#include <string.h>
+#include <algorithm>
+
+#include "virtualchannel.h"
+
+namespace pv {
+namespace data {
+
+TriggerSim::TriggerSim(const ds_trigger_program &prog) :
+    _prog(prog),
+    _valid(0),
+    _truncated(false),
+    _missing_probe(-1)
+{
+    _used = used_probes();
+    memset(_level, 0, sizeof(_level));
+    memset(_rise, 0, sizeof(_rise));
+    memset(_fall, 0, sizeof(_fall));
+}
+
+const std::vector<uint64_t>& TriggerSim::get_fires()
+{
+    return _fires;
+}
+
+bool TriggerSim::truncated()
+{
+    return _truncated;
+}
+
+int TriggerSim::get_missing_probe()
+{
+    return _missing_probe;
+}
+
+uint64_t TriggerSim::used_probes()
+{
+    uint64_t used = 0;
+
+    if (_prog.mode == SERIAL_TRIGGER) {
+        for (int s = 0; s < 2; s++) {
+            for (int c = 0; c < 2; c++) {
+                const ds_trigger_cond &cond = _prog.stage[s].cond[c];
+                used |= ~cond.mask | cond.edge;
+            }
+        }
+        // the upper 16 data probes are in the second condition
+        const ds_trigger_stage_prog &data = _prog.stage[2];
+        used |= ~data.cond[0].mask & 0xffff;
+        used |= (uint64_t)(~data.cond[1].mask & 0xffff) << TriggerProbes;
+        return used & 0xffffffffULL;
+    }
+
+    const int first = (_prog.mode == SIMPLE_TRIGGER) ? TriggerStages : 0;
+    for (int s = first; s < first + _prog.stages; s++) {
+        for (int c = 0; c < 2; c++) {
+            const ds_trigger_cond &cond = _prog.stage[s].cond[c];
+            used |= ~cond.mask | cond.edge;
+        }
+    }
+    return used & 0xffffffffULL;
+}
+
+void TriggerSim::load_word(IWordSource *source, uint64_t word, uint64_t valid)
+{
+    _valid = valid;
+
+    for (uint64_t used = _used; used; used &= used - 1) {
+        const int p = bsf64(used);
+        const uint64_t w = source->GetSourceWord(p, word);
+        // the first sample has nothing before it, so no edge
+        const uint64_t prev = (word == 0) ? (w & 1) : (_level[p] >> 63);
+        const uint64_t before = (w << 1) | prev;
+
+        _rise[p] = w & ~before;
+        _fall[p] = ~w & before;
+        _level[p] = w;
+    }
+}
+
+uint64_t TriggerSim::cond_word(const ds_trigger_cond &cond)
+{
+    uint64_t m = _valid;
+    uint64_t probes = (~cond.mask | cond.edge) & _used;
+
+    for (; probes && m; probes &= probes - 1) {
+        const int p = bsf64(probes);
+        const uint32_t bit = 1U << p;
+
+        if (!(cond.mask & bit))
+            m &= (cond.value & bit) ? _level[p] : ~_level[p];
+        if (cond.edge & bit)
+            m &= (cond.mask & bit) ? (_rise[p] | _fall[p]) : ((cond.value & bit) ? _rise[p] : _fall[p]);
+    }
+    return m;
+}
+
+uint64_t TriggerSim::stage_word(const ds_trigger_stage_prog &stage)
+{
+    uint64_t w0 = cond_word(stage.cond[0]);
+    uint64_t w1 = cond_word(stage.cond[1]);
+    if (stage.inv[0])
+        w0 = ~w0 & _valid;
+    if (stage.inv[1])
+        w1 = ~w1 & _valid;
+    return (stage.logic & 1) ? (w0 & w1) : (w0 | w1);
+}
+
+bool TriggerSim::advance(const ds_trigger_stage_prog &stage, uint64_t match,
+                         int from, uint64_t &hits, int &pos)
+{
+    const uint64_t need = std::max(stage.count, (uint32_t)1);
+
+    if (!(stage.logic & 2)) {
+        // any matching samples, the need-th one passes
+        uint64_t m = match & from_bit(from);
+        const uint64_t num = popcnt64(m);
+        if (hits + num < need) {
+            hits += num;
+            return false;
+        }
+        for (uint64_t k = hits + 1; k < need; k++)
+            m &= m - 1;
+        pos = bsf64(m);
+        return true;
+    }
+
+    // runs of matching samples, the hits of a run which reaches the end
+    // of the word are carried to the next one
+    int i = from;
+    while (i < 64) {
+        const uint64_t r = match >> i;
+        if (r & 1) {
+            const int ones = (~r == 0) ? 64 - i : bsf64(~r);
+            if (hits + ones >= need) {
+                pos = i + (int)(need - hits) - 1;
+                return true;
+            }
+            hits += ones;
+            i += ones;
+        } else {
+            hits = 0;
+            if (r == 0)
+                return false;
+            i += bsf64(r);
+        }
+    }
+    return false;
+}
+
+bool TriggerSim::fire(uint64_t sample)
+{
+    if (_fires.size() >= MaxFires) {
+        _truncated = true;
+        return false;
+    }
+    _fires.push_back(sample);
+    return true;
+}
+
+void TriggerSim::run_stages(IWordSource *source, uint64_t words, uint64_t sample_count,
+                            std::atomic<bool> *canceled)
+{
+    const int first = (_prog.mode == SIMPLE_TRIGGER) ? TriggerStages : 0;
+    const int stages = (_prog.mode == SIMPLE_TRIGGER) ? 1 : _prog.stages;
+    std::vector<uint64_t> match(stages);
+    std::vector<bool> ready(stages);
+    int stage = 0;
+    uint64_t hits = 0;
+
+    for (uint64_t w = 0; w < words; w++) {
+        if (canceled != NULL && *canceled)
+            return;
+
+        const uint64_t left = sample_count - w * 64;
+        load_word(source, w, left >= 64 ? ~0ULL : ((1ULL << left) - 1));
+        std::fill(ready.begin(), ready.end(), false);
+
+        // the next stage looks at the samples after the one which
+        // passed the stage before
+        int from = 0;
+        while (from < 64) {
+            const ds_trigger_stage_prog &sp = _prog.stage[first + stage];
+            if (!ready[stage]) {
+                match[stage] = stage_word(sp);
+                ready[stage] = true;
+            }
+
+            int pos;
+            if (!advance(sp, match[stage], from, hits, pos))
+                break;
+
+            hits = 0;
+            if (++stage == stages) {
+                stage = 0;
+                if (!fire(w * 64 + pos))
+                    return;
+            }
+            from = pos + 1;
+        }
+    }
+}
+
+void TriggerSim::run_serial(IWordSource *source, uint64_t words, uint64_t sample_count,
+                            std::atomic<bool> *canceled)
+{
+    const ds_trigger_stage_prog &frame = _prog.stage[0];
+    const ds_trigger_stage_prog &clock = _prog.stage[1];
+    const ds_trigger_stage_prog &data = _prog.stage[2];
+    const ds_trigger_stage_prog &value = _prog.stage[STriggerDataStage];
+
+    int data_probe = -1;
+    if (~data.cond[0].mask & 0xffff)
+        data_probe = bsf64(~data.cond[0].mask & 0xffff);
+    else if (~data.cond[1].mask & 0xffff)
+        data_probe = TriggerProbes + bsf64(~data.cond[1].mask & 0xffff);
+    if (data_probe < 0)
+        return;
+
+    // the newest bit is bit 0 of the shift register
+    const int bits = std::min((int)value.count + 1, TriggerProbes);
+    const uint64_t bits_mask = (1ULL << bits) - 1;
+    const uint64_t care = ~(uint64_t)value.cond[0].mask & bits_mask;
+    const uint64_t expect = value.cond[0].value & care;
+
+    bool active = false;
+    uint64_t reg = 0;
+    int shifted = 0;
+
+    for (uint64_t w = 0; w < words; w++) {
+        if (canceled != NULL && *canceled)
+            return;
+
+        const uint64_t left = sample_count - w * 64;
+        load_word(source, w, left >= 64 ? ~0ULL : ((1ULL << left) - 1));
+
+        uint64_t start = cond_word(frame.cond[0]);
+        uint64_t stop = cond_word(frame.cond[1]);
+        if (frame.inv[0])
+            start = ~start & _valid;
+        if (frame.inv[1])
+            stop = ~stop & _valid;
+        const uint64_t edges = cond_word(clock.cond[0]);
+        const uint64_t level = _level[data_probe];
+
+        int from = 0;
+        while (from < 64) {
+            if (!active) {
+                const uint64_t m = start & from_bit(from);
+                if (m == 0)
+                    break;
+                from = bsf64(m) + 1;
+                active = true;
+                reg = 0;
+                shifted = 0;
+                continue;
+            }
+
+            const uint64_t m = (edges | stop) & from_bit(from);
+            if (m == 0)
+                break;
+            const int pos = bsf64(m);
+            from = pos + 1;
+
+            if ((stop >> pos) & 1) {
+                active = false;
+                continue;
+            }
+
+            reg = ((reg << 1) | ((level >> pos) & 1)) & bits_mask;
+            if (++shifted >= bits && (reg & care) == expect) {
+                active = false;
+                if (!fire(w * 64 + pos))
+                    return;
+            }
+        }
+    }
+}
+
+bool TriggerSim::run(IWordSource *source, uint64_t sample_count, uint64_t probe_mask,
+                     std::atomic<bool> *canceled)
+{
+    assert(source);
+
+    _fires.clear();
+    _truncated = false;
+    _missing_probe = -1;
+
+    const uint64_t missing = _used & ~probe_mask;
+    if (missing) {
+        _missing_probe = bsf64(missing);
+        return false;
+    }
+
+    const uint64_t words = (sample_count + 63) / 64;
+    if (_prog.mode == SERIAL_TRIGGER)
+        run_serial(source, words, sample_count, canceled);
+    else
+        run_stages(source, words, sample_count, canceled);
+    return true;
+}
+
+} // namespace data
+} // namespace pv
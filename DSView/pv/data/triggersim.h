@@ -0,0 +1,118 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef DSVIEW_PV_DATA_TRIGGERSIM_H
+#define DSVIEW_PV_DATA_TRIGGERSIM_H
+
+#include <stdint.h>
+#include <vector>
+#include <atomic>
+
+#include <libsigrok.h>
+
+namespace pv {
+namespace data {
+
+class IWordSource;
+
+//Runs a compiled trigger program over captured logic data, 64 samples
+//at a time. Each condition is reduced to one word of matching samples
+//from the level and edge words of its probes, the stages then walk the
+//words with popcount and bit scans. The program starts again from its
+//first stage after each fire, so all the places the trigger would fire
+//on are found.
+//The serial trigger shifts the data probe in on each clock edge between
+//the start and stop conditions, and fires when the last bits match.
+class TriggerSim
+{
+public:
+    static const uint64_t MaxFires = 1024;
+
+public:
+    TriggerSim(const ds_trigger_program &prog);
+
+    // probe_mask has bit n set when probe n has data in the source,
+    // returns false when the program needs a probe without data
+    bool run(IWordSource *source, uint64_t sample_count, uint64_t probe_mask,
+             std::atomic<bool> *canceled = NULL);
+
+    // sample indexes, in order
+    const std::vector<uint64_t>& get_fires();
+
+    // more fires than MaxFires
+    bool truncated();
+
+    // the first probe needed without data, or -1
+    int get_missing_probe();
+
+private:
+    uint64_t used_probes();
+    void load_word(IWordSource *source, uint64_t word, uint64_t valid);
+    uint64_t cond_word(const ds_trigger_cond &cond);
+    uint64_t stage_word(const ds_trigger_stage_prog &stage);
+
+    static bool advance(const ds_trigger_stage_prog &stage, uint64_t match,
+                        int from, uint64_t &hits, int &pos);
+
+    bool fire(uint64_t sample);
+    void run_stages(IWordSource *source, uint64_t words, uint64_t sample_count,
+                    std::atomic<bool> *canceled);
+    void run_serial(IWordSource *source, uint64_t words, uint64_t sample_count,
+                    std::atomic<bool> *canceled);
+
+    static inline uint64_t from_bit(int bit)
+    {
+        return bit >= 64 ? 0 : ~0ULL << bit;
+    }
+
+    static inline int popcnt64(uint64_t bb)
+    {
+        bb = bb - ((bb >> 1) & 0x5555555555555555ULL);
+        bb = (bb & 0x3333333333333333ULL) + ((bb >> 2) & 0x3333333333333333ULL);
+        bb = (bb + (bb >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return (int)((bb * 0x0101010101010101ULL) >> 56);
+    }
+
+    // the lowest set bit, bb must not be 0
+    static inline int bsf64(uint64_t bb)
+    {
+        return popcnt64((bb & (0 - bb)) - 1);
+    }
+
+private:
+    ds_trigger_program _prog;
+    uint64_t _used;
+
+    // the words of the used probes at the current position
+    uint64_t _level[MaxTriggerProbes];
+    uint64_t _rise[MaxTriggerProbes];
+    uint64_t _fall[MaxTriggerProbes];
+    uint64_t _valid;
+
+    std::vector<uint64_t> _fires;
+    bool _truncated;
+    int _missing_probe;
+};
+
+} // namespace data
+} // namespace pv
+
+#endif // DSVIEW_PV_DATA_TRIGGERSIM_H
@@ -0,0 +1,331 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "virtualchannel.h"
+
+#include <algorithm>
+
+namespace pv {
+namespace data {
+
+VirtualChannel::VirtualChannel(int index, const QString &name)
+{
+    _index = index;
+    _name = name;
+    _root = NULL;
+    _word = 0;
+    _pos = 0;
+}
+
+VirtualChannel::~VirtualChannel()
+{
+    free_node(_root);
+}
+
+bool VirtualChannel::compile(const QString &expression, QString &error)
+{
+    free_node(_root);
+    _root = NULL;
+    _sources.clear();
+    _expression = expression;
+    _text = expression;
+    _pos = 0;
+
+    _root = parse_or(error);
+    skip_space();
+
+    if (_root != NULL && _pos < _text.length()) {
+        error = QString("unexpected \"%1\" at %2").arg(_text.mid(_pos, 1)).arg(_pos + 1);
+        free_node(_root);
+        _root = NULL;
+    }
+    if (_root == NULL) {
+        _sources.clear();
+        return false;
+    }
+
+    std::sort(_sources.begin(), _sources.end());
+    _sources.erase(std::unique(_sources.begin(), _sources.end()), _sources.end());
+    reset();
+    return true;
+}
+
+void VirtualChannel::reset()
+{
+    _word = 0;
+    reset_node(_root);
+}
+
+uint64_t VirtualChannel::eval(Node *node, IWordSource *src, uint64_t word)
+{
+    switch (node->type)
+    {
+    case NODE_CONST:
+        return node->arg;
+    case NODE_CHANNEL:
+        return src->GetSourceWord((int)node->arg, word);
+    case NODE_NOT:
+        return ~eval(node->a, src, word);
+    case NODE_AND:
+        return eval(node->a, src, word) & eval(node->b, src, word);
+    case NODE_OR:
+        return eval(node->a, src, word) | eval(node->b, src, word);
+    case NODE_XOR:
+        return eval(node->a, src, word) ^ eval(node->b, src, word);
+    case NODE_DELAY:
+    {
+        // the delay line keeps the input words still needed by the output
+        const uint64_t shift = node->arg / 64;
+        const uint64_t bits = node->arg % 64;
+        const uint64_t size = node->history.size();
+        node->history[word % size] = eval(node->a, src, word);
+        const uint64_t hi = word >= shift ? node->history[(word - shift) % size] : 0;
+        const uint64_t lo = word >= shift + 1 ? node->history[(word - shift - 1) % size] : 0;
+        return bits == 0 ? hi : (hi << bits) | (lo >> (64 - bits));
+    }
+    case NODE_FILTER:
+        return eval_filter(node, eval(node->a, src, word));
+    }
+
+    return 0;
+}
+
+uint64_t VirtualChannel::eval_filter(Node *node, uint64_t cur)
+{
+    const uint64_t prev = node->history[0];
+    node->history[0] = cur;
+
+    // ones/zeros: the input was high/low for the last n samples
+    uint64_t ones = cur;
+    uint64_t zeros = ~cur;
+    for (uint64_t k = 1; k < node->arg; k++) {
+        const uint64_t s = (cur << k) | (prev >> (64 - k));
+        ones &= s;
+        zeros &= ~s;
+    }
+
+    // a set/reset latch over the word: the output takes the level of the
+    // latest stable run, the carry of the add moves it over the other bits
+    const uint64_t hold = ~zeros;
+    const uint64_t carry = (ones + hold + node->state) ^ ones ^ hold;
+    const uint64_t out = ones | (carry & hold);
+    node->state = out >> 63;
+    return out;
+}
+
+VirtualChannel::Node* VirtualChannel::new_node(NodeType type, Node *a, Node *b)
+{
+    Node *node = new Node();
+    node->type = type;
+    node->arg = 0;
+    node->a = a;
+    node->b = b;
+    node->state = 0;
+    return node;
+}
+
+void VirtualChannel::free_node(Node *node)
+{
+    if (node == NULL)
+        return;
+    free_node(node->a);
+    free_node(node->b);
+    delete node;
+}
+
+void VirtualChannel::reset_node(Node *node)
+{
+    if (node == NULL)
+        return;
+    std::fill(node->history.begin(), node->history.end(), 0);
+    node->state = 0;
+    reset_node(node->a);
+    reset_node(node->b);
+}
+
+void VirtualChannel::skip_space()
+{
+    while (_pos < _text.length() && _text[_pos].isSpace())
+        _pos++;
+}
+
+bool VirtualChannel::accept(QChar c)
+{
+    skip_space();
+    if (_pos < _text.length() && _text[_pos] == c) {
+        _pos++;
+        return true;
+    }
+    return false;
+}
+
+bool VirtualChannel::parse_number(uint64_t &value)
+{
+    skip_space();
+    const int start = _pos;
+    value = 0;
+    while (_pos < _text.length() && _text[_pos].isDigit()) {
+        if (value > MaxDelay)
+            return false;
+        value = value * 10 + _text[_pos].digitValue();
+        _pos++;
+    }
+    return _pos > start;
+}
+
+VirtualChannel::Node* VirtualChannel::parse_or(QString &error)
+{
+    Node *node = parse_xor(error);
+    while (node != NULL && accept('|')) {
+        Node *b = parse_xor(error);
+        if (b == NULL) {
+            free_node(node);
+            return NULL;
+        }
+        node = new_node(NODE_OR, node, b);
+    }
+    return node;
+}
+
+VirtualChannel::Node* VirtualChannel::parse_xor(QString &error)
+{
+    Node *node = parse_and(error);
+    while (node != NULL && accept('^')) {
+        Node *b = parse_and(error);
+        if (b == NULL) {
+            free_node(node);
+            return NULL;
+        }
+        node = new_node(NODE_XOR, node, b);
+    }
+    return node;
+}
+
+VirtualChannel::Node* VirtualChannel::parse_and(QString &error)
+{
+    Node *node = parse_unary(error);
+    while (node != NULL && accept('&')) {
+        Node *b = parse_unary(error);
+        if (b == NULL) {
+            free_node(node);
+            return NULL;
+        }
+        node = new_node(NODE_AND, node, b);
+    }
+    return node;
+}
+
+VirtualChannel::Node* VirtualChannel::parse_unary(QString &error)
+{
+    if (accept('~') || accept('!')) {
+        Node *a = parse_unary(error);
+        if (a == NULL)
+            return NULL;
+        return new_node(NODE_NOT, a, NULL);
+    }
+    return parse_primary(error);
+}
+
+VirtualChannel::Node* VirtualChannel::parse_primary(QString &error)
+{
+    skip_space();
+
+    if (_pos >= _text.length()) {
+        error = "unexpected end of the expression";
+        return NULL;
+    }
+
+    if (accept('(')) {
+        Node *node = parse_or(error);
+        if (node != NULL && !accept(')')) {
+            error = QString("missing \")\" at %1").arg(_pos + 1);
+            free_node(node);
+            return NULL;
+        }
+        return node;
+    }
+
+    const int start = _pos;
+    uint64_t value;
+
+    if (_text[_pos].isDigit()) {
+        if (!parse_number(value) || value > 1) {
+            error = QString("only 0 and 1 are constants, at %1").arg(start + 1);
+            return NULL;
+        }
+        Node *node = new_node(NODE_CONST, NULL, NULL);
+        node->arg = value ? ~0ULL : 0;
+        return node;
+    }
+
+    while (_pos < _text.length() && (_text[_pos].isLetter() || _text[_pos] == '_'))
+        _pos++;
+    const QString name = _text.mid(start, _pos - start).toLower();
+
+    if (name == "d") {
+        if (!parse_number(value) || value >= 64) {
+            error = QString("bad channel number at %1").arg(start + 1);
+            return NULL;
+        }
+        Node *node = new_node(NODE_CHANNEL, NULL, NULL);
+        node->arg = value;
+        _sources.push_back((int)value);
+        return node;
+    }
+
+    if (name == "delay" || name == "filter") {
+        const bool is_delay = (name == "delay");
+
+        if (!accept('(')) {
+            error = QString("missing \"(\" after %1").arg(name);
+            return NULL;
+        }
+        Node *a = parse_or(error);
+        if (a == NULL)
+            return NULL;
+        if (!accept(',') || !parse_number(value) || !accept(')')) {
+            error = QString("%1 takes an expression and a sample count").arg(name);
+            free_node(a);
+            return NULL;
+        }
+        if (is_delay && value > MaxDelay) {
+            error = QString("delay is limited to %1 samples").arg(MaxDelay);
+            free_node(a);
+            return NULL;
+        }
+        if (!is_delay && (value < 1 || value > (uint64_t)MaxFilter)) {
+            error = QString("filter width must be 1 to %1 samples").arg(MaxFilter);
+            free_node(a);
+            return NULL;
+        }
+
+        Node *node = new_node(is_delay ? NODE_DELAY : NODE_FILTER, a, NULL);
+        node->arg = value;
+        node->history.assign(is_delay ? value / 64 + 2 : 1, 0);
+        return node;
+    }
+
+    error = QString("unknown \"%1\" at %2").arg(name.isEmpty() ? _text.mid(start, 1) : name).arg(start + 1);
+    return NULL;
+}
+
+} // namespace data
+} // namespace pv
@@ -0,0 +1,143 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef DSVIEW_PV_DATA_VIRTUALCHANNEL_H
+#define DSVIEW_PV_DATA_VIRTUALCHANNEL_H
+
+#include <stdint.h>
+#include <vector>
+#include <QString>
+
+namespace pv {
+namespace data {
+
+//Gives the 64 samples of a word of a captured channel
+class IWordSource
+{
+public:
+    virtual uint64_t GetSourceWord(int sig_index, uint64_t word_index)=0;
+};
+
+//A logic channel computed from other logic channels, 64 samples per step.
+//Expression syntax, lowest precedence first:
+//  a | b        or
+//  a ^ b        xor
+//  a & b        and
+//  ~a  !a       not
+//  (a)  D<n>  0  1
+//  delay(a, n)  a delayed by n samples, low before the capture
+//  filter(a, n) pulses shorter than n samples removed, n <= 64,
+//               the edges are delayed by n - 1 samples
+//The words must be read in order from word 0, see reset().
+class VirtualChannel
+{
+public:
+    static const uint64_t MaxDelay = 1ULL << 28;
+    static const int MaxFilter = 64;
+
+public:
+    VirtualChannel(int index, const QString &name);
+    ~VirtualChannel();
+
+    // returns false and sets error if the expression is wrong
+    bool compile(const QString &expression, QString &error);
+
+    // start again from word 0
+    void reset();
+
+    // the next word of the channel
+    inline uint64_t next_word(IWordSource *src){
+        return eval(_root, src, _word++);
+    }
+
+    inline int get_index(){
+        return _index;
+    }
+
+    inline QString get_name(){
+        return _name;
+    }
+
+    inline QString get_expression(){
+        return _expression;
+    }
+
+    // the channels used by the expression
+    inline const std::vector<int>& get_sources(){
+        return _sources;
+    }
+
+private:
+    enum NodeType
+    {
+        NODE_CONST = 0,
+        NODE_CHANNEL,
+        NODE_NOT,
+        NODE_AND,
+        NODE_OR,
+        NODE_XOR,
+        NODE_DELAY,
+        NODE_FILTER,
+    };
+
+    struct Node
+    {
+        NodeType type;
+        uint64_t arg;       // constant word, channel, delay or filter width
+        Node *a;
+        Node *b;
+        std::vector<uint64_t> history;  // delay line, filter: previous input
+        uint64_t state;     // filter: last output sample
+    };
+
+    uint64_t eval(Node *node, IWordSource *src, uint64_t word);
+    uint64_t eval_filter(Node *node, uint64_t cur);
+
+    Node* new_node(NodeType type, Node *a, Node *b);
+    void free_node(Node *node);
+    void reset_node(Node *node);
+
+    Node* parse_or(QString &error);
+    Node* parse_xor(QString &error);
+    Node* parse_and(QString &error);
+    Node* parse_unary(QString &error);
+    Node* parse_primary(QString &error);
+    bool parse_number(uint64_t &value);
+    void skip_space();
+    bool accept(QChar c);
+
+private:
+    int _index;
+    QString _name;
+    QString _expression;
+    std::vector<int> _sources;
+    Node *_root;
+    uint64_t _word;
+
+    // parser state
+    QString _text;
+    int _pos;
+};
+
+} // namespace data
+} // namespace pv
+
+#endif // DSVIEW_PV_DATA_VIRTUALCHANNEL_H
@@ -27,6 +27,8 @@
 #include "../config/appconfig.h"
 
 #include "../ui/langresource.h"
+#include "../appcontrol.h"
+#include "../sigsession.h"
 
 namespace pv
 {
@@ -56,6 +58,10 @@ bool ApplicationParamDlg::ShowDlg(QWidget *parent)
     QCheckBox *ck_quickScroll = new QCheckBox();
     ck_quickScroll->setChecked(app._appOptions.quickScroll);
     lay.addRow(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_QUICK_SCROLL), "Quick scroll"), ck_quickScroll);
+
+    QCheckBox *ck_streamData = new QCheckBox();
+    ck_streamData->setChecked(app._appOptions.streamData);
+    lay.addRow(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STREAM_DATA), "Stream data to local programs"), ck_streamData);
     dlg.layout()->addLayout(&lay);  
      
     dlg.exec();
@@ -65,7 +71,14 @@ bool ApplicationParamDlg::ShowDlg(QWidget *parent)
     //save config
     if (ret){
         app._appOptions.quickScroll = ck_quickScroll->isChecked();
+        app._appOptions.streamData = ck_streamData->isChecked();
         app.SaveApp();
+
+        StreamServer *server = AppControl::Instance()->GetSession()->get_stream_server();
+        if (app._appOptions.streamData)
+            server->start();
+        else
+            server->stop();
     }
    
    return ret;
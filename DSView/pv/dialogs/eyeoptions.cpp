@@ -0,0 +1,178 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2015 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "eyeoptions.h"
+#include "../sigsession.h"
+#include "../view/view.h"
+#include "../view/eyetrace.h"
+#include "../view/dsosignal.h"
+#include "../view/analogsignal.h"
+#include "../view/mathtrace.h"
+
+#include <QVariant>
+#include <QHBoxLayout>
+
+#include "../ui/langresource.h"
+
+using namespace std;
+using namespace pv::view;
+
+namespace pv {
+namespace dialogs {
+
+EyeOptions::EyeOptions(SigSession *session, QWidget *parent) :
+    DSDialog(parent),
+    _session(session),
+    _button_box(QDialogButtonBox::Ok | QDialogButtonBox::Cancel,
+        Qt::Horizontal, this)
+{
+    _enable = NULL;
+    _channel_group = NULL;
+    _recover = NULL;
+    _period_label = NULL;
+    _period = NULL;
+    _layout = NULL;
+
+    setMinimumSize(300, 200);
+
+    _enable = new QCheckBox(this);
+    _recover = new QCheckBox(this);
+    _period_label = new QLabel(this);
+    _period = new QDoubleSpinBox(this);
+    _period->setRange(0.001, 1e9);
+    _period->setDecimals(3);
+    _period->setValue(1000);
+
+    _channel_group = new QGroupBox(this);
+    QHBoxLayout *channel_layout = new QHBoxLayout();
+
+    for(auto &s : _session->get_signals()) {
+        if (!dynamic_cast<view::DsoSignal*>(s) && !dynamic_cast<view::AnalogSignal*>(s))
+            continue;
+        QRadioButton *radio = new QRadioButton(QString::number(s->get_index()), _channel_group);
+        radio->setProperty("index", s->get_index());
+        channel_layout->addWidget(radio);
+        _channel_radio.append(radio);
+    }
+    _channel_group->setLayout(channel_layout);
+
+    auto eye = _session->get_eye_trace();
+    int index = -1;
+    if (eye) {
+        _enable->setChecked(eye->enabled());
+        _recover->setChecked(eye->period() == 0);
+        if (eye->period() != 0)
+            _period->setValue(eye->period() * 1e9);
+        index = eye->get_index();
+    } else {
+        _enable->setChecked(false);
+        _recover->setChecked(true);
+    }
+    for (QRadioButton *radio : _channel_radio) {
+        if (index == -1 || radio->property("index").toInt() == index) {
+            radio->setChecked(true);
+            break;
+        }
+    }
+    _period->setEnabled(!_recover->isChecked());
+
+    _layout = new QGridLayout();
+    _layout->setSpacing(0);
+    _layout->addWidget(_enable, 0, 0, 1, 2);
+    _layout->addWidget(_channel_group, 1, 0, 1, 2);
+    _layout->addWidget(_recover, 2, 0, 1, 2);
+    _layout->addWidget(_period_label, 3, 0, 1, 1);
+    _layout->addWidget(_period, 3, 1, 1, 1);
+    _layout->addWidget(new QLabel(this), 4, 1, 1, 1);
+    _layout->addWidget(&_button_box, 5, 1, 1, 1, Qt::AlignHCenter | Qt::AlignBottom);
+
+    layout()->addLayout(_layout);
+
+    connect(&_button_box, SIGNAL(rejected()), this, SLOT(reject()));
+    connect(&_button_box, SIGNAL(accepted()), this, SLOT(accept()));
+    connect(_recover, SIGNAL(toggled(bool)), this, SLOT(recover_changed(bool)));
+
+    retranslateUi();
+}
+
+void EyeOptions::changeEvent(QEvent *event)
+{
+    if (event->type() == QEvent::LanguageChange)
+        retranslateUi();
+    DSDialog::changeEvent(event);
+}
+
+void EyeOptions::retranslateUi()
+{
+    _enable->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_ENABLE), "Enable"));
+    _channel_group->setTitle(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_EYE_CHANNEL), "Channel"));
+    _recover->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_EYE_RECOVER), "Recover clock"));
+    _period_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_EYE_PERIOD), "Clock period (ns)"));
+    setTitle(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_EYE_OPTIONS), "Eye Diagram Options"));
+}
+
+void EyeOptions::recover_changed(bool recover)
+{
+    _period->setEnabled(!recover);
+}
+
+void EyeOptions::accept()
+{
+	using namespace Qt;
+    QDialog::accept();
+
+    int index = -1;
+    for (QRadioButton *radio : _channel_radio) {
+        if (radio->isChecked()) {
+            index = radio->property("index").toInt();
+            break;
+        }
+    }
+    bool enable = (index != -1 && _enable->isChecked());
+    double period = _recover->isChecked() ? 0 : _period->value() * 1e-9;
+
+    // the eye and the lissajous figure take the whole view
+    if (enable)
+        _session->lissajous_disable();
+    _session->eye_rebuild(enable, index, period);
+
+    for(auto &s : _session->get_signals()) {
+        view::DsoSignal *dsoSig = NULL;
+        view::AnalogSignal *analogSig = NULL;
+        if ((dsoSig = dynamic_cast<view::DsoSignal*>(s)))
+            dsoSig->set_show(!enable);
+        else if ((analogSig = dynamic_cast<view::AnalogSignal*>(s)))
+            analogSig->set_show(!enable);
+    }
+    auto mathTrace = _session->get_math_trace();
+    if (mathTrace && mathTrace->enabled()) {
+        mathTrace->set_show(!enable);
+    }
+}
+
+void EyeOptions::reject()
+{
+    using namespace Qt;
+    QDialog::reject();
+}
+
+} // namespace dialogs
+} // namespace pv
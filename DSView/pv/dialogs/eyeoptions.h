@@ -0,0 +1,78 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2015 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+#ifndef DSVIEW_PV_EYEOPTIONS_H
+#define DSVIEW_PV_EYEOPTIONS_H
+
+#include <QGridLayout>
+#include <QDialogButtonBox>
+#include <QGroupBox>
+#include <QCheckBox>
+#include <QRadioButton>
+#include <QDoubleSpinBox>
+#include <QLabel>
+
+#include "../toolbars/titlebar.h"
+#include "dsdialog.h"
+
+namespace pv {
+
+class SigSession;
+
+namespace dialogs {
+
+class EyeOptions : public DSDialog
+{
+	Q_OBJECT
+
+public:
+    EyeOptions(SigSession *session, QWidget *parent);
+
+private:
+    void changeEvent(QEvent *event);
+    void retranslateUi();
+
+protected:
+	void accept();
+    void reject();
+
+private slots:
+    void recover_changed(bool recover);
+
+private:
+    SigSession *_session;
+
+    QCheckBox *_enable;
+    QGroupBox *_channel_group;
+    QCheckBox *_recover;
+    QLabel *_period_label;
+    QDoubleSpinBox *_period;
+    QGridLayout *_layout;
+
+    QVector<QRadioButton *> _channel_radio;
+    QDialogButtonBox _button_box;
+};
+
+} // namespace dialogs
+} // namespace pv
+
+#endif // DSVIEW_PV_EYEOPTIONS_H
@@ -42,8 +42,8 @@ Interval::Interval(QWidget *parent) :
     setMinimumWidth(300);
     _interval_label = new QLabel(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_INTERVAL_S), "Interval(s): "), this);
     _interval_spinBox = new QDoubleSpinBox(this);
-    _interval_spinBox->setRange(0.1, 10);
-    _interval_spinBox->setDecimals(1);
+    _interval_spinBox->setRange(0, 10);
+    _interval_spinBox->setDecimals(3);
     _interval_spinBox->setButtonSymbols(QAbstractSpinBox::NoButtons);
     _interval_slider = new QSlider(Qt::Horizontal, this);
     _interval_slider->setRange(0, 10);
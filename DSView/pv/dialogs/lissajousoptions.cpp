@@ -180,6 +180,8 @@ void LissajousOptions::accept()
         }
     }
     bool enable = (xindex != -1 && yindex != -1 && _enable->isChecked());
+    if (enable)
+        _session->eye_disable();
     _session->lissajous_rebuild(enable, xindex, yindex, _percent->value());
 
     for(auto &s : _session->get_signals()) {
@@ -55,25 +55,68 @@ MathOptions::MathOptions(SigSession *session, QWidget *parent) :
     lisa_label->setPixmap(QPixmap(":/icons/math.svg"));
 
     _math_group = new QGroupBox(this);
-    QHBoxLayout *type_layout = new QHBoxLayout();
+    QGridLayout *type_layout = new QGridLayout();
     QRadioButton *add_radio = new QRadioButton(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_ADD), "Add"), _math_group);
     add_radio->setProperty("type", data::MathStack::MATH_ADD);
-    type_layout->addWidget(add_radio);
+    type_layout->addWidget(add_radio, 0, 0);
     QRadioButton *sub_radio = new QRadioButton(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_SUBSTRACT), "Substract"), _math_group);
     sub_radio->setProperty("type", data::MathStack::MATH_SUB);
-    type_layout->addWidget(sub_radio);
+    type_layout->addWidget(sub_radio, 0, 1);
     QRadioButton *mul_radio = new QRadioButton(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_MULTIPLY), "Multiply"), _math_group);
     mul_radio->setProperty("type", data::MathStack::MATH_MUL);
-    type_layout->addWidget(mul_radio);
+    type_layout->addWidget(mul_radio, 0, 2);
     QRadioButton *div_radio = new QRadioButton(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_DIVIDE), "Divide"), _math_group);
     div_radio->setProperty("type", data::MathStack::MATH_DIV);
-    type_layout->addWidget(div_radio);
+    type_layout->addWidget(div_radio, 0, 3);
+    QRadioButton *fir_radio = new QRadioButton(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_FIR_FILTER), "FIR Low Pass"), _math_group);
+    fir_radio->setProperty("type", data::MathStack::MATH_FIR);
+    type_layout->addWidget(fir_radio, 1, 0);
+    QRadioButton *iir_radio = new QRadioButton(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_IIR_FILTER), "IIR Low Pass"), _math_group);
+    iir_radio->setProperty("type", data::MathStack::MATH_IIR);
+    type_layout->addWidget(iir_radio, 1, 1);
+    QRadioButton *avg_radio = new QRadioButton(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_MOVING_AVERAGE), "Moving Average"), _math_group);
+    avg_radio->setProperty("type", data::MathStack::MATH_AVERAGE);
+    type_layout->addWidget(avg_radio, 1, 2);
+    QRadioButton *median_radio = new QRadioButton(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_MOVING_MEDIAN), "Median"), _math_group);
+    median_radio->setProperty("type", data::MathStack::MATH_MEDIAN);
+    type_layout->addWidget(median_radio, 1, 3);
     _math_radio.append(add_radio);
     _math_radio.append(sub_radio);
     _math_radio.append(mul_radio);
     _math_radio.append(div_radio);
+    _math_radio.append(fir_radio);
+    _math_radio.append(iir_radio);
+    _math_radio.append(avg_radio);
+    _math_radio.append(median_radio);
     _math_group->setLayout(type_layout);
 
+    // the filters take the 1st source only
+    _filter_group = new QGroupBox(this);
+    _cutoff_label = new QLabel(this);
+    _cutoff = new QDoubleSpinBox(this);
+    _cutoff->setRange(0.001, 1e6);
+    _cutoff->setDecimals(3);
+    _cutoff->setValue(1000);
+    _length_label = new QLabel(this);
+    _length = new QSpinBox(this);
+    _length->setRange(1, data::MathFilter::MaxTaps);
+    _length->setValue(31);
+    _window_label = new QLabel(this);
+    _window = new QComboBox(this);
+    _window->addItem(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_WINDOW_RECTANGLE), "Rectangle"), data::MathFilter::WINDOW_RECTANGLE);
+    _window->addItem(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_WINDOW_HANN), "Hann"), data::MathFilter::WINDOW_HANN);
+    _window->addItem(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_WINDOW_HAMMING), "Hamming"), data::MathFilter::WINDOW_HAMMING);
+    _window->addItem(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_WINDOW_BLACKMAN), "Blackman"), data::MathFilter::WINDOW_BLACKMAN);
+    _window->setCurrentIndex(_window->findData(data::MathFilter::WINDOW_HAMMING));
+    QGridLayout *filter_layout = new QGridLayout();
+    filter_layout->addWidget(_cutoff_label, 0, 0);
+    filter_layout->addWidget(_cutoff, 0, 1);
+    filter_layout->addWidget(_length_label, 1, 0);
+    filter_layout->addWidget(_length, 1, 1);
+    filter_layout->addWidget(_window_label, 2, 0);
+    filter_layout->addWidget(_window, 2, 1);
+    _filter_group->setLayout(filter_layout);
+
     _src1_group = new QGroupBox(this);
     _src2_group = new QGroupBox(this);
     QHBoxLayout *src1_layout = new QHBoxLayout();
@@ -121,6 +164,14 @@ MathOptions::MathOptions(SigSession *session, QWidget *parent) :
                 break;
             }
         }
+        if (math->get_math_stack()->is_filter()) {
+            const data::MathFilter::Params params = math->get_math_stack()->get_filter();
+            if (params.cutoff > 0)
+                _cutoff->setValue(params.cutoff / 1000);
+            _window->setCurrentIndex(_window->findData(params.window));
+            _length->setRange(1, data::MathFilter::MaxTaps);
+            _length->setValue(params.length);
+        }
     } else {
         _enable->setChecked(false);
         for (QVector<QRadioButton *>::const_iterator i = _src1_radio.begin();
@@ -147,13 +198,16 @@ MathOptions::MathOptions(SigSession *session, QWidget *parent) :
     _layout->addWidget(_math_group, 2, 0, 1, 2);
     _layout->addWidget(_src1_group, 3, 0, 1, 1);
     _layout->addWidget(_src2_group, 3, 1, 1, 1);
-    _layout->addWidget(new QLabel(this), 4, 1, 1, 1);
-    _layout->addWidget(&_button_box, 5, 1, 1, 1, Qt::AlignHCenter | Qt::AlignBottom);
+    _layout->addWidget(_filter_group, 4, 0, 1, 2);
+    _layout->addWidget(new QLabel(this), 5, 1, 1, 1);
+    _layout->addWidget(&_button_box, 6, 1, 1, 1, Qt::AlignHCenter | Qt::AlignBottom);
 
     layout()->addLayout(_layout);
 
     connect(&_button_box, SIGNAL(rejected()), this, SLOT(reject()));
     connect(&_button_box, SIGNAL(accepted()), this, SLOT(accept()));
+    for (QRadioButton *radio : _math_radio)
+        connect(radio, SIGNAL(toggled(bool)), this, SLOT(math_type_changed()));
 
     retranslateUi();
 }
@@ -171,7 +225,46 @@ void MathOptions::retranslateUi()
     _math_group->setTitle(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_MATH_TYPE), "Math Type"));
     _src1_group->setTitle(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_1ST_SOURCE), "1st Source"));
     _src2_group->setTitle(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_2ST_SOURCE), "2st Source"));
+    _filter_group->setTitle(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_FILTER), "Filter"));
+    _cutoff_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_FILTER_CUTOFF), "Cutoff (kHz)"));
+    _window_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_FILTER_WINDOW), "Window"));
     setTitle(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_MATH_OPTIONS), "Math Options"));
+    math_type_changed();
+}
+
+int MathOptions::checked_type()
+{
+    for (QRadioButton *radio : _math_radio) {
+        if (radio->isChecked())
+            return radio->property("type").toInt();
+    }
+    return data::MathStack::MATH_ADD;
+}
+
+void MathOptions::math_type_changed()
+{
+    const int type = checked_type();
+    const bool filter = (type == data::MathStack::MATH_FIR || type == data::MathStack::MATH_IIR ||
+                         type == data::MathStack::MATH_AVERAGE || type == data::MathStack::MATH_MEDIAN);
+
+    _src2_group->setEnabled(!filter);
+    _filter_group->setEnabled(filter);
+    _cutoff->setEnabled(type == data::MathStack::MATH_FIR || type == data::MathStack::MATH_IIR);
+    _window->setEnabled(type == data::MathStack::MATH_FIR);
+
+    if (type == data::MathStack::MATH_FIR) {
+        _length_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_FILTER_TAPS), "Taps"));
+        _length->setRange(3, data::MathFilter::MaxTaps);
+        _length->setSingleStep(2);
+    } else if (type == data::MathStack::MATH_IIR) {
+        _length_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_FILTER_ORDER), "Order"));
+        _length->setRange(1, data::MathFilter::MaxOrder);
+        _length->setSingleStep(1);
+    } else {
+        _length_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_FILTER_SAMPLES), "Samples"));
+        _length->setRange(2, data::MathFilter::MaxWindow);
+        _length->setSingleStep(1);
+    }
 }
 
 void MathOptions::accept()
@@ -203,6 +296,18 @@ void MathOptions::accept()
             break;
         }
     }
+    data::MathFilter::Params filter;
+    filter.type = data::MathFilter::FILTER_AVERAGE;
+    filter.window = _window->currentData().toInt();
+    filter.length = _length->value();
+    filter.cutoff = _cutoff->value() * 1000;
+
+    // the filters only read the 1st source
+    const bool is_filter = (type == data::MathStack::MATH_FIR || type == data::MathStack::MATH_IIR ||
+                            type == data::MathStack::MATH_AVERAGE || type == data::MathStack::MATH_MEDIAN);
+    if (is_filter)
+        src2 = src1;
+
     bool enable = (src1 != -1 && src2 != -1 && _enable->isChecked());
     view::DsoSignal *dsoSig1 = NULL;
     view::DsoSignal *dsoSig2 = NULL;
@@ -216,7 +321,7 @@ void MathOptions::accept()
                 dsoSig2 = dsoSig;
         }
     }
-    _session->math_rebuild(enable, dsoSig1, dsoSig2, type);
+    _session->math_rebuild(enable, dsoSig1, dsoSig2, type, filter);
 }
 
 void MathOptions::reject()
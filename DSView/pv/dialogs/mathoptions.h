@@ -31,6 +31,10 @@
 #include <QCheckBox>
 #include <QRadioButton>
 #include <QSlider>
+#include <QLabel>
+#include <QSpinBox>
+#include <QDoubleSpinBox>
+#include <QComboBox>
  
 
 #include "../view/dsosignal.h"
@@ -60,11 +64,15 @@ public:
 private:
     void changeEvent(QEvent *event);
     void retranslateUi();
+    int checked_type();
 
 protected:
 	void accept();
     void reject();
 
+private slots:
+    void math_type_changed();
+
 private:
     SigSession *_session;
 
@@ -75,6 +83,14 @@ private:
     QVector<QRadioButton *> _src1_radio;
     QVector<QRadioButton *> _src2_radio;
     QVector<QRadioButton *> _math_radio;
+
+    QGroupBox *_filter_group;
+    QLabel *_cutoff_label;
+    QDoubleSpinBox *_cutoff;
+    QLabel *_length_label;
+    QSpinBox *_length;
+    QLabel *_window_label;
+    QComboBox *_window;
     QDialogButtonBox _button_box;
     QGridLayout *_layout;
 };
@@ -27,8 +27,7 @@
 #include <QFileDialog>
 #include <QTextStream>
 #include <QProgressDialog>
-#include <QFuture>
-#include <QtConcurrent/QtConcurrent>
+#include "../taskscheduler.h"
 
 #include "../sigsession.h"
 #include "../data/decoderstack.h"
@@ -156,11 +155,6 @@ void ProtocolExp::accept()
     }
     _fileName = file_name;
  
-    QFuture<void> future;
-    future = QtConcurrent::run([&]{
-                    save_proc();
-               });
-
     Qt::WindowFlags flags = Qt::CustomizeWindowHint;
     QProgressDialog dlg(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_EXPORT_PROTOCOL_LIST_RESULT), 
                         "Export Protocol List Result... It can take a while."),
@@ -169,16 +163,17 @@ void ProtocolExp::accept()
     dlg.setWindowFlags(Qt::Dialog | Qt::FramelessWindowHint | Qt::WindowSystemMenuHint |
                        Qt::WindowMinimizeButtonHint | Qt::WindowMaximizeButtonHint);
 
-    QFutureWatcher<void> watcher;
-
-    connect(&watcher, SIGNAL(finished()), &dlg, SLOT(cancel()));
     connect(this, SIGNAL(export_progress(int)), &dlg, SLOT(setValue(int)));
     connect(&dlg, SIGNAL(canceled()), this, SLOT(cancel_export()));
 
-    watcher.setFuture(future);
+    TaskPtr task = TaskScheduler::Instance().submit(TaskScheduler::TaskExport, [&](Task &){
+        save_proc();
+    }, [&dlg]{
+        QMetaObject::invokeMethod(&dlg, "cancel", Qt::QueuedConnection);
+    });
     dlg.exec();
 
-    future.waitForFinished();   
+    task->wait();
 }
 
 void ProtocolExp::save_proc()
@@ -28,6 +28,7 @@
 #include <QTextEdit>
 #include <QPushButton>
 #include <QRadioButton>
+#include <QCheckBox>
 #include "../ui/msgbox.h"
 #include "../config/appconfig.h"
 #include "../interface/icallbacks.h"
@@ -44,6 +45,7 @@ StoreProgress::StoreProgress(SigSession *session, QWidget *parent) :
 {
     _fileLab = NULL;
     _ckOrigin = NULL;
+    _ckDecode = NULL;
 
     this->setMinimumSize(550, 220);
     this->setModal(true);
@@ -148,6 +150,9 @@ void StoreProgress::accept()
         _ckOrigin->setVisible(false);
         _ckCompress->setVisible(false);
      }
+     if (_ckDecode != NULL){
+        _ckDecode->setVisible(false);
+     }
      _space->setVisible(true);
 
 
@@ -160,6 +165,15 @@ void StoreProgress::accept()
         }
     }
 
+    if (_ckDecode != NULL){
+        bool ck = _ckDecode->isChecked();
+        AppConfig &app = AppConfig::Instance();
+        if (app._appOptions.saveDecodeResults != ck){
+            app._appOptions.saveDecodeResults = ck;
+            app.SaveApp();
+        }
+    }
+
     //start done 
     if (_isExport){
         if (_store_session.export_start()){
@@ -206,6 +220,15 @@ void StoreProgress::save_run(ISessionDataGetter *getter)
     QString file = _store_session.MakeSaveFile(false);
     _fileLab->setText(file); 
     _store_session._sessionDataGetter = getter;
+
+    if (!_store_session.session()->get_decode_signals().empty())
+    {
+        _ckDecode = new QCheckBox();
+        _ckDecode->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_SAVE_DECODE_RESULTS), "Save decode results"));
+        _ckDecode->setChecked(AppConfig::Instance()._appOptions.saveDecodeResults);
+        _grid->addWidget(_ckDecode, 2, 0, 1, 2);
+    }
+
     show();  
 }
 
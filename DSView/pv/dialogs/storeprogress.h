@@ -30,6 +30,7 @@
 
 class QTextEdit;
 class QRadioButton;
+class QCheckBox;
 class QGridLayout;
 class QPushButton;
 class QWidget;
@@ -81,6 +82,7 @@ private:
     QTextEdit           *_fileLab;
     QRadioButton        *_ckOrigin;
     QRadioButton        *_ckCompress;
+    QCheckBox           *_ckDecode;
     QPushButton         *_openButton;
     QGridLayout         *_grid;
     QWidget             *_space;
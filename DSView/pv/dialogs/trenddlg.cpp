@@ -0,0 +1,186 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "trenddlg.h"
+#include "../sigsession.h"
+#include "../view/signal.h"
+#include "../view/trendtrace.h"
+
+#include <QHeaderView>
+#include <QApplication>
+
+#include "../ui/langresource.h"
+
+namespace pv {
+namespace dialogs {
+
+TrendDlg::TrendDlg(SigSession *session, QWidget *parent) :
+    DSDialog(parent),
+    _session(session),
+    _button_box(QDialogButtonBox::Ok, Qt::Horizontal, this)
+{
+    setMinimumSize(620, 360);
+
+    _table = new QTableWidget(this);
+    _table->setColumnCount(7);
+    _table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    _table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    _table->setSelectionMode(QAbstractItemView::SingleSelection);
+    _table->verticalHeader()->setVisible(false);
+    _table->horizontalHeader()->setStretchLastSection(true);
+
+    _channel_label = new QLabel(this);
+    _metric_label = new QLabel(this);
+    _channel_combobox = new QComboBox(this);
+    _metric_combobox = new QComboBox(this);
+    _error_label = new QLabel(this);
+    _error_label->setWordWrap(true);
+    _error_label->setStyleSheet("color: red;");
+    _add_btn = new QPushButton(this);
+    _remove_btn = new QPushButton(this);
+
+    for (auto s : _session->get_signals()) {
+        if (s->get_type() == SR_CHANNEL_LOGIC)
+            _channel_combobox->addItem(s->get_name(), s->get_index());
+    }
+
+    QGridLayout *grid = new QGridLayout();
+    grid->setVerticalSpacing(5);
+    grid->addWidget(_table, 0, 0, 1, 3);
+    grid->addWidget(_remove_btn, 1, 2);
+    grid->addWidget(_channel_label, 2, 0);
+    grid->addWidget(_channel_combobox, 2, 1, 1, 2);
+    grid->addWidget(_metric_label, 3, 0);
+    grid->addWidget(_metric_combobox, 3, 1, 1, 2);
+    grid->addWidget(_add_btn, 4, 2);
+    grid->addWidget(_error_label, 5, 0, 1, 3);
+    grid->addWidget(&_button_box, 6, 0, 1, 3, Qt::AlignHCenter | Qt::AlignBottom);
+    grid->setColumnStretch(1, 1);
+
+    layout()->addLayout(grid);
+
+    retranslateUi();
+    load_table();
+
+    connect(_add_btn, SIGNAL(clicked()), this, SLOT(on_add()));
+    connect(_remove_btn, SIGNAL(clicked()), this, SLOT(on_remove()));
+    connect(&_button_box, SIGNAL(accepted()), this, SLOT(accept()));
+    connect(_session->device_event_object(), SIGNAL(device_updated()), this, SLOT(reject()));
+}
+
+void TrendDlg::changeEvent(QEvent *event)
+{
+    if (event->type() == QEvent::LanguageChange)
+        retranslateUi();
+    DSDialog::changeEvent(event);
+}
+
+void TrendDlg::retranslateUi()
+{
+    setTitle(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_TREND_TITLE), "Trends"));
+    _channel_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_TREND_CHANNEL), "Channel"));
+    _metric_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_TREND_METRIC), "Metric"));
+    _add_btn->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_TREND_ADD), "Add"));
+    _remove_btn->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_TREND_REMOVE), "Remove"));
+
+    const int metric = _metric_combobox->currentIndex();
+    _metric_combobox->clear();
+    for (int i = 0; i < data::EdgeTrend::MetricCount; i++)
+        _metric_combobox->addItem(view::TrendTrace::metric_name(i));
+    _metric_combobox->setCurrentIndex(metric < 0 ? 0 : metric);
+
+    QStringList headers;
+    headers << L_S(STR_PAGE_DLG, S_ID(IDS_DLG_TREND_CHANNEL), "Channel")
+            << L_S(STR_PAGE_DLG, S_ID(IDS_DLG_TREND_METRIC), "Metric")
+            << L_S(STR_PAGE_DLG, S_ID(IDS_DLG_TREND_CYCLES), "Cycles")
+            << L_S(STR_PAGE_DLG, S_ID(IDS_DLG_TREND_MIN), "Min")
+            << L_S(STR_PAGE_DLG, S_ID(IDS_DLG_TREND_MAX), "Max")
+            << L_S(STR_PAGE_DLG, S_ID(IDS_DLG_TREND_MEAN), "Mean")
+            << L_S(STR_PAGE_DLG, S_ID(IDS_DLG_TREND_STDDEV), "Std Dev");
+    _table->setHorizontalHeaderLabels(headers);
+}
+
+void TrendDlg::load_table()
+{
+    const auto &traces = _session->get_trend_traces();
+
+    _table->setRowCount(traces.size());
+    for (unsigned int i = 0; i < traces.size(); i++) {
+        view::TrendTrace *t = traces[i];
+        const int metric = t->get_metric();
+        _table->setItem(i, 0, new QTableWidgetItem(t->get_name()));
+        _table->setItem(i, 1, new QTableWidgetItem(view::TrendTrace::metric_name(metric)));
+
+        data::EdgeTrend::Summary s;
+        uint64_t cycles;
+        bool truncated;
+        if (!t->get_summary(s, cycles, truncated)) {
+            for (int col = 2; col < 7; col++)
+                _table->setItem(i, col, new QTableWidgetItem("-"));
+            continue;
+        }
+
+        QString cycles_text = QString::number(cycles);
+        if (truncated)
+            cycles_text += "+";
+        _table->setItem(i, 2, new QTableWidgetItem(cycles_text));
+        _table->setItem(i, 3, new QTableWidgetItem(view::TrendTrace::format_value(metric, s.min)));
+        _table->setItem(i, 4, new QTableWidgetItem(view::TrendTrace::format_value(metric, s.max)));
+        _table->setItem(i, 5, new QTableWidgetItem(view::TrendTrace::format_value(metric, s.mean)));
+        _table->setItem(i, 6, new QTableWidgetItem(view::TrendTrace::format_value(metric, s.stddev)));
+    }
+    _remove_btn->setEnabled(traces.size() > 0);
+}
+
+void TrendDlg::on_add()
+{
+    if (_session->is_working()) {
+        _error_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_TREND_STOP_CAPTURE), "Stop the capture before changing the trends."));
+        return;
+    }
+    if (_channel_combobox->currentIndex() < 0)
+        return;
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    view::TrendTrace *trace = _session->add_trend(_channel_combobox->currentData().toInt(),
+                                                  _metric_combobox->currentIndex());
+    if (trace != NULL)
+        trace->wait();
+    QApplication::restoreOverrideCursor();
+
+    _error_label->clear();
+    load_table();
+}
+
+void TrendDlg::on_remove()
+{
+    const int row = _table->currentRow();
+    const auto &traces = _session->get_trend_traces();
+    if (row < 0 || row >= (int)traces.size())
+        return;
+
+    _session->remove_trend(traces[row]);
+    _error_label->clear();
+    load_table();
+}
+
+} // namespace dialogs
+} // namespace pv
@@ -0,0 +1,74 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef DSVIEW_PV_TRENDDLG_H
+#define DSVIEW_PV_TRENDDLG_H
+
+#include <QGridLayout>
+#include <QDialogButtonBox>
+#include <QTableWidget>
+#include <QComboBox>
+#include <QPushButton>
+#include <QLabel>
+
+#include "dsdialog.h"
+
+namespace pv {
+
+class SigSession;
+
+namespace dialogs {
+
+//Add and remove the trend traces, with the summary of each one
+class TrendDlg : public DSDialog
+{
+	Q_OBJECT
+
+public:
+    TrendDlg(SigSession *session, QWidget *parent);
+
+private:
+    void changeEvent(QEvent *event);
+    void retranslateUi();
+    void load_table();
+
+private slots:
+    void on_add();
+    void on_remove();
+
+private:
+    SigSession *_session;
+
+    QTableWidget *_table;
+    QLabel *_channel_label;
+    QLabel *_metric_label;
+    QComboBox *_channel_combobox;
+    QComboBox *_metric_combobox;
+    QLabel *_error_label;
+    QPushButton *_add_btn;
+    QPushButton *_remove_btn;
+    QDialogButtonBox _button_box;
+};
+
+} // namespace dialogs
+} // namespace pv
+
+#endif // DSVIEW_PV_TRENDDLG_H
@@ -0,0 +1,172 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "virtualchanneldlg.h"
+#include "../sigsession.h"
+#include "../data/virtualchannel.h"
+
+#include <QHeaderView>
+#include <QApplication>
+
+#include "../ui/langresource.h"
+
+namespace pv {
+namespace dialogs {
+
+VirtualChannelDlg::VirtualChannelDlg(SigSession *session, QWidget *parent) :
+    DSDialog(parent),
+    _session(session),
+    _button_box(QDialogButtonBox::Ok, Qt::Horizontal, this)
+{
+    setMinimumSize(460, 360);
+
+    _table = new QTableWidget(this);
+    _table->setColumnCount(2);
+    _table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    _table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    _table->setSelectionMode(QAbstractItemView::SingleSelection);
+    _table->verticalHeader()->setVisible(false);
+    _table->horizontalHeader()->setStretchLastSection(true);
+
+    _name_label = new QLabel(this);
+    _expr_label = new QLabel(this);
+    _name_edit = new QLineEdit(this);
+    _expr_edit = new QLineEdit(this);
+    _expr_edit->setPlaceholderText("filter(D0 ^ D1, 4)");
+    _help_label = new QLabel(this);
+    _help_label->setWordWrap(true);
+    _error_label = new QLabel(this);
+    _error_label->setWordWrap(true);
+    _error_label->setStyleSheet("color: red;");
+    _add_btn = new QPushButton(this);
+    _remove_btn = new QPushButton(this);
+
+    QGridLayout *grid = new QGridLayout();
+    grid->setVerticalSpacing(5);
+    grid->addWidget(_table, 0, 0, 1, 3);
+    grid->addWidget(_remove_btn, 1, 2);
+    grid->addWidget(_name_label, 2, 0);
+    grid->addWidget(_name_edit, 2, 1, 1, 2);
+    grid->addWidget(_expr_label, 3, 0);
+    grid->addWidget(_expr_edit, 3, 1, 1, 2);
+    grid->addWidget(_add_btn, 4, 2);
+    grid->addWidget(_help_label, 5, 0, 1, 3);
+    grid->addWidget(_error_label, 6, 0, 1, 3);
+    grid->addWidget(&_button_box, 7, 0, 1, 3, Qt::AlignHCenter | Qt::AlignBottom);
+    grid->setColumnStretch(1, 1);
+
+    layout()->addLayout(grid);
+
+    retranslateUi();
+    load_table();
+
+    connect(_add_btn, SIGNAL(clicked()), this, SLOT(on_add()));
+    connect(_remove_btn, SIGNAL(clicked()), this, SLOT(on_remove()));
+    connect(&_button_box, SIGNAL(accepted()), this, SLOT(accept()));
+    connect(_session->device_event_object(), SIGNAL(device_updated()), this, SLOT(reject()));
+}
+
+void VirtualChannelDlg::changeEvent(QEvent *event)
+{
+    if (event->type() == QEvent::LanguageChange)
+        retranslateUi();
+    DSDialog::changeEvent(event);
+}
+
+void VirtualChannelDlg::retranslateUi()
+{
+    setTitle(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_VIRTUAL_CHANNEL_TITLE), "Virtual Channels"));
+    _name_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_VIRTUAL_CHANNEL_NAME), "Name"));
+    _expr_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_VIRTUAL_CHANNEL_EXPRESSION), "Expression"));
+    _add_btn->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_VIRTUAL_CHANNEL_ADD), "Add"));
+    _remove_btn->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_VIRTUAL_CHANNEL_REMOVE), "Remove"));
+    _help_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_VIRTUAL_CHANNEL_HELP),
+        "D0, D1, ... are the channels. Operators: ~ & ^ |, delay(x, samples), "
+        "filter(x, samples) removes pulses shorter than 1 to 64 samples."));
+
+    QStringList headers;
+    headers << L_S(STR_PAGE_DLG, S_ID(IDS_DLG_VIRTUAL_CHANNEL_NAME), "Name")
+            << L_S(STR_PAGE_DLG, S_ID(IDS_DLG_VIRTUAL_CHANNEL_EXPRESSION), "Expression");
+    _table->setHorizontalHeaderLabels(headers);
+}
+
+void VirtualChannelDlg::load_table()
+{
+    const auto &channels = _session->get_virtual_channels();
+
+    _table->setRowCount(channels.size());
+    for (unsigned int i = 0; i < channels.size(); i++) {
+        QTableWidgetItem *name_item = new QTableWidgetItem(channels[i]->get_name());
+        name_item->setData(Qt::UserRole, channels[i]->get_index());
+        _table->setItem(i, 0, name_item);
+        _table->setItem(i, 1, new QTableWidgetItem(channels[i]->get_expression()));
+    }
+    _remove_btn->setEnabled(channels.size() > 0);
+}
+
+void VirtualChannelDlg::on_add()
+{
+    if (_session->is_working()) {
+        _error_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_VIRTUAL_CHANNEL_STOP_CAPTURE), "Stop the capture before changing the virtual channels."));
+        return;
+    }
+
+    QString name = _name_edit->text().trimmed();
+    if (name.isEmpty())
+        name = QString("V%1").arg(_session->get_virtual_channels().size());
+
+    QString error;
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    bool ret = _session->add_virtual_channel(name, _expr_edit->text(), error);
+    QApplication::restoreOverrideCursor();
+
+    if (!ret) {
+        _error_label->setText(error);
+        return;
+    }
+
+    _error_label->clear();
+    _name_edit->clear();
+    _expr_edit->clear();
+    load_table();
+}
+
+void VirtualChannelDlg::on_remove()
+{
+    if (_session->is_working()) {
+        _error_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_VIRTUAL_CHANNEL_STOP_CAPTURE), "Stop the capture before changing the virtual channels."));
+        return;
+    }
+
+    const int row = _table->currentRow();
+    if (row < 0)
+        return;
+
+    // the session waits for the decoders and queries reading the data
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    _session->remove_virtual_channel(_table->item(row, 0)->data(Qt::UserRole).toInt());
+    QApplication::restoreOverrideCursor();
+    _error_label->clear();
+    load_table();
+}
+
+} // namespace dialogs
+} // namespace pv
@@ -0,0 +1,460 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2013 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "comparedock.h"
+#include "../sigsession.h"
+#include "../view/view.h"
+#include "../view/ruler.h"
+#include "../view/signal.h"
+#include "../data/logicsnapshot.h"
+#include "../dialogs/dsmessagebox.h"
+#include "../utility/path.h"
+#include "../log.h"
+
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QProgressDialog>
+#include "../taskscheduler.h"
+#include <algorithm>
+#include <limits.h>
+#include "../config/appconfig.h"
+
+#include "../ui/langresource.h"
+
+namespace pv {
+namespace dock {
+
+using namespace pv::view;
+
+CompareDock::CompareDock(QWidget *parent, View &view, SigSession *session) :
+    QScrollArea(parent),
+    _session(session),
+    _view(view)
+{
+    _cur_hit = -1;
+    _compare_cancel = false;
+    _compare_num = 0;
+    _widget = new QWidget(this);
+
+    /* reference group */
+    _ref_groupBox = new QGroupBox(_widget);
+    _ref_label = new QLabel(_widget);
+    _ref_label->setWordWrap(true);
+    _load_btn = new QPushButton(_widget);
+    QGridLayout *ref_layout = new QGridLayout();
+    ref_layout->addWidget(_ref_label, 0, 0);
+    ref_layout->addWidget(_load_btn, 0, 1);
+    ref_layout->setColumnStretch(0, 1);
+    _ref_groupBox->setLayout(ref_layout);
+
+    /* options group */
+    _opt_groupBox = new QGroupBox(_widget);
+    _align_label = new QLabel(_widget);
+    _align_combobox = new DsComboBox(_widget);
+    _offset_label = new QLabel(_widget);
+    _offset_spinBox = new QSpinBox(_widget);
+    _offset_spinBox->setRange(INT_MIN, INT_MAX);
+    _tolerance_label = new QLabel(_widget);
+    _tolerance_spinBox = new QSpinBox(_widget);
+    _tolerance_spinBox->setRange(0, INT_MAX);
+    _max_label = new QLabel(_widget);
+    _max_spinBox = new QSpinBox(_widget);
+    _max_spinBox->setRange(1, 100000);
+    _max_spinBox->setValue(data::CaptureDiff::MaxRangesDefault);
+    _auto_checkBox = new QCheckBox(_widget);
+    _compare_btn = new QPushButton(_widget);
+
+    QGridLayout *opt_layout = new QGridLayout();
+    opt_layout->setVerticalSpacing(5);
+    opt_layout->addWidget(_align_label, 0, 0);
+    opt_layout->addWidget(_align_combobox, 0, 1);
+    opt_layout->addWidget(_offset_label, 1, 0);
+    opt_layout->addWidget(_offset_spinBox, 1, 1);
+    opt_layout->addWidget(_tolerance_label, 2, 0);
+    opt_layout->addWidget(_tolerance_spinBox, 2, 1);
+    opt_layout->addWidget(_max_label, 3, 0);
+    opt_layout->addWidget(_max_spinBox, 3, 1);
+    opt_layout->addWidget(_auto_checkBox, 4, 0, 1, 2);
+    opt_layout->addWidget(_compare_btn, 5, 0, 1, 2);
+    opt_layout->setColumnStretch(1, 1);
+    _opt_groupBox->setLayout(opt_layout);
+
+    /* result group */
+    _result_groupBox = new QGroupBox(_widget);
+    _result_label = new QLabel(_widget);
+    _result_label->setWordWrap(true);
+    _pre_btn = new QPushButton(_widget);
+    _nxt_btn = new QPushButton(_widget);
+    _result_table = new QTableWidget(_widget);
+    _result_table->setColumnCount(3);
+    _result_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    _result_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    _result_table->setSelectionMode(QAbstractItemView::SingleSelection);
+    _result_table->verticalHeader()->setVisible(false);
+    _result_table->horizontalHeader()->setStretchLastSection(true);
+    _result_table->setMinimumHeight(300);
+
+    QGridLayout *result_layout = new QGridLayout();
+    result_layout->addWidget(_result_label, 0, 0, 1, 2);
+    result_layout->addWidget(_pre_btn, 1, 0);
+    result_layout->addWidget(_nxt_btn, 1, 1);
+    result_layout->addWidget(_result_table, 2, 0, 1, 2);
+    _result_groupBox->setLayout(result_layout);
+
+    QVBoxLayout *layout = new QVBoxLayout(_widget);
+    layout->addWidget(_ref_groupBox);
+    layout->addWidget(_opt_groupBox);
+    layout->addWidget(_result_groupBox);
+    layout->addStretch(1);
+    _widget->setLayout(layout);
+
+    this->setWidget(_widget);
+    this->setWidgetResizable(true);
+    _widget->setObjectName("compareWidget");
+
+    retranslateUi();
+
+    connect(_load_btn, SIGNAL(clicked()), this, SLOT(on_load()));
+    connect(_compare_btn, SIGNAL(clicked()), this, SLOT(on_compare()));
+    connect(_pre_btn, SIGNAL(clicked()), this, SLOT(on_previous()));
+    connect(_nxt_btn, SIGNAL(clicked()), this, SLOT(on_next()));
+    connect(_result_table, SIGNAL(cellClicked(int,int)), this, SLOT(on_cell_clicked(int,int)));
+}
+
+CompareDock::~CompareDock()
+{
+    stop_compare();
+}
+
+void CompareDock::changeEvent(QEvent *event)
+{
+    if (event->type() == QEvent::LanguageChange)
+        retranslateUi();
+    QScrollArea::changeEvent(event);
+}
+
+void CompareDock::retranslateUi()
+{
+    _ref_groupBox->setTitle(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_REFERENCE), "Reference"));
+    _load_btn->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_LOAD), "Load..."));
+    _opt_groupBox->setTitle(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_OPTIONS), "Options"));
+    _align_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_ALIGN), "Align: "));
+    _offset_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_OFFSET), "Offset(samples): "));
+    _tolerance_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_TOLERANCE), "Tolerance(samples): "));
+    _max_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_MAX_RANGES), "Max ranges per channel: "));
+    _auto_checkBox->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_AUTO), "Compare after each capture"));
+    _compare_btn->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_RUN), "Compare"));
+    _result_groupBox->setTitle(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_RESULT), "Differences"));
+    _pre_btn->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_PREVIOUS), "Previous"));
+    _nxt_btn->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_NEXT), "Next"));
+
+    int align = _align_combobox->currentIndex();
+    _align_combobox->clear();
+    _align_combobox->addItem(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_ALIGN_TRIGGER), "Trigger"));
+    _align_combobox->addItem(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_ALIGN_START), "Start"));
+    _align_combobox->setCurrentIndex(align < 0 ? 0 : align);
+
+    QStringList headers;
+    headers << L_S(STR_PAGE_DLG, S_ID(IDS_DLG_CHANNEL), "Channel")
+            << L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_POSITION), "Position")
+            << L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_LENGTH), "Length");
+    _result_table->setHorizontalHeaderLabels(headers);
+
+    if (_diff.have_reference())
+        _ref_label->setText(_diff.reference_file());
+    else
+        _ref_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_NO_REFERENCE), "No reference loaded"));
+    update_result();
+}
+
+void CompareDock::reload()
+{
+    stop_compare();
+    _hits.clear();
+    _cur_hit = -1;
+    _result_table->setRowCount(0);
+    _result_label->setText("");
+}
+
+void CompareDock::capture_ended()
+{
+    if (!_auto_checkBox->isChecked() || !_diff.have_reference())
+        return;
+
+    stop_compare();
+    data::LogicSnapshot *logic_snapshot = prepare_compare(true);
+    if (logic_snapshot == NULL)
+        return;
+
+    // the result is shown when the task is finished, the next capture
+    // cancels it before the snapshot is cleared
+    _compare_cancel = false;
+    _compare_task = TaskScheduler::Instance().submit(TaskScheduler::TaskQuery, [=](Task &){
+        _compare_num = _diff.compare(logic_snapshot, &_compare_cancel);
+    }, [this]{
+        QMetaObject::invokeMethod(this, "on_compare_finished", Qt::QueuedConnection);
+    });
+}
+
+void CompareDock::stop_compare()
+{
+    _compare_cancel = true;
+    if (_compare_task) {
+        _compare_task->wait();
+        _compare_task.reset();
+
+        // the result of a canceled compare is not complete
+        _diff.clear_result();
+        _hits.clear();
+        _cur_hit = -1;
+        update_result();
+    }
+}
+
+void CompareDock::on_compare_finished()
+{
+    // a canceled or replaced task
+    if (_compare_cancel || !_compare_task || _compare_task->is_running())
+        return;
+
+    _compare_task.reset();
+    show_compare(_compare_num, true);
+}
+
+void CompareDock::on_load()
+{
+    AppConfig &app = AppConfig::Instance();
+    const QString file_name = QFileDialog::getOpenFileName(
+        this,
+        L_S(STR_PAGE_DLG, S_ID(IDS_DLG_OPEN_FILE), "Open File"),
+        app._userHistory.openDir,
+        "DSView Data (*.dsl)");
+
+    if (file_name.isEmpty())
+        return;
+
+    stop_compare();
+    bool ret = false;
+    QString error;
+
+    Qt::WindowFlags flags = Qt::CustomizeWindowHint;
+    QProgressDialog dlg(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_LOADING), "Loading reference..."),
+                        L_S(STR_PAGE_DLG, S_ID(IDS_DLG_CANCEL), "Cancel"),0,0,this,flags);
+    dlg.setWindowModality(Qt::WindowModal);
+    dlg.setWindowFlags(Qt::Dialog | Qt::FramelessWindowHint | Qt::WindowSystemMenuHint |
+                       Qt::WindowMinimizeButtonHint | Qt::WindowMaximizeButtonHint);
+    dlg.setCancelButton(NULL);
+
+    TaskPtr task = TaskScheduler::Instance().submit(TaskScheduler::TaskQuery, [&](Task &){
+        ret = _diff.load_reference(file_name, error);
+    }, [&dlg]{
+        QMetaObject::invokeMethod(&dlg, "cancel", Qt::QueuedConnection);
+    });
+    dlg.exec();
+    task->wait();
+
+    reload();
+
+    if (!ret) {
+        _ref_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_NO_REFERENCE), "No reference loaded"));
+        dialogs::DSMessageBox msg(this);
+        msg.mBox()->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_REFERENCE), "Reference"));
+        msg.mBox()->setInformativeText(error);
+        msg.mBox()->setStandardButtons(QMessageBox::Ok);
+        msg.mBox()->setIcon(QMessageBox::Warning);
+        msg.exec();
+        return;
+    }
+
+    _ref_label->setText(file_name);
+}
+
+void CompareDock::on_compare()
+{
+    if (!_diff.have_reference()) {
+        dialogs::DSMessageBox msg(this);
+        msg.mBox()->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_RUN), "Compare"));
+        msg.mBox()->setInformativeText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_NO_REFERENCE), "No reference loaded"));
+        msg.mBox()->setStandardButtons(QMessageBox::Ok);
+        msg.mBox()->setIcon(QMessageBox::Warning);
+        msg.exec();
+        return;
+    }
+    stop_compare();
+    run_compare();
+}
+
+data::LogicSnapshot* CompareDock::prepare_compare(bool bQuiet)
+{
+    const auto snapshot = _session->get_snapshot(SR_CHANNEL_LOGIC);
+    const auto logic_snapshot = dynamic_cast<data::LogicSnapshot*>(snapshot);
+
+    if (!logic_snapshot || logic_snapshot->empty()) {
+        if (!bQuiet) {
+            dialogs::DSMessageBox msg(this);
+            msg.mBox()->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_RUN), "Compare"));
+            msg.mBox()->setInformativeText(L_S(STR_PAGE_MSG, S_ID(IDS_MSG_NO_SAMPLE_DATA), "No Sample data!"));
+            msg.mBox()->setStandardButtons(QMessageBox::Ok);
+            msg.mBox()->setIcon(QMessageBox::Warning);
+            msg.exec();
+        }
+        return NULL;
+    }
+
+    int64_t offset = _offset_spinBox->value();
+    if (_align_combobox->currentIndex() == 0)
+        offset += (int64_t)_diff.reference_trig_pos() - (int64_t)_session->get_trigger_pos();
+
+    _diff.set_offset(offset);
+    _diff.set_tolerance(_tolerance_spinBox->value());
+    _diff.set_max_ranges(_max_spinBox->value());
+
+    return logic_snapshot;
+}
+
+void CompareDock::run_compare()
+{
+    data::LogicSnapshot *logic_snapshot = prepare_compare(false);
+    if (logic_snapshot == NULL)
+        return;
+
+    int num = 0;
+    Qt::WindowFlags flags = Qt::CustomizeWindowHint;
+    QProgressDialog dlg(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_RUNNING), "Comparing..."),
+                        L_S(STR_PAGE_DLG, S_ID(IDS_DLG_CANCEL), "Cancel"),0,0,this,flags);
+    dlg.setWindowModality(Qt::WindowModal);
+    dlg.setWindowFlags(Qt::Dialog | Qt::FramelessWindowHint | Qt::WindowSystemMenuHint |
+                       Qt::WindowMinimizeButtonHint | Qt::WindowMaximizeButtonHint);
+    dlg.setCancelButton(NULL);
+
+    TaskPtr task = TaskScheduler::Instance().submit(TaskScheduler::TaskQuery, [&](Task &){
+        num = _diff.compare(logic_snapshot);
+    }, [&dlg]{
+        QMetaObject::invokeMethod(&dlg, "cancel", Qt::QueuedConnection);
+    });
+    dlg.exec();
+    task->wait();
+
+    show_compare(num, false);
+}
+
+void CompareDock::show_compare(int num, bool bQuiet)
+{
+    dsv_info("Compare with reference, offset:%lld, differences:%d",
+             (long long)_diff.get_offset(), num);
+
+    _hits.clear();
+    for (auto &ch : _diff.get_result()) {
+        for (auto &r : ch.ranges)
+            _hits.push_back(std::make_pair(ch.sig_index, r));
+    }
+    std::stable_sort(_hits.begin(), _hits.end(),
+        [](const std::pair<int, data::CaptureDiff::DiffRange> &a,
+           const std::pair<int, data::CaptureDiff::DiffRange> &b) {
+            return a.second.start < b.second.start;
+        });
+    _cur_hit = -1;
+
+    update_result();
+
+    if (!_hits.empty() && !bQuiet)
+        on_next();
+}
+
+void CompareDock::update_result()
+{
+    const uint64_t samplerate = _session->cur_snap_samplerate();
+
+    _result_table->setRowCount(_hits.size());
+    for (int i = 0; i < (int)_hits.size(); i++) {
+        const auto &hit = _hits[i];
+        _result_table->setItem(i, 0, new QTableWidgetItem(get_channel_name(hit.first)));
+        _result_table->setItem(i, 1, new QTableWidgetItem(
+            Ruler::format_real_time(hit.second.start, samplerate)));
+        _result_table->setItem(i, 2, new QTableWidgetItem(
+            QString::number(hit.second.end - hit.second.start)));
+    }
+
+    // the background compare is still writing the result
+    if (_compare_task || !_diff.have_reference() || _diff.compared_samples() == 0) {
+        _result_label->setText("");
+        return;
+    }
+
+    QString text;
+    if (_hits.empty()) {
+        text = L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_MATCHED), "Captures match.");
+    }
+    else {
+        text = QString::number(_hits.size()) + " " +
+               L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_DIFFERENCES), "difference(s)");
+        for (auto &ch : _diff.get_result()) {
+            if (ch.truncated) {
+                text += ", ";
+                text += L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_TRUNCATED), "more are not listed");
+                break;
+            }
+        }
+    }
+    text += " / " + QString::number(_diff.compared_samples()) + " " +
+            L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_SAMPLES), "samples");
+    _result_label->setText(text);
+}
+
+QString CompareDock::get_channel_name(int sig_index)
+{
+    for (auto s : _session->get_signals()) {
+        if (s->get_type() == SR_CHANNEL_LOGIC && s->get_index() == sig_index)
+            return s->get_name();
+    }
+    return QString::number(sig_index);
+}
+
+void CompareDock::on_previous()
+{
+    if (_hits.empty())
+        return;
+    _cur_hit = (_cur_hit <= 0) ? _hits.size() - 1 : _cur_hit - 1;
+    on_cell_clicked(_cur_hit, 0);
+}
+
+void CompareDock::on_next()
+{
+    if (_hits.empty())
+        return;
+    _cur_hit = (_cur_hit + 1) % _hits.size();
+    on_cell_clicked(_cur_hit, 0);
+}
+
+void CompareDock::on_cell_clicked(int row, int column)
+{
+    (void)column;
+
+    if (row < 0 || row >= (int)_hits.size())
+        return;
+
+    _cur_hit = row;
+    _result_table->selectRow(row);
+    _session->show_region(_hits[row].second.start, _hits[row].second.end, false);
+}
+
+} // namespace dock
+} // namespace pv
@@ -0,0 +1,121 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2013 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef DSVIEW_PV_COMPAREDOCK_H
+#define DSVIEW_PV_COMPAREDOCK_H
+
+#include <QScrollArea>
+#include <QPushButton>
+#include <QLabel>
+#include <QSpinBox>
+#include <QGroupBox>
+#include <QTableWidget>
+#include <QCheckBox>
+#include <QGridLayout>
+#include <QVBoxLayout>
+#include <atomic>
+
+#include "../data/capturediff.h"
+#include "../ui/dscombobox.h"
+#include "../taskscheduler.h"
+
+namespace pv {
+
+class SigSession;
+
+namespace view {
+    class View;
+}
+
+namespace dock {
+
+//Compare the current capture with a reference .dsl file
+class CompareDock : public QScrollArea
+{
+    Q_OBJECT
+
+public:
+    CompareDock(QWidget *parent, pv::view::View &view, SigSession *session);
+    ~CompareDock();
+
+    void reload();
+
+    //called when a capture is finished
+    void capture_ended();
+
+    //cancel the compare running in the background
+    void stop_compare();
+
+private:
+    void changeEvent(QEvent *event);
+    void retranslateUi();
+    data::LogicSnapshot* prepare_compare(bool bQuiet);
+    void run_compare();
+    void show_compare(int num, bool bQuiet);
+    void update_result();
+    QString get_channel_name(int sig_index);
+
+private slots:
+    void on_load();
+    void on_compare();
+    void on_compare_finished();
+    void on_previous();
+    void on_next();
+    void on_cell_clicked(int row, int column);
+
+private:
+    SigSession *_session;
+    view::View &_view;
+    data::CaptureDiff _diff;
+    TaskPtr _compare_task;      // _diff is owned by the task while it runs
+    std::atomic<bool> _compare_cancel;
+    int _compare_num;
+    std::vector<std::pair<int, data::CaptureDiff::DiffRange>> _hits;
+    int _cur_hit;
+
+    QWidget *_widget;
+    QGroupBox *_ref_groupBox;
+    QLabel *_ref_label;
+    QPushButton *_load_btn;
+
+    QGroupBox *_opt_groupBox;
+    QLabel *_align_label;
+    DsComboBox *_align_combobox;
+    QLabel *_offset_label;
+    QSpinBox *_offset_spinBox;
+    QLabel *_tolerance_label;
+    QSpinBox *_tolerance_spinBox;
+    QLabel *_max_label;
+    QSpinBox *_max_spinBox;
+    QCheckBox *_auto_checkBox;
+    QPushButton *_compare_btn;
+
+    QGroupBox *_result_groupBox;
+    QLabel *_result_label;
+    QPushButton *_pre_btn;
+    QPushButton *_nxt_btn;
+    QTableWidget *_result_table;
+};
+
+} // namespace dock
+} // namespace pv
+
+#endif // DSVIEW_PV_COMPAREDOCK_H
@@ -29,14 +29,18 @@
 #include "../view/timemarker.h"
 #include "../view/ruler.h"
 #include "../view/logicsignal.h"
+#include "../view/analogsignal.h"
 #include "../data/signaldata.h"
 #include "../data/snapshot.h" 
+#include "../data/logicsnapshot.h"
+#include "../data/analogsnapshot.h"
 #include "../dialogs/dsdialog.h"
 #include "../dialogs/dsmessagebox.h"
 
 #include <QObject>
 #include <QPainter> 
 #include <QMessageBox>
+#include <QHeaderView>
 #include "../config/appconfig.h"
 
 #include "../ui/langresource.h"
@@ -119,6 +123,37 @@ MeasureDock::MeasureDock(QWidget *parent, View &view, SigSession *session) :
     //add_edge_measure();
     _edge_groupBox->setLayout(_edge_layout);
 
+    /* cursor range statistics group */
+    _stats_cancel = false;
+    _stats_pending = false;
+    _stats_serial = 0;
+    _stats_start = 0;
+    _stats_end = 0;
+    _stats_groupBox = new QGroupBox(_widget);
+    _stats_groupBox->setMinimumWidth(300);
+    _stats_s_btn = new QPushButton(" ", _widget);
+    _stats_s_btn->setObjectName("stats");
+    _stats_e_btn = new QPushButton(" ", _widget);
+    _stats_e_btn->setObjectName("stats");
+    _stats_table = new QTableWidget(_widget);
+    _stats_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    _stats_table->setSelectionMode(QAbstractItemView::NoSelection);
+    _stats_table->verticalHeader()->setVisible(false);
+    _stats_table->horizontalHeader()->setStretchLastSection(true);
+    _stats_table->setMinimumHeight(150);
+    connect(_stats_s_btn, SIGNAL(clicked()), this, SLOT(show_all_coursor()));
+    connect(_stats_e_btn, SIGNAL(clicked()), this, SLOT(show_all_coursor()));
+
+    QGridLayout *stats_layout = new QGridLayout();
+    stats_layout->setVerticalSpacing(5);
+    stats_layout->addWidget(_stats_s_btn, 0, 0);
+    stats_layout->addWidget(new QLabel("-", _widget), 0, 1);
+    stats_layout->addWidget(_stats_e_btn, 0, 2);
+    stats_layout->addWidget(new QLabel(_widget), 0, 3);
+    stats_layout->setColumnStretch(3, 1);
+    stats_layout->addWidget(_stats_table, 1, 0, 1, 4);
+    _stats_groupBox->setLayout(stats_layout);
+
     /* cursors group */
     _time_label = new QLabel(_widget);
     _cursor_groupBox = new QGroupBox(_widget);
@@ -133,6 +168,7 @@ MeasureDock::MeasureDock(QWidget *parent, View &view, SigSession *session) :
     layout->addWidget(_mouse_groupBox);
     layout->addWidget(_dist_groupBox);
     layout->addWidget(_edge_groupBox);
+    layout->addWidget(_stats_groupBox);
     layout->addWidget(_cursor_groupBox);
     layout->addStretch(1);
     _widget->setLayout(layout);
@@ -149,6 +185,10 @@ MeasureDock::MeasureDock(QWidget *parent, View &view, SigSession *session) :
 
 MeasureDock::~MeasureDock()
 {
+    _stats_cancel = true;
+    _stats_pending = false;
+    if (_stats_task)
+        _stats_task->wait();
 }
 
 void MeasureDock::changeEvent(QEvent *event)
@@ -167,6 +207,7 @@ void MeasureDock::retranslateUi()
     _dist_groupBox->setTitle(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_CURSOR_DISTANCE), "Cursor Distance"));
     _edge_groupBox->setTitle(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_EDGES), "Edges"));
     _cursor_groupBox->setTitle(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_CURSORS), "Cursors"));
+    _stats_groupBox->setTitle(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATISTICS), "Statistics"));
 
     _channel_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_CHANNEL), "Channel"));
     _edge_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_RIS_OR_FAL_EDGE), "Rising/Falling/Edges"));
@@ -176,6 +217,8 @@ void MeasureDock::retranslateUi()
     _p_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_P), "P: "));
     _f_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_F), "F: "));
     _d_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_D), "D: "));
+
+    show_stats();
 }
 
 void MeasureDock::reStyle()
@@ -213,6 +256,12 @@ void MeasureDock::reload()
     else
         _edge_groupBox->setVisible(false);
 
+    if (_session->get_device()->get_work_mode() == DSO)
+        _stats_groupBox->setVisible(false);
+    else
+        _stats_groupBox->setVisible(true);
+    stop_stats();
+
     for (QVector <DsComboBox *>::const_iterator i = _edge_ch_cmb_vec.begin();
          i != _edge_ch_cmb_vec.end(); i++) {
         update_probe_selector(*i);
@@ -296,6 +345,7 @@ void MeasureDock::cursor_moving()
     }
 
     update_dist();
+    update_stats();
 }
 
 void MeasureDock::reCalc()
@@ -303,6 +353,7 @@ void MeasureDock::reCalc()
     cursor_update();
     update_dist();
     update_edge();
+    update_stats();
 }
  
 
@@ -520,6 +571,8 @@ void MeasureDock::set_se_cursor()
         update_dist();
     else if (_sel_btn->objectName() == "edge")
         update_edge();
+    else if (_sel_btn->objectName() == "stats")
+        update_stats();
 }
 
 const view::Cursor* MeasureDock::find_cousor(int index)
@@ -633,6 +686,211 @@ void MeasureDock::update_edge()
     }
 }
 
+void MeasureDock::update_stats()
+{
+    bool start_ret, end_ret;
+    const unsigned int start = _stats_s_btn->text().toInt(&start_ret) - 1;
+    const unsigned int end = _stats_e_btn->text().toInt(&end_ret) - 1;
+
+    if (start_ret) {
+        if (start + 1 > _view.get_cursorList().size()) {
+            _stats_s_btn->setText(" ");
+            set_cursor_btn_color(_stats_s_btn);
+            start_ret = false;
+        }
+    }
+    if (end_ret) {
+        if (end + 1 > _view.get_cursorList().size()) {
+            _stats_e_btn->setText(" ");
+            set_cursor_btn_color(_stats_e_btn);
+            end_ret = false;
+        }
+    }
+
+    // the snapshot is not stable during capture
+    if (!start_ret || !end_ret || _stats_groupBox->isHidden() ||
+        _session->is_running_status()) {
+        _stats_cancel = true;
+        _stats_pending = false;
+        if (!_stats_items.empty()) {
+            _stats_items.clear();
+            show_stats();
+        }
+        return;
+    }
+
+    _stats_start = std::min(_view.get_cursor_samples(start), _view.get_cursor_samples(end));
+    _stats_end = std::max(_view.get_cursor_samples(start), _view.get_cursor_samples(end));
+
+    // a cursor is dragged: drop the stale request, run again when it stops
+    if (_stats_task && _stats_task->is_running()) {
+        _stats_cancel = true;
+        _stats_pending = true;
+        return;
+    }
+
+    run_stats();
+}
+
+void MeasureDock::run_stats()
+{
+    _stats_work.clear();
+
+    for (auto s : _session->get_signals()) {
+        if (!s->enabled())
+            continue;
+
+        StatsItem item;
+        item.sig_index = s->get_index();
+        item.type = s->get_type();
+        item.hw_offset = 0;
+        item.valid = false;
+
+        if (item.type == SR_CHANNEL_ANALOG) {
+            view::AnalogSignal *analogSig = dynamic_cast<view::AnalogSignal*>(s);
+            if (analogSig == NULL)
+                continue;
+            item.hw_offset = analogSig->get_hw_offset();
+        } else if (item.type != SR_CHANNEL_LOGIC) {
+            continue;
+        }
+        _stats_work.push_back(item);
+    }
+
+    data::LogicSnapshot *logic_snapshot =
+        dynamic_cast<data::LogicSnapshot*>(_session->get_snapshot(SR_CHANNEL_LOGIC));
+    data::AnalogSnapshot *analog_snapshot =
+        dynamic_cast<data::AnalogSnapshot*>(_session->get_snapshot(SR_CHANNEL_ANALOG));
+    const uint64_t start = _stats_start;
+    const uint64_t end = _stats_end;
+
+    _stats_cancel = false;
+    _stats_pending = false;
+    const int serial = ++_stats_serial;
+
+    _stats_task = TaskScheduler::Instance().submit(TaskScheduler::TaskQuery, [=](Task &){
+        for (auto &item : _stats_work) {
+            if (_stats_cancel)
+                break;
+            if (item.type == SR_CHANNEL_LOGIC && logic_snapshot != NULL)
+                item.valid = _stats.calc_logic(logic_snapshot, item.sig_index,
+                                               start, end, item.logic, _stats_cancel);
+            else if (item.type == SR_CHANNEL_ANALOG && analog_snapshot != NULL)
+                item.valid = _stats.calc_analog(analog_snapshot, item.sig_index, item.hw_offset,
+                                                start, end, item.analog, _stats_cancel);
+        }
+    }, [this, serial]{
+        QMetaObject::invokeMethod(this, "on_stats_finished", Qt::QueuedConnection,
+                                  Q_ARG(int, serial));
+    });
+}
+
+void MeasureDock::on_stats_finished(int serial)
+{
+    // the completion of a task which was replaced after its proc returned,
+    // _stats_work belongs to the next run already
+    if (serial != _stats_serial)
+        return;
+
+    if (_stats_pending) {
+        run_stats();
+        return;
+    }
+    if (_stats_cancel)
+        return;
+
+    _stats_items = _stats_work;
+    show_stats();
+}
+
+void MeasureDock::stop_stats()
+{
+    _stats_cancel = true;
+    _stats_pending = false;
+    if (_stats_task)
+        _stats_task->wait();
+
+    _stats_items.clear();
+    show_stats();
+}
+
+void MeasureDock::show_stats()
+{
+    const bool analog = (_session->get_device()->get_work_mode() == ANALOG);
+    const uint64_t samplerate = _session->cur_snap_samplerate();
+    QStringList headers;
+
+    headers << L_S(STR_PAGE_DLG, S_ID(IDS_DLG_CHANNEL), "Channel");
+    if (analog) {
+        headers << L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATS_MIN), "Min")
+                << L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATS_MAX), "Max")
+                << L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATS_MEAN), "Mean")
+                << L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATS_RMS), "RMS");
+    } else {
+        headers << L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATS_EDGES), "Rising/Falling")
+                << L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATS_FREQ), "Frequency")
+                << L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATS_DUTY), "Duty")
+                << L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATS_HIGH), "High width")
+                << L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATS_LOW), "Low width");
+    }
+    _stats_table->clear();
+    _stats_table->setColumnCount(headers.size());
+    _stats_table->setHorizontalHeaderLabels(headers);
+    _stats_table->setRowCount(0);
+
+    for (auto &item : _stats_items) {
+        if (!item.valid)
+            continue;
+
+        view::Signal *sig = NULL;
+        for (auto s : _session->get_signals()) {
+            if (s->get_index() == item.sig_index && s->get_type() == item.type) {
+                sig = s;
+                break;
+            }
+        }
+        if (sig == NULL)
+            continue;
+
+        QStringList cells;
+        cells << sig->get_name();
+
+        if (item.type == SR_CHANNEL_ANALOG) {
+            view::AnalogSignal *analogSig = dynamic_cast<view::AnalogSignal*>(sig);
+            if (analogSig == NULL)
+                continue;
+            cells << analogSig->get_voltage(item.analog.min, 2)
+                  << analogSig->get_voltage(item.analog.max, 2)
+                  << analogSig->get_voltage(item.analog.mean, 2)
+                  << analogSig->get_voltage(item.analog.rms, 2);
+        } else {
+            const data::RangeStats::LogicResult &r = item.logic;
+            cells << QString::number(r.rising) + "/" + QString::number(r.falling);
+            if (r.rising > 1 && samplerate != 0)
+                cells << Ruler::format_freq((r.last_rising - r.first_rising) * 1.0 /
+                                            (r.rising - 1) / samplerate);
+            else
+                cells << "-";
+            cells << QString::number(r.high * 100.0 / r.samples, 'f', 2) + "%";
+            if (r.max_high != 0 && samplerate != 0)
+                cells << Ruler::format_real_time(r.min_high, samplerate) + " ~ " +
+                         Ruler::format_real_time(r.max_high, samplerate);
+            else
+                cells << "-";
+            if (r.max_low != 0 && samplerate != 0)
+                cells << Ruler::format_real_time(r.min_low, samplerate) + " ~ " +
+                         Ruler::format_real_time(r.max_low, samplerate);
+            else
+                cells << "-";
+        }
+
+        const int row = _stats_table->rowCount();
+        _stats_table->insertRow(row);
+        for (int col = 0; col < cells.size(); col++)
+            _stats_table->setItem(row, col, new QTableWidgetItem(cells[col]));
+    }
+}
+
 void MeasureDock::set_cursor_btn_color(QPushButton *btn)
 {
     bool ret;
@@ -40,8 +40,11 @@
 #include <QScrollArea>
 
 #include <vector>
+#include <atomic>
 
 #include "../ui/dscombobox.h" 
+#include "../data/rangestats.h"
+#include "../taskscheduler.h"
 
 namespace pv {
 
@@ -61,6 +64,16 @@ class MeasureDock : public QScrollArea
 private:
     static const int Max_Measure_Limits = 16;
 
+    struct StatsItem
+    {
+        int sig_index;
+        int type;
+        int hw_offset;
+        bool valid;
+        data::RangeStats::LogicResult logic;
+        data::RangeStats::AnalogResult analog;
+    };
+
 public:
     MeasureDock(QWidget *parent, pv::view::View &view, SigSession *session);
     ~MeasureDock();
@@ -68,6 +81,9 @@ public:
     void paintEvent(QPaintEvent *);
     void reload();
 
+    //cancel the statistics worker and drop its cache, data is going to change
+    void stop_stats();
+
 private:
     void changeEvent(QEvent *event);
     void retranslateUi();
@@ -76,6 +92,8 @@ private:
 private:
     DsComboBox* create_probe_selector(QWidget *parent);
     void update_probe_selector(DsComboBox *selector);
+    void run_stats();
+    void show_stats();
 
 private slots:
     void goto_cursor();
@@ -90,6 +108,8 @@ private slots:
     void update_edge();
     void set_cursor_btn_color(QPushButton *btn);
     void del_cursor();
+    void update_stats();
+    void on_stats_finished(int serial);
 
 public slots:
     void add_dist_measure();
@@ -131,6 +151,20 @@ private:
     QVector<DsComboBox *> _edge_ch_cmb_vec;
     QVector<QLabel *> _edge_r_label_vec;
 
+    QGroupBox *_stats_groupBox;
+    QPushButton *_stats_s_btn;
+    QPushButton *_stats_e_btn;
+    QTableWidget *_stats_table;
+    data::RangeStats _stats;
+    TaskPtr _stats_task;
+    std::atomic<bool> _stats_cancel;
+    bool _stats_pending;
+    int _stats_serial;                    // of the last run, older completions are ignored
+    std::vector<StatsItem> _stats_items; // shown results
+    std::vector<StatsItem> _stats_work;  // owned by the worker while it runs
+    uint64_t _stats_start;
+    uint64_t _stats_end;
+
     QPushButton *_sel_btn;
 
     QGridLayout *_cursor_layout;
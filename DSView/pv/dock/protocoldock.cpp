@@ -37,9 +37,8 @@
 #include <QHeaderView>
 #include <QScrollBar>
 #include <QRegularExpression>
-#include <QFuture>
 #include <QProgressDialog>
-#include <QtConcurrent/QtConcurrent>
+#include "../taskscheduler.h"
 #include <QSizePolicy>
 #include <assert.h>
 #include <map>
@@ -807,10 +806,6 @@ void ProtocolDock::search_update()
         return;
 
     if (decoder_stack->list_annotation_size(_model_proxy.filterKeyColumn()) > ProgressRows) {
-        QFuture<void> future;
-        future = QtConcurrent::run([&]{
-            search_done();
-        });
         Qt::WindowFlags flags = Qt::CustomizeWindowHint;
         QProgressDialog dlg(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_SEARCHING), "Searching..."),
                             L_S(STR_PAGE_DLG, S_ID(IDS_DLG_CANCEL), "Cancel"),0,0,this,flags);
@@ -819,11 +814,13 @@ void ProtocolDock::search_update()
                            Qt::WindowMinimizeButtonHint | Qt::WindowMaximizeButtonHint);
         dlg.setCancelButton(NULL);
 
-        QFutureWatcher<void> watcher;
-        connect(&watcher,SIGNAL(finished()),&dlg,SLOT(cancel()));
-        watcher.setFuture(future);
-
+        TaskPtr task = TaskScheduler::Instance().submit(TaskScheduler::TaskQuery, [&](Task &){
+            search_done();
+        }, [&dlg]{
+            QMetaObject::invokeMethod(&dlg, "cancel", Qt::QueuedConnection);
+        });
         dlg.exec();
+        task->wait();
     } else {
         search_done();
     }
@@ -0,0 +1,297 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "scriptdock.h"
+#include "../sigsession.h"
+#include "../view/view.h"
+#include "../view/ruler.h"
+#include "../dialogs/dsmessagebox.h"
+#include "../taskscheduler.h"
+#include "../log.h"
+
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QFile>
+#include <QTextStream>
+#include <QFontDatabase>
+#include <QApplication>
+#include <QProgressDialog>
+#include "../config/appconfig.h"
+
+#include "../ui/langresource.h"
+
+namespace pv {
+namespace dock {
+
+using namespace pv::view;
+
+ScriptDock::ScriptDock(QWidget *parent, View &view, SigSession *session) :
+    QScrollArea(parent),
+    _session(session),
+    _view(view),
+    _engine(session)
+{
+    _widget = new QWidget(this);
+
+    const QFont fixed_font = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+
+    /* script group */
+    _code_groupBox = new QGroupBox(_widget);
+    _code_edit = new QPlainTextEdit(_widget);
+    _code_edit->setFont(fixed_font);
+    _code_edit->setLineWrapMode(QPlainTextEdit::NoWrap);
+    _code_edit->setMinimumHeight(200);
+    _code_edit->setPlainText(
+        "import dsview\n"
+        "\n"
+        "for index, name, kind in dsview.channels():\n"
+        "    if kind == 'logic':\n"
+        "        pos, levels = dsview.edges(index)\n"
+        "        dsview.measure(name + ' edges', len(pos))\n");
+    _load_btn = new QPushButton(_widget);
+    _save_btn = new QPushButton(_widget);
+    _run_btn = new QPushButton(_widget);
+
+    QGridLayout *code_layout = new QGridLayout();
+    code_layout->setVerticalSpacing(5);
+    code_layout->addWidget(_code_edit, 0, 0, 1, 3);
+    code_layout->addWidget(_load_btn, 1, 0);
+    code_layout->addWidget(_save_btn, 1, 1);
+    code_layout->addWidget(_run_btn, 1, 2);
+    _code_groupBox->setLayout(code_layout);
+
+    /* output group */
+    _output_groupBox = new QGroupBox(_widget);
+    _output_edit = new QPlainTextEdit(_widget);
+    _output_edit->setFont(fixed_font);
+    _output_edit->setReadOnly(true);
+    _output_edit->setMinimumHeight(120);
+    _output_edit->setMaximumBlockCount(10000);
+    _result_table = new QTableWidget(_widget);
+    _result_table->setColumnCount(3);
+    _result_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    _result_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    _result_table->setSelectionMode(QAbstractItemView::SingleSelection);
+    _result_table->verticalHeader()->setVisible(false);
+    _result_table->horizontalHeader()->setStretchLastSection(true);
+    _result_table->setMinimumHeight(120);
+    _clear_btn = new QPushButton(_widget);
+
+    QGridLayout *output_layout = new QGridLayout();
+    output_layout->addWidget(_output_edit, 0, 0);
+    output_layout->addWidget(_result_table, 1, 0);
+    output_layout->addWidget(_clear_btn, 2, 0);
+    _output_groupBox->setLayout(output_layout);
+
+    QVBoxLayout *layout = new QVBoxLayout(_widget);
+    layout->addWidget(_code_groupBox);
+    layout->addWidget(_output_groupBox);
+    layout->addStretch(1);
+    _widget->setLayout(layout);
+
+    this->setWidget(_widget);
+    this->setWidgetResizable(true);
+    _widget->setObjectName("scriptWidget");
+
+    retranslateUi();
+
+    connect(_load_btn, SIGNAL(clicked()), this, SLOT(on_load()));
+    connect(_save_btn, SIGNAL(clicked()), this, SLOT(on_save()));
+    connect(_run_btn, SIGNAL(clicked()), this, SLOT(on_run()));
+    connect(_clear_btn, SIGNAL(clicked()), this, SLOT(on_clear()));
+}
+
+ScriptDock::~ScriptDock()
+{
+}
+
+void ScriptDock::changeEvent(QEvent *event)
+{
+    if (event->type() == QEvent::LanguageChange)
+        retranslateUi();
+    QScrollArea::changeEvent(event);
+}
+
+void ScriptDock::retranslateUi()
+{
+    _code_groupBox->setTitle(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_SCRIPT_CODE), "Script"));
+    _load_btn->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_SCRIPT_LOAD), "Load..."));
+    _save_btn->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_SCRIPT_SAVE), "Save..."));
+    _run_btn->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_SCRIPT_RUN), "Run"));
+    _output_groupBox->setTitle(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_SCRIPT_OUTPUT), "Output"));
+    _clear_btn->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_SCRIPT_CLEAR), "Clear"));
+
+    QStringList headers;
+    headers << L_S(STR_PAGE_DLG, S_ID(IDS_DLG_SCRIPT_NAME), "Name")
+            << L_S(STR_PAGE_DLG, S_ID(IDS_DLG_SCRIPT_VALUE), "Value")
+            << L_S(STR_PAGE_DLG, S_ID(IDS_DLG_SCRIPT_UNIT), "Unit");
+    _result_table->setHorizontalHeaderLabels(headers);
+}
+
+void ScriptDock::reload()
+{
+    _result_table->setRowCount(0);
+}
+
+// the script runs on a worker thread, the widgets are updated by the gui thread
+void ScriptDock::ScriptPrint(const QString &text)
+{
+    QMetaObject::invokeMethod(this, "on_script_print", Qt::QueuedConnection,
+                              Q_ARG(QString, text));
+}
+
+void ScriptDock::ScriptAddMarker(uint64_t index)
+{
+    QMetaObject::invokeMethod(this, "on_script_marker", Qt::QueuedConnection,
+                              Q_ARG(quint64, index));
+}
+
+void ScriptDock::ScriptMeasure(const QString &name, double value, const QString &unit)
+{
+    QMetaObject::invokeMethod(this, "on_script_measure", Qt::QueuedConnection,
+                              Q_ARG(QString, name), Q_ARG(double, value), Q_ARG(QString, unit));
+}
+
+void ScriptDock::on_script_print(QString text)
+{
+    _output_edit->moveCursor(QTextCursor::End);
+    _output_edit->insertPlainText(text);
+}
+
+void ScriptDock::on_script_marker(quint64 index)
+{
+    _view.add_cursor(view::Ruler::CursorColor[_view.get_cursorList().size() % 8], index);
+    _view.show_cursors(true);
+}
+
+void ScriptDock::on_script_measure(QString name, double value, QString unit)
+{
+    int row = _result_table->rowCount();
+    _result_table->setRowCount(row + 1);
+    _result_table->setItem(row, 0, new QTableWidgetItem(name));
+    _result_table->setItem(row, 1, new QTableWidgetItem(QString::number(value, 'g', 12)));
+    _result_table->setItem(row, 2, new QTableWidgetItem(unit));
+}
+
+void ScriptDock::on_load()
+{
+    AppConfig &app = AppConfig::Instance();
+    const QString file_name = QFileDialog::getOpenFileName(
+        this,
+        L_S(STR_PAGE_DLG, S_ID(IDS_DLG_OPEN_FILE), "Open File"),
+        app._userHistory.openDir,
+        "Python Script (*.py)");
+
+    if (file_name.isEmpty())
+        return;
+
+    QFile file(file_name);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        dsv_err("ERROR: failed to open the script file: %s", file_name.toUtf8().data());
+        return;
+    }
+    QTextStream in(&file);
+    _code_edit->setPlainText(in.readAll());
+    _file_name = file_name;
+}
+
+void ScriptDock::on_save()
+{
+    AppConfig &app = AppConfig::Instance();
+    QString file_name = QFileDialog::getSaveFileName(
+        this,
+        L_S(STR_PAGE_DLG, S_ID(IDS_DLG_SAVE_FILE), "Save File"),
+        _file_name.isEmpty() ? app._userHistory.openDir : _file_name,
+        "Python Script (*.py)");
+
+    if (file_name.isEmpty())
+        return;
+    if (!file_name.endsWith(".py"))
+        file_name += ".py";
+
+    QFile file(file_name);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        dsv_err("ERROR: failed to write the script file: %s", file_name.toUtf8().data());
+        return;
+    }
+    QTextStream out(&file);
+    out << _code_edit->toPlainText();
+    _file_name = file_name;
+}
+
+void ScriptDock::on_run()
+{
+    // the views of the script point into the capture buffers
+    if (_session->is_working()) {
+        dialogs::DSMessageBox msg(this);
+        msg.mBox()->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_SCRIPT_RUN), "Run"));
+        msg.mBox()->setInformativeText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_SCRIPT_STOP_CAPTURE), "Stop the capture before running a script."));
+        msg.mBox()->setStandardButtons(QMessageBox::Ok);
+        msg.mBox()->setIcon(QMessageBox::Warning);
+        msg.exec();
+        return;
+    }
+
+    _result_table->setRowCount(0);
+
+    const QString code = _code_edit->toPlainText();
+    QString error;
+    bool ret = false;
+
+    Qt::WindowFlags flags = Qt::CustomizeWindowHint;
+    QProgressDialog dlg(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_SCRIPT_RUNNING), "Running the script..."),
+                        L_S(STR_PAGE_DLG, S_ID(IDS_DLG_CANCEL), "Cancel"),0,0,this,flags);
+    dlg.setWindowModality(Qt::WindowModal);
+    dlg.setWindowFlags(Qt::Dialog | Qt::FramelessWindowHint | Qt::WindowSystemMenuHint |
+                       Qt::WindowMinimizeButtonHint | Qt::WindowMaximizeButtonHint);
+    connect(&dlg, SIGNAL(canceled()), this, SLOT(on_cancel_run()));
+
+    TaskPtr task = TaskScheduler::Instance().submit(TaskScheduler::TaskQuery, [&](Task &){
+        ret = _engine.run(code, this, error);
+    }, [&dlg]{
+        QMetaObject::invokeMethod(&dlg, "cancel", Qt::QueuedConnection);
+    });
+    dlg.exec();
+    task->wait();
+
+    if (!ret)
+        dsv_info("The script failed: %s", error.toUtf8().data());
+
+    // queued behind the output of the script
+    if (data::ScriptEngine::get_export_count() > 0) {
+        ScriptPrint(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_SCRIPT_VIEWS_HELD),
+            "The script still holds the capture data, no capture can be started until it is deleted.") + "\n");
+    }
+}
+
+void ScriptDock::on_cancel_run()
+{
+    _engine.cancel();
+}
+
+void ScriptDock::on_clear()
+{
+    _output_edit->clear();
+    _result_table->setRowCount(0);
+}
+
+} // namespace dock
+} // namespace pv
@@ -0,0 +1,98 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef DSVIEW_PV_SCRIPTDOCK_H
+#define DSVIEW_PV_SCRIPTDOCK_H
+
+#include <QScrollArea>
+#include <QPushButton>
+#include <QLabel>
+#include <QGroupBox>
+#include <QTableWidget>
+#include <QPlainTextEdit>
+#include <QGridLayout>
+#include <QVBoxLayout>
+
+#include "../data/scriptengine.h"
+
+namespace pv {
+
+class SigSession;
+
+namespace view {
+    class View;
+}
+
+namespace dock {
+
+//Run python scripts on the capture, see data/scriptengine.cpp for the api
+class ScriptDock : public QScrollArea, public data::IScriptHost
+{
+    Q_OBJECT
+
+public:
+    ScriptDock(QWidget *parent, pv::view::View &view, SigSession *session);
+    ~ScriptDock();
+
+    void reload();
+
+private:
+    void changeEvent(QEvent *event);
+    void retranslateUi();
+
+    //IScriptHost
+    void ScriptPrint(const QString &text);
+    void ScriptAddMarker(uint64_t index);
+    void ScriptMeasure(const QString &name, double value, const QString &unit);
+
+private slots:
+    void on_load();
+    void on_save();
+    void on_run();
+    void on_clear();
+    void on_cancel_run();
+    void on_script_print(QString text);
+    void on_script_marker(quint64 index);
+    void on_script_measure(QString name, double value, QString unit);
+
+private:
+    SigSession *_session;
+    view::View &_view;
+    data::ScriptEngine _engine;
+    QString _file_name;
+
+    QWidget *_widget;
+    QGroupBox *_code_groupBox;
+    QPlainTextEdit *_code_edit;
+    QPushButton *_load_btn;
+    QPushButton *_save_btn;
+    QPushButton *_run_btn;
+
+    QGroupBox *_output_groupBox;
+    QPlainTextEdit *_output_edit;
+    QTableWidget *_result_table;
+    QPushButton *_clear_btn;
+};
+
+} // namespace dock
+} // namespace pv
+
+#endif // DSVIEW_PV_SCRIPTDOCK_H
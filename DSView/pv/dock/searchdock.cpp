@@ -34,9 +34,8 @@
 #include <QPainter> 
 #include <QRect>
 #include <QMouseEvent>
-#include <QFuture>
 #include <QProgressDialog>
-#include <QtConcurrent/QtConcurrent>
+#include "../taskscheduler.h"
 #include <stdint.h> 
 #include "../config/appconfig.h"
 
@@ -152,11 +151,6 @@ void SearchDock::on_previous()
         msg.exec();
         return;
     } else {
-        QFuture<void> future;
-        future = QtConcurrent::run([&]{
-            last_pos -= last_hit;
-            ret = logic_snapshot->pattern_search(0, end, last_pos, _pattern, false);
-        });
         Qt::WindowFlags flags = Qt::CustomizeWindowHint;
         QProgressDialog dlg(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_SEARCH_PREVIOUS), "Search Previous..."),
                             L_S(STR_PAGE_DLG, S_ID(IDS_DLG_CANCEL), "Cancel"),0,0,this,flags);
@@ -165,10 +159,14 @@ void SearchDock::on_previous()
                            Qt::WindowMinimizeButtonHint | Qt::WindowMaximizeButtonHint);
         dlg.setCancelButton(NULL);
 
-        QFutureWatcher<void> watcher;
-        connect(&watcher,SIGNAL(finished()),&dlg,SLOT(cancel()));
-        watcher.setFuture(future);
+        TaskPtr task = TaskScheduler::Instance().submit(TaskScheduler::TaskQuery, [&](Task &){
+            last_pos -= last_hit;
+            ret = logic_snapshot->pattern_search(0, end, last_pos, _pattern, false);
+        }, [&dlg]{
+            QMetaObject::invokeMethod(&dlg, "cancel", Qt::QueuedConnection);
+        });
         dlg.exec();
+        task->wait();
 
         if (!ret) {
             dialogs::DSMessageBox msg(this);
@@ -213,10 +211,6 @@ void SearchDock::on_next()
         msg.exec();
         return;
     } else {
-        QFuture<void> future;
-        future = QtConcurrent::run([&]{
-            ret = logic_snapshot->pattern_search(0, end, last_pos, _pattern, true);
-        });
         Qt::WindowFlags flags = Qt::CustomizeWindowHint;
         QProgressDialog dlg(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_SEARCH_NEXT), "Search Next..."),
                             L_S(STR_PAGE_DLG, S_ID(IDS_DLG_CANCEL), "Cancel"),0,0,this,flags);
@@ -225,10 +219,13 @@ void SearchDock::on_next()
                            Qt::WindowMinimizeButtonHint | Qt::WindowMaximizeButtonHint);
         dlg.setCancelButton(NULL);
 
-        QFutureWatcher<void> watcher;
-        connect(&watcher,SIGNAL(finished()),&dlg,SLOT(cancel()));
-        watcher.setFuture(future);
+        TaskPtr task = TaskScheduler::Instance().submit(TaskScheduler::TaskQuery, [&](Task &){
+            ret = logic_snapshot->pattern_search(0, end, last_pos, _pattern, true);
+        }, [&dlg]{
+            QMetaObject::invokeMethod(&dlg, "cancel", Qt::QueuedConnection);
+        });
         dlg.exec();
+        task->wait();
 
         if (!ret) {
             dialogs::DSMessageBox msg(this);
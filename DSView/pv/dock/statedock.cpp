@@ -0,0 +1,316 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "statedock.h"
+#include "../sigsession.h"
+#include "../view/view.h"
+#include "../view/signal.h"
+#include "../data/logicsnapshot.h"
+#include "../dialogs/dsmessagebox.h"
+#include "../log.h"
+
+#include <QHeaderView>
+#include <QProgressDialog>
+#include "../taskscheduler.h"
+#include <atomic>
+
+#include "../ui/langresource.h"
+
+namespace pv {
+namespace dock {
+
+using namespace pv::view;
+
+StateDock::StateDock(QWidget *parent, View &view, SigSession *session) :
+    QScrollArea(parent),
+    _session(session),
+    _view(view)
+{
+    _widget = new QWidget(this);
+    _model = new data::StateModel(this);
+
+    /* setting group */
+    _setting_groupBox = new QGroupBox(_widget);
+    _clock_label = new QLabel(_widget);
+    _clock_combobox = new DsComboBox(_widget);
+    _edge_label = new QLabel(_widget);
+    _edge_combobox = new DsComboBox(_widget);
+    _data_label = new QLabel(_widget);
+    _data_edit = new QLineEdit(_widget);
+    _format_label = new QLabel(_widget);
+    _format_combobox = new DsComboBox(_widget);
+    _run_btn = new QPushButton(_widget);
+
+    QGridLayout *setting_layout = new QGridLayout();
+    setting_layout->setVerticalSpacing(5);
+    setting_layout->addWidget(_clock_label, 0, 0);
+    setting_layout->addWidget(_clock_combobox, 0, 1);
+    setting_layout->addWidget(_edge_label, 1, 0);
+    setting_layout->addWidget(_edge_combobox, 1, 1);
+    setting_layout->addWidget(_data_label, 2, 0);
+    setting_layout->addWidget(_data_edit, 2, 1);
+    setting_layout->addWidget(_format_label, 3, 0);
+    setting_layout->addWidget(_format_combobox, 3, 1);
+    setting_layout->addWidget(_run_btn, 4, 0, 1, 2);
+    setting_layout->setColumnStretch(1, 1);
+    _setting_groupBox->setLayout(setting_layout);
+
+    /* result group */
+    _result_groupBox = new QGroupBox(_widget);
+    _result_label = new QLabel(_widget);
+    _result_label->setWordWrap(true);
+    _state_table = new QTableView(_widget);
+    _state_table->setModel(_model);
+    _state_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    _state_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    _state_table->setSelectionMode(QAbstractItemView::SingleSelection);
+    _state_table->horizontalHeader()->setStretchLastSection(true);
+    // the table can hold millions of states, fixed rows keep it from
+    // measuring each one
+    _state_table->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    _state_table->verticalHeader()->setDefaultSectionSize(_state_table->fontMetrics().height() + 4);
+    _state_table->setMinimumHeight(300);
+
+    QGridLayout *result_layout = new QGridLayout();
+    result_layout->addWidget(_result_label, 0, 0);
+    result_layout->addWidget(_state_table, 1, 0);
+    _result_groupBox->setLayout(result_layout);
+
+    QVBoxLayout *layout = new QVBoxLayout(_widget);
+    layout->addWidget(_setting_groupBox);
+    layout->addWidget(_result_groupBox);
+    layout->addStretch(1);
+    _widget->setLayout(layout);
+
+    this->setWidget(_widget);
+    this->setWidgetResizable(true);
+    _widget->setObjectName("stateWidget");
+
+    retranslateUi();
+
+    connect(_run_btn, SIGNAL(clicked()), this, SLOT(on_run()));
+    connect(_format_combobox, SIGNAL(currentIndexChanged(int)), this, SLOT(on_format_changed(int)));
+    connect(_state_table, SIGNAL(clicked(QModelIndex)), this, SLOT(on_state_clicked(QModelIndex)));
+}
+
+StateDock::~StateDock()
+{
+}
+
+void StateDock::changeEvent(QEvent *event)
+{
+    if (event->type() == QEvent::LanguageChange)
+        retranslateUi();
+    QScrollArea::changeEvent(event);
+}
+
+void StateDock::retranslateUi()
+{
+    _setting_groupBox->setTitle(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATE_SETTING), "Bus"));
+    _clock_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATE_CLOCK), "Clock"));
+    _edge_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATE_EDGE), "Edge"));
+    _data_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATE_DATA), "Data"));
+    _data_edit->setPlaceholderText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATE_DATA_ALL), "All channels, or 0-7,9"));
+    _format_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATE_FORMAT), "Format"));
+    _run_btn->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATE_RUN), "List States"));
+    _result_groupBox->setTitle(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATE_RESULT), "States"));
+
+    int edge = _edge_combobox->currentIndex();
+    _edge_combobox->clear();
+    _edge_combobox->addItem(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATE_RISING), "Rising"));
+    _edge_combobox->addItem(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATE_FALLING), "Falling"));
+    _edge_combobox->addItem(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATE_BOTH), "Both"));
+    _edge_combobox->setCurrentIndex(edge < 0 ? 0 : edge);
+
+    int format = _format_combobox->currentIndex();
+    _format_combobox->clear();
+    _format_combobox->addItem(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATE_HEX), "Hex"));
+    _format_combobox->addItem(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATE_DEC), "Decimal"));
+    _format_combobox->addItem(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATE_BIN), "Binary"));
+    _format_combobox->setCurrentIndex(format < 0 ? 0 : format);
+
+    QStringList headers;
+    headers << L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATE_SAMPLE), "Sample")
+            << L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATE_TIME), "Time")
+            << L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATE_VALUE), "Value");
+    _model->setHeaders(headers);
+
+    update_result();
+}
+
+void StateDock::reload()
+{
+    const int clock = _clock_combobox->currentData().isValid() ?
+                      _clock_combobox->currentData().toInt() : -1;
+
+    _clock_combobox->clear();
+    for (auto s : _session->get_signals()) {
+        if (s->get_type() == SR_CHANNEL_LOGIC && s->enabled())
+            _clock_combobox->addItem(s->get_name(), QVariant(s->get_index()));
+    }
+    const int i = _clock_combobox->findData(QVariant(clock));
+    if (i >= 0)
+        _clock_combobox->setCurrentIndex(i);
+
+    _model->setStateSnapshot(NULL, 0);
+    _states.clear();
+    update_result();
+}
+
+void StateDock::capture_ended()
+{
+    // the states belong to the previous capture, and the channels
+    // may have changed since the dock was loaded
+    reload();
+}
+
+bool StateDock::parse_channels(const QString &text, std::vector<int> &channels)
+{
+    channels.clear();
+
+    for (const QString &item : text.split(',')) {
+        if (item.trimmed().isEmpty())
+            continue;
+
+        const QStringList range = item.trimmed().split('-');
+        bool ok1 = false;
+        bool ok2 = false;
+        const int first = range.at(0).trimmed().toInt(&ok1);
+        const int last = range.size() == 2 ? range.at(1).trimmed().toInt(&ok2) : first;
+
+        if (!ok1 || (range.size() == 2 && !ok2) || range.size() > 2 || first < 0 || last < 0)
+            return false;
+
+        const int step = first <= last ? 1 : -1;
+        for (int ch = first; ch != last + step; ch += step)
+            channels.push_back(ch);
+    }
+
+    return channels.size() > 0 && channels.size() <= (size_t)data::StateSnapshot::MaxDataChannels;
+}
+
+void StateDock::on_run()
+{
+    const auto snapshot = _session->get_snapshot(SR_CHANNEL_LOGIC);
+    const auto logic_snapshot = dynamic_cast<data::LogicSnapshot*>(snapshot);
+
+    QString error;
+    std::vector<int> channels;
+    const int clock = _clock_combobox->currentData().toInt();
+
+    if (_session->is_working()) {
+        error = L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATE_STOP_CAPTURE), "Stop the capture before listing the states.");
+    }
+    else if (!logic_snapshot || logic_snapshot->empty() || _clock_combobox->count() == 0) {
+        error = L_S(STR_PAGE_MSG, S_ID(IDS_MSG_NO_SAMPLE_DATA), "No Sample data!");
+    }
+    else if (_data_edit->text().trimmed().isEmpty()) {
+        for (int i = 0; i < _clock_combobox->count(); i++) {
+            const int index = _clock_combobox->itemData(i).toInt();
+            if (index != clock && (int)channels.size() < data::StateSnapshot::MaxDataChannels)
+                channels.push_back(index);
+        }
+    }
+    else if (!parse_channels(_data_edit->text(), channels)) {
+        error = L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATE_BAD_DATA), "The data channels should be a list like 0-7,9, up to 64 channels.");
+    }
+
+    if (error.isEmpty() && channels.empty())
+        error = L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATE_BAD_DATA), "The data channels should be a list like 0-7,9, up to 64 channels.");
+
+    if (!error.isEmpty()) {
+        dialogs::DSMessageBox msg(this);
+        msg.mBox()->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATE_RUN), "List States"));
+        msg.mBox()->setInformativeText(error);
+        msg.mBox()->setStandardButtons(QMessageBox::Ok);
+        msg.mBox()->setIcon(QMessageBox::Warning);
+        msg.exec();
+        return;
+    }
+
+    const data::StateSnapshot::ClockEdge edge =
+        (data::StateSnapshot::ClockEdge)_edge_combobox->currentIndex();
+
+    _model->setStateSnapshot(NULL, 0);
+
+    bool ret = false;
+    std::atomic<bool> canceled(false);
+    Qt::WindowFlags flags = Qt::CustomizeWindowHint;
+    QProgressDialog dlg(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATE_RUNNING), "Listing states..."),
+                        L_S(STR_PAGE_DLG, S_ID(IDS_DLG_CANCEL), "Cancel"),0,0,this,flags);
+    dlg.setWindowModality(Qt::WindowModal);
+    dlg.setWindowFlags(Qt::Dialog | Qt::FramelessWindowHint | Qt::WindowSystemMenuHint |
+                       Qt::WindowMinimizeButtonHint | Qt::WindowMaximizeButtonHint);
+
+    connect(&dlg, &QProgressDialog::canceled, [&]{ canceled = true; });
+    TaskPtr task = TaskScheduler::Instance().submit(TaskScheduler::TaskQuery, [&](Task &){
+        ret = _states.extract(logic_snapshot, clock, edge, channels,
+                              0, logic_snapshot->get_sample_count(), &canceled);
+    }, [&dlg]{
+        QMetaObject::invokeMethod(&dlg, "cancel", Qt::QueuedConnection);
+    });
+    dlg.exec();
+    task->wait();
+
+    if (!ret) {
+        dsv_warn("Failed to list the states, clock:%d", clock);
+        _states.clear();
+    }
+    dsv_info("State listing, clock:%d, data channels:%d, states:%llu",
+             clock, (int)channels.size(), (unsigned long long)_states.get_state_count());
+
+    _model->setStateSnapshot(&_states, _session->cur_snap_samplerate());
+    update_result();
+}
+
+void StateDock::update_result()
+{
+    if (_states.get_state_count() == 0) {
+        _result_label->setText("");
+        return;
+    }
+
+    QString text = QString::number(_states.get_state_count()) + " " +
+                   L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATE_STATES), "state(s)");
+    if (_states.truncated()) {
+        text += ", ";
+        text += L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATE_TRUNCATED), "the capture has more");
+    }
+    _result_label->setText(text);
+}
+
+void StateDock::on_format_changed(int index)
+{
+    if (index >= 0)
+        _model->setFormat((data::StateModel::ValueFormat)index);
+}
+
+void StateDock::on_state_clicked(const QModelIndex &index)
+{
+    if (!index.isValid() || index.row() >= (int)_states.get_state_count())
+        return;
+
+    const uint64_t pos = _states.get_position(index.row());
+    _session->show_region(pos, pos + 1, false);
+}
+
+} // namespace dock
+} // namespace pv
@@ -0,0 +1,99 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef DSVIEW_PV_STATEDOCK_H
+#define DSVIEW_PV_STATEDOCK_H
+
+#include <QScrollArea>
+#include <QPushButton>
+#include <QLabel>
+#include <QGroupBox>
+#include <QLineEdit>
+#include <QTableView>
+#include <QGridLayout>
+#include <QVBoxLayout>
+
+#include "../data/statesnapshot.h"
+#include "../data/statemodel.h"
+#include "../ui/dscombobox.h"
+
+namespace pv {
+
+class SigSession;
+
+namespace view {
+    class View;
+}
+
+namespace dock {
+
+//List the value of a parallel bus at each edge of its clock channel
+class StateDock : public QScrollArea
+{
+    Q_OBJECT
+
+public:
+    StateDock(QWidget *parent, pv::view::View &view, SigSession *session);
+    ~StateDock();
+
+    void reload();
+    void capture_ended();
+
+private:
+    void changeEvent(QEvent *event);
+    void retranslateUi();
+    void update_result();
+
+    // "0-7,9" style list, the first channel is bit 0 of the value
+    bool parse_channels(const QString &text, std::vector<int> &channels);
+
+private slots:
+    void on_run();
+    void on_format_changed(int index);
+    void on_state_clicked(const QModelIndex &index);
+
+private:
+    SigSession *_session;
+    view::View &_view;
+    data::StateSnapshot _states;
+    data::StateModel *_model;
+
+    QWidget *_widget;
+    QGroupBox *_setting_groupBox;
+    QLabel *_clock_label;
+    DsComboBox *_clock_combobox;
+    QLabel *_edge_label;
+    DsComboBox *_edge_combobox;
+    QLabel *_data_label;
+    QLineEdit *_data_edit;
+    QLabel *_format_label;
+    DsComboBox *_format_combobox;
+    QPushButton *_run_btn;
+
+    QGroupBox *_result_groupBox;
+    QTableView *_state_table;
+    QLabel *_result_label;
+};
+
+} // namespace dock
+} // namespace pv
+
+#endif // DSVIEW_PV_STATEDOCK_H
@@ -37,6 +37,9 @@
 #include "../config/appconfig.h"
 #include "../deviceagent.h"
 #include "../view/logicsignal.h"
+#include "../view/ruler.h"
+#include "../data/logicsnapshot.h"
+#include "../data/triggersim.h"
 #include "../ui/langresource.h"
 
 namespace pv {
@@ -89,6 +92,11 @@ TriggerDock::TriggerDock(QWidget *parent, SigSession *session) :
     connect(_adv_radioButton, SIGNAL(clicked()), this, SLOT(adv_trigger()));
     connect(stages_comboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(widget_enable(int)));
 
+    _test_button = new QPushButton(_widget);
+    _test_label = new QLabel(_widget);
+    _test_label->setWordWrap(true);
+    connect(_test_button, SIGNAL(clicked()), this, SLOT(test_trigger()));
+
 
     QVBoxLayout *layout = new QVBoxLayout(_widget);
     QGridLayout *gLayout = new QGridLayout();
@@ -107,6 +115,8 @@ TriggerDock::TriggerDock(QWidget *parent, SigSession *session) :
 
     layout->addLayout(gLayout);
     layout->addWidget(_adv_tabWidget);
+    layout->addWidget(_test_button);
+    layout->addWidget(_test_label);
     layout->addStretch(1);
     _widget->setLayout(layout);
 
@@ -136,6 +146,7 @@ void TriggerDock::retranslateUi()
     _adv_radioButton->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_ADVANCED_TRIGGER), "Advanced Trigger"));
     _position_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_TRIGGER_POSITION), "Trigger Position: "));
     _stages_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_TOTAL_TRIGGER_STAGES), "Total Trigger Stages: "));
+    _test_button->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_TRIGGER_TEST), "Test on Capture"));
     _serial_start_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_START_FLAG), "Start Flag: "));
     _serial_stop_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STOP_FLAG), "Stop Flag: "));
     _serial_edge_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_CLOCK_FLAG), "Clock Flag: "));
@@ -956,6 +967,99 @@ void TriggerDock::try_commit_trigger()
             }
         }
     }
+
+    // the session refuses to start the capture with it
+    struct ds_trigger_program prog;
+    if (ds_trigger_compile(&prog) != SR_OK) {
+        dialogs::DSMessageBox msg(this);
+        msg.mBox()->setText(L_S(STR_PAGE_MSG, S_ID(IDS_MSG_TRIGGER), "Trigger"));
+        msg.mBox()->setInformativeText(trigger_error_text(prog));
+        msg.mBox()->setStandardButtons(QMessageBox::Ok);
+        msg.mBox()->setIcon(QMessageBox::Warning);
+        msg.exec();
+    }
+}
+
+QString TriggerDock::trigger_error_text(const struct ds_trigger_program &prog)
+{
+    const QString stage = QString::number(prog.error_stage);
+    const QString channel = QString::number(prog.error_probe);
+
+    switch (prog.error)
+    {
+    case DS_TRIGGER_ERR_CHAR:
+        return L_S(STR_PAGE_MSG, S_ID(IDS_MSG_TRIGGER_ERR_CHAR), "Stage %1: unknown trigger value of channel %2")
+                .arg(stage).arg(channel);
+    case DS_TRIGGER_ERR_NEVER:
+        return L_S(STR_PAGE_MSG, S_ID(IDS_MSG_TRIGGER_ERR_NEVER), "Stage %1: the two conditions can never match together on channel %2")
+                .arg(stage).arg(channel);
+    case DS_TRIGGER_ERR_CONTIGUOUS:
+        return L_S(STR_PAGE_MSG, S_ID(IDS_MSG_TRIGGER_ERR_CONTIGUOUS), "Stage %1: an edge can not match on contiguous samples")
+                .arg(stage);
+    case DS_TRIGGER_ERR_SERIAL:
+        return L_S(STR_PAGE_MSG, S_ID(IDS_MSG_TRIGGER_ERR_SERIAL), "Serial trigger needs one clock edge and one data channel");
+    }
+    return "";
+}
+
+void TriggerDock::test_trigger()
+{
+    _test_label->clear();
+
+    if (_session->get_device()->get_work_mode() != LOGIC || _session->is_working())
+        return;
+
+    data::LogicSnapshot *snapshot = dynamic_cast<data::LogicSnapshot*>(_session->get_snapshot(SR_CHANNEL_LOGIC));
+    if (snapshot == NULL || snapshot->empty()) {
+        _test_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_TRIGGER_TEST_NO_DATA), "No captured data"));
+        return;
+    }
+
+    // the program the next capture would get
+    ds_trigger_reset();
+    if (commit_trigger() == false) {
+        for(auto &s : _session->get_signals()) {
+            view::LogicSignal *logicSig = NULL;
+            if ((logicSig = dynamic_cast<view::LogicSignal*>(s)))
+                logicSig->commit_trig();
+        }
+    }
+
+    struct ds_trigger_program prog;
+    if (ds_trigger_compile(&prog) != SR_OK) {
+        dialogs::DSMessageBox msg(this);
+        msg.mBox()->setText(L_S(STR_PAGE_MSG, S_ID(IDS_MSG_TRIGGER), "Trigger"));
+        msg.mBox()->setInformativeText(trigger_error_text(prog));
+        msg.mBox()->setStandardButtons(QMessageBox::Ok);
+        msg.mBox()->setIcon(QMessageBox::Warning);
+        msg.exec();
+        return;
+    }
+
+    uint64_t probe_mask = 0;
+    for (int i = 0; i < MaxTriggerProbes; i++) {
+        if (snapshot->has_data(i))
+            probe_mask |= 1ULL << i;
+    }
+
+    data::TriggerSim sim(prog);
+    if (!sim.run(snapshot, snapshot->get_sample_count(), probe_mask)) {
+        _test_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_TRIGGER_TEST_NO_CHANNEL), "Channel %1 is not captured")
+                             .arg(sim.get_missing_probe()));
+        return;
+    }
+
+    const std::vector<uint64_t> &fires = sim.get_fires();
+    if (fires.empty()) {
+        _test_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_TRIGGER_TEST_NONE), "Would not trigger on this capture"));
+        return;
+    }
+
+    const QString count = QString::number(fires.size()) + (sim.truncated() ? "+" : "");
+    _test_label->setText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_TRIGGER_TEST_HITS), "Would trigger %1 times, first at %2")
+                         .arg(count)
+                         .arg(view::Ruler::format_real_time(fires[0], _session->cur_snap_samplerate())));
+    trigger_test_hit(fires[0]);
 }
 
 } // namespace dock
@@ -41,6 +41,7 @@
 #include <QScrollArea>
 
 #include <vector>
+#include <libsigrok.h>
 
 #include "../ui/dscombobox.h" 
 
@@ -86,6 +87,8 @@ private:
      *        1: advanced trigger
      */
     bool commit_trigger();
+
+    QString trigger_error_text(const struct ds_trigger_program &prog);
  
 
 public slots:
@@ -95,6 +98,12 @@ public slots:
 
     void value_changed(); 
 
+    // runs the trigger over the captured data
+    void test_trigger();
+
+signals:
+    void trigger_test_hit(quint64 index);
+
 private:
     SigSession *_session;
 
@@ -150,6 +159,8 @@ private:
     QVector <QLabel *>  _contiguous_label_list;
     QVector <QLabel *>  _stage_note_label_list;
 
+    QPushButton *_test_button;
+    QLabel *_test_label;
 };
 
 } // namespace dock
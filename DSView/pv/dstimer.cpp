@@ -86,6 +86,11 @@ void DsTimer::SetCallback(CALLBACL_FUNC f)
     _beginTime = high_resolution_clock::now();
  }
 
+ void DsTimer::SetPrecise(bool precise)
+ {
+     _timer.setTimerType(precise ? Qt::PreciseTimer : Qt::CoarseTimer);
+ }
+
  void DsTimer::Stop()
  {
      if (_isActived)
@@ -52,6 +52,9 @@ public:
 
     void Stop(); 
 
+    // millisecond accuracy instead of the coarse default
+    void SetPrecise(bool precise);
+
     inline bool IsActived(){
         return _isActived;
     }
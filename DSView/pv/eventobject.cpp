@@ -22,7 +22,80 @@
 #include "eventobject.h"
 
 EventObject::EventObject(){
-    
+    _len_reset = false;
+    _len_sum = 0;
+    _data_updated = false;
+    _flush_scheduled = false;
+
+    _flush_timer.setSingleShot(true);
+    connect(&_flush_timer, SIGNAL(timeout()), this, SLOT(on_flush()));
+}
+
+void EventObject::post_receive_data_len(quint64 len)
+{
+    {
+        std::lock_guard<std::mutex> lock(_post_mutex);
+        // zero length restarts the count, the lengths before it are dropped
+        if (len == 0) {
+            _len_reset = true;
+            _len_sum = 0;
+        }
+        else {
+            _len_sum += len;
+        }
+    }
+    schedule_flush();
+}
+
+void EventObject::post_data_updated()
+{
+    {
+        std::lock_guard<std::mutex> lock(_post_mutex);
+        _data_updated = true;
+    }
+    schedule_flush();
+}
+
+void EventObject::schedule_flush()
+{
+    if (!_flush_scheduled.exchange(true))
+        QMetaObject::invokeMethod(this, "on_schedule_flush", Qt::QueuedConnection);
+}
+
+void EventObject::on_schedule_flush()
+{
+    int wait = 0;
+
+    if (_last_flush.isValid())
+        wait = qMax(0, FrameInterval - (int)_last_flush.elapsed());
+    _flush_timer.start(wait);
+}
+
+void EventObject::on_flush()
+{
+    bool len_reset;
+    quint64 len_sum;
+    bool updated;
+
+    // events posted from here on need a new flush
+    _flush_scheduled = false;
+    {
+        std::lock_guard<std::mutex> lock(_post_mutex);
+        len_reset = _len_reset;
+        len_sum = _len_sum;
+        updated = _data_updated;
+        _len_reset = false;
+        _len_sum = 0;
+        _data_updated = false;
+    }
+    _last_flush.restart();
+
+    if (len_reset)
+        receive_data_len(0);
+    if (len_sum > 0)
+        receive_data_len(len_sum);
+    if (updated)
+        data_updated();
 }
 
 DeviceEventObject::DeviceEventObject()
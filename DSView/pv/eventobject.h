@@ -23,14 +23,33 @@
 #define _EVENT_OBJECT_H
 
 #include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <mutex>
+#include <atomic>
 
 class EventObject : public QObject
 {
     Q_OBJECT
 
+private:
+    // at most one delivery of the coalesced events per display frame
+    static const int FrameInterval = 16;
+
 public:
     EventObject(); 
 
+    // High frequency events, safe to call from any thread. They are
+    // accumulated and emitted together on the thread of this object.
+    void post_receive_data_len(quint64 len);
+    void post_data_updated();
+
+private:
+    void schedule_flush();
+
+private slots:
+    void on_schedule_flush();
+    void on_flush();
 
 signals:
     void show_error(QString error);
@@ -47,6 +66,15 @@ signals:
     void receive_data_len(quint64 len);
     void cur_snap_samplerate_changed();
     void trigger_message(int msg);
+
+private:
+    std::mutex      _post_mutex;
+    bool            _len_reset;
+    quint64         _len_sum;
+    bool            _data_updated;
+    std::atomic<bool> _flush_scheduled;
+    QTimer          _flush_timer;
+    QElapsedTimer   _last_flush;
 };
 
 
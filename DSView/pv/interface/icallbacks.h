@@ -90,6 +90,7 @@ public:
 
 #define DSV_MSG_TRIG_NEXT_COLLECT       7001
 #define DSV_MSG_SAVE_COMPLETE           7002
+#define DSV_MSG_REMOVE_VIRTUAL_CHANNEL_PREV 7003
 
 class IMessageListener
 {
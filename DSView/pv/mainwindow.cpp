@@ -69,6 +69,9 @@
 #include "dock/dsotriggerdock.h"
 #include "dock/measuredock.h"
 #include "dock/searchdock.h"
+#include "dock/comparedock.h"
+#include "dock/scriptdock.h"
+#include "dock/statedock.h"
 #include "dock/protocoldock.h"
 
 #include "view/view.h"
@@ -197,6 +200,30 @@ namespace pv
         // dock::SearchDock *_search_widget = new dock::SearchDock(_search_dock, *_view, _session);
         _search_widget = new dock::SearchDock(_search_dock, *_view, _session);
         _search_dock->setWidget(_search_widget);
+        // compare dock
+        _compare_dock = new QDockWidget(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_DOCK_TITLE), "Compare"), this);
+        _compare_dock->setObjectName("compare_dock");
+        _compare_dock->setFeatures(QDockWidget::DockWidgetMovable | QDockWidget::DockWidgetClosable);
+        _compare_dock->setAllowedAreas(Qt::RightDockWidgetArea);
+        _compare_dock->setVisible(false);
+        _compare_widget = new dock::CompareDock(_compare_dock, *_view, _session);
+        _compare_dock->setWidget(_compare_widget);
+        // script dock
+        _script_dock = new QDockWidget(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_SCRIPT_DOCK_TITLE), "Script"), this);
+        _script_dock->setObjectName("script_dock");
+        _script_dock->setFeatures(QDockWidget::DockWidgetMovable | QDockWidget::DockWidgetClosable);
+        _script_dock->setAllowedAreas(Qt::RightDockWidgetArea);
+        _script_dock->setVisible(false);
+        _script_widget = new dock::ScriptDock(_script_dock, *_view, _session);
+        _script_dock->setWidget(_script_widget);
+        // state dock
+        _state_dock = new QDockWidget(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATE_DOCK_TITLE), "State Listing"), this);
+        _state_dock->setObjectName("state_dock");
+        _state_dock->setFeatures(QDockWidget::DockWidgetMovable | QDockWidget::DockWidgetClosable);
+        _state_dock->setAllowedAreas(Qt::RightDockWidgetArea);
+        _state_dock->setVisible(false);
+        _state_widget = new dock::StateDock(_state_dock, *_view, _session);
+        _state_dock->setWidget(_state_widget);
 
         addDockWidget(Qt::RightDockWidgetArea, _protocol_dock);
 
@@ -204,6 +231,9 @@ namespace pv
         addDockWidget(Qt::RightDockWidgetArea, _dso_trigger_dock);
         addDockWidget(Qt::RightDockWidgetArea, _measure_dock);
         addDockWidget(Qt::BottomDockWidgetArea, _search_dock);
+        addDockWidget(Qt::RightDockWidgetArea, _compare_dock);
+        addDockWidget(Qt::RightDockWidgetArea, _script_dock);
+        addDockWidget(Qt::RightDockWidgetArea, _state_dock);
 
         // Set the title
         QString title = QApplication::applicationName() + " v" + QApplication::applicationVersion();
@@ -220,6 +250,9 @@ namespace pv
         _protocol_dock->installEventFilter(this);
         _measure_dock->installEventFilter(this);
         _search_dock->installEventFilter(this);
+        _compare_dock->installEventFilter(this);
+        _script_dock->installEventFilter(this);
+        _state_dock->installEventFilter(this);
 
         // defaut language
         AppConfig &app = AppConfig::Instance();
@@ -257,6 +290,9 @@ namespace pv
         connect(_trig_bar, SIGNAL(sig_search(bool)), this, SLOT(on_search(bool)));
         connect(_trig_bar, SIGNAL(sig_setTheme(QString)), this, SLOT(switchTheme(QString)));
         connect(_trig_bar, SIGNAL(sig_show_lissajous(bool)), _view, SLOT(show_lissajous(bool)));
+        connect(_trig_bar, SIGNAL(sig_compare(bool)), this, SLOT(on_compare(bool)));
+        connect(_trig_bar, SIGNAL(sig_script(bool)), this, SLOT(on_script(bool)));
+        connect(_trig_bar, SIGNAL(sig_state(bool)), this, SLOT(on_state(bool)));
 
         // file toolbar
         connect(_file_bar, SIGNAL(sig_load_file(QString)), this, SLOT(on_load_file(QString)));
@@ -276,6 +312,7 @@ namespace pv
 
         //
         connect(_dso_trigger_widget, SIGNAL(set_trig_pos(int)), _view, SLOT(set_trig_pos(int)));
+        connect(_trigger_widget, SIGNAL(trigger_test_hit(quint64)), _view, SLOT(set_search_hit(quint64)));
 
         _logo_bar->set_mainform_callback(this);
 
@@ -308,6 +345,9 @@ namespace pv
         _protocol_dock->setWindowTitle(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_PROTOCOL_DOCK_TITLE), "Protocol"));
         _measure_dock->setWindowTitle(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_MEASURE_DOCK_TITLE), "Measurement"));
         _search_dock->setWindowTitle(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_SEARCH_DOCK_TITLE), "Search..."));
+        _compare_dock->setWindowTitle(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_COMPARE_DOCK_TITLE), "Compare"));
+        _script_dock->setWindowTitle(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_SCRIPT_DOCK_TITLE), "Script"));
+        _state_dock->setWindowTitle(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_STATE_DOCK_TITLE), "State Listing"));
     }
 
     void MainWindow::on_load_file(QString file_name)
@@ -506,6 +546,21 @@ namespace pv
         _view->show_search_cursor(visible);
     }
 
+    void MainWindow::on_compare(bool visible)
+    {
+        _compare_dock->setVisible(visible);
+    }
+
+    void MainWindow::on_script(bool visible)
+    {
+        _script_dock->setVisible(visible);
+    }
+
+    void MainWindow::on_state(bool visible)
+    {
+        _state_dock->setVisible(visible);
+    }
+
     void MainWindow::on_screenShot()
     {
         AppConfig &app = AppConfig::Instance();
@@ -708,6 +763,17 @@ namespace pv
         }
         sessionVar["channel"] = channelVar;
 
+        QJsonArray virtualVar;
+        for (auto vch : _session->get_virtual_channels())
+        {
+            QJsonObject v_obj;
+            v_obj["index"] = vch->get_index();
+            v_obj["name"] = vch->get_name();
+            v_obj["expression"] = vch->get_expression();
+            virtualVar.append(v_obj);
+        }
+        sessionVar["virtual"] = virtualVar;
+
         if (_device_agent->get_work_mode() == LOGIC)
         {
             sessionVar["trigger"] = _trigger_widget->get_session();
@@ -906,6 +972,26 @@ namespace pv
         //_session->init_signals();
         _session->reload();
 
+        // the virtual channels, before the settings of their signals
+        if (mode == LOGIC)
+        {
+            std::vector<data::VirtualChannel *> old_virtual = _session->get_virtual_channels();
+            for (auto vch : old_virtual)
+                _session->remove_virtual_channel(vch->get_index());
+
+            for (const QJsonValue &value : sessionObj["virtual"].toArray())
+            {
+                QJsonObject obj = value.toObject();
+                QString error;
+                if (!_session->add_virtual_channel(obj["name"].toString(), obj["expression"].toString(),
+                                                   error, obj["index"].toInt()))
+                {
+                    dsv_warn("Failed to load the virtual channel \"%s\": %s",
+                             obj["name"].toString().toUtf8().data(), error.toUtf8().data());
+                }
+            }
+        }
+
         // load signal setting
         if (mode == DSO)
         {
@@ -1085,6 +1171,7 @@ namespace pv
         {
 
             on_protocol(false);
+            on_compare(false);
         }
         _trig_bar->update_protocol_btn(_protocol_dock->isVisible());
         _trig_bar->update_measure_btn(_measure_dock->isVisible());
@@ -1271,7 +1358,7 @@ namespace pv
 
     void MainWindow::data_updated()
     {
-        _event.data_updated(); // safe call
+        _event.post_data_updated(); // safe call, coalesced
     }
 
     void MainWindow::on_data_updated()
@@ -1379,7 +1466,7 @@ namespace pv
 
     void MainWindow::receive_data_len(quint64 len)
     {
-        _event.receive_data_len(len); // safe call
+        _event.post_receive_data_len(len); // safe call, coalesced
     }
 
     void MainWindow::on_receive_data_len(quint64 len)
@@ -1444,6 +1531,9 @@ namespace pv
         _trig_bar->restore_status();
         _dso_trigger_widget->init();
         _measure_widget->reload();
+        _compare_widget->reload();
+        _script_widget->reload();
+        _state_widget->reload();
     }
 
     bool MainWindow::confirm_to_store_data()
@@ -1590,11 +1680,18 @@ namespace pv
             break;
 
         case DSV_MSG_START_COLLECT_WORK_PREV:
+            _measure_widget->stop_stats();
+            _compare_widget->stop_compare();
             _trigger_widget->try_commit_trigger();
             _view->capture_init();
             _view->on_state_changed(false);
             break;
 
+        case DSV_MSG_REMOVE_VIRTUAL_CHANNEL_PREV:
+            _measure_widget->stop_stats();
+            _compare_widget->stop_compare();
+            break;
+
         case DSV_MSG_START_COLLECT_WORK:
             update_toolbar_view_status();
             _view->on_state_changed(false);
@@ -1604,6 +1701,8 @@ namespace pv
             prgRate(0);
             _view->repeat_unshow();
             _view->on_state_changed(true);
+            _compare_widget->capture_ended();
+            _state_widget->capture_ended();
             break;
 
         case DSV_MSG_END_COLLECT_WORK:
@@ -1644,6 +1743,11 @@ namespace pv
                     QJsonArray deArray = get_decoder_json_from_file(_device_agent->path());
                     ss.load_decoders(_protocol_widget, deArray);
                 }
+
+                // decode results saved with the file
+                StoreSession ss(_session);
+                ss.load_decode_results(_device_agent->path());
+
                 _session->start_capture(true);
             }
         }
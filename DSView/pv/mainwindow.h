@@ -62,6 +62,9 @@ class TriggerDock;
 class DsoTriggerDock;
 class MeasureDock;
 class SearchDock;
+class CompareDock;
+class ScriptDock;
+class StateDock;
 }
 
 namespace view {
@@ -101,6 +104,9 @@ private slots:
 
     void on_measure(bool visible);
     void on_search(bool visible);
+    void on_compare(bool visible);
+    void on_script(bool visible);
+    void on_state(bool visible);
     void on_screenShot();
     void on_save();
 
@@ -210,6 +216,12 @@ private:
     dock::MeasureDock       *_measure_widget;
     QDockWidget             *_search_dock;
     dock::SearchDock        *_search_widget;
+    QDockWidget             *_compare_dock;
+    dock::CompareDock       *_compare_widget;
+    QDockWidget             *_script_dock;
+    dock::ScriptDock        *_script_widget;
+    QDockWidget             *_state_dock;
+    dock::StateDock         *_state_widget;
 
     QTranslator     _qtTrans;
     QTranslator     _myTrans;
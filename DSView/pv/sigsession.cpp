@@ -38,6 +38,8 @@
 #include "data/decodermodel.h"
 #include "data/spectrumstack.h"
 #include "data/mathstack.h"
+#include "data/memorybudget.h"
+#include "data/scriptengine.h"
 
 #include "view/analogsignal.h"
 #include "view/dsosignal.h"
@@ -46,12 +48,15 @@
 #include "view/decodetrace.h"
 #include "view/spectrumtrace.h"
 #include "view/lissajoustrace.h"
+#include "view/eyetrace.h"
 #include "view/mathtrace.h"
+#include "view/trendtrace.h"
 
 #include <assert.h>
 #include <stdexcept>
 #include <sys/stat.h>
 #include <map>
+#include <algorithm>
 #include <QString>
 
 #include "data/decode/decoderstatus.h"
@@ -60,6 +65,7 @@
 #include "config/appconfig.h"
 #include "utility/path.h"
 #include "ui/msgbox.h"
+#include "ui/langresource.h"
 
 namespace pv
 {
@@ -91,6 +97,7 @@ namespace pv
         _decoder_model = new pv::data::DecoderModel(NULL);
 
         _lissajous_trace = NULL;
+        _eye_trace = NULL;
         _math_trace = NULL;
         _dso_feed = false;
         _stop_scale = 1;
@@ -100,11 +107,15 @@ namespace pv
         _capture_time_id = 0;
         _confirm_store_time_id = 0;
         _repeat_wait_prog_step = 10;
+        _rearm_ready = false;
+        _rearm_pending = false;
+        _rearm_latency_us = -1;
 
         _device_agent.set_callback(this);
 
         // Create snapshots & data containers
         _logic_data = new data::Logic(new data::LogicSnapshot());
+        _logic_data->snapshot()->set_block_listener(&_stream_server);
         _dso_data = new data::Dso(new data::DsoSnapshot());
         _analog_data = new data::Analog(new data::AnalogSnapshot());
         _group_data = new data::Group();
@@ -114,6 +125,7 @@ namespace pv
         _feed_timer.SetCallback(std::bind(&SigSession::feed_timeout, this));
         _repeat_timer.SetCallback(std::bind(&SigSession::repeat_capture_wait_timeout, this));
         _repeat_wait_prog_timer.SetCallback(std::bind(&SigSession::repeat_wait_prog_timeout, this));
+        _repeat_timer.SetPrecise(true);
     }
 
     SigSession::SigSession(SigSession &o)
@@ -144,6 +156,9 @@ namespace pv
             return false;
         }
 
+        if (AppConfig::Instance()._appOptions.streamData)
+            _stream_server.start();
+
         return true;
     }
 
@@ -405,6 +420,64 @@ namespace pv
         }
     }
 
+    // Refuse a capture whose buffers do not fit in the memory budget,
+    // the buffers of the last capture are reused or released by it.
+    bool SigSession::check_memory_budget()
+    {
+        data::MemoryBudget &mem = data::MemoryBudget::Instance();
+        const uint64_t depth = _device_agent.get_sample_limit();
+        const int work_mode = _device_agent.get_work_mode();
+        uint64_t need = 0;
+        uint64_t reusable = 0;
+
+        if (work_mode == LOGIC) {
+            need = data::LogicSnapshot::get_memory_size(depth, get_ch_num(SR_CHANNEL_LOGIC));
+            reusable = mem.used(data::MemoryBudget::PoolLogic);
+        }
+        else if (work_mode == DSO) {
+            need = data::DsoSnapshot::get_memory_size(depth, get_ch_num(SR_CHANNEL_DSO));
+            reusable = mem.used(data::MemoryBudget::PoolDso);
+        }
+        else if (work_mode == ANALOG) {
+            unsigned int channel_num = 0;
+            int unit_bytes = 1;
+
+            for (const GSList *l = _device_agent.get_channels(); l; l = l->next) {
+                sr_channel *const probe = (sr_channel*)l->data;
+                if (probe->type == SR_CHANNEL_ANALOG)
+                    channel_num++;
+            }
+
+            GVariant *gvar = _device_agent.get_config(NULL, NULL, SR_CONF_UNIT_BITS);
+            if (gvar != NULL) {
+                unit_bytes = (g_variant_get_byte(gvar) + 7) / 8;
+                g_variant_unref(gvar);
+            }
+
+            need = data::AnalogSnapshot::get_memory_size(depth, channel_num, unit_bytes);
+            reusable = mem.used(data::MemoryBudget::PoolAnalog);
+        }
+
+        if (mem.admit(need, reusable))
+            return true;
+
+        const uint64_t MB = 1024 * 1024;
+        const uint64_t budget = mem.get_budget();
+        const uint64_t used = mem.total_used() - std::min(reusable, mem.total_used());
+        const uint64_t available = (budget > used) ? budget - used : 0;
+
+        dsv_err("The capture needs %lluMB, only %lluMB is available.",
+            (unsigned long long)(need / MB), (unsigned long long)(available / MB));
+        mem.log_usage("Memory usage");
+
+        QString msg = L_S(STR_PAGE_MSG, S_ID(IDS_MSG_MEMORY_BUDGET_ERROR),
+            "This capture needs %1MB of memory, but only %2MB is available in the memory budget.\n"
+            "Please reduce the sample depth or the channels, or raise the budget in the memory options.");
+        _callback->show_error(msg.arg(need / MB).arg(available / MB));
+
+        return false;
+    }
+
     void SigSession::container_init()
     {
         // Logic
@@ -433,6 +506,12 @@ namespace pv
         if (_math_trace)
             _math_trace->get_math_stack()->init();
 
+        for (auto &t : _trend_traces)
+            t->clear();
+
+        if (_eye_trace)
+            _eye_trace->clear();
+
         // DecoderStack
         for (auto &d : _decode_traces)
         {
@@ -464,6 +543,17 @@ namespace pv
             return false;
         }
 
+        // the capture reuses the buffers which python views point to
+        if (data::ScriptEngine::get_export_count() > 0)
+        {
+            dsv_err("Error!A script holds %lld views of the capture data.",
+                    (long long)data::ScriptEngine::get_export_count());
+            _callback->show_error(L_S(STR_PAGE_MSG, S_ID(IDS_MSG_SCRIPT_VIEWS_HELD),
+                "A script still holds the capture data.\n"
+                "Delete its references, e.g. with a del in a new script, before starting a capture."));
+            return false;
+        }
+
         // update setting
         if (_device_agent.is_file())
             _is_instant = true;
@@ -472,6 +562,20 @@ namespace pv
 
         _callback->trigger_message(DSV_MSG_START_COLLECT_WORK_PREV);
 
+        // the trigger dock has committed the trigger and shown its error
+        if (_device_agent.get_work_mode() == LOGIC && !_is_instant)
+        {
+            struct ds_trigger_program prog;
+            if (ds_trigger_compile(&prog) != SR_OK)
+            {
+                dsv_err("Error!The trigger can't work, error:%d, stage:%d.", prog.error, prog.error_stage);
+                return false;
+            }
+        }
+
+        _rearm_ready = false;
+        _rearm_latency_us = -1;
+
         if (exec_capture())
         {   
             _capture_time_id++;
@@ -491,6 +595,10 @@ namespace pv
             return false;
         }
 
+        if (_is_working && _is_repeat_mode && can_rearm())
+            return rearm_capture();
+        _rearm_ready = false;
+
         // Clear the previous decoder tasks.
         int run_dex = 0;
         clear_all_decode_task(run_dex);
@@ -509,6 +617,9 @@ namespace pv
             return false;
         }
 
+        if (!check_memory_budget())
+            return false;
+
         capture_init();
 
         if (_device_agent.start() == false)
@@ -517,9 +628,77 @@ namespace pv
             return false;
         }
 
+        _rearm_channels = get_logic_ch_index();
+        _rearm_ready = true;
+
         return true;
     }
 
+    // the indexes of the enabled logic channels
+    std::vector<int> SigSession::get_logic_ch_index()
+    {
+        std::vector<int> index_list;
+
+        for (const GSList *l = _device_agent.get_channels(); l; l = l->next)
+        {
+            const sr_channel *const probe = (const sr_channel *)l->data;
+            if (probe->type == SR_CHANNEL_LOGIC && probe->enabled)
+                index_list.push_back(probe->index);
+        }
+        return index_list;
+    }
+
+    // The repeat captures of the logic analyzer keep the settings of the
+    // first one when the samplerate, the depth and the enabled channels
+    // are unchanged.
+    bool SigSession::can_rearm()
+    {
+        return _rearm_ready
+            && _device_agent.get_work_mode() == LOGIC
+            && _device_agent.get_sample_rate() == _cur_snap_samplerate
+            && _device_agent.get_sample_limit() == _cur_samplelimits
+            && get_logic_ch_index() == _rearm_channels;
+    }
+
+    // Skips capture_init() and the memory budget check of exec_capture():
+    // the instant config, the feed timer, the samplerate and the depth are
+    // already set. The decode tasks are still stopped because they read the
+    // snapshots, and the snapshots are reset by container_init(), which keeps
+    // their blocks allocated. The device is started in full, the driver has
+    // no lighter way to arm a capture again.
+    bool SigSession::rearm_capture()
+    {
+        int run_dex = 0;
+        clear_all_decode_task(run_dex);
+
+        _data_updated = false;
+        _trigger_flag = false;
+        _trigger_ch = 0;
+        _hw_replied = false;
+        _noData_cnt = 0;
+        _data_lock = false;
+
+        container_init();
+
+        if (_device_agent.start() == false)
+        {
+            dsv_err("%s", "Start collect error!");
+            _rearm_ready = false;
+            return false;
+        }
+
+        return true;
+    }
+
+    void SigSession::repeat_next_capture()
+    {
+        _rearm_time = std::chrono::steady_clock::now();
+        _rearm_pending = true;
+
+        if (!exec_capture())
+            _rearm_pending = false;
+    }
+
     void SigSession::stop_capture()
     { 
         if (!_is_working)
@@ -620,6 +799,192 @@ namespace pv
         return _group_traces;
     }
 
+    bool SigSession::add_virtual_channel(const QString &name, const QString &expression,
+                                         QString &error, int index)
+    {
+        assert(!_is_working);
+
+        data::LogicSnapshot *snapshot = _logic_data->snapshot();
+
+        if (index == -1)
+        {
+            index = data::LogicSnapshot::VirtualIndexBase;
+            for (auto vch : snapshot->get_virtual_channels())
+                index = std::max(index, vch->get_index() + 1);
+        }
+        for (auto vch : snapshot->get_virtual_channels())
+        {
+            if (vch->get_index() == index)
+                index = CHANNEL_MAX_COUNT;
+        }
+
+        if (index < data::LogicSnapshot::VirtualIndexBase || index >= CHANNEL_MAX_COUNT)
+        {
+            error = L_S(STR_PAGE_MSG, S_ID(IDS_MSG_VIRTUAL_CHANNEL_FULL), "No more virtual channels can be added.");
+            return false;
+        }
+
+        data::VirtualChannel *vch = new data::VirtualChannel(index, name);
+        if (!vch->compile(expression, error))
+        {
+            delete vch;
+            return false;
+        }
+
+        // the sources must be captured logic channels
+        for (int src : vch->get_sources())
+        {
+            bool found = false;
+            for (const GSList *l = _device_agent.get_channels(); l; l = l->next)
+            {
+                const sr_channel *const probe = (const sr_channel *)l->data;
+                if (probe->type == SR_CHANNEL_LOGIC && probe->enabled && probe->index == src)
+                    found = true;
+            }
+            if (!found)
+            {
+                error = L_S(STR_PAGE_MSG, S_ID(IDS_MSG_VIRTUAL_CHANNEL_SOURCE), "Channel is not an enabled logic channel:") + QString(" D%1").arg(src);
+                delete vch;
+                return false;
+            }
+        }
+
+        snapshot->add_virtual_channel(vch);
+
+        sr_channel *probe = (sr_channel *)g_malloc0(sizeof(sr_channel));
+        probe->index = index;
+        probe->type = SR_CHANNEL_LOGIC;
+        probe->enabled = TRUE;
+        probe->name = g_strdup(name.toUtf8().data());
+        _virtual_probes.push_back(probe);
+
+        _signals.push_back(new view::LogicSignal(_logic_data, probe));
+        signals_changed();
+        data_updated();
+        return true;
+    }
+
+    void SigSession::remove_virtual_channel(int index)
+    {
+        assert(!_is_working);
+
+        // nothing may read the snapshot while the channel goes, the docks
+        // stop their queries, the decode tasks are stopped here
+        _callback->trigger_message(DSV_MSG_REMOVE_VIRTUAL_CHANNEL_PREV);
+
+        std::vector<view::DecodeTrace *> stopped;
+        {
+            std::lock_guard<std::mutex> lock(_decode_task_mutex);
+            stopped = _decode_tasks;
+        }
+        int run_dex = -1;
+        clear_all_decode_task(run_dex);
+        if (run_dex != -1)
+            stopped.push_back(_decode_traces[run_dex]);
+
+        for (auto t : _trend_traces)
+            t->cancel();
+
+        // the decoders and trends of the channel go with it
+        for (int i = (int)_decode_traces.size() - 1; i >= 0; i--)
+        {
+            bool bound = false;
+            for (auto dec : _decode_traces[i]->decoder()->stack())
+            {
+                for (auto &ch : dec->channels())
+                    bound |= ch.second == index;
+            }
+            if (bound)
+            {
+                stopped.erase(std::remove(stopped.begin(), stopped.end(), _decode_traces[i]),
+                              stopped.end());
+                remove_decoder(i);
+            }
+        }
+
+        for (auto it = _trend_traces.begin(); it != _trend_traces.end();)
+        {
+            if ((*it)->get_channel() == index)
+            {
+                delete *it;
+                it = _trend_traces.erase(it);
+            }
+            else
+            {
+                it++;
+            }
+        }
+
+        for (auto it = _signals.begin(); it != _signals.end(); it++)
+        {
+            if ((*it)->get_index() == index)
+            {
+                delete *it;
+                _signals.erase(it);
+                break;
+            }
+        }
+
+        data::LogicSnapshot *snapshot = _logic_data->snapshot();
+        snapshot->remove_virtual_channel(index);
+
+        for (auto it = _virtual_probes.begin(); it != _virtual_probes.end(); it++)
+        {
+            if ((*it)->index == index)
+            {
+                g_free((*it)->name);
+                g_free(*it);
+                _virtual_probes.erase(it);
+                break;
+            }
+        }
+
+        // the stopped decoders start again, their results were not complete
+        for (auto trace : stopped)
+        {
+            trace->decoder()->clear();
+            add_decode_task(trace);
+        }
+        if (!snapshot->empty())
+        {
+            for (auto &t : _trend_traces)
+                t->update(snapshot, _cur_snap_samplerate, [this]{ data_updated(); });
+        }
+
+        signals_changed();
+        data_updated();
+    }
+
+    std::vector<data::VirtualChannel *> SigSession::get_virtual_channels()
+    {
+        return _logic_data->snapshot()->get_virtual_channels();
+    }
+
+    void SigSession::append_virtual_signals(std::vector<view::Signal *> &sigs)
+    {
+        if (_device_agent.get_work_mode() != LOGIC)
+            return;
+
+        for (auto probe : _virtual_probes)
+        {
+            view::Signal *signal = NULL;
+
+            for (auto s : _signals)
+            {
+                view::LogicSignal *logicSig = NULL;
+                if (s->get_index() == probe->index && (logicSig = dynamic_cast<view::LogicSignal *>(s)))
+                {
+                    signal = new view::LogicSignal(logicSig, _logic_data, probe);
+                    break;
+                }
+            }
+            if (signal == NULL)
+                signal = new view::LogicSignal(_logic_data, probe);
+
+            sigs.push_back(signal);
+        }
+    }
+
     std::set<data::SignalData *> SigSession::get_data()
     {
         std::set<data::SignalData *> data;
@@ -686,6 +1051,43 @@ namespace pv
         }
     }
 
+    view::TrendTrace *SigSession::add_trend(int channel, int metric)
+    {
+        assert(!_is_working);
+
+        QString name;
+        for (auto s : _signals)
+        {
+            if (s->get_type() == SR_CHANNEL_LOGIC && s->get_index() == channel)
+                name = s->get_name();
+        }
+        if (name.isEmpty())
+            return NULL;
+
+        auto trace = new view::TrendTrace(name, channel, (data::EdgeTrend::Metric)metric);
+        _trend_traces.push_back(trace);
+
+        data::LogicSnapshot *snapshot = _logic_data->snapshot();
+        if (!snapshot->empty())
+            trace->update(snapshot, _cur_snap_samplerate, [this]{ data_updated(); });
+
+        signals_changed();
+        return trace;
+    }
+
+    void SigSession::remove_trend(view::TrendTrace *trace)
+    {
+        auto it = std::find(_trend_traces.begin(), _trend_traces.end(), trace);
+        if (it == _trend_traces.end())
+            return;
+
+        delete trace;
+        _trend_traces.erase(it);
+
+        signals_changed();
+        data_updated();
+    }
+
     void SigSession::del_group()
     {
         auto i = _group_traces.begin();
@@ -779,6 +1181,7 @@ namespace pv
 
         // Make the logic probe list
         RELEASE_ARRAY(_group_traces);
+        RELEASE_ARRAY(_trend_traces);
 
         std::vector<view::GroupSignal *>().swap(_group_traces);
 
@@ -808,6 +1211,7 @@ namespace pv
             if (signal != NULL)
                 sigs.push_back(signal);
         }
+        append_virtual_signals(sigs);
 
         RELEASE_ARRAY(_signals);
         std::vector<view::Signal *>().swap(_signals);
@@ -815,6 +1219,7 @@ namespace pv
 
         spectrum_rebuild();
         lissajous_disable();
+        eye_disable();
         math_disable();
     }
 
@@ -888,6 +1293,7 @@ namespace pv
             if (signal != NULL)
                 sigs.push_back(signal);
         }
+        append_virtual_signals(sigs);
 
         if (!sigs.empty())
         {
@@ -960,6 +1366,7 @@ namespace pv
     {
         (void)sdi;
         _trigger_pos = 0;
+        _stream_server.begin_capture(_device_agent.get_sample_rate());
         _callback->receive_header();
     }
 
@@ -1081,6 +1488,9 @@ namespace pv
 
             // first payload
             _dso_data->snapshot()->first_payload(dso, _device_agent.get_sample_limit(), sig_enable, _is_instant);
+
+            if (_eye_trace)
+                _eye_trace->frame_begin();
         }
         else
         {
@@ -1088,6 +1498,18 @@ namespace pv
             _dso_data->snapshot()->append_payload(dso);
         }
 
+        if (dso.num_samples != 0 && _stream_server.is_running())
+        {
+            auto snapshot = _dso_data->snapshot();
+            uint64_t samples = dso.num_samples;
+            uint64_t start = 0;
+            if (_is_instant){
+                samples = std::min(samples, snapshot->get_sample_count());
+                start = snapshot->get_sample_count() - samples;
+            }
+            _stream_server.publish_dso(snapshot->get_channel_num(), start, samples, dso.data);
+        }
+
         for (auto &s : _signals)
         {
             view::DsoSignal *dsoSig = NULL;
@@ -1108,21 +1530,41 @@ namespace pv
             return;
         }
 
-        // calculate related spectrum results
+        // calculate related spectrum and math results, they are independent
+        // of each other and run side by side before the frame is shown
+        std::vector<TaskPtr> calc_tasks;
+        TaskScheduler &scheduler = TaskScheduler::Instance();
+
         for (auto &m : _spectrum_traces)
         {
             assert(m);
-            if (m->enabled())
-                m->get_spectrum_stack()->calc_fft();
+            if (m->enabled()) {
+                data::SpectrumStack *spectrum = m->get_spectrum_stack();
+                calc_tasks.push_back(scheduler.submit(TaskScheduler::TaskRender,
+                    [spectrum](Task &){ spectrum->calc_fft(); }));
+            }
         }
 
-        // calculate related math results
         if (_math_trace && _math_trace->enabled())
         {
-            _math_trace->get_math_stack()->realloc(_device_agent.get_sample_limit());
-            _math_trace->get_math_stack()->calc_math();
+            data::MathStack *math = _math_trace->get_math_stack();
+            math->realloc(_device_agent.get_sample_limit());
+            calc_tasks.push_back(scheduler.submit(TaskScheduler::TaskRender,
+                [math](Task &){ math->calc_math(); }));
         }
 
+        if (_eye_trace && _eye_trace->enabled())
+        {
+            view::EyeTrace *eye = _eye_trace;
+            data::DsoSnapshot *snapshot = _dso_data->snapshot();
+            const double samplerate = _cur_snap_samplerate;
+            calc_tasks.push_back(scheduler.submit(TaskScheduler::TaskRender,
+                [eye, snapshot, samplerate](Task &){ eye->fold(snapshot, samplerate); }));
+        }
+
+        for (auto &task : calc_tasks)
+            task->wait();
+
         _trigger_flag = dso.trig_flag;
         _trigger_ch = dso.trig_ch;
 
@@ -1166,6 +1608,9 @@ namespace pv
             _analog_data->snapshot()->append_payload(analog);
         }
 
+        if (_eye_trace && _eye_trace->enabled())
+            _eye_trace->fold(analog, _analog_data->snapshot(), _cur_snap_samplerate);
+
         if (_analog_data->snapshot()->memory_failed())
         {
             _error = Malloc_err;
@@ -1253,6 +1698,13 @@ namespace pv
             _dso_data->snapshot()->capture_ended();
             _analog_data->snapshot()->capture_ended();
 
+            if (!_logic_data->snapshot()->empty())
+            {
+                for (auto &t : _trend_traces)
+                    t->update(_logic_data->snapshot(), _cur_snap_samplerate, [this]{ data_updated(); });
+            }
+            _stream_server.end_capture();
+
             for (auto trace : _decode_traces)
             {
                 trace->decoder()->frame_ended();
@@ -1535,13 +1987,35 @@ namespace pv
             _lissajous_trace->set_enable(false);
     }
 
+    void SigSession::eye_rebuild(bool enable, int index, double period)
+    {
+        ds_lock_guard lock(_data_mutex);
+
+        DESTROY_OBJECT(_eye_trace);
+        _eye_trace = new view::EyeTrace(enable, index, period);
+
+        // the current frame is folded right away
+        if (enable && _dso_data && !_dso_data->snapshot()->empty())
+            _eye_trace->fold(_dso_data->snapshot(), _cur_snap_samplerate);
+        signals_changed();
+    }
+
+    void SigSession::eye_disable()
+    {
+        if (_eye_trace)
+            _eye_trace->set_enable(false);
+    }
+
     void SigSession::math_rebuild(bool enable, view::DsoSignal *dsoSig1,
                                   view::DsoSignal *dsoSig2,
-                                  data::MathStack::MathType type)
+                                  data::MathStack::MathType type,
+                                  const data::MathFilter::Params &filter)
     {
         ds_lock_guard lock(_data_mutex);
 
         auto math_stack = new data::MathStack(this, dsoSig1, dsoSig2, type);
+        if (math_stack->is_filter())
+            math_stack->set_filter(filter);
         DESTROY_OBJECT(_math_trace);
         _math_trace = new view::MathTrace(enable, math_stack, dsoSig1, dsoSig2);
 
@@ -1634,8 +2108,12 @@ namespace pv
         // Stop decode thread.
         clear_all_decoder(false);
 
+        RELEASE_ARRAY(_trend_traces);
+
         stop_capture();
 
+        _stream_server.stop();
+
         // TODO: This should not be necessary
         _session = NULL;
     }
@@ -1648,10 +2126,11 @@ namespace pv
 
         if (!_is_decoding)
         {
-            if (_decode_thread.joinable())
-                _decode_thread.join();
+            if (_decode_task)
+                _decode_task->wait();
 
-            _decode_thread = std::thread(&SigSession::decode_task_proc, this);
+            _decode_task = TaskScheduler::Instance().submit(TaskScheduler::TaskDecode,
+                [this](Task &){ decode_task_proc(); });
             _is_decoding = true;
         }
     }
@@ -1731,9 +2210,9 @@ namespace pv
             dex++;
         }
 
-        // Wait the thread end.
-        if (_decode_thread.joinable())
-            _decode_thread.join();
+        // Wait the task end.
+        if (_decode_task)
+            _decode_task->wait();
     }
 
     view::DecodeTrace *SigSession::get_decoder_trace(int index)
@@ -1839,6 +2318,13 @@ namespace pv
             break;
 
         case DS_EV_COLLECT_TASK_START:
+            if (_rearm_pending)
+            {
+                _rearm_pending = false;
+                _rearm_latency_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - _rearm_time).count();
+                dsv_detail("Repeat capture re-armed in %lldus.", (long long)_rearm_latency_us);
+            }
             _callback->trigger_message(DSV_MSG_COLLECT_START);
             break;
 
@@ -1864,6 +2350,7 @@ namespace pv
             {
                 _is_working = false;
                 _is_instant = false;
+                data::MemoryBudget::Instance().log_usage("Memory usage");
                 _callback->trigger_message(DSV_MSG_END_COLLECT_WORK);
             }
         }
@@ -1926,7 +2413,7 @@ namespace pv
         if (_is_working)
         {
             _callback->repeat_hold(_repeat_hold_prg);
-            exec_capture();
+            repeat_next_capture();
         }
     }
 
@@ -1953,30 +2440,37 @@ namespace pv
         {
             if (_is_working)
             {
-                if (_repeat_intvl > 0)
+                const int intvl_ms = (int)(_repeat_intvl * 1000 + 0.5);
+
+                if (intvl_ms > 0)
                 {
-                    _repeat_hold_prg = 100;
-                    _repeat_timer.Start(_repeat_intvl * 1000);
-                    int intvl = _repeat_intvl * 1000 / 20;
+                    _repeat_timer.Start(intvl_ms);
 
-                    if (intvl >= 100){
-                        _repeat_wait_prog_step = 5;
-                    }
-                    else if (_repeat_intvl >= 1){
-                        intvl = _repeat_intvl * 1000 / 10;
-                        _repeat_wait_prog_step = 10;
-                    }
-                    else{
-                        intvl = _repeat_intvl * 1000 / 5;
-                        _repeat_wait_prog_step = 20;
-                    }
+                    // no progress bar for the short intervals
+                    if (intvl_ms >= RepeatHoldMinTime)
+                    {
+                        _repeat_hold_prg = 100;
+                        int intvl = intvl_ms / 20;
 
-                    _repeat_wait_prog_timer.Start(intvl);
+                        if (intvl >= 100){
+                            _repeat_wait_prog_step = 5;
+                        }
+                        else if (_repeat_intvl >= 1){
+                            intvl = intvl_ms / 10;
+                            _repeat_wait_prog_step = 10;
+                        }
+                        else{
+                            intvl = intvl_ms / 5;
+                            _repeat_wait_prog_step = 20;
+                        }
+
+                        _repeat_wait_prog_timer.Start(intvl);
+                    }
                 }
                 else
                 {
                     _repeat_hold_prg = 0;
-                    exec_capture();
+                    repeat_next_capture();
                 }
             }
         }
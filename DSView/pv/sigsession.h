@@ -29,6 +29,8 @@
 #include <stdint.h> 
 #include <QString>
 #include <thread>
+#include <atomic>
+#include <chrono>
 #include <QDateTime>
 #include <list>
 
@@ -39,6 +41,8 @@
 #include <libsigrok.h>
 #include "deviceagent.h"
 #include "eventobject.h"
+#include "streamserver.h"
+#include "taskscheduler.h"
  
 
 struct srd_decoder;
@@ -62,6 +66,7 @@ class Group;
 class GroupSnapshot;
 class DecoderModel;
 class MathStack;
+class VirtualChannel;
 
 namespace decode {
     class Decoder;
@@ -79,7 +84,9 @@ class GroupSignal;
 class DecodeTrace;
 class SpectrumTrace;
 class LissajousTrace;
+class EyeTrace;
 class MathTrace;
+class TrendTrace;
 }
 
 using namespace pv::data;
@@ -93,6 +100,7 @@ private:
     static constexpr float Oversampling = 2.0f;
     static const int RefreshTime = 500;
     static const int RepeatHoldDiv = 20;
+    static const int RepeatHoldMinTime = 100; // ms
 
 public:
     static const int FeedInterval = 50;
@@ -127,6 +135,10 @@ public:
         return &_device_agent;
     }
 
+    inline StreamServer* get_stream_server(){
+        return &_stream_server;
+    }
+
     bool init();
     void uninit();
     void Open();
@@ -173,6 +185,13 @@ public:
 	std::vector<view::Signal*>& get_signals();
     std::vector<view::GroupSignal*>& get_group_signals();
 
+    // logic channels computed from the captured ones, see data/virtualchannel.h
+    // index -1 takes the next free index
+    bool add_virtual_channel(const QString &name, const QString &expression,
+                             QString &error, int index = -1);
+    void remove_virtual_channel(int index);
+    std::vector<data::VirtualChannel*> get_virtual_channels();
+
     bool add_decoder(srd_decoder *const dec, bool silent, DecoderStatus *dstatus, 
                         std::list<pv::data::decode::Decoder*> &sub_decoders);
     int get_trace_index_by_key_handel(void *handel);
@@ -198,12 +217,25 @@ public:
         return _lissajous_trace;
     }
 
+    inline view::EyeTrace* get_eye_trace(){
+        return _eye_trace;
+    }
+
     inline view::MathTrace* get_math_trace(){
         return _math_trace;
     }
 
     void add_group();
     void del_group();
+
+    // per cycle timing of a logic channel, see data/edgetrend.h
+    view::TrendTrace* add_trend(int channel, int metric);
+    void remove_trend(view::TrendTrace *trace);
+
+    inline std::vector<view::TrendTrace*>& get_trend_traces(){
+        return _trend_traces;
+    }
+
     uint16_t get_ch_num(int type); 
  
     inline bool get_data_lock(){
@@ -217,10 +249,13 @@ public:
     void spectrum_rebuild();
     void lissajous_rebuild(bool enable, int xindex, int yindex, double percent);
     void lissajous_disable();
+    void eye_rebuild(bool enable, int index, double period);
+    void eye_disable();
 
     void math_rebuild(bool enable,pv::view::DsoSignal *dsoSig1,
                       pv::view::DsoSignal *dsoSig2,
-                      data::MathStack::MathType type);
+                      data::MathStack::MathType type,
+                      const data::MathFilter::Params &filter);
 
     void math_disable();
 
@@ -258,6 +293,12 @@ public:
    
     int get_repeat_hold();
 
+    // ms from the end of the repeat interval to the start of the next
+    // capture, negative before the first re-arm
+    inline double get_rearm_latency(){
+        return _rearm_latency_us / 1000.0;
+    }
+
     inline void set_save_start(uint64_t start){
         _save_start = start;
     }
@@ -391,11 +432,13 @@ private:
     view::DecodeTrace* get_top_decode_task();    
 
     void capture_init(); 
+    bool check_memory_budget();
     void nodata_timeout();
     void feed_timeout();
    
     void container_init();
     void init_signals(); 
+    void append_virtual_signals(std::vector<view::Signal*> &sigs);
   
     //IMessageListener
     void OnMessage(int msg);
@@ -434,12 +477,16 @@ private:
 
     void repeat_capture_wait_timeout();
     void repeat_wait_prog_timeout();
+    std::vector<int> get_logic_ch_index();
+    bool can_rearm();
+    bool rearm_capture();
+    void repeat_next_capture();
  
 private:
     mutable std::mutex      _sampling_mutex;
     mutable std::mutex      _data_mutex;
     mutable std::mutex      _decode_task_mutex;  
-    std::thread             _decode_thread;
+    TaskPtr                 _decode_task;
     volatile bool           _is_decoding;   
     uint64_t                _cur_snap_samplerate;
     uint64_t                _cur_samplelimits;
@@ -451,7 +498,9 @@ private:
     pv::data::DecoderModel          *_decoder_model;
     std::vector<view::SpectrumTrace*> _spectrum_traces;
     view::LissajousTrace            *_lissajous_trace;
+    view::EyeTrace                  *_eye_trace;
     view::MathTrace                 *_math_trace;
+    std::vector<view::TrendTrace*>  _trend_traces;
   
 	data::Logic              *_logic_data; 
     data::Dso                *_dso_data; 
@@ -488,6 +537,11 @@ private:
     double      _repeat_intvl; // The progress wait timer interval.
     int         _repeat_hold_prg; // The time sleep progress
     int         _repeat_wait_prog_step;
+    bool        _rearm_ready;
+    std::vector<int> _rearm_channels;
+    bool        _rearm_pending;
+    std::chrono::steady_clock::time_point _rearm_time;
+    std::atomic<int64_t> _rearm_latency_us;
     bool        _is_saving;
     bool        _is_instant;
     int         _device_status;
@@ -499,6 +553,8 @@ private:
     DeviceAgent   _device_agent;
     std::vector<IMessageListener*> _msg_listeners;
     DeviceEventObject   _device_event;
+    StreamServer  _stream_server;
+    std::vector<sr_channel*> _virtual_probes;
    
 private:
 	// TODO: This should not be necessary. Multiple concurrent
@@ -98,8 +98,8 @@ const QString& StoreSession::error()
 
 void StoreSession::wait()
 {
-    if (_thread.joinable())
-        _thread.join();
+    if (_task)
+        _task->wait();
 }
 
 void StoreSession::cancel()
@@ -187,18 +187,36 @@ bool StoreSession::save_start()
     
     if (m_zipDoc.CreateNew(_filename.c_str(), false))
     {    
-        if ( !m_zipDoc.AddFromBuffer("header", meta_data.c_str(), meta_data.size())
-            || !m_zipDoc.AddFromBuffer("decoders", decoder_data.c_str(), decoder_data.size())
-            || !m_zipDoc.AddFromBuffer("session", session_data.c_str(), session_data.size())
-        )
+        bool bAdded = m_zipDoc.AddFromBuffer("header", meta_data.c_str(), meta_data.size())
+            && m_zipDoc.AddFromBuffer("decoders", decoder_data.c_str(), decoder_data.size())
+            && m_zipDoc.AddFromBuffer("session", session_data.c_str(), session_data.size());
+
+        // the decode results, the file can be opened without decoding again
+        if (bAdded && AppConfig::Instance()._appOptions.saveDecodeResults) {
+            int index = 0;
+            for (auto &t : _session->get_decode_signals()) {
+                QByteArray results;
+                char name[32];
+                MakeDecodeResultName(name, index++);
+
+                if (t->decoder()->save_results(results)
+                    && !m_zipDoc.AddFromBuffer(name, results.data(), results.size())) {
+                    bAdded = false;
+                    break;
+                }
+            }
+        }
+
+        if (!bAdded)
         {
             _has_error = true;
             _error = m_zipDoc.GetError();
         }
         else
         {
-            if (_thread.joinable()) _thread.join();
-            _thread = std::thread(&StoreSession::save_proc, this, snapshot);
+            wait();
+            _task = TaskScheduler::Instance().submit(TaskScheduler::TaskExport,
+                [this, snapshot](Task &){ save_proc(snapshot); });
             return !_has_error;
         }
     }
@@ -225,7 +243,8 @@ void StoreSession::save_proc(data::Snapshot *snapshot)
     if ((logic_snapshot = dynamic_cast<data::LogicSnapshot*>(snapshot))) {
         uint16_t to_save_probes = 0;
         for(auto &s : _session->get_signals()) {
-            if (s->enabled() && logic_snapshot->has_data(s->get_index()))
+            if (s->enabled() && logic_snapshot->has_data(s->get_index())
+                && !logic_snapshot->is_virtual_index(s->get_index()))
                 to_save_probes++;
         }
         _unit_count = logic_snapshot->get_sample_count() / 8 * to_save_probes;
@@ -236,7 +255,9 @@ void StoreSession::save_proc(data::Snapshot *snapshot)
             int ch_type = s->get_type();
             if (ch_type == SR_CHANNEL_LOGIC) {
                 int ch_index = s->get_index();
-                if (!s->enabled() || !logic_snapshot->has_data(ch_index))
+                // virtual channels are computed again when the file is loaded
+                if (!s->enabled() || !logic_snapshot->has_data(ch_index)
+                    || logic_snapshot->is_virtual_index(ch_index))
                     continue;
                 for (int i = 0; !_canceled && i < num; i++) {
                     uint8_t *buf = logic_snapshot->get_block_buf(i, ch_index, sample);
@@ -632,8 +653,9 @@ bool StoreSession::export_start()
     }
     else
     {
-        if (_thread.joinable()) _thread.join();
-        _thread = std::thread(&StoreSession::export_proc, this, snapshot);
+        wait();
+        _task = TaskScheduler::Instance().submit(TaskScheduler::TaskExport,
+            [this, snapshot](Task &){ export_proc(snapshot); });
         return !_has_error;
     }
 
@@ -761,7 +783,9 @@ void StoreSession::export_proc(data::Snapshot *snapshot)
                 int ch_type = s->get_type();
                 if (ch_type == SR_CHANNEL_LOGIC) {
                     int ch_index = s->get_index();
-                    if (!logic_snapshot->has_data(ch_index))
+                    // the output modules take the channels of the device
+                    if (!logic_snapshot->has_data(ch_index)
+                        || logic_snapshot->is_virtual_index(ch_index))
                         continue;
                     uint8_t *buf = logic_snapshot->get_block_buf(blk, ch_index, sample);
                     buf_vec.push_back(buf);
@@ -1363,6 +1387,35 @@ bool StoreSession::IsLogicDataType()
     return false;
 }
 
+void StoreSession::MakeDecodeResultName(char *name, int index)
+{
+    snprintf(name, 32, "decode-%d", index);
+}
+
+void StoreSession::load_decode_results(QString file)
+{
+    if (_session->get_decode_signals().empty())
+        return;
+
+    auto f_name = path::ConvertPath(file);
+    ZipReader rd(f_name.c_str());
+    if (!rd.HaveArchive())
+        return;
+
+    // the decoders are loaded in the order they were saved
+    int index = 0;
+    for (auto &t : _session->get_decode_signals()) {
+        char name[32];
+        MakeDecodeResultName(name, index++);
+
+        auto *data = rd.GetInnterFileData(name);
+        if (data != NULL) {
+            t->decoder()->set_saved_results(QByteArray(data->data(), data->size()));
+            rd.ReleaseInnerFileData(data);
+        }
+    }
+}
+
 void StoreSession::MakeChunkName(char *chunk_name, int chunk_num, int index, int type, int version)
 { 
     chunk_name[0] = 0;
@@ -25,13 +25,13 @@
 
 #include <stdint.h>
 #include <string>
-#include <thread>  
 #include <QObject>
 #include <libsigrok.h> 
 
 #include "interface/icallbacks.h"
 
 #include "ZipMaker.h"
+#include "taskscheduler.h"
 
 namespace pv {
 
@@ -81,6 +81,7 @@ private:
 public:    
     bool json_decoders(QJsonArray &array);
     bool load_decoders(dock::ProtocolDock *widget, QJsonArray &dec_array);
+    void load_decode_results(QString file);
     QString MakeSaveFile(bool bDlg);
     QString MakeExportFile(bool bDlg);
 
@@ -94,6 +95,7 @@ private:
     QList<QString> getSuportedExportFormats();
     double get_integer(GVariant * var);
     void MakeChunkName(char *chunk_name, int chunk_num, int index, int type, int version);
+    void MakeDecodeResultName(char *name, int index);
 
 signals:
 	void progress_updated();
@@ -106,7 +108,7 @@ private:
     QString         _suffix;
     SigSession      *_session;
 
-	std::thread   _thread;
+	TaskPtr       _task;
 
     const struct sr_output_module* _outModule;
  
@@ -0,0 +1,234 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "streamserver.h"
+
+#include <string.h>
+#include <stdio.h>
+#include <algorithm>
+
+#include "../../common/dsstream/dsstream.h"
+#include "log.h"
+
+namespace pv {
+
+StreamServer::StreamServer()
+{
+    _writer = NULL;
+    _listen_fd = -1;
+    _stop = false;
+    _have_client = false;
+    _capture = 0;
+    _samplerate = 0;
+}
+
+StreamServer::~StreamServer()
+{
+    stop();
+}
+
+bool StreamServer::start()
+{
+    if (_writer != NULL)
+        return true;
+
+    // a slot holds one block of a logic channel
+    const uint32_t payload_size = data::LogicSnapshot::get_block_samples() / 8;
+    int ret = dsstream_writer_create(&_writer, SlotCount, payload_size);
+    if (ret != DSSTREAM_OK){
+        _writer = NULL;
+        dsv_err("ERROR: failed to create the data stream, error:%d", ret);
+        return false;
+    }
+
+    _listen_fd = dsstream_listen(NULL);
+    if (_listen_fd < 0){
+        dsv_err("ERROR: failed to listen for the data stream readers, error:%d", _listen_fd);
+        _listen_fd = -1;
+        dsstream_writer_destroy(_writer);
+        _writer = NULL;
+        return false;
+    }
+
+    _stop = false;
+    _thread = std::thread(&StreamServer::accept_proc, this);
+
+    char path[108];
+    if (dsstream_default_path(path, sizeof(path)) == DSSTREAM_OK)
+        dsv_info("The data stream is ready at \"%s\".", path);
+    return true;
+}
+
+void StreamServer::stop()
+{
+    if (_writer == NULL)
+        return;
+
+    _stop = true;
+    if (_thread.joinable())
+        _thread.join();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for (int fd : _clients){
+        dsstream_close(fd);
+    }
+    _clients.clear();
+    _have_client = false;
+
+    if (_listen_fd >= 0){
+        dsstream_close(_listen_fd);
+        _listen_fd = -1;
+
+        char path[108];
+        if (dsstream_default_path(path, sizeof(path)) == DSSTREAM_OK)
+            remove(path);
+    }
+
+    dsstream_writer_destroy(_writer);
+    _writer = NULL;
+    dsv_info("The data stream is closed.");
+}
+
+void StreamServer::accept_proc()
+{
+    while (!_stop)
+    {
+        int ret = dsstream_listen_wait(_listen_fd, AcceptTimeout);
+        if (ret < 0){
+            dsv_err("ERROR: the data stream stopped to accept readers, error:%d", ret);
+            break;
+        }
+        if (ret == 0)
+            continue;
+
+        int fd = dsstream_accept(_listen_fd, _writer);
+        if (fd < 0){
+            dsv_info("Failed to accept a data stream reader, error:%d", fd);
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _clients.push_back(fd);
+        _have_client = true;
+        dsv_info("A data stream reader is connected, readers:%d", (int)_clients.size());
+    }
+}
+
+void StreamServer::publish(dsstream_slot &info, const void *data, uint32_t length)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_writer == NULL || _clients.empty())
+        return;
+
+    info.capture = _capture;
+    info.samplerate = _samplerate;
+    uint64_t seq = dsstream_writer_publish(_writer, &info, data, length);
+    if (seq == 0)
+        return;
+
+    for (auto it = _clients.begin(); it != _clients.end();)
+    {
+        if (dsstream_notify(*it, seq) == DSSTREAM_ERR_CLOSED){
+            dsstream_close(*it);
+            it = _clients.erase(it);
+            dsv_info("A data stream reader is disconnected, readers:%d", (int)_clients.size());
+        }
+        else{
+            it++;
+        }
+    }
+    _have_client = !_clients.empty();
+}
+
+void StreamServer::begin_capture(uint64_t samplerate)
+{
+    if (_writer == NULL)
+        return;
+
+    _capture++;
+    _samplerate = samplerate;
+
+    if (!_have_client)
+        return;
+
+    dsstream_slot info;
+    memset(&info, 0, sizeof(info));
+    info.type = DSSTREAM_BEGIN;
+    publish(info, NULL, 0);
+}
+
+void StreamServer::end_capture()
+{
+    if (!_have_client)
+        return;
+
+    dsstream_slot info;
+    memset(&info, 0, sizeof(info));
+    info.type = DSSTREAM_END;
+    publish(info, NULL, 0);
+}
+
+void StreamServer::publish_dso(unsigned int channel_num, uint64_t start,
+                               uint64_t samples, const void *data)
+{
+    if (!_have_client || channel_num == 0 || data == NULL)
+        return;
+
+    // a large frame is written to several slots
+    const uint64_t max_samples = dsstream_writer_payload_size(_writer) / channel_num;
+    const uint8_t *p = (const uint8_t*)data;
+    dsstream_slot info;
+
+    while (samples > 0)
+    {
+        uint64_t n = std::min(samples, max_samples);
+
+        memset(&info, 0, sizeof(info));
+        info.type = DSSTREAM_DSO;
+        info.channel = channel_num;
+        info.start = start;
+        info.samples = n;
+        publish(info, p, (uint32_t)(n * channel_num));
+
+        p += n * channel_num;
+        start += n;
+        samples -= n;
+    }
+}
+
+void StreamServer::OnLogicBlock(int probe_index, uint64_t start_sample,
+                                uint64_t sample_count, const void *data)
+{
+    if (!_have_client || data == NULL)
+        return;
+
+    dsstream_slot info;
+    memset(&info, 0, sizeof(info));
+    info.type = DSSTREAM_LOGIC;
+    info.channel = probe_index;
+    info.start = start_sample;
+    info.samples = sample_count;
+    publish(info, data, (uint32_t)((sample_count + 7) / 8));
+}
+
+} // namespace pv
@@ -0,0 +1,86 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef DSVIEW_PV_STREAMSERVER_H
+#define DSVIEW_PV_STREAMSERVER_H
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "data/logicsnapshot.h"
+
+struct dsstream_writer;
+struct dsstream_slot;
+
+namespace pv {
+
+//Publish the capture data to local programs, see common/dsstream/dsstream.h.
+//It is owned by SigSession, the data is written from the collect thread.
+class StreamServer : public data::ILogicBlockListener
+{
+private:
+    static const uint32_t SlotCount = 32;
+    static const int AcceptTimeout = 200; // ms
+
+public:
+    StreamServer();
+    ~StreamServer();
+
+    bool start();
+    void stop();
+
+    inline bool is_running(){
+        return _writer != NULL;
+    }
+
+    void begin_capture(uint64_t samplerate);
+    void end_capture();
+
+    // interleaved samples of the enabled dso channels
+    void publish_dso(unsigned int channel_num, uint64_t start,
+                     uint64_t samples, const void *data);
+
+    //ILogicBlockListener
+    void OnLogicBlock(int probe_index, uint64_t start_sample,
+                      uint64_t sample_count, const void *data);
+
+private:
+    void accept_proc();
+    void publish(dsstream_slot &info, const void *data, uint32_t length);
+
+private:
+    dsstream_writer     *_writer;
+    int                 _listen_fd;
+    std::thread         _thread;
+    std::atomic<bool>   _stop;
+    std::atomic<bool>   _have_client;
+    std::mutex          _mutex;
+    std::vector<int>    _clients;
+    uint64_t            _capture;
+    uint64_t            _samplerate;
+};
+
+} // namespace pv
+
+#endif // DSVIEW_PV_STREAMSERVER_H
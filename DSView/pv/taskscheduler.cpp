@@ -0,0 +1,295 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "taskscheduler.h"
+
+#include <assert.h>
+#include <algorithm>
+
+#include "log.h"
+
+namespace pv {
+
+Task::Task(int task_class, std::function<void(Task&)> proc, std::function<void()> finished)
+{
+    _class = task_class;
+    _proc = proc;
+    _finished = finished;
+    _canceled = false;
+    _proc_done = false;
+    _complete = false;
+}
+
+void Task::wait()
+{
+    TaskScheduler::Instance().wait_task(this);
+}
+
+//------------TaskScheduler
+
+TaskScheduler::TaskScheduler()
+{
+    const int num = std::max(3, (int)std::thread::hardware_concurrency());
+
+    for (int i = 0; i < TaskClassCount; i++) {
+        _running[i] = 0;
+        _limits[i] = num;
+    }
+    // one decoder stack at a time, the decoders share the python
+    // interpreter, and one file written at a time
+    _limits[TaskDecode] = 1;
+    _limits[TaskExport] = 1;
+    _background_limit = num - 1;
+    _next_queue = 0;
+    _stopped = false;
+
+    _queues.resize(num, std::vector<std::deque<TaskPtr> >(TaskClassCount));
+    start();
+
+    dsv_info("Task scheduler, workers:%d", num);
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    shutdown();
+}
+
+TaskScheduler& TaskScheduler::Instance()
+{
+    static TaskScheduler ins;
+    return ins;
+}
+
+void TaskScheduler::start()
+{
+    const int num = (int)_queues.size();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (int i = 0; i < num; i++)
+        _workers.push_back(std::thread(&TaskScheduler::worker_proc, this, i));
+    for (auto &t : _workers)
+        _worker_ids.push_back(t.get_id());
+}
+
+TaskPtr TaskScheduler::submit(int task_class, std::function<void(Task&)> proc,
+                              std::function<void()> finished)
+{
+    assert(task_class >= 0 && task_class < TaskClassCount);
+
+    TaskPtr task = std::make_shared<Task>(task_class, proc, finished);
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (!_stopped) {
+            int id = current_worker();
+            if (id < 0) {
+                id = _next_queue;
+                _next_queue = (_next_queue + 1) % (int)_queues.size();
+            }
+            _queues[id][task_class].push_back(task);
+            _work_cond.notify_all();
+            return task;
+        }
+    }
+
+    // the workers are gone, the task ends without running
+    dsv_warn("The task scheduler is stopped, drop a %s task", class_name(task_class));
+    task->_canceled = true;
+    task->_proc_done = true;
+    if (task->_finished)
+        task->_finished();
+    task->_complete = true;
+    return task;
+}
+
+void TaskScheduler::set_limit(int task_class, int limit)
+{
+    assert(task_class >= 0 && task_class < TaskClassCount);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _limits[task_class] = std::max(1, limit);
+    _work_cond.notify_all();
+}
+
+int TaskScheduler::get_limit(int task_class)
+{
+    assert(task_class >= 0 && task_class < TaskClassCount);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _limits[task_class];
+}
+
+int TaskScheduler::worker_count()
+{
+    return (int)_queues.size();
+}
+
+void TaskScheduler::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_stopped)
+            return;
+        _stopped = true;
+
+        // the workers drain the queues, the waiting tasks only run
+        // their finished callbacks
+        for (auto &queues : _queues) {
+            for (auto &q : queues) {
+                for (auto &task : q)
+                    task->cancel();
+            }
+        }
+        _work_cond.notify_all();
+    }
+
+    for (auto &t : _workers) {
+        if (t.joinable())
+            t.join();
+    }
+    _workers.clear();
+
+    dsv_info("%s", "Task scheduler stopped");
+}
+
+const char* TaskScheduler::class_name(int task_class)
+{
+    static const char *names[TaskClassCount] = {
+        "ingest", "render", "query", "decode", "export"
+    };
+    if (task_class >= 0 && task_class < TaskClassCount)
+        return names[task_class];
+    return "unknown";
+}
+
+int TaskScheduler::current_worker()
+{
+    const std::thread::id id = std::this_thread::get_id();
+    for (int i = 0; i < (int)_worker_ids.size(); i++) {
+        if (_worker_ids[i] == id)
+            return i;
+    }
+    return -1;
+}
+
+// called with the lock held
+TaskPtr TaskScheduler::take_task(int id)
+{
+    const int num = (int)_queues.size();
+
+    int background = 0;
+    for (int c = TaskDecode; c < TaskClassCount; c++)
+        background += _running[c];
+
+    for (int c = 0; c < TaskClassCount; c++) {
+        if (_running[c] >= _limits[c])
+            continue;
+        if (c >= TaskDecode && background >= _background_limit)
+            continue;
+
+        // the own queue from the front, in the order of submission
+        std::deque<TaskPtr> &own = _queues[id][c];
+        if (!own.empty()) {
+            TaskPtr task = own.front();
+            own.pop_front();
+            return task;
+        }
+
+        // steal the newest task of another worker
+        for (int k = 1; k < num; k++) {
+            std::deque<TaskPtr> &other = _queues[(id + k) % num][c];
+            if (!other.empty()) {
+                TaskPtr task = other.back();
+                other.pop_back();
+                return task;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+// the lock is released while the task runs
+void TaskScheduler::run_task(std::unique_lock<std::mutex> &lock, TaskPtr task)
+{
+    const int c = task->_class;
+    _running[c]++;
+
+    lock.unlock();
+
+    if (!task->_canceled)
+        task->_proc(*task);
+    task->_proc = NULL;
+    task->_proc_done = true;
+
+    if (task->_finished) {
+        task->_finished();
+        task->_finished = NULL;
+    }
+
+    lock.lock();
+
+    _running[c]--;
+    task->_complete = true;
+    _done_cond.notify_all();
+    // a slot of the class is free again
+    _work_cond.notify_all();
+}
+
+void TaskScheduler::worker_proc(int id)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (true)
+    {
+        TaskPtr task = take_task(id);
+        if (task != NULL) {
+            run_task(lock, task);
+            continue;
+        }
+        if (_stopped)
+            break;
+        _work_cond.wait(lock);
+    }
+}
+
+void TaskScheduler::wait_task(Task *task)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    const int id = current_worker();
+
+    while (!task->_complete)
+    {
+        // a waiting worker helps with the queued work, so nested
+        // tasks can not hold up all the workers
+        if (id >= 0) {
+            TaskPtr other = take_task(id);
+            if (other != NULL) {
+                run_task(lock, other);
+                continue;
+            }
+        }
+        _done_cond.wait(lock);
+    }
+}
+
+} // namespace pv
@@ -0,0 +1,145 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef DSVIEW_PV_TASKSCHEDULER_H
+#define DSVIEW_PV_TASKSCHEDULER_H
+
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace pv {
+
+class TaskScheduler;
+
+//A unit of background work. The owner may cancel it, a task which has
+//not started is then dropped, a running one should poll canceled().
+class Task
+{
+    friend class TaskScheduler;
+
+public:
+    Task(int task_class, std::function<void(Task&)> proc, std::function<void()> finished);
+
+    inline int task_class(){
+        return _class;
+    }
+
+    inline void cancel(){
+        _canceled = true;
+    }
+
+    inline bool canceled(){
+        return _canceled;
+    }
+
+    // false once the proc has returned, the finished callback may still run
+    inline bool is_running(){
+        return !_proc_done;
+    }
+
+    // returns after the proc and the finished callback, a worker thread
+    // runs other tasks meanwhile
+    void wait();
+
+private:
+    int _class;
+    std::function<void(Task&)> _proc;
+    std::function<void()> _finished;
+    std::atomic<bool> _canceled;
+    std::atomic<bool> _proc_done;
+    bool _complete;
+};
+
+typedef std::shared_ptr<Task> TaskPtr;
+
+//One pool of worker threads for the background work of the application.
+//Each worker keeps its own queues, tasks submitted by a worker go to its
+//own queue and idle workers steal from the others. The classes are taken
+//in priority order, each one within its own concurrency limit, and the
+//background classes leave a worker free for the interactive ones.
+class TaskScheduler
+{
+    friend class Task;
+
+public:
+    enum TaskClass
+    {
+        TaskIngest = 0, // work on the capture data as it arrives
+        TaskRender,     // data prepared for the next paint
+        TaskQuery,      // searches and measurements waited on by the user
+        TaskDecode,     // protocol decoding
+        TaskExport,     // saving and exporting files
+        TaskClassCount
+    };
+
+private:
+    TaskScheduler();
+    ~TaskScheduler();
+
+public:
+    static TaskScheduler& Instance();
+
+    // the finished callback runs on the worker thread, after the proc
+    // or in place of it if the task was canceled before it started
+    TaskPtr submit(int task_class, std::function<void(Task&)> proc,
+                   std::function<void()> finished = NULL);
+
+    void set_limit(int task_class, int limit);
+    int get_limit(int task_class);
+    int worker_count();
+
+    // cancels the waiting tasks and stops the workers, at exit
+    void shutdown();
+
+    static const char* class_name(int task_class);
+
+private:
+    void start();
+    void worker_proc(int id);
+    TaskPtr take_task(int id);
+    void run_task(std::unique_lock<std::mutex> &lock, TaskPtr task);
+    void wait_task(Task *task);
+    int current_worker();
+
+private:
+    std::mutex _mutex;
+    std::condition_variable _work_cond;
+    std::condition_variable _done_cond;
+    std::vector<std::thread> _workers;
+    std::vector<std::thread::id> _worker_ids;
+    // _queues[worker][class]
+    std::vector<std::vector<std::deque<TaskPtr> > > _queues;
+    int _running[TaskClassCount];
+    int _limits[TaskClassCount];
+    int _background_limit;
+    int _next_queue;
+    bool _stopped;
+};
+
+} // namespace pv
+
+#endif // DSVIEW_PV_TASKSCHEDULER_H
@@ -150,7 +150,7 @@ void FileBar::on_actionOpen_triggered()
         this, 
         L_S(STR_PAGE_DLG, S_ID(IDS_DLG_OPEN_FILE), "Open File"), 
         app._userHistory.openDir,
-        "DSView Data (*.dsl)");
+        "DSView Data (*.dsl);;sigrok Session (*.sr)");
 
     if (!file_name.isEmpty()) { 
         QString fname = path::GetDirectoryName(file_name);
@@ -28,10 +28,13 @@
 #include <QUrl>
 #include <QApplication>
 #include <assert.h>
+#include <limits.h>
 #include <QComboBox>
 #include <QFormLayout>
 #include <QWidget>
 #include <QCheckBox>
+#include <QLabel>
+#include <QSpinBox>
 
 #include "logobar.h"
 #include "../dialogs/about.h"
@@ -41,6 +44,7 @@
 #include "../appcontrol.h"
 #include "../log.h"
 #include "../ui/langresource.h"
+#include "../data/memorybudget.h"
 
 
 namespace pv {
@@ -86,6 +90,7 @@ LogoBar::LogoBar(SigSession *session, QWidget *parent) :
 
     _update = new QAction(this);
     _log = new QAction(this);
+    _memory = new QAction(this);
 
     _menu = new QMenu(this);
     _menu->addMenu(_language);
@@ -94,6 +99,7 @@ LogoBar::LogoBar(SigSession *session, QWidget *parent) :
     _menu->addAction(_issue);
     _menu->addAction(_update);
     _menu->addAction(_log);
+    _menu->addAction(_memory);
     _logo_button.setMenu(_menu);
 
     _logo_button.setToolButtonStyle(Qt::ToolButtonTextUnderIcon);
@@ -116,6 +122,7 @@ LogoBar::LogoBar(SigSession *session, QWidget *parent) :
     connect(_issue, SIGNAL(triggered()), this, SLOT(on_actionIssue_triggered()));
     connect(_update, SIGNAL(triggered()), this, SLOT(on_action_update()));
     connect(_log, SIGNAL(triggered()), this, SLOT(on_action_setting_log()));
+    connect(_memory, SIGNAL(triggered()), this, SLOT(on_action_setting_memory()));
 }
 
 void LogoBar::changeEvent(QEvent *event)
@@ -139,6 +146,7 @@ void LogoBar::retranslateUi()
     _issue->setText(L_S(STR_PAGE_TOOLBAR, S_ID(IDS_LOGOBAR_BUG_REPORT), "&Bug Report"));
     _update->setText(L_S(STR_PAGE_TOOLBAR, S_ID(IDS_LOGOBAR_UPDATE), "&Update"));
     _log->setText(L_S(STR_PAGE_TOOLBAR, S_ID(IDS_LOGOBAR_LOG_OPTIONS), "L&og Options"));
+    _memory->setText(L_S(STR_PAGE_TOOLBAR, S_ID(IDS_LOGOBAR_MEMORY_OPTIONS), "&Memory Options"));
 
     AppConfig &app = AppConfig::Instance(); 
     if (app._frameOptions.language == LAN_CN)
@@ -270,5 +278,65 @@ void LogoBar::on_action_setting_log()
     }  
 }
 
+void LogoBar::on_action_setting_memory()
+{
+    using pv::data::MemoryBudget;
+
+    AppConfig &app = AppConfig::Instance();
+    MemoryBudget &mem = MemoryBudget::Instance();
+    const uint64_t MB = 1024 * 1024;
+    auto *topWind = AppControl::Instance()->GetTopWindow();
+    dialogs::DSDialog dlg(topWind, false, true);
+    dlg.setTitle(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_MEMORY_OPTIONS), "Memory Options"));
+    dlg.setMinimumSize(320, 300);
+    QWidget *panel = new QWidget(&dlg);
+    dlg.layout()->addWidget(panel);
+    QFormLayout *lay = new QFormLayout();
+    panel->setLayout(lay);
+    lay->setVerticalSpacing(10);
+
+    const char *pool_ids[MemoryBudget::PoolCount] = {
+        "IDS_DLG_MEMORY_LOGIC", "IDS_DLG_MEMORY_DSO", "IDS_DLG_MEMORY_ANALOG",
+        "IDS_DLG_MEMORY_ANNOTATION", "IDS_DLG_MEMORY_RESOURCE",
+        "IDS_DLG_MEMORY_REPLAY", "IDS_DLG_MEMORY_SPECTRUM"
+    };
+    const char *pool_texts[MemoryBudget::PoolCount] = {
+        "Logic Data", "Oscilloscope Data", "Analog Data",
+        "Annotations", "Annotation Text", "Decoder Record", "FFT"
+    };
+    QString usage = L_S(STR_PAGE_DLG, S_ID(IDS_DLG_MEMORY_USAGE), "%1MB (peak %2MB)");
+
+    for (int i = 0; i < MemoryBudget::PoolCount; i++) {
+        QLabel *lb = new QLabel(usage.arg(QString::number(mem.used(i) / (double)MB, 'f', 1))
+                                     .arg(QString::number(mem.peak(i) / (double)MB, 'f', 1)));
+        lay->addRow(LangResource::Instance()->get_lang_text(STR_PAGE_DLG, pool_ids[i], pool_texts[i]), lb);
+    }
+    QLabel *total = new QLabel(usage.arg(QString::number(mem.total_used() / (double)MB, 'f', 1))
+                                    .arg(QString::number(mem.total_peak() / (double)MB, 'f', 1)));
+    lay->addRow(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_MEMORY_TOTAL), "Total"), total);
+
+    QSpinBox *budgetBox = new QSpinBox();
+    budgetBox->setRange(0, INT_MAX);
+    budgetBox->setSingleStep(256);
+    budgetBox->setSuffix("MB");
+    budgetBox->setSpecialValueText(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_MEMORY_AUTO), "Automatic"));
+    budgetBox->setValue(app._appOptions.memoryBudget);
+    budgetBox->setToolTip(QString::number(mem.get_physical_memory() / MB) + "MB");
+    lay->addRow(L_S(STR_PAGE_DLG, S_ID(IDS_DLG_MEMORY_BUDGET), "Memory Budget"), budgetBox);
+
+    dlg.exec();
+
+    if (dlg.IsClickYes()){
+        int budget = budgetBox->value();
+
+        if (budget != app._appOptions.memoryBudget){
+            app._appOptions.memoryBudget = budget;
+            app.SaveApp();
+            mem.set_budget((uint64_t)budget * MB);
+            dsv_info("Memory budget:%lluMB", (unsigned long long)(mem.get_budget() / MB));
+        }
+    }
+}
+
 } // namespace toolbars
 } // namespace pv
@@ -71,6 +71,7 @@ private slots:
     void on_actionIssue_triggered();
     void on_action_update();
     void on_action_setting_log();
+    void on_action_setting_memory();
 
 private:
     bool _enable;
@@ -90,6 +91,7 @@ private:
     QAction *_issue;
     QAction *_update;
     QAction *_log;
+    QAction *_memory;
 
     IMainForm *_mainForm;
 };
@@ -741,6 +741,29 @@ namespace pv
             return hori_res;
         }
 
+        // the fastest timebase not below hori_res
+        double SamplingBar::hori_knob_to(double hori_res)
+        {
+            int index = 0;
+
+            for (int i = 0; i < _sample_count.count(); i++)
+            {
+                if (_sample_count.itemData(i).value<double>() < hori_res)
+                    break;
+                index = i;
+            }
+
+            disconnect(&_sample_count, SIGNAL(currentIndexChanged(int)), this, SLOT(on_samplecount_sel(int)));
+
+            _sample_count.setCurrentIndex(index);
+            const double ret = commit_hori_res();
+
+            connect(&_sample_count, SIGNAL(currentIndexChanged(int)),
+                    this, SLOT(on_samplecount_sel(int)));
+
+            return ret;
+        }
+
         double SamplingBar::commit_hori_res()
         {
             const double hori_res = _sample_count.itemData(
@@ -79,6 +79,7 @@ namespace pv
             SamplingBar(SigSession *session, QWidget *parent);         
 
             double hori_knob(int dir);           
+            double hori_knob_to(double hori_res);
             double get_hori_res();          
             void update_device_list();          
             void reload(); 
@@ -28,7 +28,10 @@
 #include "../sigsession.h"
 #include "../dialogs/fftoptions.h"
 #include "../dialogs/lissajousoptions.h"
+#include "../dialogs/eyeoptions.h"
 #include "../dialogs/mathoptions.h"
+#include "../dialogs/virtualchanneldlg.h"
+#include "../dialogs/trenddlg.h"
 #include "../view/trace.h"
 #include "../dialogs/applicationpardlg.h"
 #include "../config/appconfig.h"
@@ -75,6 +78,24 @@ TrigBar::TrigBar(SigSession *session, QWidget *parent) :
 
     _action_lissajous = new QAction(this);
     _action_lissajous->setObjectName(QString::fromUtf8("actionLissajous"));
+
+    _action_eye = new QAction(this);
+    _action_eye->setObjectName(QString::fromUtf8("actionEye"));
+
+    _action_compare = new QAction(this);
+    _action_compare->setObjectName(QString::fromUtf8("actionCompare"));
+
+    _action_script = new QAction(this);
+    _action_script->setObjectName(QString::fromUtf8("actionScript"));
+
+    _action_virtual = new QAction(this);
+    _action_virtual->setObjectName(QString::fromUtf8("actionVirtual"));
+
+    _action_state = new QAction(this);
+    _action_state->setObjectName(QString::fromUtf8("actionState"));
+
+    _action_trend = new QAction(this);
+    _action_trend->setObjectName(QString::fromUtf8("actionTrend"));
    
     _dark_style = new QAction(this);
     _dark_style->setObjectName(QString::fromUtf8("actionDark"));
@@ -93,6 +114,12 @@ TrigBar::TrigBar(SigSession *session, QWidget *parent) :
     _display_menu->setContentsMargins(0,0,0,0);
     
     _display_menu->addAction(_action_lissajous);    
+    _display_menu->addAction(_action_eye);
+    _display_menu->addAction(_action_compare);
+    _display_menu->addAction(_action_script);
+    _display_menu->addAction(_action_virtual);
+    _display_menu->addAction(_action_state);
+    _display_menu->addAction(_action_trend);
     _display_menu->addMenu(_themes);
 	_display_menu->addAction(_action_dispalyOptions);
 
@@ -125,6 +152,12 @@ TrigBar::TrigBar(SigSession *session, QWidget *parent) :
     connect(_action_fft, SIGNAL(triggered()), this, SLOT(on_actionFft_triggered()));
     connect(_action_math, SIGNAL(triggered()), this, SLOT(on_actionMath_triggered()));
     connect(_action_lissajous, SIGNAL(triggered()), this, SLOT(on_actionLissajous_triggered()));
+    connect(_action_eye, SIGNAL(triggered()), this, SLOT(on_actionEye_triggered()));
+    connect(_action_compare, SIGNAL(triggered()), this, SLOT(on_actionCompare_triggered()));
+    connect(_action_script, SIGNAL(triggered()), this, SLOT(on_actionScript_triggered()));
+    connect(_action_virtual, SIGNAL(triggered()), this, SLOT(on_actionVirtual_triggered()));
+    connect(_action_state, SIGNAL(triggered()), this, SLOT(on_actionState_triggered()));
+    connect(_action_trend, SIGNAL(triggered()), this, SLOT(on_actionTrend_triggered()));
     connect(_dark_style, SIGNAL(triggered()), this, SLOT(on_actionDark_triggered()));
     connect(_light_style, SIGNAL(triggered()), this, SLOT(on_actionLight_triggered()));
     connect(_action_dispalyOptions, SIGNAL(triggered()), this, SLOT(on_application_param()));
@@ -150,6 +183,12 @@ void TrigBar::retranslateUi()
     _setting_button.setText(L_S(STR_PAGE_TOOLBAR, S_ID(IDS_TOOLBAR_DISPLAY), "Display"));
  
     _action_lissajous->setText(L_S(STR_PAGE_TOOLBAR, S_ID(IDS_TOOLBAR_LISSAJOUS), "Lissajous"));
+    _action_eye->setText(L_S(STR_PAGE_TOOLBAR, S_ID(IDS_TOOLBAR_EYE), "Eye Diagram"));
+    _action_compare->setText(L_S(STR_PAGE_TOOLBAR, S_ID(IDS_TOOLBAR_COMPARE), "Compare"));
+    _action_script->setText(L_S(STR_PAGE_TOOLBAR, S_ID(IDS_TOOLBAR_SCRIPT), "Script"));
+    _action_virtual->setText(L_S(STR_PAGE_TOOLBAR, S_ID(IDS_TOOLBAR_VIRTUAL_CHANNEL), "Virtual Channels"));
+    _action_state->setText(L_S(STR_PAGE_TOOLBAR, S_ID(IDS_TOOLBAR_STATE), "State Listing"));
+    _action_trend->setText(L_S(STR_PAGE_TOOLBAR, S_ID(IDS_TOOLBAR_TREND), "Trends"));
 
     _themes->setTitle(L_S(STR_PAGE_TOOLBAR, S_ID(IDS_TOOLBAR_THEMES), "Themes"));
     _dark_style->setText(L_S(STR_PAGE_TOOLBAR, S_ID(IDS_TOOLBAR_DARK), "Dark"));
@@ -175,6 +214,12 @@ void TrigBar::reStyle()
     _action_fft->setIcon(QIcon(iconPath+"/fft.svg"));
     _action_math->setIcon(QIcon(iconPath+"/math.svg"));
     _action_lissajous->setIcon(QIcon(iconPath+"/lissajous.svg"));
+    _action_eye->setIcon(QIcon(iconPath+"/shown.svg"));
+    _action_compare->setIcon(QIcon(iconPath+"/file.svg"));
+    _action_script->setIcon(QIcon(iconPath+"/math.svg"));
+    _action_virtual->setIcon(QIcon(iconPath+"/function.svg"));
+    _action_state->setIcon(QIcon(iconPath+"/protocol.svg"));
+    _action_trend->setIcon(QIcon(iconPath+"/measure.svg"));
     _dark_style->setIcon(QIcon(iconPath+"/dark.svg"));
     _light_style->setIcon(QIcon(iconPath+"/light.svg"));
 
@@ -275,6 +320,11 @@ void TrigBar::reload()
         _search_action->setVisible(true);
         _function_action->setVisible(false);
         _action_lissajous->setVisible(false);
+        _action_eye->setVisible(false);
+        _action_compare->setVisible(true);
+        _action_virtual->setVisible(true);
+        _action_state->setVisible(true);
+        _action_trend->setVisible(true);
         _action_dispalyOptions->setVisible(true);
 
     } else if (mode == ANALOG) {
@@ -284,6 +334,11 @@ void TrigBar::reload()
         _search_action->setVisible(false);
         _function_action->setVisible(false);
         _action_lissajous->setVisible(false);
+        _action_eye->setVisible(true);
+        _action_compare->setVisible(false);
+        _action_virtual->setVisible(false);
+        _action_state->setVisible(false);
+        _action_trend->setVisible(false);
         _action_dispalyOptions->setVisible(false);
 
     } else if (mode == DSO) {
@@ -293,6 +348,11 @@ void TrigBar::reload()
         _search_action->setVisible(false);
         _function_action->setVisible(true);
         _action_lissajous->setVisible(true);
+        _action_eye->setVisible(true);
+        _action_compare->setVisible(false);
+        _action_virtual->setVisible(false);
+        _action_state->setVisible(false);
+        _action_trend->setVisible(false);
         _action_dispalyOptions->setVisible(false);
     }
 
@@ -332,6 +392,39 @@ void TrigBar::on_actionLissajous_triggered()
     lissajous_dlg.exec();
 }
 
+void TrigBar::on_actionEye_triggered()
+{
+    pv::dialogs::EyeOptions eye_dlg(_session, this);
+    eye_dlg.exec();
+}
+
+void TrigBar::on_actionCompare_triggered()
+{
+    sig_compare(true);
+}
+
+void TrigBar::on_actionScript_triggered()
+{
+    sig_script(true);
+}
+
+void TrigBar::on_actionVirtual_triggered()
+{
+    pv::dialogs::VirtualChannelDlg virtual_dlg(_session, this);
+    virtual_dlg.exec();
+}
+
+void TrigBar::on_actionState_triggered()
+{
+    sig_state(true);
+}
+
+void TrigBar::on_actionTrend_triggered()
+{
+    pv::dialogs::TrendDlg trend_dlg(_session, this);
+    trend_dlg.exec();
+}
+
  void TrigBar::on_application_param(){
    //  pv::dialogs::MathOptions math_dlg(_session, this);  math_dlg.exec();   return;
     
@@ -63,11 +63,20 @@ signals:
     void sig_measure(bool visible);//post decode button click event,to show or hide measure property panel
     void sig_search(bool visible);
     void sig_show_lissajous(bool visible);
+    void sig_compare(bool visible);
+    void sig_script(bool visible);
+    void sig_state(bool visible);
 
 private slots:
     void on_actionDark_triggered();
     void on_actionLight_triggered();
     void on_actionLissajous_triggered();
+    void on_actionEye_triggered();
+    void on_actionCompare_triggered();
+    void on_actionScript_triggered();
+    void on_actionVirtual_triggered();
+    void on_actionState_triggered();
+    void on_actionTrend_triggered();
 
 public slots:
     void protocol_clicked();
@@ -113,6 +122,12 @@ private:
     QAction     *_dark_style;
     QAction     *_light_style;
     QAction     *_action_lissajous;
+    QAction     *_action_eye;
+    QAction     *_action_compare;
+    QAction     *_action_script;
+    QAction     *_action_virtual;
+    QAction     *_action_state;
+    QAction     *_action_trend;
 };
 
 } // namespace toolbars
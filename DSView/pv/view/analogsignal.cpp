@@ -48,6 +48,7 @@ AnalogSignal::AnalogSignal(data::Analog *data, sr_channel *probe) :
     Signal(probe),
     _data(data),
     _rects(NULL),
+    _show(true),
     _hover_en(false),
     _hover_index(0),
     _hover_point(QPointF(-1, -1)),
@@ -98,6 +99,7 @@ AnalogSignal::AnalogSignal(view::AnalogSignal *s, pv::data::Analog *data, sr_cha
     Signal(*s, probe),
     _data(data),
     _rects(NULL),
+    _show(true),
     _hover_en(false),
     _hover_index(0),
     _hover_point(QPointF(-1, -1)),
@@ -125,6 +127,18 @@ pv::data::SignalData* AnalogSignal::data()
     return _data;
 }
 
+bool AnalogSignal::get_data_state(uint64_t &generation, uint64_t &samples)
+{
+    const auto &snapshots = _data->get_snapshots();
+    if (snapshots.empty())
+        return false;
+
+    const auto snapshot = snapshots.front();
+    generation = snapshot->get_generation();
+    samples = snapshot->get_sample_count();
+    return true;
+}
+
 void AnalogSignal::set_scale(int height)
 {
     _scale = height / (_ref_max - _ref_min);
@@ -439,6 +453,9 @@ void AnalogSignal::paint_back(QPainter &p, int left, int right, QColor fore, QCo
 {
     assert(_view);
 
+    if (!_show)
+        return;
+
     int i, j;
     const double height = get_totalHeight();
     const int DIVS = DS_CONF_DSO_VDIVS;
@@ -493,6 +510,9 @@ void AnalogSignal::paint_mid(QPainter &p, int left, int right, QColor fore, QCol
     assert(_view);
     assert(right >= left);
 
+    if (!_show)
+        return;
+
     const int height = get_totalHeight();
     const float top = get_y() - height * 0.5;
     const float bottom = get_y() + height * 0.5;
@@ -547,6 +567,9 @@ void AnalogSignal::paint_fore(QPainter &p, int left, int right, QColor fore, QCo
 {
     assert(_view);
 
+    if (!_show)
+        return;
+
     fore.setAlpha(View::BackAlpha);
     QPen pen(fore);
     pen.setStyle(Qt::DotLine);
@@ -744,6 +767,16 @@ void AnalogSignal::paint_hover_measure(QPainter &p, QColor fore, QColor back)
     }
 }
 
+void AnalogSignal::set_show(bool show)
+{
+    _show = show;
+}
+
+bool AnalogSignal::show()
+{
+    return _show;
+}
+
 QString AnalogSignal::get_voltage(double v, int p, bool scaled)
 {
     const double mapRange = (get_mapMax() - get_mapMin()) * 1000;
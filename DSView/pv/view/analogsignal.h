@@ -61,6 +61,8 @@ public:
 
     pv::data::SignalData* data();
 
+    bool get_data_state(uint64_t &generation, uint64_t &samples);
+
     void set_scale(int height);
     float get_scale();
     int get_bits();
@@ -76,6 +78,8 @@ public:
     bool get_hover(uint64_t &index, QPointF &p, double &value);
     QPointF get_point(uint64_t index, float &value);
     QString get_voltage(double v, int p, bool scaled = false);
+    void set_show(bool show);
+    bool show();
 
     /**
      * Probe options
@@ -163,6 +167,7 @@ private:
     double _ref_min;
     double _ref_max;
 
+    bool _show;
     bool _hover_en;
     uint64_t _hover_index;
     QPointF _hover_point;
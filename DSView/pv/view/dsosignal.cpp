@@ -52,6 +52,7 @@ const QColor DsoSignal::SignalColours[4] = {
 };
 
 const float DsoSignal::EnvelopeThreshold = 256.0f;
+const double DsoSignal::AutoMargin = 0.1;
 
 DsoSignal::DsoSignal(data::Dso *data,
                      sr_channel *probe):
@@ -65,8 +66,7 @@ DsoSignal::DsoSignal(data::Dso *data,
     _level_valid(false),
     _autoV(false),
     _autoH(false),
-    _autoV_over(false),
-    _auto_cnt(0),
+    _auto_verify(false),
     _hover_en(false),
     _hover_index(0),
     _hover_point(QPointF(-1, -1)),
@@ -119,6 +119,18 @@ pv::data::Dso* DsoSignal::dso_data()
     return _data;
 }
 
+bool DsoSignal::get_data_state(uint64_t &generation, uint64_t &samples)
+{
+    const auto &snapshots = _data->get_snapshots();
+    if (snapshots.empty())
+        return false;
+
+    const auto snapshot = snapshots.front();
+    generation = snapshot->get_generation();
+    samples = snapshot->get_sample_count();
+    return true;
+}
+
 void DsoSignal::set_scale(int height)
 {
     _scale = height / (_ref_max - _ref_min) * session->stop_scale();
@@ -216,33 +228,9 @@ bool DsoSignal::go_vDialPre(bool manul)
         autoV_end(); 
 
     if (enabled() && !_vDial->isMin()) 
-    {
-        if (session->is_running_status())
-            session->refresh(RefreshShort);
+        return set_vDialSel(_vDial->get_sel() - 1);
 
-        const double pre_vdiv = _vDial->get_value();
-        _vDial->set_sel(_vDial->get_sel() - 1);
-
-        session->get_device()->set_config(_probe, NULL, SR_CONF_PROBE_VDIV,
-                              g_variant_new_uint64(_vDial->get_value()));
-
-        if (session->is_stopped_status()) {
-            session->set_stop_scale(session->stop_scale() * (pre_vdiv/_vDial->get_value()));
-            set_scale(get_view_rect().height());
-        }
-        session->get_device()->set_config(_probe, NULL, SR_CONF_PROBE_OFFSET,
-                              g_variant_new_uint16(_zero_offset));
-
-        _view->vDial_updated();
-        _view->set_update(_viewport, true);
-        _view->update();
-        return true;
-    }
-    else {
-        if (_autoV && !_autoV_over)
-            autoV_end();
-        return false;
-    }
+    return false;
 }
 
 bool DsoSignal::go_vDialNext(bool manul)
@@ -251,33 +239,36 @@ bool DsoSignal::go_vDialNext(bool manul)
         autoV_end(); 
 
     if (enabled() && !_vDial->isMax())
-    {
-        if (session->is_running_status())
-            session->refresh(RefreshShort);
+        return set_vDialSel(_vDial->get_sel() + 1);
 
-        const double pre_vdiv = _vDial->get_value();
-        _vDial->set_sel(_vDial->get_sel() + 1);
+    return false;
+}
 
-        session->get_device()->set_config(_probe, NULL, SR_CONF_PROBE_VDIV,
-                              g_variant_new_uint64(_vDial->get_value()));
+bool DsoSignal::set_vDialSel(uint64_t sel)
+{
+    if (!enabled() || sel >= _vDial->get_count())
+        return false;
 
-        if (session->is_stopped_status()) {
-            session->set_stop_scale(session->stop_scale() * (pre_vdiv/_vDial->get_value()));
-            set_scale(get_view_rect().height());
-        }
-        session->get_device()->set_config(_probe, NULL, SR_CONF_PROBE_OFFSET,
-                              g_variant_new_uint16(_zero_offset));
+    if (session->is_running_status())
+        session->refresh(RefreshShort);
 
-        _view->vDial_updated();
-        _view->set_update(_viewport, true);
-        _view->update();
-        return true;
-    } 
-    else {
-        if (_autoV && !_autoV_over)
-            autoV_end();
-        return false;
+    const double pre_vdiv = _vDial->get_value();
+    _vDial->set_sel(sel);
+
+    session->get_device()->set_config(_probe, NULL, SR_CONF_PROBE_VDIV,
+                          g_variant_new_uint64(_vDial->get_value()));
+
+    if (session->is_stopped_status()) {
+        session->set_stop_scale(session->stop_scale() * (pre_vdiv/_vDial->get_value()));
+        set_scale(get_view_rect().height());
     }
+    session->get_device()->set_config(_probe, NULL, SR_CONF_PROBE_OFFSET,
+                          g_variant_new_uint16(_zero_offset));
+
+    _view->vDial_updated();
+    _view->set_update(_viewport, true);
+    _view->update();
+    return true;
 }
 
 bool DsoSignal::load_settings()
@@ -1390,66 +1381,118 @@ void DsoSignal::auto_set()
         if (_autoH)
             autoH_end();
     } 
-    else {
-        if (_autoH && _autoV && get_zero_ratio() != 0.5) {
-            set_zero_ratio(0.5);
+    else if ((_autoV || _autoH) && _mValid && !session->get_data_auto_lock()) {
+        const auto &snapshots = _data->get_snapshots();
+        if (snapshots.empty())
+            return;
+
+        const auto snapshot = const_cast<data::DsoSnapshot*>(snapshots.front());
+        if (snapshot->empty() || !snapshot->has_data(get_index()))
+            return;
+
+        // targets come from this frame, the next one only verifies them
+        data::DsoFrameStats::Result stats;
+        data::DsoFrameStats::calc(snapshot->get_samples(0, 0, get_index()),
+                                  snapshot->get_sample_count(), snapshot->get_channel_num(), stats);
+
+        const bool changed = auto_apply(stats);
+
+        if (changed && !_auto_verify) {
+            _auto_verify = true;
+            session->data_auto_lock(AutoLock);
         }
-        if (_mValid && !session->get_data_auto_lock()) {
-            if (_autoH) {
-                bool roll = false;
-                GVariant *gvar = session->get_device()->get_config(NULL, NULL, SR_CONF_ROLL);
-                if (gvar != NULL) {
-                    roll = g_variant_get_boolean(gvar);
-                    g_variant_unref(gvar);
-                }
-                const double hori_res = _view->get_hori_res();
-                if (_level_valid && ((!roll && _pcount < 3) || _period > 4*hori_res)) {
-                    _view->zoom(-1);
-                } else if (_level_valid && _pcount > 6 && _period < 1.5*hori_res) {
-                    _view->zoom(1);
-                } else if (_level_valid) {
-                    autoH_end();
-                }
-            }
-            if (_autoV) {
-                const bool over_flag = _max == 0xff || _min == 0x0;
-                const bool out_flag = _max >= 0xE0 || _min <= 0x20;
-                const bool under_flag = _max <= 0xA0 && _min >= 0x60;
-                if (over_flag) {
-                    if (!_autoV_over)
-                        _auto_cnt = 0;
-                    _autoV_over = true;
-                    go_vDialNext(false);
-                } else if (out_flag) {
-                    go_vDialNext(false);
-                } else if (!_autoV_over && under_flag) {
-                    go_vDialPre(false);
-                } else if (!_autoH) {
-                    autoV_end();
-                }
+        else {
+            _autoV = false;
+            _autoH = false;
+            _auto_verify = false;
+            _view->set_update(_viewport, true);
+            _view->update();
+        }
+    }
+}
 
-                if (_autoV_over && under_flag) {
-                    if (_auto_cnt++ > 16)
-                        _autoV_over = false;
-                } else {
-                    _auto_cnt = 0;
+bool DsoSignal::auto_apply(const data::DsoFrameStats::Result &stats)
+{
+    bool changed = false;
+
+    if (_autoV) {
+        const uint64_t sel = _vDial->get_sel();
+        const bool clipped = stats.min <= _ref_min || stats.max >= _ref_max;
+
+        if (clipped) {
+            // the swing is unknown, about ten times the range for the next frame
+            if (!_vDial->isMax())
+                changed = set_vDialSel(min(sel + 3, _vDial->get_count() - 1));
+            if (get_zero_ratio() != 0.5) {
+                set_zero_ratio(0.5);
+                changed = true;
+            }
+        }
+        else {
+            // voltages above the zero line in vDial units, codes grow downwards
+            const int hw_offset = get_hw_offset();
+            const double unit = _vDial->get_value() * DS_CONF_DSO_VDIVS / (_ref_max - _ref_min);
+            const double center = (hw_offset - (stats.min + stats.max) / 2.0) * unit;
+            const double half = (stats.max - stats.min) / 2.0 * unit;
+            const double level = (hw_offset - (stats.lower + stats.upper) / 2.0) * unit;
+
+            // the smallest V/div that fits the trace with the zero line
+            // moved to center it
+            uint64_t target = _vDial->get_count() - 1;
+            double zero = 0.5;
+            for (uint64_t i = 0; i < _vDial->get_count(); i++) {
+                const double range = (double)_vDial->get_value(i) * DS_CONF_DSO_VDIVS;
+                zero = min(max(0.5 + center / range, AutoMargin), 1 - AutoMargin);
+                if (zero - (center + half) / range >= AutoMargin &&
+                    zero - (center - half) / range <= 1 - AutoMargin) {
+                    target = i;
+                    break;
                 }
+            }
 
-                if (_level_valid) {
-                    _trig_value = (_min+_max)/2;
-                    set_trig_vpos(ratio2pos(get_trig_vrate()));
-                }
+            if (target != sel)
+                changed = set_vDialSel(target);
+            if (fabs(zero - get_zero_ratio()) > 0.01) {
+                set_zero_ratio(zero);
+                changed = true;
             }
-            if (_autoH || _autoV)
-                session->data_auto_lock(AutoLock);
+
+            const double range = (double)_vDial->get_value() * DS_CONF_DSO_VDIVS;
+            set_trig_ratio(zero - level / range);
         }
     }
+
+    if (_autoH && _data->samplerate() > 0) {
+        bool roll = false;
+        GVariant *gvar = session->get_device()->get_config(NULL, NULL, SR_CONF_ROLL);
+        if (gvar != NULL) {
+            roll = g_variant_get_boolean(gvar);
+            g_variant_unref(gvar);
+        }
+
+        const uint16_t total_channels = g_slist_length(session->get_device()->get_channels());
+        const uint16_t enabled_channels = max((int)_data->get_snapshots().front()->get_channel_num(), 1);
+        const double tfactor = (total_channels / enabled_channels) * SR_GHZ(1) * 1.0 / _data->samplerate();
+        const double hori_res = _view->get_hori_res();
+
+        if (stats.period > 0) {
+            const double period = stats.period * tfactor;
+            if (period < 1.5 * hori_res || period > AutoDivsPerPeriod * hori_res)
+                changed |= _view->set_hori_res(period / AutoDivsPerPeriod);
+        }
+        else if (!roll && stats.upper - stats.lower >= 4) {
+            // edges but not a whole period in the frame
+            changed |= _view->set_hori_res(hori_res * 10);
+        }
+    }
+
+    return changed;
 }
 
 void DsoSignal::autoV_end()
 {
     _autoV = false;
-    _autoV_over = false;
+    _auto_verify = false;
     _view->auto_trig(get_index());
     _trig_value = (_min+_max)/2;
     set_trig_vpos(ratio2pos(get_trig_vrate()));
@@ -1460,6 +1503,7 @@ void DsoSignal::autoV_end()
 void DsoSignal::autoH_end()
 {
     _autoH = false;
+    _auto_verify = false;
     _view->set_update(_viewport, true);
     _view->update();
 }
@@ -25,6 +25,7 @@
 
 #include "signal.h"
 #include "../dstimer.h"
+#include "../data/dsoframestats.h"
   
 namespace pv {
 namespace data {
@@ -62,6 +63,10 @@ private:
     static const int RefreshLong = 800;
     static const int AutoTime = 10000;
     static const int AutoLock = 3;
+    // autoset: the trace spans the screen but AutoMargin at both ends,
+    // a period takes 1.6 to 4 divisions
+    static const double AutoMargin;
+    static const int AutoDivsPerPeriod = 4;
 
     static const int TrigHRng = 2;
 
@@ -93,6 +98,8 @@ public:
     pv::data::SignalData* data();
     pv::data::Dso* dso_data();
 
+    bool get_data_state(uint64_t &generation, uint64_t &samples);
+
     void set_scale(int height);
     float get_scale();
     uint8_t get_bits();
@@ -226,6 +233,8 @@ private:
 
     void paint_hover_measure(QPainter &p, QColor fore, QColor back);
     void auto_set();
+    bool auto_apply(const data::DsoFrameStats::Result &stats);
+    bool set_vDialSel(uint64_t sel);
 
     void call_auto_end();
 
@@ -263,8 +272,7 @@ private:
 
     bool _autoV;
     bool _autoH;
-    bool _autoV_over;
-    uint16_t _auto_cnt;
+    bool _auto_verify;
 
     bool _hover_en;
     uint64_t _hover_index;
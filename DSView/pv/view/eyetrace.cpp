@@ -0,0 +1,302 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+#include <math.h>
+
+#include "view.h"
+#include "../dsvdef.h"
+#include "eyetrace.h"
+#include "dsosignal.h"
+#include "analogsignal.h"
+#include "../data/dsosnapshot.h"
+#include "../data/analogsnapshot.h"
+#include "../sigsession.h"
+
+#include "../ui/langresource.h"
+
+using namespace std;
+
+namespace pv {
+namespace view {
+
+EyeTrace::EyeTrace(bool enable, int index, double period):
+    Trace("Eye", index, SR_CHANNEL_EYE),
+    _enable(enable),
+    _period(period),
+    _folded(0),
+    _image_version(0)
+{
+    _measure.open = false;
+    _measure.height = 0;
+    _measure.level = 0;
+    _measure.width = 0;
+}
+
+EyeTrace::~EyeTrace()
+{
+}
+
+bool EyeTrace::enabled()
+{
+    return _enable;
+}
+
+void EyeTrace::set_enable(bool enable)
+{
+    _enable = enable;
+}
+
+double EyeTrace::period()
+{
+    return _period;
+}
+
+pv::data::EyeDiagram* EyeTrace::get_eye()
+{
+    return &_eye;
+}
+
+void EyeTrace::clear()
+{
+    _eye.clear();
+    _folded = 0;
+}
+
+void EyeTrace::frame_begin()
+{
+    _folded = 0;
+}
+
+void EyeTrace::fold(data::DsoSnapshot *snapshot, double samplerate)
+{
+    assert(snapshot);
+
+    if (!_enable || snapshot->empty() || !snapshot->has_data(get_index()))
+        return;
+
+    const uint64_t count = snapshot->get_sample_count();
+    if (count <= _folded)
+        return;
+
+    // an instant capture keeps the samples without a clock until more
+    // of them arrive
+    const uint8_t *data = snapshot->get_samples(_folded, count - 1, get_index());
+    _eye.set_period(_period * samplerate);
+    if (_eye.fold(data, count - _folded, snapshot->get_channel_num()) ||
+        count - _folded >= MaxPending)
+        _folded = count;
+}
+
+void EyeTrace::fold(const sr_datafeed_analog &analog,
+                    data::AnalogSnapshot *snapshot, double samplerate)
+{
+    assert(snapshot);
+
+    // only the 8 bit samples of an undecimated stream
+    if (!_enable || analog.num_samples == 0 || analog.unit_pitch > 1 ||
+        snapshot->get_unit_bytes() != 1)
+        return;
+
+    const int order = snapshot->get_ch_order(get_index());
+    if (order == -1)
+        return;
+
+    _eye.set_period(_period * samplerate);
+    _eye.fold((const uint8_t *)analog.data + order, analog.num_samples,
+              snapshot->get_channel_num());
+}
+
+int EyeTrace::rows_size()
+{
+    return 0;
+}
+
+void EyeTrace::paint_back(QPainter &p, int left, int right, QColor fore, QColor back)
+{
+    assert(_view);
+
+    fore.setAlpha(view::View::BackAlpha);
+    _border = QRect(left, 0, right - left, _viewport->height()).marginsRemoved(QMargins(10, 10, 10, 10));
+
+    QPen solidPen(fore);
+    solidPen.setStyle(Qt::SolidLine);
+    p.setPen(solidPen);
+    p.setBrush(back.black() > 0x80 ? back.darker() : back.lighter());
+    p.drawRect(_border);
+
+    QPen dashPen(fore);
+    dashPen.setStyle(Qt::DashLine);
+    p.setPen(dashPen);
+
+    const double spanY = _border.height() * 1.0 / DIV_NUM;
+    for (int i = 1; i < DIV_NUM; i++) {
+        const double posY = _border.top() + spanY * i;
+        p.drawLine(_border.left(), posY, _border.right(), posY);
+    }
+    // the crossings and the middle of the eye
+    const double spanX = _border.width() / 4.0;
+    for (int i = 1; i < 4; i++) {
+        const double posX = _border.left() + spanX * i;
+        p.drawLine(posX, _border.top(), posX, _border.bottom());
+    }
+
+    fore.setAlpha(view::View::ForeAlpha);
+    p.setPen(fore);
+    p.drawText(_border.marginsRemoved(QMargins(10, 10, 10, 10)),
+               L_S(STR_PAGE_DLG, S_ID(IDS_DLG_EYE_DIAGRAM), "Eye Diagram"), Qt::AlignTop | Qt::AlignLeft);
+
+    _view->set_back(true);
+}
+
+void EyeTrace::update_image()
+{
+    std::vector<uint32_t> density;
+    uint32_t max = 0;
+    _image_version = _eye.get_version();
+    _eye.get_density(density, max);
+    _measure = _eye.measure();
+
+    // log scaled, from blue for the rare hits to red for the common ones
+    const int cols = data::EyeDiagram::Columns;
+    const int rows = data::EyeDiagram::Rows;
+    const double log_max = log(1.0 + max);
+    _image = QImage(cols, rows, QImage::Format_ARGB32);
+    _image.fill(Qt::transparent);
+
+    for (int r = 0; r < rows; r++) {
+        QRgb *line = (QRgb *)_image.scanLine(r);
+        for (int c = 0; c < cols; c++) {
+            const uint32_t hits = density[r * cols + c];
+            if (hits == 0)
+                continue;
+            const double level = log(1.0 + hits) / log_max;
+            line[c] = QColor::fromHsvF((1 - level) * 2 / 3.0, 1, 1).rgba();
+        }
+    }
+}
+
+void EyeTrace::paint_mid(QPainter &p, int left, int right, QColor fore, QColor back)
+{
+    (void)fore;
+    (void)back;
+    (void)left;
+    (void)right;
+
+    assert(_view);
+
+    if (!enabled())
+        return;
+
+    // the image only changes when more data has been folded
+    const uint64_t version = _eye.get_version();
+    if (version == 0)
+        return;
+    if (version != _image_version || _image.isNull())
+        update_image();
+
+    p.drawImage(_border, _image);
+}
+
+QString EyeTrace::format_voltage(int value)
+{
+    for (auto s : _view->session().get_signals()) {
+        if (s->get_index() != get_index())
+            continue;
+
+        view::DsoSignal *dsoSig = NULL;
+        view::AnalogSignal *analogSig = NULL;
+        if ((dsoSig = dynamic_cast<view::DsoSignal*>(s)))
+            return dsoSig->get_voltage(value, 2);
+        if ((analogSig = dynamic_cast<view::AnalogSignal*>(s)))
+            return analogSig->get_voltage(value, 2);
+    }
+    return QString::number(value);
+}
+
+QString EyeTrace::format_time(double t)
+{
+    static const char *prefixes[] = {"p", "n", "u", "m", ""};
+
+    int prefix = 0;
+    double v = t * 1e12;
+    while (fabs(v) >= 1000 && prefix < (int)countof(prefixes) - 1) {
+        v /= 1000;
+        prefix++;
+    }
+    return QString::number(v, 'f', 2) + prefixes[prefix] + "s";
+}
+
+void EyeTrace::paint_fore(QPainter &p, int left, int right, QColor fore, QColor back)
+{
+    (void)left;
+    (void)right;
+    (void)back;
+
+    assert(_view);
+
+    if (!enabled() || _eye.get_version() == 0)
+        return;
+
+    const double samplerate = _view->session().cur_snap_samplerate();
+    if (samplerate == 0)
+        return;
+
+    const double ui = _eye.get_ui() / samplerate;
+    QString text = L_S(STR_PAGE_DLG, S_ID(IDS_DLG_EYE_UI), "UI") + ": " + format_time(ui) + "\n";
+    if (_measure.open) {
+        text += L_S(STR_PAGE_DLG, S_ID(IDS_DLG_EYE_HEIGHT), "Eye Height") + ": " +
+                format_voltage(_measure.height) + "\n";
+        text += L_S(STR_PAGE_DLG, S_ID(IDS_DLG_EYE_WIDTH), "Eye Width") + ": " +
+                format_time(_measure.width * ui) + " (" +
+                QString::number(_measure.width, 'f', 2) + " UI)\n";
+    } else {
+        text += L_S(STR_PAGE_DLG, S_ID(IDS_DLG_EYE_CLOSED), "Eye closed") + "\n";
+    }
+    text += L_S(STR_PAGE_DLG, S_ID(IDS_DLG_EYE_FOLDED), "Folded") + ": " +
+            QString::number(_eye.get_blocks());
+
+    fore.setAlpha(view::View::ForeAlpha);
+    p.setPen(fore);
+    p.drawText(_border.marginsRemoved(QMargins(10, 10, 10, 10)), text,
+               Qt::AlignBottom | Qt::AlignLeft);
+
+    // the middle level of the opening
+    if (_measure.open) {
+        const double y = _border.top() + _border.height() *
+                         (_measure.level + 0.5) / data::EyeDiagram::Rows;
+        QPen dashPen(fore);
+        dashPen.setStyle(Qt::DotLine);
+        p.setPen(dashPen);
+        p.drawLine(_border.left(), y, _border.right(), y);
+    }
+}
+
+void EyeTrace::paint_label(QPainter &p, int right, const QPoint pt, QColor fore)
+{
+    (void)p;
+    (void)right;
+    (void)pt;
+    (void)fore;
+}
+
+} // namespace view
+} // namespace pv
@@ -0,0 +1,128 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+
+#ifndef DSVIEW_PV_EYETRACE_H
+#define DSVIEW_PV_EYETRACE_H
+
+#include <QImage>
+
+#include "trace.h"
+#include "../data/eyediagram.h"
+
+struct sr_datafeed_analog;
+
+namespace pv {
+
+namespace data {
+class DsoSnapshot;
+class AnalogSnapshot;
+}
+
+namespace view {
+
+//when device is oscilloscope or analog mode, it can use to draw the eye
+//diagram of one channel, created by SigSession
+class EyeTrace : public Trace
+{
+    Q_OBJECT
+
+private:
+    static const int DIV_NUM = 8;
+    // samples of an instant capture left unfolded while no clock is found
+    static const uint64_t MaxPending = SR_Mn(1);
+
+public:
+    EyeTrace(bool enable, int index, double period);
+
+    virtual ~EyeTrace();
+
+    bool enabled();
+    void set_enable(bool enable);
+
+    // seconds, 0 recovers the clock from the data
+    double period();
+
+    pv::data::EyeDiagram* get_eye();
+
+    void clear();
+
+    // the new frame is folded from its start, on top of the old ones
+    void frame_begin();
+
+    // the samples of the snapshot which are not folded yet
+    void fold(pv::data::DsoSnapshot *snapshot, double samplerate);
+
+    // the samples of a packet of the analog stream
+    void fold(const sr_datafeed_analog &analog,
+              pv::data::AnalogSnapshot *snapshot, double samplerate);
+
+    int rows_size();
+
+    /**
+     * Paints the background layer of the trace with a QPainter
+     * @param p the QPainter to paint into.
+     * @param left the x-coordinate of the left edge of the signal
+     * @param right the x-coordinate of the right edge of the signal
+     **/
+    void paint_back(QPainter &p, int left, int right, QColor fore, QColor back);
+
+    /**
+     * Paints the signal with a QPainter
+     * @param p the QPainter to paint into.
+     * @param left the x-coordinate of the left edge of the signal.
+     * @param right the x-coordinate of the right edge of the signal.
+     **/
+    void paint_mid(QPainter &p, int left, int right, QColor fore, QColor back);
+
+    /**
+     * Paints the signal with a QPainter
+     * @param p the QPainter to paint into.
+     * @param left the x-coordinate of the left edge of the signal.
+     * @param right the x-coordinate of the right edge of the signal.
+     **/
+    void paint_fore(QPainter &p, int left, int right, QColor fore, QColor back);
+
+    void paint_label(QPainter &p, int right, const QPoint pt, QColor fore);
+
+private:
+    void update_image();
+    QString format_voltage(int value);
+    static QString format_time(double t);
+
+private:
+    pv::data::EyeDiagram _eye;
+
+    bool _enable;
+    double _period;
+    uint64_t _folded;
+    QRect _border;
+
+    // the density as colours, rebuilt when more data is folded
+    QImage _image;
+    uint64_t _image_version;
+    pv::data::EyeDiagram::Eye _measure;
+};
+
+} // namespace view
+} // namespace pv
+
+#endif // DSVIEW_PV_EYETRACE_H
@@ -78,6 +78,18 @@ pv::data::Logic* LogicSignal::logic_data()
     return _data;
 }
 
+bool LogicSignal::get_data_state(uint64_t &generation, uint64_t &samples)
+{
+    const auto &snapshots = _data->get_snapshots();
+    if (snapshots.empty())
+        return false;
+
+    const auto snapshot = snapshots.front();
+    generation = snapshot->get_generation();
+    samples = snapshot->get_sample_count();
+    return true;
+}
+
 LogicSignal::LogicSetRegions LogicSignal::get_trig()
 {
     return _trig;
@@ -85,7 +97,10 @@ LogicSignal::LogicSetRegions LogicSignal::get_trig()
 
 void LogicSignal::set_trig(int trig)
 {
-    if (trig > NONTRIG && trig <= EDGTRIG)
+    // the hardware does not see the virtual channels
+    if (data::LogicSnapshot::is_virtual_index(get_index()))
+        _trig = NONTRIG;
+    else if (trig > NONTRIG && trig <= EDGTRIG)
         _trig = (LogicSetRegions)trig;
     else
         _trig = NONTRIG;
@@ -93,6 +108,8 @@ void LogicSignal::set_trig(int trig)
 
 bool LogicSignal::commit_trig()
 {
+    if (data::LogicSnapshot::is_virtual_index(get_index()))
+        return false;
 
     if (_trig == NONTRIG) {
         ds_trigger_probe_set(_index_list.front(), 'X', 'X');
@@ -299,24 +316,25 @@ bool LogicSignal::measure(const QPointF &p, uint64_t &index0, uint64_t &index1,
             return false;
 
         const uint64_t end = snapshot->get_sample_count() - 1;
+        const auto ch = snapshot->get_channel(get_index());
         uint64_t index = _data->samplerate() * _view->scale() * (_view->offset() + p.x());
         if (index > end)
             return false;
 
-        bool sample = snapshot->get_sample(index, get_index());
+        bool sample = snapshot->get_sample(index, ch);
         if (index == 0)
             index0 = index;
         else {
             index--;
-            if (snapshot->get_pre_edge(index, sample, 1, get_index()))
+            if (snapshot->get_pre_edge(index, sample, 1, ch))
                 index0 = index;
             else
                 index0 = 0;
         }
 
-        sample = snapshot->get_sample(index, get_index());
+        sample = snapshot->get_sample(index, ch);
         index++;
-        if (snapshot->get_nxt_edge(index, sample, end, 1, get_index()))
+        if (snapshot->get_nxt_edge(index, sample, end, 1, ch))
             index1 = index;
         else {
             if (index0 == 0)
@@ -326,9 +344,9 @@ bool LogicSignal::measure(const QPointF &p, uint64_t &index0, uint64_t &index1,
             return true;
         }
 
-        sample = snapshot->get_sample(index, get_index());
+        sample = snapshot->get_sample(index, ch);
         index++;
-        if (snapshot->get_nxt_edge(index, sample, end, 1, get_index()))
+        if (snapshot->get_nxt_edge(index, sample, end, 1, ch))
             index2 = index;
         else
             index2 = end + 1;
@@ -352,26 +370,27 @@ bool LogicSignal::edge(const QPointF &p, uint64_t &index, int radius)
             return false;
 
         const uint64_t end = snapshot->get_sample_count() - 1;
+        const auto ch = snapshot->get_channel(get_index());
         const
         double pos = _data->samplerate() * _view->scale() * (_view->offset() + p.x());
         index = floor(pos + 0.5);
         if (index > end)
             return false;
 
-        bool sample = snapshot->get_sample(index, get_index());
+        bool sample = snapshot->get_sample(index, ch);
         if (index == 0)
             pre_index = index;
         else {
             index--;
-            if (snapshot->get_pre_edge(index, sample, 1, get_index()))
+            if (snapshot->get_pre_edge(index, sample, 1, ch))
                 pre_index = index;
             else
                 pre_index = 0;
         }
 
-        sample = snapshot->get_sample(index, get_index());
+        sample = snapshot->get_sample(index, ch);
         index++;
-        if (snapshot->get_nxt_edge(index, sample, end, 1, get_index()))
+        if (snapshot->get_nxt_edge(index, sample, end, 1, ch))
             nxt_index = index;
         else
             nxt_index = 0;
@@ -418,22 +437,21 @@ bool LogicSignal::edges(uint64_t end, uint64_t start, uint64_t &rising, uint64_t
     if (end > (sample_count - 1))
         return false;
 
-    const int ch_index = get_index();
-    bool sample = snapshot->get_sample(start, ch_index);
+    const auto ch = snapshot->get_channel(get_index());
+    std::vector<data::LogicSnapshot::EdgePair> edges(EdgeBatchSize);
+    uint64_t cnt;
 
+    // edges in (start, end]
+    index = start + 1;
     rising = 0;
     falling = 0;
     do {
-        if (snapshot->get_nxt_edge(index, sample, sample_count, 1, ch_index)) {
-            if (index > end)
-                break;
-            rising += !sample;
-            falling += sample;
-            sample = !sample;
-        } else {
-            break;
-        }
-    } while(index <= end);
+        cnt = snapshot->get_edges(index, end + 1, ch, edges.data(), EdgeBatchSize);
+        for (uint64_t i = 0; i < cnt; i++)
+            rising += edges[i].second;
+        falling += cnt;
+    } while (cnt == EdgeBatchSize);
+    falling -= rising;
 
     return true;
 }
@@ -51,6 +51,7 @@ private:
     static const int StateRound;
 
     static const int TogMaxScale = 10;
+    static const uint64_t EdgeBatchSize = 4096;
 
 public:
     enum LogicSetRegions{
@@ -75,6 +76,8 @@ public:
 
     pv::data::Logic* logic_data();
 
+    bool get_data_state(uint64_t &generation, uint64_t &samples);
+
     /**
      *
      */
@@ -0,0 +1,247 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "repaintgovernor.h"
+
+#include <assert.h>
+#include <cmath>
+#include <algorithm>
+
+#include "view.h"
+#include "viewport.h"
+#include "trace.h"
+#include "../sigsession.h"
+
+namespace pv {
+namespace view {
+
+RepaintGovernor::RepaintGovernor(View &view) :
+    _view(view),
+    _running(false),
+    _full(true),
+    _scale(0),
+    _offset(0),
+    _cost(0)
+{
+    _frame_timer.setSingleShot(true);
+    QObject::connect(&_frame_timer, &QTimer::timeout, [this]{ flush(); });
+    QObject::connect(&_poll_timer, &QTimer::timeout, [this]{ poll(); });
+}
+
+void RepaintGovernor::add_viewport(Viewport *viewport, int type)
+{
+    assert(viewport);
+
+    Port port;
+    port.viewport = viewport;
+    port.type = type;
+    _ports.push_back(port);
+}
+
+void RepaintGovernor::start()
+{
+    if (_running)
+        return;
+
+    _running = true;
+    invalidate();
+    _poll_timer.start(get_interval());
+}
+
+void RepaintGovernor::stop()
+{
+    _running = false;
+    _poll_timer.stop();
+    _frame_timer.stop();
+    _painted.clear();
+    for (auto &port : _ports)
+        port.dirty = QRegion();
+}
+
+bool RepaintGovernor::running()
+{
+    return _running;
+}
+
+int RepaintGovernor::get_interval()
+{
+    const int interval = (int)std::ceil(_cost * CostShare);
+    if (interval < MinInterval)
+        return MinInterval;
+    if (interval > MaxInterval)
+        return MaxInterval;
+    return interval;
+}
+
+void RepaintGovernor::paint_begin()
+{
+    _paint_clock.start();
+}
+
+void RepaintGovernor::paint_end()
+{
+    if (!_paint_clock.isValid())
+        return;
+
+    // the viewports of one frame are painted one after the other
+    const double cost = _paint_clock.nsecsElapsed() / 1e6;
+    _cost = (_cost == 0) ? cost : _cost * 0.8 + cost * 0.2;
+    _paint_clock.invalidate();
+}
+
+QRect RepaintGovernor::get_trace_rect(Trace *trace)
+{
+    assert(trace);
+
+    // the oscilloscope traces and the ones without rows share the whole view
+    if (trace->get_type() == SR_CHANNEL_DSO || trace->rows_size() == 0)
+        return trace->get_view_rect();
+
+    const int height = trace->get_totalHeight();
+    return QRect(0, trace->get_y() - height / 2 - 1,
+                 _view.get_view_width(), height + 2);
+}
+
+void RepaintGovernor::invalidate()
+{
+    _full = true;
+    _painted.clear();
+    if (_running)
+        schedule();
+}
+
+void RepaintGovernor::collect(Port &port)
+{
+    std::vector<Trace*> traces;
+    _view.get_traces(port.type, traces);
+
+    for (auto t : traces) {
+        if (!t->enabled())
+            continue;
+
+        const QRect area = get_trace_rect(t) & port.viewport->rect();
+        uint64_t generation = 0;
+        uint64_t samples = 0;
+
+        // traces without a counter are repainted with every update
+        if (!t->get_data_state(generation, samples)) {
+            port.dirty += area;
+            continue;
+        }
+
+        auto i = _painted.find(t);
+        if (i == _painted.end()) {
+            PaintedData data = {generation, samples};
+            _painted[t] = data;
+            port.dirty += area;
+            continue;
+        }
+
+        PaintedData &last = i->second;
+        if (generation == last.generation)
+            continue;
+
+        if (samples > last.samples) {
+            // appended samples, from the last one painted on
+            const int64_t x0 = (int64_t)std::floor(_view.index2pixel(last.samples > 0 ? last.samples - 1 : 0)) - 1;
+            const int64_t x1 = (int64_t)std::ceil(_view.index2pixel(samples)) + 1;
+            if (x1 >= area.left() && x0 <= area.right()) {
+                const int left = (int)std::max(x0, (int64_t)area.left());
+                const int right = (int)std::min(x1, (int64_t)area.right());
+                port.dirty += QRect(left, area.top(), right - left + 1, area.height());
+            }
+        } else {
+            port.dirty += area;
+        }
+        last.generation = generation;
+        last.samples = samples;
+    }
+}
+
+void RepaintGovernor::data_updated()
+{
+    // a new scale, offset or size moves every pixel
+    const QSize size(_view.get_view_width(), _view.get_view_height());
+    if (_view.scale() != _scale || _view.offset() != _offset || size != _size) {
+        _scale = _view.scale();
+        _offset = _view.offset();
+        _size = size;
+        _full = true;
+    }
+
+    for (auto &port : _ports) {
+        if (port.viewport->isVisible())
+            collect(port);
+    }
+
+    schedule();
+}
+
+void RepaintGovernor::schedule()
+{
+    bool dirty = _full;
+    for (auto &port : _ports)
+        dirty = dirty || !port.dirty.isEmpty();
+
+    if (!dirty || _frame_timer.isActive())
+        return;
+
+    int wait = 0;
+    if (_frame_clock.isValid())
+        wait = std::max(0, get_interval() - (int)_frame_clock.elapsed());
+    _frame_timer.start(wait);
+}
+
+void RepaintGovernor::flush()
+{
+    _frame_clock.restart();
+
+    if (_full) {
+        _full = false;
+        for (auto &port : _ports)
+            port.dirty = QRegion();
+        _view.set_all_update(true);
+        _view.viewport_update();
+        return;
+    }
+
+    for (auto &port : _ports) {
+        if (port.dirty.isEmpty())
+            continue;
+        // the cached oscilloscope image is rebuilt for any change
+        _view.set_update(port.viewport, true);
+        port.viewport->update(port.dirty);
+        port.dirty = QRegion();
+    }
+}
+
+void RepaintGovernor::poll()
+{
+    // posts data_updated() when new data arrived since the last poll
+    _view.session().check_update();
+
+    const int interval = get_interval();
+    if (_poll_timer.interval() != interval)
+        _poll_timer.start(interval);
+}
+
+} // namespace view
+} // namespace pv
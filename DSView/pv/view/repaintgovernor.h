@@ -0,0 +1,120 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef DSVIEW_PV_VIEW_REPAINTGOVERNOR_H
+#define DSVIEW_PV_VIEW_REPAINTGOVERNOR_H
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+
+#include <QRegion>
+#include <QTimer>
+#include <QElapsedTimer>
+
+namespace pv {
+namespace view {
+
+class View;
+class Viewport;
+class Trace;
+
+//Paces the repaints of the viewports while the session captures. The
+//session is polled for new data once per frame, each trace then compares
+//the generation of its data with the one it painted, and only the rows
+//of the changed traces are repainted, for appended samples only their
+//columns. The frame interval follows the measured paint cost, so the
+//painting takes a fixed share of the GUI thread at most, and nothing is
+//repainted while no visible data changes.
+class RepaintGovernor
+{
+public:
+    static const int MinInterval = 16;      // ms, about 60 frames per second
+    static const int MaxInterval = 250;
+    static const int CostShare = 4;         // a frame may take a quarter of its interval
+
+private:
+    struct PaintedData
+    {
+        uint64_t generation;
+        uint64_t samples;
+    };
+
+    struct Port
+    {
+        Viewport *viewport;
+        int type;
+        QRegion dirty;
+    };
+
+public:
+    RepaintGovernor(View &view);
+
+    void add_viewport(Viewport *viewport, int type);
+
+    void start();
+    void stop();
+    bool running();
+
+    // the traces may have new data
+    void data_updated();
+
+    // the next frame repaints everything
+    void invalidate();
+
+    // around the paint of a viewport
+    void paint_begin();
+    void paint_end();
+
+    // ms between two frames
+    int get_interval();
+
+    // the area a trace paints its data into
+    QRect get_trace_rect(Trace *trace);
+
+private:
+    void collect(Port &port);
+    void schedule();
+    void flush();
+    void poll();
+
+private:
+    View &_view;
+    std::vector<Port> _ports;
+    std::map<Trace*, PaintedData> _painted;
+
+    bool _running;
+    bool _full;
+    double _scale;
+    int64_t _offset;
+    QSize _size;
+
+    QTimer _poll_timer;
+    QTimer _frame_timer;
+    QElapsedTimer _frame_clock;
+    QElapsedTimer _paint_clock;
+    double _cost;           // ms, moving average
+};
+
+} // namespace view
+} // namespace pv
+
+#endif // DSVIEW_PV_VIEW_REPAINTGOVERNOR_H
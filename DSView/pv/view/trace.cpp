@@ -341,6 +341,8 @@ void Trace::paint_label(QPainter &p, int right, const QPoint pt, QColor fore)
             p.drawText(label_rect, Qt::AlignCenter | Qt::AlignVCenter, "F");
         else if (_type == SR_CHANNEL_MATH)
             p.drawText(label_rect, Qt::AlignCenter | Qt::AlignVCenter, "M");
+        else if (_type == SR_CHANNEL_TREND)
+            p.drawText(label_rect, Qt::AlignCenter | Qt::AlignVCenter, "T");
         else
             p.drawText(label_rect, Qt::AlignCenter | Qt::AlignVCenter, QString::number(_index_list.front()));
     }
@@ -405,6 +407,13 @@ QRect Trace::get_view_rect()
     return QRect(0, 0, _view->viewport()->width(), _view->viewport()->height());
 }
 
+bool Trace::get_data_state(uint64_t &generation, uint64_t &samples)
+{
+    (void)generation;
+    (void)samples;
+    return false;
+}
+
 int Trace::get_y()
 {
     return _v_offset;
@@ -229,6 +229,13 @@ public:
 
     virtual QRect get_view_rect();
 
+    /**
+     * Gets the generation and the sample count of the data painted.
+     * @return false when the trace does not track its data, it is then
+     * 	repainted with every update.
+     */
+    virtual bool get_data_state(uint64_t &generation, uint64_t &samples);
+
     virtual bool mouse_double_click(int right, const QPoint pt);
 
     virtual bool mouse_press(int right, const QPoint pt);
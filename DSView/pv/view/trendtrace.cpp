@@ -0,0 +1,278 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include "trendtrace.h"
+
+#include <assert.h>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include "view.h"
+#include "../data/logicsnapshot.h"
+#include "../dsvdef.h"
+#include "../ui/langresource.h"
+
+namespace pv {
+namespace view {
+
+TrendTrace::TrendTrace(QString name, int channel, data::EdgeTrend::Metric metric) :
+    Trace(name, channel, SR_CHANNEL_TREND),
+    _metric(metric),
+    _trend(NULL),
+    _canceled(false)
+{
+    _colour = PROBE_COLORS[channel % countof(PROBE_COLORS)];
+}
+
+TrendTrace::~TrendTrace()
+{
+    cancel();
+    DESTROY_OBJECT(_trend);
+}
+
+bool TrendTrace::enabled()
+{
+    return true;
+}
+
+int TrendTrace::rows_size()
+{
+    return 2;
+}
+
+void TrendTrace::cancel()
+{
+    if (_task != NULL) {
+        _canceled = true;
+        _task->wait();
+        _task = NULL;
+    }
+    _canceled = false;
+}
+
+void TrendTrace::update(data::LogicSnapshot *snapshot, double samplerate,
+                        std::function<void()> done)
+{
+    cancel();
+
+    const int channel = get_channel();
+    _task = TaskScheduler::Instance().submit(TaskScheduler::TaskQuery,
+        [this, snapshot, samplerate, channel, done](Task &){
+            // the old trend stays on screen until the new one is ready
+            data::EdgeTrend *trend = new data::EdgeTrend();
+            if (!trend->extract(snapshot, channel, samplerate, &_canceled) || _canceled) {
+                delete trend;
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                std::swap(_trend, trend);
+            }
+            delete trend;
+            if (done)
+                done();
+        });
+}
+
+void TrendTrace::wait()
+{
+    if (_task != NULL)
+        _task->wait();
+}
+
+void TrendTrace::clear()
+{
+    cancel();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    DESTROY_OBJECT(_trend);
+}
+
+bool TrendTrace::get_summary(data::EdgeTrend::Summary &summary, uint64_t &cycles, bool &truncated)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_trend == NULL || _trend->get_cycle_count() == 0)
+        return false;
+
+    summary = _trend->get_summary(_metric);
+    cycles = _trend->get_cycle_count();
+    truncated = _trend->truncated();
+    return true;
+}
+
+QString TrendTrace::metric_name(int metric)
+{
+    switch (metric)
+    {
+    case data::EdgeTrend::TREND_PERIOD:
+        return L_S(STR_PAGE_DLG, S_ID(IDS_DLG_TREND_PERIOD), "Period");
+    case data::EdgeTrend::TREND_FREQUENCY:
+        return L_S(STR_PAGE_DLG, S_ID(IDS_DLG_TREND_FREQUENCY), "Frequency");
+    case data::EdgeTrend::TREND_DUTY:
+        return L_S(STR_PAGE_DLG, S_ID(IDS_DLG_TREND_DUTY), "Duty");
+    case data::EdgeTrend::TREND_TIE:
+        return L_S(STR_PAGE_DLG, S_ID(IDS_DLG_TREND_TIE), "TIE");
+    }
+    return "";
+}
+
+QString TrendTrace::format_value(int metric, double value)
+{
+    static const char *prefixes[] = {"f", "p", "n", "u", "m", "", "k", "M", "G"};
+
+    if (metric == data::EdgeTrend::TREND_DUTY)
+        return QString::number(value, 'f', 2) + "%";
+
+    const char *unit = (metric == data::EdgeTrend::TREND_FREQUENCY) ? "Hz" : "s";
+    int prefix = 5;
+    double v = value;
+    while (v != 0 && std::fabs(v) < 1 && prefix > 0) {
+        v *= 1000;
+        prefix--;
+    }
+    while (std::fabs(v) >= 1000 && prefix < (int)countof(prefixes) - 1) {
+        v /= 1000;
+        prefix++;
+    }
+    return QString::number(v, 'f', 3) + prefixes[prefix] + unit;
+}
+
+// called with the lock held
+bool TrendTrace::get_scale(double &low, double &high)
+{
+    if (_trend == NULL || _trend->get_cycle_count() == 0)
+        return false;
+
+    const data::EdgeTrend::Summary &s = _trend->get_summary(_metric);
+    low = s.min;
+    high = s.max;
+
+    // a flat trend is drawn in the middle
+    if (high - low <= std::fabs(high) * 1e-9) {
+        double pad = std::fabs(high) * 0.05;
+        if (pad == 0)
+            pad = (_metric == data::EdgeTrend::TREND_TIE) ? 1 / _trend->get_samplerate() : 1;
+        low -= pad;
+        high += pad;
+    }
+    return true;
+}
+
+void TrendTrace::paint_mid(QPainter &p, int left, int right, QColor fore, QColor back)
+{
+    (void)fore;
+    (void)back;
+    assert(_view);
+    assert(right >= left);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    double low, high;
+    if (!get_scale(low, high))
+        return;
+
+    const double samples_per_pixel = _trend->get_samplerate() * _view->scale();
+    const double start = _view->offset() * samples_per_pixel;
+    const double top = get_y() - _totalHeight * 0.5 + Margin;
+    const double bottom = get_y() + _totalHeight * 0.5 - Margin;
+    const double ratio = (bottom - top) / (high - low);
+    const int64_t count = _trend->get_cycle_count();
+
+    // each column spans the cycles which hold its samples, the mipmap
+    // gives their range when there are many
+    std::vector<QLineF> lines;
+    bool connect = false;
+    double last_y = 0;
+
+    for (int x = left; x < right; x++) {
+        const double s0 = start + (x - left) * samples_per_pixel;
+        const double s1 = s0 + samples_per_pixel;
+        if (s1 <= 0)
+            continue;
+
+        int64_t first = _trend->find_cycle((uint64_t)std::max(s0, 0.0));
+        int64_t last = _trend->find_cycle((uint64_t)std::max(std::ceil(s1) - 1, 0.0));
+        if (last < 0 || first >= count) {
+            connect = false;
+            continue;
+        }
+        first = std::max(first, (int64_t)0);
+        last = std::min(last, count - 1);
+
+        double min, max;
+        _trend->get_range(_metric, first, last, min, max);
+
+        const double y0 = bottom - (_trend->get_value(_metric, first) - low) * ratio;
+        if (connect)
+            lines.push_back(QLineF(x - 1, last_y, x, y0));
+        lines.push_back(QLineF(x, bottom - (max - low) * ratio, x, bottom - (min - low) * ratio));
+
+        last_y = bottom - (_trend->get_value(_metric, last) - low) * ratio;
+        connect = true;
+    }
+
+    p.setPen(_colour);
+    p.drawLines(lines.data(), lines.size());
+}
+
+void TrendTrace::paint_fore(QPainter &p, int left, int right, QColor fore, QColor back)
+{
+    (void)right;
+    (void)back;
+    assert(_view);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    double low, high;
+    if (!get_scale(low, high))
+        return;
+
+    // the range of the trend at the top and bottom
+    const int top = get_y() - _totalHeight / 2;
+    const int bottom = get_y() + _totalHeight / 2;
+    const QRect max_rect(left + Margin, top, _view->get_view_width() / 2, _totalHeight / 2);
+    const QRect min_rect(left + Margin, get_y(), _view->get_view_width() / 2, bottom - get_y());
+
+    fore.setAlpha(View::ForeAlpha);
+    p.setPen(fore);
+    p.drawText(max_rect, Qt::AlignLeft | Qt::AlignTop, format_value(_metric, high));
+    p.drawText(min_rect, Qt::AlignLeft | Qt::AlignBottom, format_value(_metric, low));
+}
+
+void TrendTrace::paint_type_options(QPainter &p, int right, const QPoint pt, QColor fore)
+{
+    (void)pt;
+
+    const int y = get_y();
+    const QSizeF name_size(right - get_leftWidth() - get_rightWidth(), SquareWidth);
+    const QRectF metric_rect(get_leftWidth() + name_size.width() + Margin,
+                             y - SquareWidth / 2, SquareWidth * SquareNum, SquareWidth);
+
+    p.setPen(QPen(fore, 1, Qt::DashLine));
+    p.drawLine(metric_rect.bottomLeft(), metric_rect.bottomRight());
+    p.setPen(fore);
+    p.drawText(metric_rect, Qt::AlignRight | Qt::AlignVCenter, metric_name(_metric));
+}
+
+} // namespace view
+} // namespace pv
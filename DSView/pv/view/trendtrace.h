@@ -0,0 +1,100 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef DSVIEW_PV_VIEW_TRENDTRACE_H
+#define DSVIEW_PV_VIEW_TRENDTRACE_H
+
+#include "trace.h"
+#include "../data/edgetrend.h"
+#include "../taskscheduler.h"
+
+#include <mutex>
+#include <functional>
+
+namespace pv {
+
+namespace data {
+class LogicSnapshot;
+}
+
+namespace view {
+
+//One metric of the per cycle timing of a logic channel, drawn as an
+//analog trace, created by SigSession
+class TrendTrace : public Trace
+{
+    Q_OBJECT
+
+public:
+    TrendTrace(QString name, int channel, data::EdgeTrend::Metric metric);
+
+    virtual ~TrendTrace();
+
+    bool enabled();
+
+    int rows_size();
+
+    inline int get_channel(){
+        return _index_list.front();
+    }
+
+    inline data::EdgeTrend::Metric get_metric(){
+        return _metric;
+    }
+
+    // the trend is computed in the background, done is called from the
+    // worker thread when it is ready
+    void update(data::LogicSnapshot *snapshot, double samplerate,
+                std::function<void()> done);
+    void wait();
+    // stops the background work, the last trend stays
+    void cancel();
+    void clear();
+
+    // false until a trend with at least one cycle is ready
+    bool get_summary(data::EdgeTrend::Summary &summary, uint64_t &cycles, bool &truncated);
+
+    static QString metric_name(int metric);
+    static QString format_value(int metric, double value);
+
+    void paint_mid(QPainter &p, int left, int right, QColor fore, QColor back);
+
+    void paint_fore(QPainter &p, int left, int right, QColor fore, QColor back);
+
+protected:
+    void paint_type_options(QPainter &p, int right, const QPoint pt, QColor fore);
+
+private:
+    bool get_scale(double &low, double &high);
+
+private:
+    data::EdgeTrend::Metric _metric;
+
+    std::mutex _mutex;
+    data::EdgeTrend *_trend;
+    TaskPtr _task;
+    std::atomic<bool> _canceled;
+};
+
+} // namespace view
+} // namespace pv
+
+#endif // DSVIEW_PV_VIEW_TRENDTRACE_H
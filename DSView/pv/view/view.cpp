@@ -39,7 +39,10 @@
 #include "viewport.h"
 #include "spectrumtrace.h"
 #include "lissajoustrace.h"
+#include "eyetrace.h"
 #include "analogsignal.h"
+#include "trendtrace.h"
+#include "repaintgovernor.h"
 
 #include "../sigsession.h"
 #include "../data/logic.h"
@@ -113,6 +116,8 @@ View::View(SigSession *session, pv::toolbars::SamplingBar *sampling_bar, QWidget
     _trace_view_map[SR_CHANNEL_FFT] = FFT_VIEW;
     _trace_view_map[SR_CHANNEL_LISSAJOUS] = TIME_VIEW;
     _trace_view_map[SR_CHANNEL_MATH] = TIME_VIEW;
+    _trace_view_map[SR_CHANNEL_TREND] = TIME_VIEW;
+    _trace_view_map[SR_CHANNEL_EYE] = TIME_VIEW;
 
     _active_viewport = NULL;
     _ruler = new Ruler(*this);
@@ -144,6 +149,10 @@ View::View(SigSession *session, pv::toolbars::SamplingBar *sampling_bar, QWidget
     _vsplitter->setCollapsible(1, false);
     _vsplitter->setStretchFactor(1, 1);
 
+    _governor = new RepaintGovernor(*this);
+    _governor->add_viewport(_time_viewport, TIME_VIEW);
+    _governor->add_viewport(_fft_viewport, FFT_VIEW);
+
     _viewcenter = new QWidget(this);
     _viewcenter->setContentsMargins(0,0,0,0);
     QGridLayout* layout = new QGridLayout(_viewcenter);
@@ -195,6 +204,7 @@ View::View(SigSession *session, pv::toolbars::SamplingBar *sampling_bar, QWidget
 View::~View(){
     DESTROY_OBJECT(_trig_cursor);
     DESTROY_OBJECT(_search_cursor);
+    DESTROY_OBJECT(_governor);
 }
 
 void View::show_wait_trigger()
@@ -257,6 +267,8 @@ void View::capture_init()
     status_clear();
     _trig_time_setted = false;
     _trig_hoff = 0;
+
+    _governor->start();
 }
 
 void View::zoom(double steps)
@@ -280,6 +292,20 @@ double View::get_hori_res()
     return _sampling_bar->get_hori_res();
 }
 
+bool View::set_hori_res(double hori_res)
+{
+    if (_device_agent->get_work_mode() != DSO)
+        return false;
+    if (_session->is_running_status() && _session->is_instant())
+        return false;
+
+    if (_sampling_bar->hori_knob_to(hori_res) <= 0)
+        return false;
+
+    timebase_changed();
+    return true;
+}
+
 void View::update_hori_res()
 {
     if (_device_agent->get_work_mode() == DSO) {
@@ -397,11 +423,21 @@ void View::get_traces(int type, std::vector<Trace*> &traces)
             traces.push_back(t);
     }
 
+    for(auto &t : _session->get_trend_traces()) {
+        if (type == ALL_VIEW || _trace_view_map[t->get_type()] == type)
+            traces.push_back(t);
+    }
+
     auto lissajous = _session->get_lissajous_trace();
     if (lissajous && lissajous->enabled() &&
         (type == ALL_VIEW || _trace_view_map[lissajous->get_type()] == type))
         traces.push_back(lissajous);
 
+    auto eye = _session->get_eye_trace();
+    if (eye && eye->enabled() &&
+        (type == ALL_VIEW || _trace_view_map[eye->get_type()] == type))
+        traces.push_back(eye);
+
     auto math = _session->get_math_trace();
     if (math && math->enabled() &&
         (type == ALL_VIEW || _trace_view_map[math->get_type()] == type))
@@ -558,6 +594,11 @@ void View::set_search_pos(uint64_t search_pos, bool hit)
     }
 }
 
+void View::set_search_hit(quint64 index)
+{
+    set_search_pos(index, true);
+}
+
 uint64_t View::get_search_pos()
 {
     return _search_pos;
@@ -647,6 +688,14 @@ void View::update_scroll()
 }
 
 void View::update_scale_offset()
+{
+    update_scale_range();
+
+    _ruler->update();
+    viewport_update();
+}
+
+void View::update_scale_range()
 {
     if (_device_agent->get_work_mode() != DSO) {
         _maxscale = _session->cur_sampletime() / (get_view_width() * MaxViewRate);
@@ -664,9 +713,6 @@ void View::update_scale_offset()
     _preOffset = _offset;
 
     //_trig_cursor->set_index(_session->get_trigger_pos());
-
-    _ruler->update();
-    viewport_update();
 }
 
 void View::mode_changed()
@@ -791,6 +837,9 @@ void View::signals_changed()
         _time_viewport->clear_measure();
     }
 
+    // the traces may have been replaced or moved
+    _governor->invalidate();
+
     header_updated();
     normalize_layout();
     update_scale_offset();
@@ -926,6 +975,23 @@ void View::data_updated()
 	// Update the scroll bars
 	update_scroll();
 
+    // while capturing, only what changed is repainted, at the governor's pace
+    if (_governor->running()) {
+        const double scale = _scale;
+        const int64_t offset = _offset;
+        update_scale_range();
+        if (scale != _scale || offset != _offset)
+            _ruler->update();
+
+        _time_viewport->unshow_wait_trigger();
+        // the progress of a buffered capture covers the whole view
+        if (_device_agent->get_work_mode() == LOGIC && !_session->is_instant())
+            _governor->invalidate();
+        else
+            _governor->data_updated();
+        return;
+    }
+
     // update scale & offset
     update_scale_offset();
 
@@ -1094,6 +1160,10 @@ void View::on_state_changed(bool stop)
     if (stop) {
         _time_viewport->stop_trigger_timer();
         _fft_viewport->stop_trigger_timer();
+        _governor->stop();
+    }
+    else {
+        _governor->start();
     }
     update_scale_offset();
 }
@@ -1209,6 +1279,11 @@ void View::viewport_update()
         viewport->update();
 }
 
+RepaintGovernor* View::governor()
+{
+    return _governor;
+}
+
 void View::splitterMoved(int pos, int index)
 {
     (void)pos;
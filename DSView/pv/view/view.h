@@ -66,6 +66,7 @@ class Ruler;
 class Trace;
 class Viewport;
 class LissajousFigure;
+class RepaintGovernor;
 
 //created by MainWindow
 class View : public QScrollArea {
@@ -221,11 +222,15 @@ public:
     int get_view_height();
 
     double get_hori_res();
+    bool set_hori_res(double hori_res);
 
     QString get_measure(QString option);
 
     void viewport_update();
 
+    // paces the repaints while capturing
+    RepaintGovernor* governor();
+
     void set_capture_status();
 
     bool get_dso_trig_moved();
@@ -266,6 +271,8 @@ private:
 
     void update_margins();
 
+    void update_scale_range();
+
     static bool compare_trace_v_offsets(
         const pv::view::Trace *a,
         const pv::view::Trace *b);
@@ -323,6 +330,8 @@ private slots:
 
    
     void set_trig_pos(int percent);
+    // centers the view on a found position
+    void set_search_hit(quint64 index);
  
     // calibration for oscilloscope
     void show_calibration();
@@ -352,6 +361,7 @@ private:
     Viewport                *_fft_viewport;
     Viewport                *_active_viewport;
     LissajousFigure         *_lissajous;
+    RepaintGovernor         *_governor;
     std::list<QWidget *>    _viewport_list;
     std::map<int, int>      _trace_view_map;
 	Ruler                   *_ruler;
@@ -33,6 +33,7 @@
 #include "../sigsession.h"
 #include "../dialogs/dsomeasure.h"
 #include "decodetrace.h"
+#include "repaintgovernor.h"
 
 #include <QMouseEvent>
 #include <QStyleOption>
@@ -140,16 +141,15 @@ bool Viewport::event(QEvent *event)
 
 void Viewport::paintEvent(QPaintEvent *event)
 {    
-    (void)event;
-
     using pv::view::Signal;
 
+    _view.governor()->paint_begin();
+
     QStyleOption o;
     o.initFrom(this);
     QPainter p(this);
     style()->drawPrimitive(QStyle::PE_Widget, &o, &p, this);
 
-    _view.session().check_update();
     QColor fore(QWidget::palette().color(QWidget::foregroundRole()));
     QColor back(QWidget::palette().color(QWidget::backgroundRole()));
     fore.setAlpha(View::ForeAlpha);
@@ -170,12 +170,12 @@ void Viewport::paintEvent(QPaintEvent *event)
         _view.session().is_instant()) 
     {
         if (_view.session().is_stopped_status()){
-            paintSignals(p, fore, back);
+            paintSignals(p, fore, back, event->rect());
         }
         else if (_view.session().is_running_status()){
             if (_view.session().is_repeat_mode() && !transfer_started) {
                 _view.set_capture_status();
-                paintSignals(p, fore, back);
+                paintSignals(p, fore, back, event->rect());
             }
             else if (_type == TIME_VIEW) {
                 _view.repeat_unshow();
@@ -184,7 +184,7 @@ void Viewport::paintEvent(QPaintEvent *event)
         }     
     }
     else {
-        paintSignals(p, fore, back);
+        paintSignals(p, fore, back, event->rect());
     }
 
     for(auto &t : traces)
@@ -198,9 +198,11 @@ void Viewport::paintEvent(QPaintEvent *event)
             _curSignalHeight = _view.get_signalHeight();
 
 	p.end();
+
+    _view.governor()->paint_end();
 }
 
-void Viewport::paintSignals(QPainter &p, QColor fore, QColor back)
+void Viewport::paintSignals(QPainter &p, QColor fore, QColor back, const QRect &clip)
 { 
     std::vector<Trace*> traces;
     _view.get_traces(_type, traces);
@@ -211,7 +213,8 @@ void Viewport::paintSignals(QPainter &p, QColor fore, QColor back)
         {
             assert(t); 
 
-            if (t->enabled())
+            // the rows outside of a partial repaint are kept
+            if (t->enabled() && _view.governor()->get_trace_rect(t).intersects(clip))
                 t->paint_mid(p, 0, t->get_view_rect().right(), fore, back);
         }
     } 
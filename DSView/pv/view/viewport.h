@@ -122,7 +122,7 @@ private:
     void resizeEvent(QResizeEvent *e) override;
     bool gestureEvent(QNativeGestureEvent *event);
 
-    void paintSignals(QPainter& p, QColor fore, QColor back);
+    void paintSignals(QPainter& p, QColor fore, QColor back, const QRect &clip);
     void paintProgress(QPainter& p, QColor fore, QColor back);
     void paintMeasure(QPainter &p, QColor fore, QColor back);
 
@@ -190,6 +190,11 @@ void ViewStatus::set_capture_status(bool triggered, int progess)
         _capture_status = L_S(STR_PAGE_DLG, S_ID(IDS_DLG_WAITING_FOR_TRIGGER), "Waiting for Trigger! ") + QString::number(progess) 
                         + L_S(STR_PAGE_DLG, S_ID(IDS_DLG_CAPTURED), "% Captured");
     }
+
+    if (_session->is_repeating() && _session->get_rearm_latency() >= 0) {
+        _capture_status += "  " + L_S(STR_PAGE_DLG, S_ID(IDS_DLG_REARM_LATENCY), "Re-arm: %1ms")
+                                  .arg(_session->get_rearm_latency(), 0, 'f', 1);
+    }
 }
 
 void ViewStatus::mousePressEvent(QMouseEvent *event)
@@ -0,0 +1,623 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef _WIN32
+#define _GNU_SOURCE
+#endif
+
+#include "dsstream.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#ifndef _WIN32
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS (MSG_NOSIGNAL | MSG_DONTWAIT)
+#else
+#define SEND_FLAGS MSG_DONTWAIT
+#endif
+
+#define ALIGN_UP(x) (((x) + DSSTREAM_ALIGN - 1) / DSSTREAM_ALIGN * DSSTREAM_ALIGN)
+
+struct dsstream_client {
+	int sock;
+	const uint8_t *base;
+	uint64_t size;
+	const struct dsstream_ring *ring;
+	uint64_t read_seq;
+	uint64_t dropped;
+};
+
+struct dsstream_writer {
+	int fd;
+	int ro_fd;
+	uint8_t *base;
+	uint64_t size;
+	struct dsstream_ring *ring;
+};
+
+static inline struct dsstream_slot* get_slot(const uint8_t *base,
+		const struct dsstream_ring *ring, uint64_t seq)
+{
+	uint64_t index = (seq - 1) % ring->slot_count;
+	return (struct dsstream_slot*)(base + ALIGN_UP(sizeof(struct dsstream_ring))
+			+ index * ring->slot_size);
+}
+
+int dsstream_default_path(char *buf, int size)
+{
+	const char *dir = getenv("XDG_RUNTIME_DIR");
+	int len;
+
+	if (buf == NULL || size <= 0)
+		return DSSTREAM_ERR_ARG;
+
+	if (dir != NULL && dir[0] != 0)
+		len = snprintf(buf, size, "%s/dsview-stream", dir);
+	else
+		len = snprintf(buf, size, "/tmp/dsview-stream-%u", (unsigned int)getuid());
+
+	if (len < 0 || len >= size)
+		return DSSTREAM_ERR_ARG;
+	return DSSTREAM_OK;
+}
+
+static int make_address(struct sockaddr_un *addr, const char *path)
+{
+	char def_path[sizeof(addr->sun_path)];
+
+	if (path == NULL) {
+		if (dsstream_default_path(def_path, sizeof(def_path)) != DSSTREAM_OK)
+			return DSSTREAM_ERR_ARG;
+		path = def_path;
+	}
+	if (strlen(path) >= sizeof(addr->sun_path))
+		return DSSTREAM_ERR_ARG;
+
+	memset(addr, 0, sizeof(*addr));
+	addr->sun_family = AF_UNIX;
+	strcpy(addr->sun_path, path);
+	return DSSTREAM_OK;
+}
+
+/*--------------------- reader ---------------------*/
+
+int dsstream_connect(struct dsstream_client **client, const char *path)
+{
+	struct sockaddr_un addr;
+	struct dsstream_hello hello;
+	struct dsstream_client *c;
+	struct msghdr msg;
+	struct iovec iov;
+	struct cmsghdr *cmsg;
+	char cbuf[CMSG_SPACE(sizeof(int))];
+	int sock, fd = -1;
+	void *base;
+
+	if (client == NULL || make_address(&addr, path) != DSSTREAM_OK)
+		return DSSTREAM_ERR_ARG;
+	*client = NULL;
+
+	sock = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (sock < 0)
+		return DSSTREAM_ERR;
+	if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+		close(sock);
+		return DSSTREAM_ERR_CLOSED;
+	}
+
+	memset(&msg, 0, sizeof(msg));
+	iov.iov_base = &hello;
+	iov.iov_len = sizeof(hello);
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = cbuf;
+	msg.msg_controllen = sizeof(cbuf);
+
+	if (recvmsg(sock, &msg, MSG_WAITALL) != sizeof(hello)) {
+		close(sock);
+		return DSSTREAM_ERR_CLOSED;
+	}
+	for (cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+		if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+			memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+	}
+	if (fd < 0) {
+		close(sock);
+		return DSSTREAM_ERR;
+	}
+	if (hello.magic != DSSTREAM_MAGIC || hello.version != DSSTREAM_VERSION) {
+		close(fd);
+		close(sock);
+		return DSSTREAM_ERR_VERSION;
+	}
+
+	base = mmap(NULL, hello.size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED) {
+		close(sock);
+		return DSSTREAM_ERR;
+	}
+
+	c = (struct dsstream_client*)malloc(sizeof(struct dsstream_client));
+	if (c == NULL) {
+		munmap(base, hello.size);
+		close(sock);
+		return DSSTREAM_ERR;
+	}
+	c->sock = sock;
+	c->base = (const uint8_t*)base;
+	c->size = hello.size;
+	c->ring = (const struct dsstream_ring*)base;
+	c->read_seq = __atomic_load_n(&c->ring->write_seq, __ATOMIC_ACQUIRE);
+	c->dropped = 0;
+
+	*client = c;
+	return DSSTREAM_OK;
+}
+
+void dsstream_disconnect(struct dsstream_client *client)
+{
+	if (client == NULL)
+		return;
+	munmap((void*)client->base, client->size);
+	close(client->sock);
+	free(client);
+}
+
+int dsstream_wait(struct dsstream_client *client, int timeout_ms)
+{
+	struct pollfd pfd;
+	uint64_t buf[64];
+	ssize_t ret;
+
+	if (client == NULL)
+		return DSSTREAM_ERR_ARG;
+
+	for (;;) {
+		if (__atomic_load_n(&client->ring->write_seq, __ATOMIC_ACQUIRE) > client->read_seq)
+			return 1;
+
+		pfd.fd = client->sock;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		ret = poll(&pfd, 1, timeout_ms);
+		if (ret == 0)
+			return 0;
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			return DSSTREAM_ERR;
+		}
+
+		// the notifications only wake up the reader
+		ret = recv(client->sock, buf, sizeof(buf), MSG_DONTWAIT);
+		if (ret == 0)
+			return DSSTREAM_ERR_CLOSED;
+		if (ret < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+			return DSSTREAM_ERR_CLOSED;
+	}
+}
+
+int dsstream_next(struct dsstream_client *client,
+		const struct dsstream_slot **slot, const void **data)
+{
+	const struct dsstream_ring *ring;
+	const struct dsstream_slot *s;
+	uint64_t write_seq, seq;
+
+	if (client == NULL || slot == NULL || data == NULL)
+		return DSSTREAM_ERR_ARG;
+	ring = client->ring;
+
+	for (;;) {
+		write_seq = __atomic_load_n(&ring->write_seq, __ATOMIC_ACQUIRE);
+		if (client->read_seq >= write_seq)
+			return 0;
+
+		seq = client->read_seq + 1;
+		if (write_seq - seq >= ring->slot_count) {
+			// the writer has gone round the ring
+			client->dropped += write_seq - ring->slot_count + 1 - seq;
+			seq = write_seq - ring->slot_count + 1;
+		}
+		client->read_seq = seq;
+
+		s = get_slot(client->base, ring, seq);
+		if (__atomic_load_n(&s->seq, __ATOMIC_ACQUIRE) != seq) {
+			client->dropped++;
+			continue;
+		}
+
+		*slot = s;
+		*data = (const uint8_t*)s + ALIGN_UP(sizeof(struct dsstream_slot));
+		return 1;
+	}
+}
+
+int dsstream_done(struct dsstream_client *client)
+{
+	const struct dsstream_slot *s;
+
+	if (client == NULL || client->read_seq == 0)
+		return 0;
+
+	s = get_slot(client->base, client->ring, client->read_seq);
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	if (__atomic_load_n(&s->seq, __ATOMIC_RELAXED) != client->read_seq) {
+		client->dropped++;
+		return 0;
+	}
+	return 1;
+}
+
+uint64_t dsstream_dropped(struct dsstream_client *client)
+{
+	return client ? client->dropped : 0;
+}
+
+/*--------------------- writer ---------------------*/
+
+int dsstream_writer_create(struct dsstream_writer **writer,
+		uint32_t slot_count, uint32_t payload_size)
+{
+	struct dsstream_writer *w;
+	char name[64];
+	static int serial = 0;
+	uint64_t slot_size;
+	uint64_t size;
+	void *base;
+	int fd, ro_fd;
+
+	if (writer == NULL || slot_count == 0 || payload_size == 0)
+		return DSSTREAM_ERR_ARG;
+	*writer = NULL;
+
+	slot_size = ALIGN_UP(sizeof(struct dsstream_slot)) + ALIGN_UP((uint64_t)payload_size);
+	if (slot_size > UINT32_MAX)
+		return DSSTREAM_ERR_ARG;
+	size = ALIGN_UP(sizeof(struct dsstream_ring)) + slot_size * slot_count;
+
+	// the name is removed at once, the readers get the descriptor
+	snprintf(name, sizeof(name), "/dsview-stream-%d-%d", (int)getpid(), serial++);
+	fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+	if (fd < 0)
+		return DSSTREAM_ERR;
+	ro_fd = shm_open(name, O_RDONLY, 0);
+	shm_unlink(name);
+	if (ro_fd < 0 || ftruncate(fd, size) != 0) {
+		if (ro_fd >= 0)
+			close(ro_fd);
+		close(fd);
+		return DSSTREAM_ERR;
+	}
+
+	base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (base == MAP_FAILED) {
+		close(ro_fd);
+		close(fd);
+		return DSSTREAM_ERR;
+	}
+
+	w = (struct dsstream_writer*)malloc(sizeof(struct dsstream_writer));
+	if (w == NULL) {
+		munmap(base, size);
+		close(ro_fd);
+		close(fd);
+		return DSSTREAM_ERR;
+	}
+	w->fd = fd;
+	w->ro_fd = ro_fd;
+	w->base = (uint8_t*)base;
+	w->size = size;
+	w->ring = (struct dsstream_ring*)base;
+
+	memset(w->ring, 0, sizeof(struct dsstream_ring));
+	w->ring->magic = DSSTREAM_MAGIC;
+	w->ring->version = DSSTREAM_VERSION;
+	w->ring->slot_count = slot_count;
+	w->ring->slot_size = (uint32_t)slot_size;
+	w->ring->size = size;
+
+	*writer = w;
+	return DSSTREAM_OK;
+}
+
+void dsstream_writer_destroy(struct dsstream_writer *writer)
+{
+	if (writer == NULL)
+		return;
+	munmap(writer->base, writer->size);
+	close(writer->ro_fd);
+	close(writer->fd);
+	free(writer);
+}
+
+uint32_t dsstream_writer_payload_size(struct dsstream_writer *writer)
+{
+	if (writer == NULL)
+		return 0;
+	return writer->ring->slot_size - ALIGN_UP(sizeof(struct dsstream_slot));
+}
+
+uint64_t dsstream_writer_publish(struct dsstream_writer *writer,
+		const struct dsstream_slot *info, const void *data, uint32_t length)
+{
+	struct dsstream_ring *ring;
+	struct dsstream_slot *s;
+	uint64_t seq;
+
+	if (writer == NULL || info == NULL || length > dsstream_writer_payload_size(writer))
+		return 0;
+	ring = writer->ring;
+
+	seq = ring->write_seq + 1;
+	s = get_slot(writer->base, ring, seq);
+
+	// the readers see seq 0 until the slot is complete
+	__atomic_store_n(&s->seq, 0, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	s->type = info->type;
+	s->channel = info->channel;
+	s->capture = info->capture;
+	s->start = info->start;
+	s->samples = info->samples;
+	s->samplerate = info->samplerate;
+	s->length = length;
+	s->flags = info->flags;
+	if (length > 0)
+		memcpy((uint8_t*)s + ALIGN_UP(sizeof(struct dsstream_slot)), data, length);
+
+	__atomic_store_n(&s->seq, seq, __ATOMIC_RELEASE);
+	__atomic_store_n(&ring->write_seq, seq, __ATOMIC_RELEASE);
+
+	return seq;
+}
+
+int dsstream_listen(const char *path)
+{
+	struct sockaddr_un addr;
+	int fd;
+
+	if (make_address(&addr, path) != DSSTREAM_OK)
+		return DSSTREAM_ERR_ARG;
+
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+		return DSSTREAM_ERR;
+
+	unlink(addr.sun_path);
+	if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0
+		|| chmod(addr.sun_path, 0600) != 0
+		|| listen(fd, 8) != 0) {
+		close(fd);
+		return DSSTREAM_ERR;
+	}
+	return fd;
+}
+
+int dsstream_listen_wait(int listen_fd, int timeout_ms)
+{
+	struct pollfd pfd;
+	int ret;
+
+	pfd.fd = listen_fd;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+	ret = poll(&pfd, 1, timeout_ms);
+	if (ret < 0)
+		return (errno == EINTR) ? 0 : DSSTREAM_ERR;
+	return (ret > 0 && (pfd.revents & POLLIN)) ? 1 : 0;
+}
+
+int dsstream_accept(int listen_fd, struct dsstream_writer *writer)
+{
+	struct dsstream_hello hello;
+	struct msghdr msg;
+	struct iovec iov;
+	struct cmsghdr *cmsg;
+	char cbuf[CMSG_SPACE(sizeof(int))];
+	int fd;
+
+	if (writer == NULL)
+		return DSSTREAM_ERR_ARG;
+
+	fd = accept(listen_fd, NULL, NULL);
+	if (fd < 0)
+		return DSSTREAM_ERR;
+
+#ifdef SO_NOSIGPIPE
+	{
+		int on = 1;
+		setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+	}
+#endif
+
+	hello.magic = DSSTREAM_MAGIC;
+	hello.version = DSSTREAM_VERSION;
+	hello.size = writer->size;
+
+	memset(&msg, 0, sizeof(msg));
+	memset(cbuf, 0, sizeof(cbuf));
+	iov.iov_base = &hello;
+	iov.iov_len = sizeof(hello);
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = cbuf;
+	msg.msg_controllen = sizeof(cbuf);
+	cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+	memcpy(CMSG_DATA(cmsg), &writer->ro_fd, sizeof(int));
+
+	if (sendmsg(fd, &msg, SEND_FLAGS) != sizeof(hello)) {
+		close(fd);
+		return DSSTREAM_ERR_CLOSED;
+	}
+
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+	return fd;
+}
+
+int dsstream_notify(int client_fd, uint64_t seq)
+{
+	if (send(client_fd, &seq, sizeof(seq), SEND_FLAGS) >= 0)
+		return DSSTREAM_OK;
+	if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+		return DSSTREAM_OK;
+	return DSSTREAM_ERR_CLOSED;
+}
+
+void dsstream_close(int fd)
+{
+	if (fd >= 0)
+		close(fd);
+}
+
+#else
+
+/* shared memory streaming is not available on windows */
+
+int dsstream_default_path(char *buf, int size)
+{
+	(void)buf;
+	(void)size;
+	return DSSTREAM_ERR_UNSUPPORTED;
+}
+
+int dsstream_connect(struct dsstream_client **client, const char *path)
+{
+	(void)path;
+	if (client)
+		*client = NULL;
+	return DSSTREAM_ERR_UNSUPPORTED;
+}
+
+void dsstream_disconnect(struct dsstream_client *client)
+{
+	(void)client;
+}
+
+int dsstream_wait(struct dsstream_client *client, int timeout_ms)
+{
+	(void)client;
+	(void)timeout_ms;
+	return DSSTREAM_ERR_UNSUPPORTED;
+}
+
+int dsstream_next(struct dsstream_client *client,
+		const struct dsstream_slot **slot, const void **data)
+{
+	(void)client;
+	(void)slot;
+	(void)data;
+	return 0;
+}
+
+int dsstream_done(struct dsstream_client *client)
+{
+	(void)client;
+	return 0;
+}
+
+uint64_t dsstream_dropped(struct dsstream_client *client)
+{
+	(void)client;
+	return 0;
+}
+
+int dsstream_writer_create(struct dsstream_writer **writer,
+		uint32_t slot_count, uint32_t payload_size)
+{
+	(void)slot_count;
+	(void)payload_size;
+	if (writer)
+		*writer = NULL;
+	return DSSTREAM_ERR_UNSUPPORTED;
+}
+
+void dsstream_writer_destroy(struct dsstream_writer *writer)
+{
+	(void)writer;
+}
+
+uint32_t dsstream_writer_payload_size(struct dsstream_writer *writer)
+{
+	(void)writer;
+	return 0;
+}
+
+uint64_t dsstream_writer_publish(struct dsstream_writer *writer,
+		const struct dsstream_slot *info, const void *data, uint32_t length)
+{
+	(void)writer;
+	(void)info;
+	(void)data;
+	(void)length;
+	return 0;
+}
+
+int dsstream_listen(const char *path)
+{
+	(void)path;
+	return DSSTREAM_ERR_UNSUPPORTED;
+}
+
+int dsstream_listen_wait(int listen_fd, int timeout_ms)
+{
+	(void)listen_fd;
+	(void)timeout_ms;
+	return DSSTREAM_ERR_UNSUPPORTED;
+}
+
+int dsstream_accept(int listen_fd, struct dsstream_writer *writer)
+{
+	(void)listen_fd;
+	(void)writer;
+	return DSSTREAM_ERR_UNSUPPORTED;
+}
+
+int dsstream_notify(int client_fd, uint64_t seq)
+{
+	(void)client_fd;
+	(void)seq;
+	return DSSTREAM_ERR_UNSUPPORTED;
+}
+
+void dsstream_close(int fd)
+{
+	(void)fd;
+}
+
+#endif
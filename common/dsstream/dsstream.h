@@ -0,0 +1,178 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/*
+*	Live capture data for local programs.
+*
+*	DSView writes the finished blocks of the logic channels and the dso
+*	frames to a ring of slots in shared memory. A program connects to the
+*	unix socket of DSView, receives the shared memory and maps it read only.
+*	The writer never waits for the readers, a slow reader loses the slots
+*	which are written again before it reads them.
+*
+*	example:
+*	struct dsstream_client *c;
+*	const struct dsstream_slot *slot;
+*	const void *data;
+*
+*	dsstream_connect(&c, NULL);
+*	while (dsstream_wait(c, 1000) >= 0) {
+*		while (dsstream_next(c, &slot, &data) == 1) {
+*			... use slot and data in place ...
+*			if (!dsstream_done(c))
+*				... the slot was written again while in use, drop the results ...
+*		}
+*	}
+*	dsstream_disconnect(c);
+*/
+
+#ifndef _DS_STREAM_H_
+#define _DS_STREAM_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DSSTREAM_MAGIC          0x44535354  /* "DSST" */
+#define DSSTREAM_VERSION        1
+#define DSSTREAM_ALIGN          64
+
+/* error codes */
+#define DSSTREAM_OK                 0
+#define DSSTREAM_ERR               -1
+#define DSSTREAM_ERR_ARG           -2
+#define DSSTREAM_ERR_VERSION       -3
+#define DSSTREAM_ERR_CLOSED        -4
+#define DSSTREAM_ERR_UNSUPPORTED   -5
+
+/* slot types */
+enum dsstream_type {
+	/* a block of one logic channel, one bit per sample, bit 0 of
+	   byte 0 is the first sample, channel is the probe index */
+	DSSTREAM_LOGIC = 1,
+	/* a part of a dso frame, one byte per sample, the samples of the
+	   channels are interleaved, channel is the number of channels */
+	DSSTREAM_DSO = 2,
+	/* a capture has been started, no payload */
+	DSSTREAM_BEGIN = 3,
+	/* the capture is finished, no payload */
+	DSSTREAM_END = 4,
+};
+
+/* at the start of the shared memory */
+struct dsstream_ring {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t slot_count;
+	uint32_t slot_size;		/* bytes from one slot to the next */
+	uint64_t size;			/* bytes of the shared memory */
+	uint64_t write_seq;		/* sequence of the last written slot, 0 if none */
+	uint8_t  reserved[32];
+};
+
+/* the slot of sequence n is at index (n - 1) % slot_count,
+   the payload follows the slot header */
+struct dsstream_slot {
+	uint64_t seq;			/* 0 while the slot is written */
+	uint32_t type;
+	uint32_t channel;
+	uint64_t capture;		/* number of the capture */
+	uint64_t start;			/* first sample in the capture buffer */
+	uint64_t samples;
+	uint64_t samplerate;
+	uint32_t length;		/* bytes of the payload */
+	uint32_t flags;
+	uint8_t  reserved[8];
+};
+
+/* sent by the server with the descriptor of the shared memory */
+struct dsstream_hello {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t size;
+};
+
+/* the default socket path */
+int dsstream_default_path(char *buf, int size);
+
+/*--------------------- reader ---------------------*/
+
+struct dsstream_client;
+
+/* path NULL for the default path */
+int dsstream_connect(struct dsstream_client **client, const char *path);
+
+void dsstream_disconnect(struct dsstream_client *client);
+
+/* wait until a new slot is written, returns 1 if there is one,
+   0 on timeout, a negative error code if DSView has gone */
+int dsstream_wait(struct dsstream_client *client, int timeout_ms);
+
+/* the next unread slot, returns 1 if there is one, 0 if not */
+int dsstream_next(struct dsstream_client *client,
+		const struct dsstream_slot **slot, const void **data);
+
+/* check the slot of the last dsstream_next() after using it,
+   returns 0 if it has been written again in the meantime */
+int dsstream_done(struct dsstream_client *client);
+
+/* slots which have been written again before they were read */
+uint64_t dsstream_dropped(struct dsstream_client *client);
+
+/*--------------------- writer ---------------------*/
+
+struct dsstream_writer;
+
+int dsstream_writer_create(struct dsstream_writer **writer,
+		uint32_t slot_count, uint32_t payload_size);
+
+void dsstream_writer_destroy(struct dsstream_writer *writer);
+
+uint32_t dsstream_writer_payload_size(struct dsstream_writer *writer);
+
+/* write a slot, the sequence and the length of info are set here,
+   returns the sequence of the slot, 0 on error */
+uint64_t dsstream_writer_publish(struct dsstream_writer *writer,
+		const struct dsstream_slot *info, const void *data, uint32_t length);
+
+/* the listening socket of the server */
+int dsstream_listen(const char *path);
+
+/* wait for a reader to connect, returns 1 if one is waiting, 0 on timeout */
+int dsstream_listen_wait(int listen_fd, int timeout_ms);
+
+/* accept a reader and give it the shared memory,
+   returns the socket of the reader or a negative error code */
+int dsstream_accept(int listen_fd, struct dsstream_writer *writer);
+
+/* tell a reader that a slot has been written, it never blocks,
+   returns DSSTREAM_ERR_CLOSED if the reader has gone */
+int dsstream_notify(int client_fd, uint64_t seq);
+
+void dsstream_close(int fd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,180 @@
+/*
+ * This file is part of the DSView project.
+ * DSView is based on PulseView.
+ *
+ * Copyright (C) 2022 DreamSourceLab <support@dreamsourcelab.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/*
+*	Throughput of the stream, a writer in this process feeds a reader
+*	in a child process the way DSView feeds the logic blocks.
+*
+*	dsstream_bench [-n slots] [-s payload KB] [-r ring slots] [-d reader delay us]
+*/
+
+#define _GNU_SOURCE
+
+#include "dsstream.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/wait.h>
+
+static double now_sec(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int run_reader(const char *path, int delay_us)
+{
+	struct dsstream_client *c;
+	const struct dsstream_slot *slot;
+	const void *data;
+	uint64_t received = 0;
+	uint64_t bytes = 0;
+	uint64_t edges = 0;
+	double start = 0;
+	int ret, end = 0;
+
+	if (dsstream_connect(&c, path) != DSSTREAM_OK) {
+		fprintf(stderr, "reader: connect failed\n");
+		return 1;
+	}
+
+	while (!end && (ret = dsstream_wait(c, 2000)) > 0) {
+		while (dsstream_next(c, &slot, &data) == 1) {
+			if (slot->type == DSSTREAM_BEGIN) {
+				start = now_sec();
+				continue;
+			}
+			if (slot->type == DSSTREAM_END) {
+				end = 1;
+				break;
+			}
+
+			// count the edges in place, as a checker would
+			const uint64_t *p = (const uint64_t*)data;
+			uint32_t i;
+			for (i = 0; i < slot->length / 8; i++)
+				edges += __builtin_popcountll(p[i] ^ (p[i] >> 1));
+
+			if (delay_us > 0)
+				usleep(delay_us);
+
+			if (dsstream_done(c)) {
+				received++;
+				bytes += slot->length;
+			}
+		}
+	}
+
+	if (start > 0) {
+		double dt = now_sec() - start;
+		printf("reader: %llu slots, %llu dropped, %.1f MB/s (%llu)\n",
+			(unsigned long long)received, (unsigned long long)dsstream_dropped(c),
+			bytes / dt / 1e6, (unsigned long long)(edges & 1));
+	}
+	dsstream_disconnect(c);
+	return end ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+	struct dsstream_writer *w;
+	struct dsstream_slot info;
+	uint32_t payload_kb = 2048;
+	uint32_t ring_slots = 32;
+	uint64_t count = 2000;
+	int delay_us = 0;
+	char path[108];
+	uint8_t *buf;
+	uint64_t i, seq;
+	int opt, lfd, cfd, status;
+	double start, dt;
+	pid_t pid;
+
+	while ((opt = getopt(argc, argv, "n:s:r:d:")) != -1) {
+		switch (opt) {
+		case 'n': count = strtoull(optarg, NULL, 10); break;
+		case 's': payload_kb = atoi(optarg); break;
+		case 'r': ring_slots = atoi(optarg); break;
+		case 'd': delay_us = atoi(optarg); break;
+		default:
+			fprintf(stderr, "usage: %s [-n slots] [-s payload KB] [-r ring slots] [-d reader delay us]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	snprintf(path, sizeof(path), "/tmp/dsstream-bench-%d", (int)getpid());
+	if (dsstream_writer_create(&w, ring_slots, payload_kb * 1024) != DSSTREAM_OK) {
+		fprintf(stderr, "writer: create failed\n");
+		return 1;
+	}
+	lfd = dsstream_listen(path);
+	if (lfd < 0) {
+		fprintf(stderr, "writer: listen failed\n");
+		return 1;
+	}
+
+	pid = fork();
+	if (pid == 0)
+		return run_reader(path, delay_us);
+
+	cfd = dsstream_accept(lfd, w);
+	if (cfd < 0) {
+		fprintf(stderr, "writer: accept failed\n");
+		return 1;
+	}
+
+	buf = (uint8_t*)malloc(payload_kb * 1024);
+	srand(1);
+	for (i = 0; i < payload_kb * 1024; i++)
+		buf[i] = (rand() % 16) ? 0 : rand();
+
+	memset(&info, 0, sizeof(info));
+	info.type = DSSTREAM_BEGIN;
+	dsstream_notify(cfd, dsstream_writer_publish(w, &info, NULL, 0));
+
+	start = now_sec();
+	info.type = DSSTREAM_LOGIC;
+	info.samples = payload_kb * 1024 * 8;
+	for (i = 0; i < count; i++) {
+		info.start = i * info.samples;
+		seq = dsstream_writer_publish(w, &info, buf, payload_kb * 1024);
+		dsstream_notify(cfd, seq);
+	}
+	dt = now_sec() - start;
+
+	info.type = DSSTREAM_END;
+	dsstream_notify(cfd, dsstream_writer_publish(w, &info, NULL, 0));
+
+	printf("writer: %llu slots of %u KB, %.1f MB/s\n", (unsigned long long)count,
+		payload_kb, count * (double)payload_kb * 1024 / dt / 1e6);
+
+	waitpid(pid, &status, 0);
+	dsstream_close(cfd);
+	dsstream_close(lfd);
+	unlink(path);
+	dsstream_writer_destroy(w);
+	free(buf);
+
+	return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
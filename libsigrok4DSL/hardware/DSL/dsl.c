@@ -1012,6 +1012,8 @@ SR_PRIV int dsl_fpga_arm(const struct sr_dev_inst *sdi)
     uint8_t rd_cmd_data;
     gboolean qutr_trig;
     gboolean half_trig;
+    struct ds_trigger_program trig_prog;
+    const struct ds_trigger_stage_prog *sp;
 
     devc = sdi->priv;
     usb = sdi->conn;
@@ -1110,30 +1112,37 @@ SR_PRIV int dsl_fpga_arm(const struct sr_dev_inst *sdi)
         break;
     }
 
-    // trigger advanced configuration
-    if (trigger->trigger_mode == SIMPLE_TRIGGER) {
+    // trigger advanced configuration, the application refuses to start
+    // a capture with a broken trigger, don't arm the device with it
+    if (ds_trigger_compile(&trig_prog) != SR_OK) {
+        sr_err("Unable to arm FPGA of dsl device: trigger error %d at stage %d.",
+               trig_prog.error, trig_prog.error_stage);
+        return SR_ERR;
+    }
+    if (trig_prog.mode == SIMPLE_TRIGGER) {
+        sp = &trig_prog.stage[TriggerStages];
         qutr_trig = !(devc->profile->dev_caps.feature_caps & CAPS_FEATURE_USB30) && (setting.mode & (1 << QUAR_MODE_BIT));
         half_trig = (!(devc->profile->dev_caps.feature_caps & CAPS_FEATURE_USB30) && setting.mode & (1 << HALF_MODE_BIT)) ||
                     ((devc->profile->dev_caps.feature_caps & CAPS_FEATURE_USB30) && setting.mode & (1 << QUAR_MODE_BIT));
 
-        setting.trig_mask0[0] = ds_trigger_get_mask0(TriggerStages, TriggerProbes-1, 0, qutr_trig, half_trig);
-        setting.trig_mask1[0] = ds_trigger_get_mask1(TriggerStages, TriggerProbes-1, 0, qutr_trig, half_trig);
-        setting.trig_value0[0] = ds_trigger_get_value0(TriggerStages, TriggerProbes-1, 0, qutr_trig, half_trig);
-        setting.trig_value1[0] = ds_trigger_get_value1(TriggerStages, TriggerProbes-1, 0, qutr_trig, half_trig);
-        setting.trig_edge0[0] = ds_trigger_get_edge0(TriggerStages, TriggerProbes-1, 0, qutr_trig, half_trig);
-        setting.trig_edge1[0] = ds_trigger_get_edge1(TriggerStages, TriggerProbes-1, 0, qutr_trig, half_trig);
+        setting.trig_mask0[0] = ds_trigger_pack(sp->cond[0].mask, TriggerProbes-1, 0, qutr_trig, half_trig);
+        setting.trig_mask1[0] = ds_trigger_pack(sp->cond[1].mask, TriggerProbes-1, 0, qutr_trig, half_trig);
+        setting.trig_value0[0] = ds_trigger_pack(sp->cond[0].value, TriggerProbes-1, 0, qutr_trig, half_trig);
+        setting.trig_value1[0] = ds_trigger_pack(sp->cond[1].value, TriggerProbes-1, 0, qutr_trig, half_trig);
+        setting.trig_edge0[0] = ds_trigger_pack(sp->cond[0].edge, TriggerProbes-1, 0, qutr_trig, half_trig);
+        setting.trig_edge1[0] = ds_trigger_pack(sp->cond[1].edge, TriggerProbes-1, 0, qutr_trig, half_trig);
 
-        setting_ext32.trig_mask0[0] = ds_trigger_get_mask0(TriggerStages, 2*TriggerProbes-1, TriggerProbes, qutr_trig, half_trig);
-        setting_ext32.trig_mask1[0] = ds_trigger_get_mask1(TriggerStages, 2*TriggerProbes-1, TriggerProbes, qutr_trig, half_trig);
-        setting_ext32.trig_value0[0] = ds_trigger_get_value0(TriggerStages, 2*TriggerProbes-1, TriggerProbes, qutr_trig, half_trig);
-        setting_ext32.trig_value1[0] = ds_trigger_get_value1(TriggerStages, 2*TriggerProbes-1, TriggerProbes, qutr_trig, half_trig);
-        setting_ext32.trig_edge0[0] = ds_trigger_get_edge0(TriggerStages, 2*TriggerProbes-1, TriggerProbes, qutr_trig, half_trig);
-        setting_ext32.trig_edge1[0] = ds_trigger_get_edge1(TriggerStages, 2*TriggerProbes-1, TriggerProbes, qutr_trig, half_trig);
+        setting_ext32.trig_mask0[0] = ds_trigger_pack(sp->cond[0].mask, 2*TriggerProbes-1, TriggerProbes, qutr_trig, half_trig);
+        setting_ext32.trig_mask1[0] = ds_trigger_pack(sp->cond[1].mask, 2*TriggerProbes-1, TriggerProbes, qutr_trig, half_trig);
+        setting_ext32.trig_value0[0] = ds_trigger_pack(sp->cond[0].value, 2*TriggerProbes-1, TriggerProbes, qutr_trig, half_trig);
+        setting_ext32.trig_value1[0] = ds_trigger_pack(sp->cond[1].value, 2*TriggerProbes-1, TriggerProbes, qutr_trig, half_trig);
+        setting_ext32.trig_edge0[0] = ds_trigger_pack(sp->cond[0].edge, 2*TriggerProbes-1, TriggerProbes, qutr_trig, half_trig);
+        setting_ext32.trig_edge1[0] = ds_trigger_pack(sp->cond[1].edge, 2*TriggerProbes-1, TriggerProbes, qutr_trig, half_trig);
 
-        setting.trig_logic0[0] = (trigger->trigger_logic[TriggerStages] << 1) + trigger->trigger0_inv[TriggerStages];
-        setting.trig_logic1[0] = (trigger->trigger_logic[TriggerStages] << 1) + trigger->trigger1_inv[TriggerStages];
+        setting.trig_logic0[0] = (sp->logic << 1) + sp->inv[0];
+        setting.trig_logic1[0] = (sp->logic << 1) + sp->inv[1];
 
-        setting.trig_count[0] = trigger->trigger0_count[TriggerStages];
+        setting.trig_count[0] = sp->count;
 
         for (i = 1; i < NUM_TRIGGER_STAGES; i++) {
             setting.trig_mask0[i] = 0xffff;
@@ -1157,6 +1166,7 @@ SR_PRIV int dsl_fpga_arm(const struct sr_dev_inst *sdi)
         }
     } else {
         for (i = 0; i < NUM_TRIGGER_STAGES; i++) {
+            sp = &trig_prog.stage[i];
             if (setting.mode & (1 << STRIG_MODE_BIT) && i == STriggerDataStage) {
                 qutr_trig = FALSE;
                 half_trig = FALSE;
@@ -1166,24 +1176,24 @@ SR_PRIV int dsl_fpga_arm(const struct sr_dev_inst *sdi)
                             ((devc->profile->dev_caps.feature_caps & CAPS_FEATURE_USB30) && setting.mode & (1 << QUAR_MODE_BIT));
             }
 
-            setting.trig_mask0[i] = ds_trigger_get_mask0(i, TriggerProbes-1 , 0, qutr_trig, half_trig);
-            setting.trig_mask1[i] = ds_trigger_get_mask1(i, TriggerProbes-1, 0, qutr_trig, half_trig);
-            setting.trig_value0[i] = ds_trigger_get_value0(i, TriggerProbes-1, 0, qutr_trig, half_trig);
-            setting.trig_value1[i] = ds_trigger_get_value1(i, TriggerProbes-1, 0, qutr_trig, half_trig);
-            setting.trig_edge0[i] = ds_trigger_get_edge0(i, TriggerProbes-1, 0, qutr_trig, half_trig);
-            setting.trig_edge1[i] = ds_trigger_get_edge1(i, TriggerProbes-1, 0, qutr_trig, half_trig);
+            setting.trig_mask0[i] = ds_trigger_pack(sp->cond[0].mask, TriggerProbes-1, 0, qutr_trig, half_trig);
+            setting.trig_mask1[i] = ds_trigger_pack(sp->cond[1].mask, TriggerProbes-1, 0, qutr_trig, half_trig);
+            setting.trig_value0[i] = ds_trigger_pack(sp->cond[0].value, TriggerProbes-1, 0, qutr_trig, half_trig);
+            setting.trig_value1[i] = ds_trigger_pack(sp->cond[1].value, TriggerProbes-1, 0, qutr_trig, half_trig);
+            setting.trig_edge0[i] = ds_trigger_pack(sp->cond[0].edge, TriggerProbes-1, 0, qutr_trig, half_trig);
+            setting.trig_edge1[i] = ds_trigger_pack(sp->cond[1].edge, TriggerProbes-1, 0, qutr_trig, half_trig);
 
-            setting_ext32.trig_mask0[i] = ds_trigger_get_mask0(i, 2*TriggerProbes-1, TriggerProbes, qutr_trig, half_trig);
-            setting_ext32.trig_mask1[i] = ds_trigger_get_mask1(i, 2*TriggerProbes-1, TriggerProbes, qutr_trig, half_trig);
-            setting_ext32.trig_value0[i] = ds_trigger_get_value0(i, 2*TriggerProbes-1, TriggerProbes, qutr_trig, half_trig);
-            setting_ext32.trig_value1[i] = ds_trigger_get_value1(i, 2*TriggerProbes-1, TriggerProbes, qutr_trig, half_trig);
-            setting_ext32.trig_edge0[i] = ds_trigger_get_edge0(i, 2*TriggerProbes-1, TriggerProbes, qutr_trig, half_trig);
-            setting_ext32.trig_edge1[i] = ds_trigger_get_edge1(i, 2*TriggerProbes-1, TriggerProbes, qutr_trig, half_trig);
+            setting_ext32.trig_mask0[i] = ds_trigger_pack(sp->cond[0].mask, 2*TriggerProbes-1, TriggerProbes, qutr_trig, half_trig);
+            setting_ext32.trig_mask1[i] = ds_trigger_pack(sp->cond[1].mask, 2*TriggerProbes-1, TriggerProbes, qutr_trig, half_trig);
+            setting_ext32.trig_value0[i] = ds_trigger_pack(sp->cond[0].value, 2*TriggerProbes-1, TriggerProbes, qutr_trig, half_trig);
+            setting_ext32.trig_value1[i] = ds_trigger_pack(sp->cond[1].value, 2*TriggerProbes-1, TriggerProbes, qutr_trig, half_trig);
+            setting_ext32.trig_edge0[i] = ds_trigger_pack(sp->cond[0].edge, 2*TriggerProbes-1, TriggerProbes, qutr_trig, half_trig);
+            setting_ext32.trig_edge1[i] = ds_trigger_pack(sp->cond[1].edge, 2*TriggerProbes-1, TriggerProbes, qutr_trig, half_trig);
 
-            setting.trig_logic0[i] = (trigger->trigger_logic[i] << 1) + trigger->trigger0_inv[i];
-            setting.trig_logic1[i] = (trigger->trigger_logic[i] << 1) + trigger->trigger1_inv[i];
+            setting.trig_logic0[i] = (sp->logic << 1) + sp->inv[0];
+            setting.trig_logic1[i] = (sp->logic << 1) + sp->inv[1];
 
-            setting.trig_count[i] = trigger->trigger0_count[i];
+            setting.trig_count[i] = sp->count;
         }
     }
 
@@ -314,12 +314,7 @@ SR_PRIV uint64_t sr_trigger_get_value1(uint16_t stage);
 SR_PRIV uint64_t sr_trigger_get_edge0(uint16_t stage);
 SR_PRIV uint64_t sr_trigger_get_edge1(uint16_t stage);
 
-SR_PRIV uint16_t ds_trigger_get_mask0(uint16_t stage, uint16_t msc, uint16_t lsc, gboolean qutr_mode, gboolean half_mode);
-SR_PRIV uint16_t ds_trigger_get_value0(uint16_t stage, uint16_t msc, uint16_t lsc, gboolean qutr_mode, gboolean half_mode);
-SR_PRIV uint16_t ds_trigger_get_edge0(uint16_t stage, uint16_t msc, uint16_t lsc, gboolean qutr_mode, gboolean half_mode);
-SR_PRIV uint16_t ds_trigger_get_mask1(uint16_t stage, uint16_t msc, uint16_t lsc, gboolean qutr_mode, gboolean half_mode);
-SR_PRIV uint16_t ds_trigger_get_value1(uint16_t stage, uint16_t msc, uint16_t lsc, gboolean qutr_mode, gboolean half_mode);
-SR_PRIV uint16_t ds_trigger_get_edge1(uint16_t stage, uint16_t msc, uint16_t lsc, gboolean qutr_mode, gboolean half_mode);
+SR_PRIV uint16_t ds_trigger_pack(uint32_t bits, uint16_t msc, uint16_t lsc, gboolean qutr_mode, gboolean half_mode);
 
 SR_PRIV int ds_trigger_init(void);
 SR_PRIV int ds_trigger_destroy(void);
@@ -622,6 +622,8 @@ enum CHANNEL_TYPE {
     SR_CHANNEL_FFT,
     SR_CHANNEL_LISSAJOUS,
     SR_CHANNEL_MATH,
+    SR_CHANNEL_TREND,
+    SR_CHANNEL_EYE,
 };
 
 enum OPERATION_MODE {	
@@ -1147,6 +1149,44 @@ enum {
     DSO_TRIGGER_FALLING,
 };
 
+enum {
+    DS_TRIGGER_OK = 0,
+    DS_TRIGGER_ERR_CHAR,        /* not one of X 0 1 R F C */
+    DS_TRIGGER_ERR_NEVER,       /* the conditions of an and stage exclude each other */
+    DS_TRIGGER_ERR_CONTIGUOUS,  /* an edge can not be matched on contiguous samples */
+    DS_TRIGGER_ERR_SERIAL,      /* the serial trigger needs one clock edge and one data probe */
+};
+
+/* one trigger condition, bit n is probe n */
+struct ds_trigger_cond {
+    uint32_t mask;      /* X and C, the level is not compared */
+    uint32_t value;     /* 1 and R */
+    uint32_t edge;      /* R, F and C */
+};
+
+struct ds_trigger_stage_prog {
+    struct ds_trigger_cond cond[2];
+    unsigned char inv[2];
+    unsigned char logic;    /* bit 0: and, bit 1: contiguous */
+    uint32_t count;
+};
+
+/*
+ * The compiled trigger. stage[] holds every stage, stage[TriggerStages] is
+ * the simple trigger, the first stages of stage[] are used by the others.
+ */
+struct ds_trigger_program {
+    uint16_t mode;
+    uint16_t pos;
+    uint16_t stages;
+    struct ds_trigger_stage_prog stage[TriggerStages + 1];
+
+    int error;
+    int error_stage;
+    int error_cond;
+    int error_probe;
+};
+
 struct ds_trigger_pos {
     uint32_t check_id;
     uint32_t real_pos;
@@ -1241,6 +1281,7 @@ SR_API uint16_t ds_trigger_get_pos();
 SR_API int ds_trigger_set_en(uint16_t enable);
 SR_API uint16_t ds_trigger_get_en();
 SR_API int ds_trigger_set_mode(uint16_t mode);
+SR_API int ds_trigger_compile(struct ds_trigger_program *prog);
  
 /*--- log.c -----------------------------------------------------------------*/
 
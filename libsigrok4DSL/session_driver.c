@@ -37,12 +37,16 @@
 /** @cond PRIVATE */
 #define CHUNKSIZE (512 * 1024)
 #define UNITLEN 64
+/* decompressed chunks of a sigrok srzip file read ahead of the feed */
+#define SRZIP_SLOTS 2
+#define SRZIP_MAX_UNITSIZE 8
 /** @endcond */
 
 extern struct sr_session *session;
 extern SR_PRIV struct sr_dev_driver session_driver;
 
 static int sr_load_virtual_device_session(struct sr_dev_inst *sdi);
+static int sr_load_srzip_session(struct sr_dev_inst *sdi, unzFile archive);
 
 static uint64_t samplerates[1];
 static uint64_t samplecounts[1];
@@ -96,6 +100,24 @@ static void get_file_short_name(const char *file, char *buf, int buflen)
     *wr = '\0';
 }
 
+struct srzip_reader
+{
+    GThread *thread;
+    GMutex mutex;
+    GCond cond;
+    char *path;
+    char capturefile[32];
+    int chunked;        // "logic-1-1", "logic-1-2"... or a single "logic-1"
+    int num_chunks;
+    void *slot[SRZIP_SLOTS];
+    int slot_len[SRZIP_SLOTS];
+    int head;           // the next slot to consume
+    int count;          // filled slots
+    gboolean finished;
+    gboolean failed;
+    gboolean abort;
+};
+
 struct session_vdev
 { 
     int version;
@@ -122,6 +144,17 @@ struct session_vdev
     uint32_t ref_max;
     uint8_t max_height;
     struct sr_status mstatus;
+
+    // sigrok srzip archive, interleaved samples of unitsize bytes
+    int srzip;
+    int unitsize;
+    int srzip_chunked;
+    int srzip_chunks;
+    char capturefile[32];
+    struct srzip_reader *reader;
+    uint8_t carry[UNITLEN * SRZIP_MAX_UNITSIZE];  // samples short of a whole group
+    int carry_len;
+    uint8_t enabled_index[UNITLEN];
 };
 
 static const int hwoptions[] = {
@@ -186,10 +219,256 @@ static int trans_data(struct sr_dev_inst *sdi)
     return SR_OK;
 }
 
+/*
+ * sigrok srzip: the samples are stored one after another, unitsize bytes
+ * each, bit n of a sample is probe n. A group of 64 samples is turned into
+ * one 64 bit word per probe with 8x8 bit matrix transposes.
+ */
+static inline uint64_t transpose8(uint64_t x)
+{
+    uint64_t t;
+
+    t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+    x = x ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+    x = x ^ t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+    x = x ^ t ^ (t << 28);
+    return x;
+}
+
+// words[n] gets the 64 samples of probe n, unitsize * 8 words
+static void transpose_group(const uint8_t *src, int unitsize, uint64_t *words)
+{
+    const uint8_t *p;
+    uint64_t *w;
+    uint64_t x, y;
+    int lane, blk, j, k;
+
+    for (lane = 0; lane < unitsize; lane++)
+    {
+        w = words + lane * 8;
+        memset(w, 0, 8 * sizeof(uint64_t));
+
+        for (blk = 0; blk < 8; blk++)
+        {
+            // byte k of x is the lane byte of sample blk * 8 + k
+            p = src + (blk * 8) * unitsize + lane;
+            x = 0;
+            for (k = 0; k < 8; k++)
+                x |= (uint64_t)p[k * unitsize] << (k * 8);
+
+            // byte j of y holds bit j of the 8 samples
+            y = transpose8(x);
+            for (j = 0; j < 8; j++)
+                w[j] |= ((y >> (j * 8)) & 0xFF) << (blk * 8);
+        }
+    }
+}
+
+static uint64_t *srzip_unpack_group(struct session_vdev *vdev, const uint8_t *src, uint64_t *dest)
+{
+    uint64_t words[UNITLEN];
+    int i;
+
+    transpose_group(src, vdev->unitsize, words);
+    for (i = 0; i < vdev->enabled_probes; i++)
+        *dest++ = words[vdev->enabled_index[i]];
+
+    return dest;
+}
+
+/*
+ * The capture files are inflated by a thread of their own, so the next
+ * chunk is ready while the current one is transposed and stored.
+ */
+static gpointer srzip_reader_proc(gpointer data)
+{
+    struct srzip_reader *rd = data;
+    unzFile archive;
+    char file_name[48];
+    int chunk, slot, len, ret;
+    gboolean failed = FALSE;
+    gboolean stop = FALSE;
+
+    archive = unzOpen64(rd->path);
+    if (archive == NULL)
+    {
+        sr_err("%s: load zip file error:%s", __func__, rd->path);
+        failed = TRUE;
+    }
+
+    for (chunk = 1; !failed && !stop && chunk <= rd->num_chunks; chunk++)
+    {
+        if (rd->chunked)
+            snprintf(file_name, sizeof(file_name), "%s-%d", rd->capturefile, chunk);
+        else
+            snprintf(file_name, sizeof(file_name), "%s", rd->capturefile);
+
+        if (unzLocateFile(archive, file_name, 0) != UNZ_OK
+            || unzOpenCurrentFile(archive) != UNZ_OK)
+        {
+            sr_err("cant't open zip inner file:%s", file_name);
+            failed = TRUE;
+            break;
+        }
+
+        for (;;)
+        {
+            g_mutex_lock(&rd->mutex);
+            while (rd->count == SRZIP_SLOTS && !rd->abort)
+                g_cond_wait(&rd->cond, &rd->mutex);
+            stop = rd->abort;
+            slot = (rd->head + rd->count) % SRZIP_SLOTS;
+            g_mutex_unlock(&rd->mutex);
+
+            if (stop)
+                break;
+
+            len = 0;
+            while (len < CHUNKSIZE)
+            {
+                ret = unzReadCurrentFile(archive, (uint8_t *)rd->slot[slot] + len, CHUNKSIZE - len);
+                if (ret < 0)
+                {
+                    sr_err("read zip inner file error:%s", file_name);
+                    failed = TRUE;
+                    break;
+                }
+                if (ret == 0)
+                    break;
+                len += ret;
+            }
+
+            if (failed || len == 0)
+                break;
+
+            g_mutex_lock(&rd->mutex);
+            rd->slot_len[slot] = len;
+            rd->count++;
+            g_cond_broadcast(&rd->cond);
+            g_mutex_unlock(&rd->mutex);
+
+            if (len < CHUNKSIZE)
+                break;
+        }
+
+        unzCloseCurrentFile(archive);
+    }
+
+    if (archive != NULL)
+        unzClose(archive);
+
+    g_mutex_lock(&rd->mutex);
+    rd->failed = failed;
+    rd->finished = TRUE;
+    g_cond_broadcast(&rd->cond);
+    g_mutex_unlock(&rd->mutex);
+
+    return NULL;
+}
+
+static int srzip_reader_start(const struct sr_dev_inst *sdi, struct session_vdev *vdev)
+{
+    struct srzip_reader *rd;
+    int i;
+
+    rd = g_try_malloc0(sizeof(struct srzip_reader));
+    if (rd == NULL)
+    {
+        sr_err("%s: reader malloc failed", __func__);
+        return SR_ERR_MALLOC;
+    }
+
+    for (i = 0; i < SRZIP_SLOTS; i++)
+    {
+        rd->slot[i] = g_try_malloc(CHUNKSIZE);
+        if (rd->slot[i] == NULL)
+        {
+            sr_err("%s: reader buffer malloc failed", __func__);
+            while (i--)
+                g_free(rd->slot[i]);
+            g_free(rd);
+            return SR_ERR_MALLOC;
+        }
+    }
+
+    g_mutex_init(&rd->mutex);
+    g_cond_init(&rd->cond);
+    rd->path = g_strdup(sdi->path);
+    strncpy(rd->capturefile, vdev->capturefile, sizeof(rd->capturefile) - 1);
+    rd->chunked = vdev->srzip_chunked;
+    rd->num_chunks = vdev->srzip_chunks;
+
+    vdev->reader = rd;
+    rd->thread = g_thread_new("srzip_reader_proc", srzip_reader_proc, rd);
+
+    return SR_OK;
+}
+
+static void srzip_reader_stop(struct session_vdev *vdev)
+{
+    struct srzip_reader *rd = vdev->reader;
+    int i;
+
+    if (rd == NULL)
+        return;
+
+    g_mutex_lock(&rd->mutex);
+    rd->abort = TRUE;
+    g_cond_broadcast(&rd->cond);
+    g_mutex_unlock(&rd->mutex);
+
+    g_thread_join(rd->thread);
+    g_mutex_clear(&rd->mutex);
+    g_cond_clear(&rd->cond);
+
+    for (i = 0; i < SRZIP_SLOTS; i++)
+        g_free(rd->slot[i]);
+    g_free(rd->path);
+    g_free(rd);
+
+    vdev->reader = NULL;
+}
+
+// returns the length of the next filled slot, 0 at the end, -1 on error
+static int srzip_reader_take(struct srzip_reader *rd, const uint8_t **buf)
+{
+    int len;
+
+    g_mutex_lock(&rd->mutex);
+    while (rd->count == 0 && !rd->finished)
+        g_cond_wait(&rd->cond, &rd->mutex);
+
+    if (rd->count > 0)
+    {
+        *buf = rd->slot[rd->head];
+        len = rd->slot_len[rd->head];
+    }
+    else
+    {
+        len = rd->failed ? -1 : 0;
+    }
+    g_mutex_unlock(&rd->mutex);
+
+    return len;
+}
+
+static void srzip_reader_release(struct srzip_reader *rd)
+{
+    g_mutex_lock(&rd->mutex);
+    rd->head = (rd->head + 1) % SRZIP_SLOTS;
+    rd->count--;
+    g_cond_broadcast(&rd->cond);
+    g_mutex_unlock(&rd->mutex);
+}
+
 static int close_archive(struct session_vdev *vdev)
 {
     assert(vdev->archive);
 
+    srzip_reader_stop(vdev);
+
     // close current inner file
     if (vdev->capfile)
     {
@@ -216,6 +495,86 @@ static void send_error_packet(const struct sr_dev_inst *cb_sdi, struct session_v
     close_archive(vdev);
 }
 
+static int receive_srzip_data(const struct sr_dev_inst *sdi, struct session_vdev *vdev)
+{
+    struct sr_datafeed_packet packet;
+    struct sr_datafeed_logic logic;
+    const int group = UNITLEN * vdev->unitsize;
+    const uint8_t *src;
+    uint64_t *dest;
+    int len, n;
+
+    len = srzip_reader_take(vdev->reader, &src);
+    if (len < 0)
+        return SR_ERR;
+
+    dest = vdev->logic_buf;
+
+    if (len == 0)
+    {
+        // the capture ends inside a group, the rest of it is zero
+        if (vdev->carry_len > 0)
+        {
+            memset(vdev->carry + vdev->carry_len, 0, group - vdev->carry_len);
+            dest = srzip_unpack_group(vdev, vdev->carry, dest);
+            vdev->carry_len = 0;
+        }
+        vdev->cur_channel = vdev->num_probes;
+    }
+    else
+    {
+        vdev->bytes_read += len;
+
+        // complete the group left over by the previous slot
+        if (vdev->carry_len > 0)
+        {
+            n = group - vdev->carry_len;
+            if (n > len)
+                n = len;
+            memcpy(vdev->carry + vdev->carry_len, src, n);
+            vdev->carry_len += n;
+            src += n;
+            len -= n;
+
+            if (vdev->carry_len == group)
+            {
+                dest = srzip_unpack_group(vdev, vdev->carry, dest);
+                vdev->carry_len = 0;
+            }
+        }
+
+        while (len >= group)
+        {
+            dest = srzip_unpack_group(vdev, src, dest);
+            src += group;
+            len -= group;
+        }
+
+        if (len > 0)
+        {
+            memcpy(vdev->carry, src, len);
+            vdev->carry_len = len;
+        }
+
+        srzip_reader_release(vdev->reader);
+    }
+
+    if (dest != vdev->logic_buf)
+    {
+        packet.type = SR_DF_LOGIC;
+        packet.status = SR_PKT_OK;
+        packet.payload = &logic;
+        logic.format = LA_CROSS_DATA;
+        logic.index = 0;
+        logic.order = vdev->cur_channel;
+        logic.length = (dest - (uint64_t *)vdev->logic_buf) * sizeof(uint64_t);
+        logic.data = vdev->logic_buf;
+        ds_data_forward(sdi, &packet);
+    }
+
+    return SR_OK;
+}
+
 static int receive_data(int fd, int revents, const struct sr_dev_inst *sdi)
 {
     struct session_vdev *vdev = NULL;
@@ -249,7 +608,16 @@ static int receive_data(int fd, int revents, const struct sr_dev_inst *sdi)
         assert(vdev->cur_channel >= 0);
         assert(vdev->archive);
 
-        if (vdev->cur_channel < vdev->num_probes)
+        if (vdev->srzip && vdev->cur_channel < vdev->num_probes && revents != -1)
+        {
+            if (receive_srzip_data(sdi, vdev) != SR_OK)
+            {
+                sr_err("%s: Read capture file error!", __func__);
+                send_error_packet(sdi, vdev, &packet);
+                return FALSE;
+            }
+        }
+        else if (vdev->cur_channel < vdev->num_probes)
         {
             if (vdev->version == 1)
             {
@@ -1106,7 +1474,30 @@ static int dev_acquisition_start(struct sr_dev_inst *sdi, void *cb_data)
     {
         probe = l->data;
         if (probe->enabled)
-            vdev->enabled_probes++;
+            vdev->enabled_index[vdev->enabled_probes++] = probe->index;
+    }
+
+    if (vdev->srzip)
+    {
+        g_safe_free(vdev->logic_buf);
+        vdev->logic_buf = g_try_malloc((CHUNKSIZE / (UNITLEN * vdev->unitsize) + 2)
+                                       * vdev->enabled_probes * sizeof(uint64_t));
+        if (vdev->logic_buf == NULL)
+        {
+            sr_err("%s: vdev->logic_buf malloc failed", __func__);
+            close_archive(vdev);
+            return SR_ERR_MALLOC;
+        }
+
+        vdev->carry_len = 0;
+        vdev->bytes_read = 0;
+
+        ret = srzip_reader_start(sdi, vdev);
+        if (ret != SR_OK)
+        {
+            close_archive(vdev);
+            return ret;
+        }
     }
 
     /* Send header packet to the session bus. */
@@ -1164,6 +1555,16 @@ SR_PRIV int sr_new_virtual_device(const char *filename, struct sr_dev_inst **out
         sr_err("load zip file error:%s", filename);
         return SR_ERR;
     }
+
+    // a sigrok session has a "metadata" file instead, it holds logic data only
+    if (unzLocateFile(archive, "header", 0) != UNZ_OK
+        && unzLocateFile(archive, "metadata", 0) == UNZ_OK)
+    {
+        unzClose(archive);
+        archive = NULL;
+        goto create_device;
+    }
+
     if (unzLocateFile(archive, "header", 0) != UNZ_OK)
     {
         unzClose(archive);
@@ -1230,6 +1631,7 @@ SR_PRIV int sr_new_virtual_device(const char *filename, struct sr_dev_inst **out
     g_key_file_free(kf);
     g_free(metafile);
 
+create_device:
     sdi = sr_dev_inst_new(mode, SR_ST_INACTIVE, NULL, NULL, NULL);
     sdi->driver = &session_driver;
     sdi->dev_type = DEV_TYPE_FILELOG;
@@ -1281,6 +1683,13 @@ static int sr_load_virtual_device_session(struct sr_dev_inst *sdi)
         sr_err("%s: Load zip file error.", __func__);
         return SR_ERR;
     }
+    if (unzLocateFile(archive, "header", 0) != UNZ_OK
+        && unzLocateFile(archive, "metadata", 0) == UNZ_OK)
+    {
+        ret = sr_load_srzip_session(sdi, archive);
+        unzClose(archive);
+        return ret;
+    }
     if (unzLocateFile(archive, "header", 0) != UNZ_OK)
     {
         unzClose(archive);
@@ -1747,6 +2156,182 @@ static int sr_load_virtual_device_session(struct sr_dev_inst *sdi)
     return SR_OK;
 }
 
+/*
+ * A sigrok session archive (srzip): "metadata" is a key file, the section
+ * "device 1" names the capture files and the probes, "probe1" is bit 0 of
+ * a sample. Newer files split the samples into "logic-1-1", "logic-1-2"...
+ * @archive is located at "metadata".
+ */
+static int sr_load_srzip_session(struct sr_dev_inst *sdi, unzFile archive)
+{
+    struct session_vdev *vdev;
+    GKeyFile *kf;
+    unz_file_info64 fileInfo;
+    char szFilePath[15];
+    char file_name[48];
+    char key[16];
+    char **sections, *metafile, *val, *section;
+    struct sr_channel *probe;
+    uint64_t tmp_u64, total_bytes;
+    int total_probes, unitsize, ret, i, p;
+
+    vdev = sdi->priv;
+    ret = SR_ERR;
+
+    if (sdi->mode != LOGIC)
+    {
+        sr_err("%s: A sigrok session holds logic data only.", __func__);
+        return SR_ERR;
+    }
+
+    if (unzGetCurrentFileInfo64(archive, &fileInfo, szFilePath,
+                                sizeof(szFilePath), NULL, 0, NULL, 0) != UNZ_OK)
+    {
+        sr_err("%s: unzGetCurrentFileInfo64 error.", __func__);
+        return SR_ERR;
+    }
+    if (unzOpenCurrentFile(archive) != UNZ_OK)
+    {
+        sr_err("%s: Cant't open zip inner file.", __func__);
+        return SR_ERR;
+    }
+
+    if (!(metafile = g_try_malloc(fileInfo.uncompressed_size)))
+    {
+        sr_err("%s: metafile malloc failed", __func__);
+        unzCloseCurrentFile(archive);
+        return SR_ERR_MALLOC;
+    }
+
+    unzReadCurrentFile(archive, metafile, fileInfo.uncompressed_size);
+    unzCloseCurrentFile(archive);
+
+    kf = g_key_file_new();
+    if (!g_key_file_load_from_data(kf, metafile, fileInfo.uncompressed_size, 0, NULL))
+    {
+        sr_err("Failed to parse metadata.");
+        g_key_file_free(kf);
+        g_free(metafile);
+        return SR_ERR;
+    }
+
+    // the first device with a logic capture
+    section = NULL;
+    sections = g_key_file_get_groups(kf, NULL);
+    for (i = 0; sections[i]; i++)
+    {
+        if (!strncmp(sections[i], "device ", 7)
+            && g_key_file_has_key(kf, sections[i], "capturefile", NULL))
+        {
+            section = sections[i];
+            break;
+        }
+    }
+
+    if (section == NULL)
+    {
+        sr_err("%s: No logic capture in the session.", __func__);
+        goto done;
+    }
+
+    total_probes = g_key_file_get_integer(kf, section, "total probes", NULL);
+    unitsize = 1;
+    if (g_key_file_has_key(kf, section, "unitsize", NULL))
+        unitsize = g_key_file_get_integer(kf, section, "unitsize", NULL);
+
+    if (total_probes <= 0 || total_probes > UNITLEN
+        || unitsize <= 0 || unitsize > SRZIP_MAX_UNITSIZE || unitsize * 8 < total_probes)
+    {
+        sr_err("%s: Unsupported capture, %d probes in %d bytes.", __func__, total_probes, unitsize);
+        goto done;
+    }
+
+    val = g_key_file_get_string(kf, section, "capturefile", NULL);
+    strncpy(vdev->capturefile, val, sizeof(vdev->capturefile) - 1);
+    g_free(val);
+
+    sdi->driver->config_set(SR_CONF_FILE_VERSION,
+                            g_variant_new_int16(2), sdi, NULL, NULL);
+    vdev->srzip = TRUE;
+    vdev->unitsize = unitsize;
+
+    val = g_key_file_get_string(kf, section, "samplerate", NULL);
+    if (val != NULL && sr_parse_sizestring(val, &tmp_u64) == SR_OK)
+    {
+        sdi->driver->config_set(SR_CONF_SAMPLERATE,
+                                g_variant_new_uint64(tmp_u64), sdi, NULL, NULL);
+    }
+    g_free(val);
+
+    sdi->driver->config_set(SR_CONF_CAPTURE_NUM_PROBES,
+                            g_variant_new_uint64(total_probes), sdi, NULL, NULL);
+
+    // probes without a name were disabled in the capture, their bits stay in the samples
+    for (p = 0; p < total_probes; p++)
+    {
+        snprintf(key, sizeof(key), "probe%d", p + 1);
+        val = g_key_file_get_string(kf, section, key, NULL);
+        if (val == NULL)
+            continue;
+
+        probe = sr_channel_new(p, SR_CHANNEL_LOGIC, TRUE, val);
+        g_free(val);
+        if (probe == NULL)
+        {
+            sr_err("%s: create channel failed", __func__);
+            goto done;
+        }
+        sdi->channels = g_slist_append(sdi->channels, probe);
+    }
+
+    if (sdi->channels == NULL)
+    {
+        sr_err("%s: No probe in the session.", __func__);
+        goto done;
+    }
+
+    // the sample count comes from the sizes of the capture files
+    total_bytes = 0;
+    vdev->srzip_chunks = 0;
+    snprintf(file_name, sizeof(file_name), "%s-1", vdev->capturefile);
+    vdev->srzip_chunked = (unzLocateFile(archive, file_name, 0) == UNZ_OK);
+
+    for (;;)
+    {
+        if (vdev->srzip_chunked)
+            snprintf(file_name, sizeof(file_name), "%s-%d", vdev->capturefile, vdev->srzip_chunks + 1);
+        else if (vdev->srzip_chunks == 0)
+            snprintf(file_name, sizeof(file_name), "%s", vdev->capturefile);
+        else
+            break;
+
+        if (unzLocateFile(archive, file_name, 0) != UNZ_OK)
+            break;
+        if (unzGetCurrentFileInfo64(archive, &fileInfo, NULL, 0, NULL, 0, NULL, 0) != UNZ_OK)
+            break;
+
+        total_bytes += fileInfo.uncompressed_size;
+        vdev->srzip_chunks++;
+    }
+
+    if (total_bytes < (uint64_t)unitsize)
+    {
+        sr_err("%s: No samples in the session.", __func__);
+        goto done;
+    }
+
+    sdi->driver->config_set(SR_CONF_LIMIT_SAMPLES,
+                            g_variant_new_uint64(total_bytes / unitsize), sdi, NULL, NULL);
+    ret = SR_OK;
+
+done:
+    g_strfreev(sections);
+    g_key_file_free(kf);
+    g_free(metafile);
+
+    return ret;
+}
+
 /** @private */
 SR_PRIV struct sr_dev_driver session_driver = {
     .name = "virtual-session",
@@ -281,202 +281,187 @@ SR_API int ds_trigger_set_mode(uint16_t mode)
     return SR_OK;
 }
 
-/*
- *
- */
-SR_PRIV uint16_t ds_trigger_get_mask0(uint16_t stage, uint16_t msc, uint16_t lsc, gboolean qutr_mode, gboolean half_mode)
+static int trigger_cond_compile(const char *probes, struct ds_trigger_cond *cond, int *bad_probe)
 {
-    assert(stage <= TriggerStages);
-    assert(lsc <= msc);
-    assert(msc < MaxTriggerProbes);
-
-    if (trigger == NULL){
-        sr_err("%s", "ds_trigger_get_mask0() error, trigger have'nt be inited.");
-        return SR_ERR_CALL_STATUS;
-    }
-
-    uint16_t mask = 0;
-    const uint16_t qutr_mask = (0xffff >> (TriggerProbes - TriggerProbes/4));
-    const uint16_t half_mask = (0xffff >> (TriggerProbes - TriggerProbes/2));
     int i;
 
-    for (i = msc; i >= lsc ; i--) {
-        mask = (mask << 1);
-        mask += ((trigger->trigger0[stage][i] == 'X') | (trigger->trigger0[stage][i] == 'C'));
+    cond->mask = 0;
+    cond->value = 0;
+    cond->edge = 0;
+    *bad_probe = -1;
+
+    for (i = 0; i < MaxTriggerProbes; i++) {
+        const uint32_t bit = (uint32_t)1 << i;
+        switch (probes[i]) {
+        case 'X': cond->mask |= bit; break;
+        case '0': break;
+        case '1': cond->value |= bit; break;
+        case 'R': cond->value |= bit; cond->edge |= bit; break;
+        case 'F': cond->edge |= bit; break;
+        case 'C': cond->mask |= bit; cond->edge |= bit; break;
+        default:
+            // compared as '0' by the hardware
+            if (*bad_probe < 0)
+                *bad_probe = i;
+            break;
+        }
     }
 
-    if (qutr_mode)
-        mask = ((mask & qutr_mask) << (TriggerProbes/4*3)) +
-               ((mask & qutr_mask) << (TriggerProbes/4*2)) +
-               ((mask & qutr_mask) << (TriggerProbes/4*1)) +
-               ((mask & qutr_mask) << (TriggerProbes/4*0));
-    else if (half_mode)
-        mask = ((mask & half_mask) << (TriggerProbes/2*1)) +
-               ((mask & half_mask) << (TriggerProbes/2*0));
-
-    return mask;
+    return (*bad_probe < 0) ? SR_OK : SR_ERR_ARG;
 }
-SR_PRIV uint16_t ds_trigger_get_mask1(uint16_t stage, uint16_t msc, uint16_t lsc, gboolean qutr_mode, gboolean half_mode)
-{
-    assert(stage <= TriggerStages);
-    assert(lsc <= msc);
-    assert(msc < MaxTriggerProbes);
-
-    if (trigger == NULL){
-        sr_err("%s", "ds_trigger_get_mask1() error, trigger have'nt be inited.");
-        return SR_ERR_CALL_STATUS;
-    }
 
-    uint16_t mask = 0;
-    const uint16_t qutr_mask = (0xffff >> (TriggerProbes - TriggerProbes/4));
-    const uint16_t half_mask = (0xffff >> (TriggerProbes - TriggerProbes/2));
-    int i;
-
-    for (i = msc; i >= lsc ; i--) {
-        mask = (mask << 1);
-        mask += ((trigger->trigger1[stage][i] == 'X') | (trigger->trigger1[stage][i] == 'C'));
-    }
-
-    if (qutr_mode)
-        mask = ((mask & qutr_mask) << (TriggerProbes/4*3)) +
-               ((mask & qutr_mask) << (TriggerProbes/4*2)) +
-               ((mask & qutr_mask) << (TriggerProbes/4*1)) +
-               ((mask & qutr_mask) << (TriggerProbes/4*0));
-    else if (half_mode)
-        mask = ((mask & half_mask) << (TriggerProbes/2*1)) +
-               ((mask & half_mask) << (TriggerProbes/2*0));
-
-    return mask;
+static void trigger_set_error(struct ds_trigger_program *prog, int error, int stage, int cond, int probe)
+{
+    // the first error is kept
+    if (prog->error != DS_TRIGGER_OK)
+        return;
+    prog->error = error;
+    prog->error_stage = stage;
+    prog->error_cond = cond;
+    prog->error_probe = probe;
 }
-SR_PRIV uint16_t ds_trigger_get_value0(uint16_t stage, uint16_t msc, uint16_t lsc, gboolean qutr_mode, gboolean half_mode)
+
+/* the probes which must rise or fall on the matched sample */
+static uint32_t trigger_cond_edges(const struct ds_trigger_cond *cond)
 {
-    assert(stage <= TriggerStages);
-    assert(lsc <= msc);
-    assert(msc < MaxTriggerProbes);
+    return cond->edge & ~cond->mask;
+}
 
-    if (trigger == NULL){
-        sr_err("%s", "ds_trigger_get_value0() error, trigger have'nt be inited.");
-        return SR_ERR_CALL_STATUS;
+static void trigger_stage_check(struct ds_trigger_program *prog, int stage)
+{
+    const struct ds_trigger_stage_prog *sp = &prog->stage[stage];
+    const struct ds_trigger_cond *c0 = &sp->cond[0];
+    const struct ds_trigger_cond *c1 = &sp->cond[1];
+    uint32_t clash;
+    int need_edge;
+    int probe;
+
+    // both conditions of an and stage compare the same probe with
+    // different levels, or want different edges on it
+    if ((sp->logic & 1) && !sp->inv[0] && !sp->inv[1]) {
+        clash = ~c0->mask & ~c1->mask & (c0->value ^ c1->value);
+        clash |= trigger_cond_edges(c0) & trigger_cond_edges(c1) & (c0->value ^ c1->value);
+        if (clash) {
+            probe = 0;
+            while (!(clash & 1)) {
+                clash >>= 1;
+                probe++;
+            }
+            trigger_set_error(prog, DS_TRIGGER_ERR_NEVER, stage, -1, probe);
+        }
     }
 
-    uint16_t value = 0;
-    const uint16_t qutr_mask = (0xffff >> (TriggerProbes - TriggerProbes/4));
-    const uint16_t half_mask = (0xffff >> (TriggerProbes - TriggerProbes/2));
-    int i;
-
-    for (i = msc; i >= lsc ; i--) {
-        value = (value << 1);
-        value += ((trigger->trigger0[stage][i] == '1') | (trigger->trigger0[stage][i] == 'R'));
+    // a probe can not rise or fall on two samples in a row
+    if ((sp->logic & 2) && sp->count > 1) {
+        if (sp->logic & 1)
+            need_edge = (!sp->inv[0] && trigger_cond_edges(c0)) ||
+                        (!sp->inv[1] && trigger_cond_edges(c1));
+        else
+            need_edge = !sp->inv[0] && trigger_cond_edges(c0) &&
+                        !sp->inv[1] && trigger_cond_edges(c1);
+        if (need_edge)
+            trigger_set_error(prog, DS_TRIGGER_ERR_CONTIGUOUS, stage, -1, -1);
     }
-
-    if (qutr_mode)
-        value = ((value & qutr_mask) << (TriggerProbes/4*3)) +
-                ((value & qutr_mask) << (TriggerProbes/4*2)) +
-                ((value & qutr_mask) << (TriggerProbes/4*1)) +
-                ((value & qutr_mask) << (TriggerProbes/4*0));
-    else if (half_mode)
-        value = ((value & half_mask) << (TriggerProbes/2*1)) +
-                ((value & half_mask) << (TriggerProbes/2*0));
-
-    return value;
 }
-SR_PRIV uint16_t ds_trigger_get_value1(uint16_t stage, uint16_t msc, uint16_t lsc, gboolean qutr_mode, gboolean half_mode)
+
+/**
+ * Compile the trigger set up by the ds_trigger_* calls into bit masks,
+ * and check it. The program of every stage is filled even when an error
+ * is returned, with unknown probe settings compared as '0'.
+ *
+ * @return SR_OK upon success, SR_ERR_ARG when the trigger can not work,
+ * prog->error tells why.
+ */
+SR_API int ds_trigger_compile(struct ds_trigger_program *prog)
 {
-    assert(stage <= TriggerStages);
-    assert(lsc <= msc);
-    assert(msc < MaxTriggerProbes);
+    int i, j, probe;
+    uint32_t clock;
 
-    uint16_t value = 0;
-    const uint16_t qutr_mask = (0xffff >> (TriggerProbes - TriggerProbes/4));
-    const uint16_t half_mask = (0xffff >> (TriggerProbes - TriggerProbes/2));
-    int i;
+    assert(prog);
 
     if (trigger == NULL){
-        sr_err("%s", "ds_trigger_get_value1() error, trigger have'nt be inited.");
+        sr_err("%s", "ds_trigger_compile() error, trigger have'nt be inited.");
         return SR_ERR_CALL_STATUS;
     }
 
-    for (i = msc; i >= lsc ; i--) {
-        value = (value << 1);
-        value += ((trigger->trigger1[stage][i] == '1') | (trigger->trigger1[stage][i] == 'R'));
-    }
-
-    if (qutr_mode)
-        value = ((value & qutr_mask) << (TriggerProbes/4*3)) +
-                ((value & qutr_mask) << (TriggerProbes/4*2)) +
-                ((value & qutr_mask) << (TriggerProbes/4*1)) +
-                ((value & qutr_mask) << (TriggerProbes/4*0));
-    else if (half_mode)
-        value = ((value & half_mask) << (TriggerProbes/2*1)) +
-                ((value & half_mask) << (TriggerProbes/2*0));
+    memset(prog, 0, sizeof(struct ds_trigger_program));
+    prog->mode = trigger->trigger_mode;
+    prog->pos = trigger->trigger_pos;
+    prog->error = DS_TRIGGER_OK;
+    prog->error_stage = -1;
+    prog->error_cond = -1;
+    prog->error_probe = -1;
 
-    return value;
-}
-SR_PRIV uint16_t ds_trigger_get_edge0(uint16_t stage, uint16_t msc, uint16_t lsc, gboolean qutr_mode, gboolean half_mode)
-{
-    assert(stage <= TriggerStages);
-    assert(lsc <= msc);
-    assert(msc < MaxTriggerProbes);
-
-    uint16_t edge = 0;
-    const uint16_t qutr_mask = (0xffff >> (TriggerProbes - TriggerProbes/4));
-    const uint16_t half_mask = (0xffff >> (TriggerProbes - TriggerProbes/2));
-    int i;
+    for (i = 0; i <= TriggerStages; i++) {
+        struct ds_trigger_stage_prog *sp = &prog->stage[i];
 
-    if (trigger == NULL){
-        sr_err("%s", "ds_trigger_get_edge0() error, trigger have'nt be inited.");
-        return SR_ERR_CALL_STATUS;
+        for (j = 0; j < 2; j++) {
+            if (trigger_cond_compile(j ? trigger->trigger1[i] : trigger->trigger0[i],
+                                     &sp->cond[j], &probe) != SR_OK)
+                trigger_set_error(prog, DS_TRIGGER_ERR_CHAR, i, j, probe);
+        }
+        sp->inv[0] = trigger->trigger0_inv[i];
+        sp->inv[1] = trigger->trigger1_inv[i];
+        sp->logic = trigger->trigger_logic[i];
+        sp->count = trigger->trigger0_count[i];
     }
 
-    for (i = msc; i >= lsc ; i--) {
-        edge = (edge << 1);
-        edge += ((trigger->trigger0[stage][i] == 'R') | (trigger->trigger0[stage][i] == 'F') |
-                 (trigger->trigger0[stage][i] == 'C'));
+    if (prog->mode == SIMPLE_TRIGGER) {
+        prog->stages = 1;
+        trigger_stage_check(prog, TriggerStages);
+    }
+    else if (prog->mode == SERIAL_TRIGGER) {
+        prog->stages = STriggerDataStage + 1;
+
+        // the data is taken on exactly one edge of one clock probe, from
+        // exactly one data probe, the upper 16 probes of the data stage
+        // are held by its second condition
+        clock = trigger_cond_edges(&prog->stage[1].cond[0]);
+        if (clock == 0 || (clock & (clock - 1)) != 0)
+            trigger_set_error(prog, DS_TRIGGER_ERR_SERIAL, 1, 0, -1);
+
+        j = 0;
+        for (i = 0; i < TriggerProbes; i++) {
+            j += !(prog->stage[2].cond[0].mask & ((uint32_t)1 << i));
+            j += !(prog->stage[2].cond[1].mask & ((uint32_t)1 << i));
+        }
+        if (j != 1)
+            trigger_set_error(prog, DS_TRIGGER_ERR_SERIAL, 2, 0, -1);
+    }
+    else {
+        prog->stages = trigger->trigger_stages + 1;
+        for (i = 0; i < prog->stages; i++)
+            trigger_stage_check(prog, i);
     }
 
-    if (qutr_mode)
-        edge = ((edge & qutr_mask) << (TriggerProbes/4*3)) +
-               ((edge & qutr_mask) << (TriggerProbes/4*2)) +
-               ((edge & qutr_mask) << (TriggerProbes/4*1)) +
-               ((edge & qutr_mask) << (TriggerProbes/4*0));
-    else if (half_mode)
-        edge = ((edge & half_mask) << (TriggerProbes/2*1)) +
-               ((edge & half_mask) << (TriggerProbes/2*0));
-
-    return edge;
+    return (prog->error == DS_TRIGGER_OK) ? SR_OK : SR_ERR_ARG;
 }
-SR_PRIV uint16_t ds_trigger_get_edge1(uint16_t stage, uint16_t msc, uint16_t lsc, gboolean qutr_mode, gboolean half_mode)
+
+/**
+ * Pack the probes msc..lsc of a compiled mask into the 16 bits of a
+ * trigger register. In the half and quarter modes, the low probes are
+ * repeated over the register.
+ */
+SR_PRIV uint16_t ds_trigger_pack(uint32_t bits, uint16_t msc, uint16_t lsc, gboolean qutr_mode, gboolean half_mode)
 {
-    assert(stage <= TriggerStages);
     assert(lsc <= msc);
     assert(msc < MaxTriggerProbes);
 
-    uint16_t edge = 0;
     const uint16_t qutr_mask = (0xffff >> (TriggerProbes - TriggerProbes/4));
     const uint16_t half_mask = (0xffff >> (TriggerProbes - TriggerProbes/2));
-    int i;
-
-    if (trigger == NULL){
-        sr_err("%s", "ds_trigger_get_edge1() error, trigger have'nt be inited.");
-        return SR_ERR_CALL_STATUS;
-    }
-
-    for (i = msc; i >= lsc ; i--) {
-        edge = (edge << 1);
-        edge += ((trigger->trigger1[stage][i] == 'R') | (trigger->trigger1[stage][i] == 'F') |
-                 (trigger->trigger1[stage][i] == 'C'));
-    }
+    const uint32_t width_mask = (msc - lsc >= 31) ? 0xffffffff : (((uint32_t)1 << (msc - lsc + 1)) - 1);
+    uint16_t reg = (uint16_t)((bits >> lsc) & width_mask);
 
     if (qutr_mode)
-        edge = ((edge & qutr_mask) << (TriggerProbes/4*3)) +
-               ((edge & qutr_mask) << (TriggerProbes/4*2)) +
-               ((edge & qutr_mask) << (TriggerProbes/4*1)) +
-               ((edge & qutr_mask) << (TriggerProbes/4*0));
+        reg = ((reg & qutr_mask) << (TriggerProbes/4*3)) +
+              ((reg & qutr_mask) << (TriggerProbes/4*2)) +
+              ((reg & qutr_mask) << (TriggerProbes/4*1)) +
+              ((reg & qutr_mask) << (TriggerProbes/4*0));
     else if (half_mode)
-        edge = ((edge & half_mask) << (TriggerProbes/2*1)) +
-               ((edge & half_mask) << (TriggerProbes/2*0));
+        reg = ((reg & half_mask) << (TriggerProbes/2*1)) +
+              ((reg & half_mask) << (TriggerProbes/2*0));
 
-    return edge;
+    return reg;
 }
 
 /** @} */
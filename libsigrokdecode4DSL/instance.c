@@ -26,6 +26,7 @@
 #include <inttypes.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include <assert.h>
 #include "log.h"
 
@@ -419,6 +420,7 @@ SRD_API struct srd_decoder_inst *srd_inst_new(struct srd_session *sess,
 	di->got_new_samples = FALSE;
 	di->handled_all_samples = FALSE;
 	di->want_wait_terminate = FALSE;
+	di->want_wait_flush = FALSE;
 	di->decoder_state = SRD_OK;
 	di->python_proc_error = NULL;
 	di->is_task_stop_signal = FALSE;
@@ -502,6 +504,7 @@ static void srd_inst_reset_state(struct srd_decoder_inst *di)
 	di->got_new_samples = FALSE;
 	di->handled_all_samples = FALSE;
 	di->want_wait_terminate = FALSE;
+	di->want_wait_flush = FALSE;
 	di->decoder_state = SRD_OK;
 	/* Conditions and mutex got reset after joining the thread. */
 }
@@ -1038,6 +1041,178 @@ SRD_PRIV int process_samples_until_condition_match(struct srd_decoder_inst *di,
 	return SRD_OK;
 }
 
+static uint64_t next_pin_edge(const uint8_t *buf, uint64_t from,
+		uint64_t end, uint8_t old_sample)
+{
+	const uint64_t fill = old_sample ? ~0ULL : 0;
+	uint64_t pos, word;
+	uint8_t diff;
+
+	/* Whole 64-sample words are skipped while they hold the old level. */
+	pos = from;
+	while (pos < end) {
+		if ((pos & 63) == 0 && pos + 64 <= end) {
+			memcpy(&word, buf + pos / 8, sizeof(word));
+			if (word == fill) {
+				pos += 64;
+				continue;
+			}
+		}
+		diff = (uint8_t)((buf[pos / 8] ^ (uint8_t)fill) >> (pos & 7));
+		if (diff) {
+			pos += __builtin_ctz(diff);
+			return pos < end ? pos : end;
+		}
+		pos = (pos | 7) + 1;
+	}
+
+	return end;
+}
+
+static uint8_t pin_sample(const struct srd_decoder_inst *di, int ch, uint64_t rel)
+{
+	if (*(di->inbuf + ch) == NULL)
+		return *(di->inbuf_const + ch) ? 1 : 0;
+	return *(*(di->inbuf + ch) + rel / 8) & (1 << (rel % 8)) ? 1 : 0;
+}
+
+/**
+ * Collect the edges of the selected channels from the current chunk.
+ *
+ * Starts after the sample of the last wait() / wait_edges() result and
+ * stops when run->count edges were found, or the sample run->limit was
+ * consumed. In both cases the position is left as if wait() matched at
+ * the last consumed sample, so both calls can be mixed freely.
+ *
+ * @param di The decoder instance to use. Must not be NULL.
+ * @param run The channels and limits, found edges are appended to
+ *            run->edges. Must not be NULL.
+ * @param done Will be set to TRUE when the request is complete, FALSE
+ *             when all samples of the chunk were consumed before.
+ *
+ * @retval SRD_OK No errors occured, see done for the result.
+ * @retval SRD_ERR_ARG Invalid arguments.
+ *
+ * @private
+ */
+SRD_PRIV int process_samples_until_edges(struct srd_decoder_inst *di,
+		struct srd_edge_run *run, gboolean *done)
+{
+	uint64_t cur, end, pos, pins, flip, record[2];
+	uint64_t next[64];
+	gboolean limited;
+	int i, num;
+
+	if (!di || !run || !done)
+		return SRD_ERR_ARG;
+
+	*done = FALSE;
+	if (di->want_wait_terminate)
+		return SRD_OK;
+
+	/* The last chunk was consumed, stop at its last sample. */
+	if (!di->got_new_samples) {
+		if (di->want_wait_flush && run->edges->len > 0) {
+			if (!di->abs_cur_matched && di->abs_cur_samplenum > 0) {
+				di->abs_cur_samplenum--;
+				di->abs_cur_matched = TRUE;
+			}
+			di->match_array = 0;
+			*done = TRUE;
+		}
+		return SRD_OK;
+	}
+
+	num = di->dec_num_channels < 64 ? di->dec_num_channels : 64;
+
+	if (di->first_pos) {
+		di->first_pos = FALSE;
+		update_old_pins_array_initial_pins(di);
+	}
+
+	cur = di->abs_cur_samplenum + (di->abs_cur_matched ? 1 : 0);
+	if (run->limit < cur) {
+		*done = TRUE;
+		return SRD_OK;
+	}
+
+	end = di->abs_end_samplenum;
+	limited = run->limit < end;
+	if (limited)
+		end = run->limit + 1;
+
+	/* Edge positions are relative to the chunk start from here on. */
+	cur -= di->abs_start_samplenum;
+	end -= di->abs_start_samplenum;
+	pos = cur;
+
+	pins = 0;
+	for (i = 0; i < num; i++) {
+		if (di->old_pins_array->data[i] == 1)
+			pins |= 1ULL << i;
+		if (!(run->mask & (1ULL << i)))
+			continue;
+		if (*(di->inbuf + i) == NULL)
+			next[i] = (pin_sample(di, i, 0) != ((pins >> i) & 1)) ? cur : end;
+		else
+			next[i] = next_pin_edge(*(di->inbuf + i), cur, end, (pins >> i) & 1);
+	}
+
+	while (run->edges->len / 2 < run->count) {
+		pos = end;
+		for (i = 0; i < num; i++) {
+			if ((run->mask & (1ULL << i)) && next[i] < pos)
+				pos = next[i];
+		}
+		if (pos >= end)
+			break;
+
+		flip = 0;
+		for (i = 0; i < num; i++) {
+			if ((run->mask & (1ULL << i)) && next[i] == pos) {
+				flip |= 1ULL << i;
+				next[i] = (*(di->inbuf + i) == NULL) ? end :
+					next_pin_edge(*(di->inbuf + i), pos + 1, end, !((pins >> i) & 1));
+			}
+		}
+		pins ^= flip;
+
+		/* The other channels are only read at the edges. */
+		for (i = 0; i < num; i++) {
+			if (!(run->mask & (1ULL << i))) {
+				pins &= ~(1ULL << i);
+				pins |= (uint64_t)pin_sample(di, i, pos) << i;
+			}
+		}
+
+		record[0] = di->abs_start_samplenum + pos;
+		record[1] = pins;
+		g_array_append_vals(run->edges, record, 2);
+	}
+
+	if (run->edges->len / 2 >= run->count || limited) {
+		/* Complete, stop at the last edge or at the limit. */
+		if (run->edges->len / 2 < run->count)
+			pos = end - 1;
+		di->abs_cur_samplenum = di->abs_start_samplenum + pos;
+		update_old_pins_array(di);
+		di->abs_cur_matched = TRUE;
+		di->match_array = 0;
+		*done = TRUE;
+		return SRD_OK;
+	}
+
+	/* Consumed the whole chunk, like a wait() without a match. */
+	if (end > cur) {
+		di->abs_cur_samplenum = di->abs_start_samplenum + end - 1;
+		update_old_pins_array(di);
+	}
+	di->abs_cur_samplenum = di->abs_end_samplenum;
+	di->abs_cur_matched = FALSE;
+
+	return SRD_OK;
+}
+
 /**
  * Worker thread (per PD-stack).
  *
@@ -1265,6 +1440,34 @@ SRD_PRIV int srd_inst_decode(struct srd_decoder_inst *di,
 	return SRD_OK;
 }
 
+/**
+ * Tell the worker thread that no more samples will be sent.
+ *
+ * A decoder blocked in wait_edges() returns the edges collected so far,
+ * and the call returns when the decoder waits again, so that end() does
+ * not run while it still handles them. Called before end().
+ *
+ * @param di The decoder instance to call. Must not be NULL.
+ *
+ * @private
+ */
+SRD_PRIV void srd_inst_flush(struct srd_decoder_inst *di)
+{
+	if (!di || !di->thread_handle)
+		return;
+
+	g_mutex_lock(&di->data_mutex);
+	if (!di->want_wait_terminate) {
+		di->want_wait_flush = TRUE;
+		di->handled_all_samples = FALSE;
+		g_cond_signal(&di->got_new_samples_cond);
+
+		while (!di->handled_all_samples && !di->want_wait_terminate)
+			g_cond_wait(&di->handled_all_samples_cond, &di->data_mutex);
+	}
+	g_mutex_unlock(&di->data_mutex);
+}
+
 /**
  * Terminate current decoder work, prepare for re-use on new input data.
  *
@@ -1329,6 +1532,185 @@ SRD_PRIV int srd_inst_terminate_reset(struct srd_decoder_inst *di)
 	return di->decoder_state;
 }
 
+/* One recorded put() call, followed by the marshalled python data. */
+struct put_record_head {
+	uint64_t start_sample;
+	uint64_t end_sample;
+	int32_t output_id;
+	uint32_t size;
+};
+
+/* The python marshal module, only used with the GIL held. */
+static PyObject *py_marshal = NULL;
+
+static PyObject *marshal_module(void)
+{
+	if (!py_marshal)
+		py_marshal = py_import_by_name("marshal");
+
+	return py_marshal;
+}
+
+/**
+ * Start recording every put() call of a decoder instance, so that its
+ * outputs can be fed to an identical stack later by srd_inst_replay(),
+ * without decoding the samples again.
+ *
+ * @param di The decoder instance. Must not be NULL.
+ * @param limit The maximum size of the record in bytes. Recording is
+ *              given up when the record grows bigger.
+ *
+ * @return SRD_OK upon success, a (negative) error code otherwise.
+ */
+SRD_API int srd_inst_record_start(struct srd_decoder_inst *di, uint64_t limit)
+{
+	if (!di)
+		return SRD_ERR_ARG;
+
+	if (di->put_record)
+		g_byte_array_free(di->put_record, TRUE);
+
+	di->put_record = g_byte_array_new();
+	di->put_record_limit = limit;
+
+	return SRD_OK;
+}
+
+/**
+ * Take the record of a decoder instance, and stop recording.
+ *
+ * @param di The decoder instance. Must not be NULL.
+ *
+ * @return The record, to be freed by the caller with g_byte_array_free(),
+ *         or NULL if there is no complete record.
+ */
+SRD_API GByteArray *srd_inst_record_take(struct srd_decoder_inst *di)
+{
+	GByteArray *record;
+
+	if (!di)
+		return NULL;
+
+	record = di->put_record;
+	di->put_record = NULL;
+
+	return record;
+}
+
+/**
+ * Append one put() call to the record, the caller must hold the GIL.
+ *
+ * Python data which can't be marshalled, like decoder defined classes,
+ * makes the record useless, it is dropped then.
+ *
+ * @private
+ */
+SRD_PRIV void srd_inst_record_put(struct srd_decoder_inst *di,
+		uint64_t start_sample, uint64_t end_sample, int output_id,
+		PyObject *py_data)
+{
+	struct put_record_head head;
+	PyObject *py_bytes;
+	char *buf;
+	Py_ssize_t size;
+
+	py_bytes = NULL;
+	if (marshal_module())
+		py_bytes = PyObject_CallMethod(py_marshal, "dumps", "O", py_data);
+	if (!py_bytes || PyBytes_AsStringAndSize(py_bytes, &buf, &size) != 0) {
+		PyErr_Clear();
+		Py_XDECREF(py_bytes);
+		srd_dbg("Instance %s output can't be recorded.", di->inst_id);
+		g_byte_array_free(di->put_record, TRUE);
+		di->put_record = NULL;
+		return;
+	}
+
+	if (di->put_record->len + sizeof(head) + size > di->put_record_limit) {
+		Py_DECREF(py_bytes);
+		srd_dbg("Instance %s record is over the limit.", di->inst_id);
+		g_byte_array_free(di->put_record, TRUE);
+		di->put_record = NULL;
+		return;
+	}
+
+	head.start_sample = start_sample;
+	head.end_sample = end_sample;
+	head.output_id = output_id;
+	head.size = (uint32_t)size;
+	g_byte_array_append(di->put_record, (const guint8 *)&head, sizeof(head));
+	g_byte_array_append(di->put_record, (const guint8 *)buf, size);
+
+	Py_DECREF(py_bytes);
+}
+
+/**
+ * Replay recorded put() calls on a started decoder instance, instead of
+ * sending samples to it. The instance itself does not run, its outputs
+ * go to the callbacks and the stacked decoders as when they were recorded.
+ *
+ * @param di The decoder instance, created with the same decoder, options
+ *           and outputs as the recorded one. Must not be NULL.
+ * @param record The record from srd_inst_record_take().
+ * @param offset The position in the record, updated on return. Start with 0,
+ *               the replay is complete when it reaches record->len.
+ * @param max_count The maximum number of put() calls to replay.
+ * @param error Set to the error message when the replay fails.
+ *
+ * @return SRD_OK upon success, a (negative) error code otherwise.
+ */
+SRD_API int srd_inst_replay(struct srd_decoder_inst *di,
+		const GByteArray *record, uint64_t *offset, uint64_t max_count,
+		char **error)
+{
+	struct put_record_head head;
+	PyObject *py_data, *py_bytes;
+	PyGILState_STATE gstate;
+	int ret;
+
+	if (!di || !record || !offset)
+		return SRD_ERR_ARG;
+
+	/* The recorded outputs include the ones of end(). */
+	di->put_replay = TRUE;
+	ret = SRD_OK;
+
+	gstate = PyGILState_Ensure();
+
+	while (max_count-- > 0 && *offset + sizeof(head) <= record->len) {
+		memcpy(&head, record->data + *offset, sizeof(head));
+		if (*offset + sizeof(head) + head.size > record->len) {
+			ret = SRD_ERR_ARG;
+			break;
+		}
+
+		py_data = NULL;
+		py_bytes = PyBytes_FromStringAndSize(
+			(const char *)record->data + *offset + sizeof(head), head.size);
+		if (py_bytes && marshal_module())
+			py_data = PyObject_CallMethod(py_marshal, "loads", "O", py_bytes);
+		Py_XDECREF(py_bytes);
+		if (!py_data) {
+			srd_exception_catch(error, "Instance %s replay failed",
+					di->inst_id);
+			ret = SRD_ERR_PYTHON;
+			break;
+		}
+
+		ret = srd_inst_put(di, head.start_sample, head.end_sample,
+				head.output_id, py_data);
+		Py_DECREF(py_data);
+		if (ret != SRD_OK)
+			break;
+
+		*offset += sizeof(head) + head.size;
+	}
+
+	PyGILState_Release(gstate);
+
+	return ret;
+}
+
 /** @private */
 SRD_PRIV void srd_inst_free(struct srd_decoder_inst *di)
 {
@@ -1362,6 +1744,8 @@ SRD_PRIV void srd_inst_free(struct srd_decoder_inst *di)
 		g_free(pdo);
 	}
 	g_slist_free(di->pd_output);
+	if (di->put_record)
+		g_byte_array_free(di->put_record, TRUE);
 	g_free(di);
 }
 
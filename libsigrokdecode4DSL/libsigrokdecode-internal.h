@@ -58,6 +58,18 @@ typedef struct {
 	PyObject *sample;
 } srd_logic;
 
+/* Request and result of one Decoder.wait_edges() call. */
+struct srd_edge_run {
+	/* Decoder channels to watch, bit i is channel i. */
+	uint64_t mask;
+	/* Last sample to consume. */
+	uint64_t limit;
+	/* Number of edges wanted. */
+	uint64_t count;
+	/* (samplenum, pins) pairs of uint64_t found so far. */
+	GArray *edges;
+};
+
 /* srd.c */
 SRD_PRIV int srd_decoder_searchpath_add(const char *path);
 
@@ -72,9 +84,15 @@ SRD_PRIV int srd_inst_decode(struct srd_decoder_inst *di,
         uint64_t abs_start_samplenum, uint64_t abs_end_samplenum,
         const uint8_t **inbuf, const uint8_t *inbuf_const, uint64_t inbuflen, char **error);
 SRD_PRIV int process_samples_until_condition_match(struct srd_decoder_inst *di, gboolean *found_match);
+SRD_PRIV int process_samples_until_edges(struct srd_decoder_inst *di,
+		struct srd_edge_run *run, gboolean *done);
+SRD_PRIV void srd_inst_flush(struct srd_decoder_inst *di);
 SRD_PRIV int srd_inst_terminate_reset(struct srd_decoder_inst *di);
 SRD_PRIV void srd_inst_free(struct srd_decoder_inst *di);
 SRD_PRIV void srd_inst_free_all(struct srd_session *sess);
+SRD_PRIV void srd_inst_record_put(struct srd_decoder_inst *di,
+		uint64_t start_sample, uint64_t end_sample, int output_id,
+		PyObject *py_data);
 
 /* log.c */
 #if defined(G_OS_WIN32) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 4))
@@ -94,6 +112,8 @@ SRD_PRIV long srd_decoder_apiver(const struct srd_decoder *d);
 /* type_decoder.c */
 SRD_PRIV PyObject *srd_Decoder_type_new(void);
 SRD_PRIV const char *output_type_name(unsigned int idx);
+SRD_PRIV int srd_inst_put(struct srd_decoder_inst *di, uint64_t start_sample,
+		uint64_t end_sample, int output_id, PyObject *py_data);
 
 /* type_logic.c */
 SRD_PRIV PyObject *srd_logic_type_new(void);
@@ -306,6 +306,9 @@ struct srd_decoder_inst {
 	/** Requests termination of wait() and decode(). */
 	gboolean want_wait_terminate;
 
+	/** The last chunk was sent, wait_edges() returns its partial batch. */
+	gboolean want_wait_flush;
+
     /** First entry of wait(). */
     gboolean first_pos;
 
@@ -323,6 +326,15 @@ struct srd_decoder_inst {
 
 	/** the task normal ends flag */
 	int  is_task_stop_signal;
+
+	/** Serialized put() calls, NULL when not recording. */
+	GByteArray *put_record;
+
+	/** Size limit of put_record. */
+	uint64_t put_record_limit;
+
+	/** The outputs are replayed, end() was called when recording. */
+	gboolean put_replay;
 };
 
 struct srd_pd_output {
@@ -407,6 +419,12 @@ SRD_API struct srd_decoder_inst *srd_inst_find_by_id(struct srd_session *sess,
 		const char *inst_id);
 SRD_API int srd_inst_initial_pins_set_all(struct srd_decoder_inst *di,
 		GArray *initial_pins);
+SRD_API int srd_inst_record_start(struct srd_decoder_inst *di,
+		uint64_t limit);
+SRD_API GByteArray *srd_inst_record_take(struct srd_decoder_inst *di);
+SRD_API int srd_inst_replay(struct srd_decoder_inst *di,
+		const GByteArray *record, uint64_t *offset, uint64_t max_count,
+		char **error);
 
 /* log.c */
 /**
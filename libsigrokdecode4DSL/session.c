@@ -422,13 +422,18 @@ SRD_API int srd_session_end(struct srd_session *sess, char **error)
 		return SRD_ERR;
 	}
 
+	/* The decoder threads need the GIL to hand over their last edges. */
+	for (d = sess->di_list; d; d = d->next)
+		srd_inst_flush(d->data);
+
 	gstate = PyGILState_Ensure();
 
 	for (d = sess->di_list; d; d = d->next)
 	{
 		di = d->data;
 
-		if (PyObject_HasAttrString(di->py_inst, "end"))
+		/* A replayed instance did not run, its end() output is in the record. */
+		if (!di->put_replay && PyObject_HasAttrString(di->py_inst, "end"))
 		{
 			//set the last sample index
 			PyObject *py_cur_samplenum = PyLong_FromUnsignedLongLong(di->abs_cur_samplenum);
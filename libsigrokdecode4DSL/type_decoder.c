@@ -452,44 +452,30 @@ static void release_meta(GVariant *gvar)
 	g_variant_unref(gvar);
 }
 
-static PyObject *Decoder_put(PyObject *self, PyObject *args)
+/**
+ * Deliver one output of a decoder instance: annotations, binary and meta
+ * data go to the frontend callbacks, python data to the stacked decoders.
+ *
+ * The caller must hold the GIL.
+ *
+ * @private
+ */
+SRD_PRIV int srd_inst_put(struct srd_decoder_inst *di, uint64_t start_sample,
+		uint64_t end_sample, int output_id, PyObject *py_data)
 {
 	GSList *l;
-	PyObject *py_data, *py_res;
-	struct srd_decoder_inst *di, *next_di;
+	PyObject *py_res;
+	struct srd_decoder_inst *next_di;
 	struct srd_pd_output *pdo;
 	struct srd_proto_data pdata;
 	struct srd_proto_data_annotation pda;
 	struct srd_proto_data_binary pdb;
-	uint64_t start_sample, end_sample;
-	int output_id;
 	struct srd_pd_callback *cb;
-	PyGILState_STATE gstate; 
-
-	py_data = NULL; //the fourth param from python
-
-	gstate = PyGILState_Ensure();
-
-	if (!(di = srd_inst_find_by_obj(NULL, self))) {
-		/* Shouldn't happen. */
-		srd_dbg("put(): self instance not found.");
-		goto err;
-	}
-
-	if (!PyArg_ParseTuple(args, "KKiO", &start_sample, &end_sample,
-		&output_id, &py_data)) {
-		/*
-		 * This throws an exception, but by returning NULL here we let
-		 * Python raise it. This results in a much better trace in
-		 * controller.c on the decode() method call.
-		 */
-		goto err;
-	}
 
 	if (!(l = g_slist_nth(di->pd_output, output_id))) {
 		srd_err("Protocol decoder %s submitted invalid output ID %d.",
 			di->decoder->name, output_id);
-		goto err;
+		return SRD_ERR_ARG;
 	}
 	pdo = l->data;
 
@@ -584,6 +570,43 @@ static PyObject *Decoder_put(PyObject *self, PyObject *args)
         break;
     }
 
+	return SRD_OK;
+}
+
+static PyObject *Decoder_put(PyObject *self, PyObject *args)
+{
+	PyObject *py_data;
+	struct srd_decoder_inst *di;
+	uint64_t start_sample, end_sample;
+	int output_id;
+	PyGILState_STATE gstate; 
+
+	py_data = NULL; //the fourth param from python
+
+	gstate = PyGILState_Ensure();
+
+	if (!(di = srd_inst_find_by_obj(NULL, self))) {
+		/* Shouldn't happen. */
+		srd_dbg("put(): self instance not found.");
+		goto err;
+	}
+
+	if (!PyArg_ParseTuple(args, "KKiO", &start_sample, &end_sample,
+		&output_id, &py_data)) {
+		/*
+		 * This throws an exception, but by returning NULL here we let
+		 * Python raise it. This results in a much better trace in
+		 * controller.c on the decode() method call.
+		 */
+		goto err;
+	}
+
+	if (di->put_record)
+		srd_inst_record_put(di, start_sample, end_sample, output_id, py_data);
+
+	if (srd_inst_put(di, start_sample, end_sample, output_id, py_data) != SRD_OK)
+		goto err;
+
 	PyGILState_Release(gstate);
 
 	Py_RETURN_NONE;
@@ -963,6 +986,17 @@ ret_9999:
 	return 9999;
 }
 
+/*
+ * srd_inst_flush() waits until the decoder blocks again, the caller
+ * holds data_mutex.
+ */
+static void ack_wait_flush(struct srd_decoder_inst *di)
+{
+	di->want_wait_flush = FALSE;
+	di->handled_all_samples = TRUE;
+	g_cond_signal(&di->handled_all_samples_cond);
+}
+
 /**
  * Create a SKIP condition list for condition-less .wait() calls.
  *
@@ -1052,8 +1086,11 @@ static PyObject *Decoder_wait(PyObject *self, PyObject *args)
 
         /* Wait for new samples to process, or termination request. */
         g_mutex_lock(&di->data_mutex);
-        while (!di->got_new_samples && !di->want_wait_terminate)
+        while (!di->got_new_samples && !di->want_wait_terminate) {
+            if (di->want_wait_flush)
+                ack_wait_flush(di);
             g_cond_wait(&di->got_new_samples_cond, &di->data_mutex);
+        }
 
  
         /*
@@ -1127,6 +1164,161 @@ err:
 	return NULL;
 }
 
+/**
+ * Get the edges of one or more channels in one call.
+ *
+ * self.wait_edges(channels, count[, limit]) takes a channel index, or a
+ * list of channel indices, and returns a bytes object with up to count
+ * (samplenum, pins) pairs of native uint64_t, one per sample where at
+ * least one of the channels changed. Bit i of pins is the value of
+ * channel i at that sample. Use memoryview(...).cast('Q') to read it.
+ *
+ * Fewer pairs are returned when the sample limit was reached, or when the
+ * last chunk was consumed: srd_session_end() flushes the instance before
+ * end() is called, the edges found so far are returned then, and the
+ * next wait() or wait_edges() blocks until the decoder is terminated.
+ *
+ * self.samplenum is set like wait() would, to the last edge, to the
+ * limit, or to the last sample of the data, so wait() and wait_edges()
+ * can be mixed.
+ */
+static PyObject *Decoder_wait_edges(PyObject *self, PyObject *args)
+{
+	PyObject *py_channels, *py_item, *py_limit, *py_edges;
+	Py_ssize_t i, num;
+	long idx;
+	gboolean done;
+	struct srd_edge_run run;
+	struct srd_decoder_inst *di;
+	PyGILState_STATE gstate;
+
+	if (!self || !args)
+		return NULL;
+
+	gstate = PyGILState_Ensure();
+
+	if (!(di = srd_inst_find_by_obj(NULL, self))) {
+		PyErr_SetString(PyExc_Exception, "decoder instance not found");
+		PyGILState_Release(gstate);
+		Py_RETURN_NONE;
+	}
+
+	py_limit = Py_None;
+	if (!PyArg_ParseTuple(args, "OK|O", &py_channels, &run.count, &py_limit)) {
+		/* Let Python raise this exception. */
+		goto err;
+	}
+
+	run.mask = 0;
+	if (PyLong_Check(py_channels)) {
+		num = 1;
+		py_channels = PyTuple_Pack(1, py_channels);
+	} else if (PyList_Check(py_channels) || PyTuple_Check(py_channels)) {
+		num = PySequence_Size(py_channels);
+		Py_INCREF(py_channels);
+	} else {
+		PyErr_SetString(PyExc_TypeError, "channels must be an index or a list of indices");
+		goto err;
+	}
+	for (i = 0; i < num; i++) {
+		py_item = PySequence_GetItem(py_channels, i);
+		idx = py_item ? PyLong_AsLong(py_item) : -1;
+		Py_XDECREF(py_item);
+		if (idx < 0 || idx >= di->dec_num_channels || idx >= 64) {
+			Py_DECREF(py_channels);
+			if (!PyErr_Occurred())
+				PyErr_SetString(PyExc_IndexError, "invalid channel index");
+			goto err;
+		}
+		run.mask |= 1ULL << idx;
+	}
+	Py_DECREF(py_channels);
+
+	if (run.mask == 0 || run.count == 0) {
+		PyErr_SetString(PyExc_ValueError, "wait_edges() needs a channel and a count");
+		goto err;
+	}
+
+	run.limit = UINT64_MAX;
+	if (py_limit != Py_None) {
+		run.limit = PyLong_AsUnsignedLongLong(py_limit);
+		if (PyErr_Occurred())
+			goto err;
+	}
+
+	run.edges = g_array_sized_new(FALSE, FALSE, sizeof(uint64_t),
+				2 * MIN(run.count, 4096));
+
+	while (1) {
+
+		Py_BEGIN_ALLOW_THREADS
+
+		/* Wait for new samples to process, or termination request. */
+		g_mutex_lock(&di->data_mutex);
+		while (!di->got_new_samples && !di->want_wait_terminate) {
+			if (di->want_wait_flush) {
+				/* Return the last edges first, ack on the next call. */
+				if (run.edges->len > 0)
+					break;
+				ack_wait_flush(di);
+			}
+			g_cond_wait(&di->got_new_samples_cond, &di->data_mutex);
+		}
+
+		done = FALSE;
+
+		/* Ignore return value for now, should never be negative. */
+		process_samples_until_edges(di, &run, &done);
+
+		Py_END_ALLOW_THREADS
+
+		if (done) {
+			PyObject *py_cur_samplenum = PyLong_FromUnsignedLongLong(di->abs_cur_samplenum);
+			PyObject_SetAttrString(di->py_inst, "samplenum", py_cur_samplenum);
+			Py_DECREF(py_cur_samplenum);
+
+			PyObject *py_matched = PyLong_FromUnsignedLongLong(di->match_array);
+			PyObject_SetAttrString(di->py_inst, "matched", py_matched);
+			Py_DECREF(py_matched);
+
+			g_mutex_unlock(&di->data_mutex);
+
+			py_edges = PyBytes_FromStringAndSize(run.edges->data,
+					run.edges->len * sizeof(uint64_t));
+			g_array_free(run.edges, TRUE);
+
+			PyGILState_Release(gstate);
+
+			return py_edges;
+		}
+
+		/* All samples of the chunk consumed, same as in wait(). */
+		di->got_new_samples = FALSE;
+		di->handled_all_samples = TRUE;
+		di->abs_start_samplenum = 0;
+		di->abs_end_samplenum = 0;
+		di->inbuf = NULL;
+		di->inbuflen = 0;
+
+		g_cond_signal(&di->handled_all_samples_cond);
+
+		if (di->want_wait_terminate) {
+			srd_dbg("%s: %s: Will return from wait_edges().",
+				di->inst_id, __func__);
+			g_mutex_unlock(&di->data_mutex);
+			g_array_free(run.edges, TRUE);
+			goto err;
+		}
+
+		g_mutex_unlock(&di->data_mutex);
+	}
+
+err:
+	PyGILState_Release(gstate);
+
+	return NULL;
+}
+
 /**
  * Return whether the specified channel was supplied to the decoder.
  *
@@ -1248,6 +1440,9 @@ static PyMethodDef Decoder_methods[] = {
 	{ "wait", Decoder_wait, METH_VARARGS,
 			"Wait for one or more conditions to occur" },
 
+	{ "wait_edges", Decoder_wait_edges, METH_VARARGS,
+			"Wait for the next edges of one or more channels" },
+
 	{ "has_channel", Decoder_has_channel, METH_VARARGS,
 			"Report whether a channel was supplied" },
 